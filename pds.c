@@ -0,0 +1,1084 @@
+/********************************************************************
+ *                                                                  *
+ *  Copyright (C) 2026                                              *
+ *  Geoscience Australia, Canberra, Australia                       *
+ *                                                                  *
+ *  This program is free software; you can redistribute it and/or   *
+ *  modify it under the terms of the GNU General Public License as  *
+ *  published by the Free Software Foundation; either version 2 of  *
+ *  the License, or (at your option) any later version.             *
+ *                                                                  *
+ *  This program is distributed in the hope that it will be         *
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied      *
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR         *
+ *  PURPOSE.  See the GNU General Public License for more details.  *
+ *                                                                  *
+ *  You should have received a copy of the GNU General Public       *
+ *  License along with this program; if not, write to the Free      *
+ *  Software Foundation, Inc., 59 Temple Place, Suite 330, Boston,  *
+ *  MA  02111-1307  USA                                             *
+ *                                                                  *
+ ********************************************************************
+ *                                                                  *
+ *  libpds: MODIS Level-0 PDS packet decoding                       *
+ *                                                                  *
+ *  18/10/2026  GA           initial version, decoding taken from   *
+ *                           pdsinfo and pdsmerge                   *
+ *  18/10/2026  GA           decoders per instrument, selected by   *
+ *                           APID table                             *
+ *  18/10/2026  GA           unpack 12bit samples together with     *
+ *                           checksum (SSSE3 if available)          *
+ *  18/10/2026  GA           verification levels, packet data       *
+ *                           skipped below full level               *
+ *  18/10/2026  GA           batch decoding of headers into arrays  *
+ *                           per field (SSSE3 if available)         *
+ *  18/10/2026  GA           integer conversion of packet days to   *
+ *                           calendar date                          *
+ *  18/10/2026  GA           packet time as text (PDSFormatTime())  *
+ *  18/10/2026  GA           SSSE3 kernels built for x86 by target  *
+ *                           attribute and selected at run time     *
+ *                                                                  *
+ ********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAVE_SSSE3_KERNELS
+#include <tmmintrin.h>
+#endif
+
+#include "pds.h"
+
+
+/********************************************************************
+ *                                                                  *
+ *  defines                                                         *
+ *                                                                  *
+ ********************************************************************/
+/* decoder of APID (index into decoders, 0 = unknown instrument) */
+#define APID_DECODER(a) \
+	((((a) >= 64) && ((a) <= 127)) ? 1 : \
+	 (((a) >= 141) && ((a) <= 171)) ? 2 : \
+	 (((a) >= 257) && ((a) <= 290)) ? 3 : \
+	 ((a) == 342) ? 4 : \
+	 (((a) >= 404) && ((a) <= 417)) ? 5 : \
+	 ((a) == 957) ? 6 : 0)
+/* decoders of 8 and 64 consecutive APIDs */
+#define APID_DECODER8(a) \
+	APID_DECODER(a), APID_DECODER((a) + 1), APID_DECODER((a) + 2), \
+	APID_DECODER((a) + 3), APID_DECODER((a) + 4), APID_DECODER((a) + 5), \
+	APID_DECODER((a) + 6), APID_DECODER((a) + 7)
+#define APID_DECODER64(a) \
+	APID_DECODER8(a), APID_DECODER8((a) + 8), APID_DECODER8((a) + 16), \
+	APID_DECODER8((a) + 24), APID_DECODER8((a) + 32), \
+	APID_DECODER8((a) + 40), APID_DECODER8((a) + 48), \
+	APID_DECODER8((a) + 56)
+/* number of samples written per chunk */
+#define SAMPLE_CHUNK 1024
+/* size of EOS secondary header (CCSDS day segmented time code) */
+#define EOS_HDR_SIZE 8
+/* SSSE3 kernels (library itself is built for the base instruction
+	 set) */
+#ifdef HAVE_SSSE3_KERNELS
+#define SSSE3 __attribute__((target("ssse3")))
+#endif
+
+
+/********************************************************************
+ *                                                                  *
+ *  function declarations                                           *
+ *                                                                  *
+ ********************************************************************/
+static void DecodeMODIS(unsigned char *data, int length,
+												struct pds_packet *pkt);
+static void DecodeEOS(unsigned char *data, int length,
+											struct pds_packet *pkt);
+#ifdef HAVE_SSSE3_KERNELS
+static int HaveSSSE3(void);
+static SSSE3 void DecodeHeaders4(unsigned char **p, struct pds_batch *b,
+																 int i);
+static SSSE3 void Transpose4(__m128i *v);
+static SSSE3 int Unpack12SSSE3(unsigned char *buf, int n,
+															 unsigned short *out, unsigned long *s);
+#endif
+
+
+/********************************************************************
+ *                                                                  *
+ *  decoders                                                        *
+ *                                                                  *
+ ********************************************************************/
+/* instruments (Aqua APIDs for CERES, AMSU-A, HSB, AIRS and GBAD) */
+static const struct pds_decoder decoders[] = {
+	{ NULL, 0, NULL },
+	{ "MODIS", MODIS_HDR_SIZE, DecodeMODIS },
+	{ "CERES", EOS_HDR_SIZE, DecodeEOS },
+	{ "AMSU-A", EOS_HDR_SIZE, DecodeEOS },
+	{ "HSB", EOS_HDR_SIZE, DecodeEOS },
+	{ "AIRS", EOS_HDR_SIZE, DecodeEOS },
+	{ "GBAD", EOS_HDR_SIZE, DecodeEOS }
+};
+
+/* decoder of each APID, resolved at compile time */
+static const unsigned char apid_decoder[2048] = {
+	APID_DECODER64(0), APID_DECODER64(64), APID_DECODER64(128),
+	APID_DECODER64(192), APID_DECODER64(256), APID_DECODER64(320),
+	APID_DECODER64(384), APID_DECODER64(448), APID_DECODER64(512),
+	APID_DECODER64(576), APID_DECODER64(640), APID_DECODER64(704),
+	APID_DECODER64(768), APID_DECODER64(832), APID_DECODER64(896),
+	APID_DECODER64(960), APID_DECODER64(1024), APID_DECODER64(1088),
+	APID_DECODER64(1152), APID_DECODER64(1216), APID_DECODER64(1280),
+	APID_DECODER64(1344), APID_DECODER64(1408), APID_DECODER64(1472),
+	APID_DECODER64(1536), APID_DECODER64(1600), APID_DECODER64(1664),
+	APID_DECODER64(1728), APID_DECODER64(1792), APID_DECODER64(1856),
+	APID_DECODER64(1920), APID_DECODER64(1984)
+};
+
+
+/********************************************************************
+ *                                                                  *
+ *  read and decode next packet                                     *
+ *                                                                  *
+ *  The primary header and the data of the packet are read into     *
+ *  buf, which has to hold PDS_PKT_SIZE bytes. Packets of a known   *
+ *  instrument get their secondary header decoded by the decoder    *
+ *  of their APID (time and validity in pkt->info, MODIS packets    *
+ *  also in pkt->mhdr). Packets with unsupported version are read   *
+ *  as well (their length is the only thing we can trust), so the   *
+ *  caller can copy them and carry on with the next packet.         *
+ *                                                                  *
+ *  f:   PDS file pointer                                           *
+ *  buf: pointer to packet buffer                                   *
+ *  pkt: pointer to store decoded packet                            *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *           1 - end of file                                        *
+ *          -1 - error reading primary header                       *
+ *          -2 - unsupported packet version (packet read)           *
+ *          -3 - error reading data (primary header decoded)        *
+ *          -4 - packet too long (primary header decoded)           *
+ *                                                                  *
+ ********************************************************************/
+int PDSNextPacket(struct pds_file *f, unsigned char *buf,
+									struct pds_packet *pkt) {
+	/* read and check everything */
+	return(PDSReadPacket(f, buf, pkt, PDS_LEVEL_FULL));
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  read and decode next packet up to verification level            *
+ *                                                                  *
+ *  Like PDSNextPacket(), but below PDS_LEVEL_DATA only the headers *
+ *  are read into buf and the rest of the packet is skipped         *
+ *  (plain files are positioned, compressed files decompressed).    *
+ *  With PDS_LEVEL_SECONDARY the decoder gets the secondary header  *
+ *  only, the time is set but the packet isn't checked (valid is    *
+ *  set, MODIS checksum and samples are 0), with PDS_LEVEL_HEADER   *
+ *  only the primary header is decoded (no decoder is looked up).   *
+ *  PDS_LEVEL_DATA is PDS_LEVEL_SECONDARY with the whole packet     *
+ *  read into buf, so it can be checked later by PDSCheckPacket().  *
+ *  pkt->size is the size of the whole packet in the file.          *
+ *                                                                  *
+ *  f:     PDS file pointer                                         *
+ *  buf:   pointer to packet buffer                                 *
+ *  pkt:   pointer to store decoded packet                          *
+ *  level: PDS_LEVEL_HEADER, PDS_LEVEL_SECONDARY, PDS_LEVEL_DATA or *
+ *         PDS_LEVEL_FULL                                           *
+ *                                                                  *
+ *  result: see PDSNextPacket()                                     *
+ *                                                                  *
+ ********************************************************************/
+int PDSReadPacket(struct pds_file *f, unsigned char *buf,
+									struct pds_packet *pkt, int level) {
+	/* pointer to data */
+	unsigned char *data = buf + PRI_HDR_SIZE;
+	/* length of data */
+	int length;
+	/* number of bytes read */
+	int n;
+	/* size of secondary header */
+	int hdr_size;
+	/* error code */
+	int error;
+
+
+	/* read primary header */
+	pkt->size = 0;
+	if(ReadPriHdr(f, buf))
+		return(PDSEof(f) ? 1 : -1);
+
+	/* decode primary header, take length from buffer as it isn't
+		 decoded for unsupported versions */
+	error = DecodePriHdr(buf, &(pkt->hdr));
+	length = (((int)buf[4]) << 8) + buf[5] + 1;
+
+	/* read data block, below data level only the secondary header */
+	if(length > DATA_SIZE)
+		return(-4);
+	pkt->decoder = (error || (level < PDS_LEVEL_SECONDARY)) ?
+		NULL : PDSDecoder(pkt->hdr.apid);
+	hdr_size = (pkt->decoder && (pkt->decoder->hdr_size < length)) ?
+		pkt->decoder->hdr_size : 0;
+	n = (level < PDS_LEVEL_DATA) ? hdr_size : length;
+	if(PDSRead(f, data, n) || ((n < length) && PDSSkip(f, length - n)))
+		return(-3);
+	pkt->size = PRI_HDR_SIZE + length;
+
+	/* packet info */
+	pkt->info.apid = error ? -1 : pkt->hdr.apid;
+	pkt->info.pkt_count = pkt->hdr.pkt_count;
+	pkt->info.modis = 0;
+	pkt->nsamples = 0;
+	if(error)
+		return(-2);
+
+	/* decode secondary header */
+	if(pkt->decoder && (level < PDS_LEVEL_FULL)) {
+		pkt->decoder->decode(data, hdr_size, pkt);
+		pkt->info.valid = 1;
+		pkt->mhdr.checksum = 0;
+	} else if(pkt->decoder)
+		pkt->decoder->decode(data, length, pkt);
+
+	/* alles klar */
+	return(0);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  check packet read with PDS_LEVEL_DATA                           *
+ *                                                                  *
+ *  Runs the full decoder on the packet in buf, which sets validity *
+ *  and MODIS checksum and unpacks the samples like PDSNextPacket() *
+ *  would have done.                                                *
+ *                                                                  *
+ *  buf: pointer to packet buffer                                   *
+ *  pkt: pointer to decoded packet                                  *
+ *                                                                  *
+ *  result: 1 - packet valid                                        *
+ *          0 - packet invalid                                      *
+ *                                                                  *
+ ********************************************************************/
+int PDSCheckPacket(unsigned char *buf, struct pds_packet *pkt) {
+	/* decode again with whole data */
+	if(pkt->decoder)
+		pkt->decoder->decode(buf + PRI_HDR_SIZE, pkt->size - PRI_HDR_SIZE,
+												 pkt);
+
+	/* voila */
+	return(pkt->info.valid);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  get decoder of APID                                             *
+ *                                                                  *
+ *  apid: APID                                                      *
+ *                                                                  *
+ *  result: pointer to decoder, NULL if instrument unknown          *
+ *                                                                  *
+ ********************************************************************/
+const struct pds_decoder *PDSDecoder(int apid) {
+	/* out of range? */
+	if((apid < 0) || (apid > 2047) || !apid_decoder[apid])
+		return(NULL);
+
+	/* gut */
+	return(&(decoders[apid_decoder[apid]]));
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  decode MODIS packet                                             *
+ *                                                                  *
+ *  The samples are unpacked into pkt->samples (if not NULL) in the *
+ *  same pass that calculates the checksum.                         *
+ *                                                                  *
+ *  data:   pointer to data (after primary header)                  *
+ *  length: length of data                                          *
+ *  pkt:    pointer to decoded packet                               *
+ *                                                                  *
+ *  result: none                                                    *
+ *                                                                  *
+ ********************************************************************/
+static void DecodeMODIS(unsigned char *data, int length,
+												struct pds_packet *pkt) {
+	/* number of samples */
+	int n;
+
+
+	/* number of samples (without checksum) */
+	n = (length - MODIS_HDR_SIZE) / 1.5 - 1;
+	pkt->nsamples = (n > 0) ? n : 0;
+
+	/* decode MODIS header, unpack samples and test checksum */
+	DecodeMODISHdr(data, length, &(pkt->mhdr));
+	pkt->info.modis = 1;
+	pkt->info.valid =
+		(Unpack12(&(data[MODIS_HDR_SIZE]), n, pkt->samples) ==
+		 pkt->mhdr.checksum);
+	pkt->info.days = pkt->mhdr.days;
+	pkt->info.millisec = pkt->mhdr.millisec;
+	pkt->info.microsec = pkt->mhdr.microsec;
+	pkt->info.pkt_type = pkt->mhdr.pkt_type;
+	pkt->info.src1 = pkt->mhdr.src1;
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  decode packet with EOS secondary header                         *
+ *                                                                  *
+ *  The secondary header holds the time as CCSDS day segmented      *
+ *  time code like the MODIS header (days since 01/01/1958,         *
+ *  milliseconds of day, microseconds of millisecond). There's no   *
+ *  checksum, a packet is valid if it holds the whole header.       *
+ *                                                                  *
+ *  data:   pointer to data (after primary header)                  *
+ *  length: length of data                                          *
+ *  pkt:    pointer to decoded packet                               *
+ *                                                                  *
+ *  result: none                                                    *
+ *                                                                  *
+ ********************************************************************/
+static void DecodeEOS(unsigned char *data, int length,
+											struct pds_packet *pkt) {
+	/* header complete? */
+	pkt->info.valid = (length >= EOS_HDR_SIZE);
+	pkt->info.pkt_type = 0;
+	pkt->info.src1 = 0;
+	if(!pkt->info.valid) {
+		pkt->info.days = 0;
+		pkt->info.millisec = 0;
+		pkt->info.microsec = 0;
+		return;
+	}
+
+	/* time */
+	pkt->info.days = (((int)data[0]) << 8) + data[1];
+	pkt->info.millisec =
+		(((unsigned long int)data[2]) << 24) +
+		(((unsigned long int)data[3]) << 16) +
+		(((unsigned long int)data[4]) << 8) +
+		(((unsigned long int)data[5]));
+	pkt->info.microsec = (((int)data[6]) << 8) + data[7];
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  read primary header from file                                   *
+ *                                                                  *
+ *  f:   PDS file pointer                                           *
+ *  buf: pointer to buffer                                          *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          -1 - read error                                         *
+ *                                                                  *
+ ********************************************************************/
+int ReadPriHdr(struct pds_file *f, unsigned char *buf) {
+	/* read header */
+	if(PDSRead(f, buf, PRI_HDR_SIZE))
+		return(-1);
+
+	/* ois rodger */
+	return(0);
+}
+
+
+
+
+/********************************************************************
+ *                                                                  *
+ *  decode primary header                                           *
+ *                                                                  *
+ *  buf: pointer to buffer                                          *
+ *  hdr: pointer to header structure                                *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          -1 - decode error (version not supported)               *
+ *                                                                  *
+ ********************************************************************/
+int DecodePriHdr(unsigned char *buf, struct pri_hdr *hdr) {
+	/* version */
+	hdr->version = (buf[0] & 0xE0) >> 5;
+
+	/* version supported? */
+	if(hdr->version != 0)
+		return(-1);
+
+	/* type */
+	hdr->type = (buf[0] & 0x10) >> 4;
+
+	/* secondary header flag */
+	hdr->sec_hdr_flag = (buf[0] & 0x08) >> 3;
+
+	/* APID */
+	hdr->apid = (((int)(buf[0] & 0x07)) << 8) + buf[1];
+
+	/* sequence flags */
+	hdr->seq_flags = (buf[2] & 0xC0) >> 6;
+
+	/* packet count per APID */
+	hdr->pkt_count = (((int)(buf[2] & 0x3F)) << 8) + buf[3];
+
+	/* packet length (length - 1) */
+	hdr->pkt_length = (((int)buf[4]) << 8) + buf[5];
+
+	/* okeydokey */
+	return(0);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  decode MODIS header                                             *
+ *                                                                  *
+ *  buf: pointer to buffer                                          *
+ *  len: data lengh                                                 *
+ *  hdr: pointer to header structure                                *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          -1 - decode error                                       *
+ *          -2 - decode error                                       *
+ *                                                                  *
+ ********************************************************************/
+int DecodeMODISHdr(unsigned char *buf, int len,
+									 struct modis_hdr *hdr) {
+	/* days since 01/01/1958 */
+	hdr->days =
+		(((int)buf[0]) << 8) +
+		(((int)buf[1]));
+	
+	/* milliseconds of day */
+	hdr->millisec =
+		(((unsigned long int)buf[2]) << 24) +
+		(((unsigned long int)buf[3]) << 16) +
+		(((unsigned long int)buf[4]) << 8) +
+		(((unsigned long int)buf[5]));
+	
+	/* microseconds of milliseconds */
+	hdr->microsec =
+		(((int)buf[6]) << 8) +
+		(((int)buf[7]));
+	
+	/* quicklook flag */
+	hdr->ql = (buf[8] & 0x80) >> 7;
+	
+	/* packet type */
+	hdr->pkt_type = (buf[8] & 0x70) >> 4;
+	
+	/* scan count */
+	hdr->scan_count = (buf[8] & 0x0E) >> 1;
+	
+	/* mirror side */
+	hdr->mirror_side = (buf[8] & 1);
+	
+	/* source identification (0 = earth, 1 = calibration) */
+	hdr->src1 = (buf[9] & 0x80) >> 7;
+
+	/* source identification (0 = eng., 1 to 1354 = sample count) */
+	hdr->src2 =
+		(((int)buf[9] & 0x7F) << 4) +
+		(((int)buf[10] & 0xF0) >> 4);
+
+	/* FPA/AEM config */
+	hdr->conf =
+		(((int)buf[10] & 0x0F) << 6) +
+		(((int)buf[11] & 0xFC) >> 2);
+
+	/* sci state */
+	hdr->sci_state = (((int)buf[11] & 0x02) >> 1);
+
+	/* sci abnorm */
+	hdr->sci_abnorm = (((int)buf[11] & 0x01));
+
+	/* check sum */
+	hdr->checksum =
+		(((int)buf[len - 2] & 0x0F) << 8) +
+		(((int)buf[len - 1]));
+
+	/* passt */
+	return(0);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  find packets in buffer                                          *
+ *                                                                  *
+ *  Follows the packet lengths from the start of the buffer and     *
+ *  stores the offsets of the packets lying completely inside.      *
+ *                                                                  *
+ *  buf:     pointer to buffer (starting with a packet)             *
+ *  n:       number of bytes in buffer                              *
+ *  offsets: pointer to store offsets of packets                    *
+ *  max:     maximum number of packets                              *
+ *                                                                  *
+ *  result: number of packets found                                 *
+ *                                                                  *
+ ********************************************************************/
+int PDSFindPackets(unsigned char *buf, long n, long *offsets, int max) {
+	/* number of packets */
+	int count = 0;
+	/* offset and size of packet */
+	long off = 0, size;
+
+
+	/* follow packet lengths */
+	while((count < max) && (off + PRI_HDR_SIZE <= n)) {
+		size = PRI_HDR_SIZE + (((long)buf[off + 4]) << 8) + buf[off + 5] + 1;
+		if(off + size > n)
+			break;
+		offsets[count++] = off;
+		off += size;
+	}
+
+	/* tschuess */
+	return(count);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  decode headers of batch of packets                              *
+ *                                                                  *
+ *  Decodes the primary header, the time of the secondary header,   *
+ *  MODIS packet type and source and the checksum in the last word  *
+ *  of up to PDS_BATCH packets into one array per field. Nothing is *
+ *  checked: time and packet type only make sense for packets of    *
+ *  instruments with decoder, the checksum for MODIS packets, it's  *
+ *  -1 for packets not ending inside the buffer. On CPUs with SSSE3 *
+ *  the first 16 bytes of 4 packets at a time are rearranged by     *
+ *  byte shuffles and transposed into the arrays (DecodeHeaders4()).*
+ *                                                                  *
+ *  buf:     pointer to buffer                                      *
+ *  n:       number of bytes in buffer                              *
+ *  offsets: offsets of packets in buffer (see PDSFindPackets())    *
+ *  count:   number of packets                                      *
+ *  b:       pointer to store headers                               *
+ *                                                                  *
+ *  result: number of packets decoded                               *
+ *                                                                  *
+ ********************************************************************/
+int PDSDecodeBatch(unsigned char *buf, long n, long *offsets, int count,
+									 struct pds_batch *b) {
+	/* counters */
+	int i, j;
+	/* headers of 4 packets */
+	unsigned char *p[4];
+	/* copies of headers reaching past the end of buffer */
+	unsigned char tail[4][16];
+	/* end of packet */
+	long end;
+	/* use SSSE3 kernel */
+	int simd = 0;
+
+
+#ifdef HAVE_SSSE3_KERNELS
+	simd = HaveSSSE3();
+#endif
+
+	/* not more than a batch */
+	if(count > PDS_BATCH)
+		count = PDS_BATCH;
+	b->n = count;
+
+	/* 4 packets per step (the arrays hold a multiple of 4) */
+	for(i = 0; i < count; i += 4) {
+		/* first 16 bytes of packets, zero padded at end of buffer */
+		for(j = 0; j < 4; j++) {
+			if((i + j < count) && (offsets[i + j] + 16 <= n)) {
+				p[j] = buf + offsets[i + j];
+				continue;
+			}
+			memset(tail[j], 0, 16);
+			if((i + j < count) && (offsets[i + j] < n))
+				memcpy(tail[j], buf + offsets[i + j], n - offsets[i + j]);
+			p[j] = tail[j];
+		}
+
+#ifdef HAVE_SSSE3_KERNELS
+		if(simd) {
+			DecodeHeaders4(p, b, i);
+			continue;
+		}
+#endif
+
+		/* field by field */
+		for(j = 0; j < 4; j++) {
+			b->version[i + j] = p[j][0] >> 5;
+			b->apid[i + j] = (((int)(p[j][0] & 0x07)) << 8) + p[j][1];
+			b->pkt_count[i + j] = (((int)(p[j][2] & 0x3F)) << 8) + p[j][3];
+			b->pkt_length[i + j] = (((int)p[j][4]) << 8) + p[j][5];
+			b->days[i + j] = (((int)p[j][6]) << 8) + p[j][7];
+			b->millisec[i + j] =
+				(((unsigned int)p[j][8]) << 24) +
+				(((unsigned int)p[j][9]) << 16) +
+				(((unsigned int)p[j][10]) << 8) +
+				(((unsigned int)p[j][11]));
+			b->microsec[i + j] = (((int)p[j][12]) << 8) + p[j][13];
+			b->pkt_type[i + j] = (p[j][14] & 0x70) >> 4;
+			b->src1[i + j] = (p[j][15] & 0x80) >> 7;
+		}
+	}
+
+	/* MODIS packets and checksum in last word of packet */
+	for(i = 0; i < count; i++) {
+		b->modis[i] = (apid_decoder[b->apid[i]] == 1);
+		end = offsets[i] + PRI_HDR_SIZE + b->pkt_length[i] + 1;
+		b->checksum[i] = (end <= n) ?
+			(((int)buf[end - 2] & 0x0F) << 8) + buf[end - 1] : -1;
+	}
+
+	/* ois rodger */
+	return(count);
+}
+
+
+#ifdef HAVE_SSSE3_KERNELS
+/********************************************************************
+ *                                                                  *
+ *  test CPU for SSSE3                                              *
+ *                                                                  *
+ *  result: 1 - SSSE3 kernels can be used                           *
+ *          0 - otherwise                                           *
+ *                                                                  *
+ ********************************************************************/
+static int HaveSSSE3(void) {
+	/* result of test (-1 = not tested yet) */
+	static int have = -1;
+
+
+	if(have < 0) {
+		__builtin_cpu_init();
+		have = __builtin_cpu_supports("ssse3") ? 1 : 0;
+	}
+	return(have);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  decode headers of 4 packets with SSSE3 (see PDSDecodeBatch())   *
+ *                                                                  *
+ *  p: pointers to first 16 bytes of packets                        *
+ *  b: pointer to store headers                                     *
+ *  i: index of first packet in batch                               *
+ *                                                                  *
+ *  result: none                                                    *
+ *                                                                  *
+ ********************************************************************/
+static SSSE3 void DecodeHeaders4(unsigned char **p, struct pds_batch *b,
+																 int i) {
+	/* byte shuffles of primary and secondary header */
+	__m128i pri, sec;
+	/* shuffled headers */
+	__m128i v[4], w[4];
+	/* counter */
+	int j;
+
+
+	/* big endian fields into 32bit lanes: APID, packet count, packet
+		 length and days, millisec, microsec, packet type and source
+		 bytes and version byte */
+	pri = _mm_setr_epi8(1, 0, -1, -1, 3, 2, -1, -1, 5, 4, -1, -1,
+											7, 6, -1, -1);
+	sec = _mm_setr_epi8(11, 10, 9, 8, 13, 12, -1, -1, 14, 15, -1, -1,
+											0, -1, -1, -1);
+
+	/* one vector per packet, then one vector per field */
+	for(j = 0; j < 4; j++) {
+		v[j] = _mm_loadu_si128((__m128i *)p[j]);
+		w[j] = _mm_shuffle_epi8(v[j], sec);
+		v[j] = _mm_shuffle_epi8(v[j], pri);
+	}
+	Transpose4(v);
+	Transpose4(w);
+
+	/* store fields */
+	_mm_storeu_si128((__m128i *)(b->apid + i),
+									 _mm_and_si128(v[0], _mm_set1_epi32(0x7FF)));
+	_mm_storeu_si128((__m128i *)(b->pkt_count + i),
+									 _mm_and_si128(v[1], _mm_set1_epi32(0x3FFF)));
+	_mm_storeu_si128((__m128i *)(b->pkt_length + i), v[2]);
+	_mm_storeu_si128((__m128i *)(b->days + i), v[3]);
+	_mm_storeu_si128((__m128i *)(b->millisec + i), w[0]);
+	_mm_storeu_si128((__m128i *)(b->microsec + i), w[1]);
+	_mm_storeu_si128((__m128i *)(b->pkt_type + i),
+									 _mm_and_si128(_mm_srli_epi32(w[2], 4),
+																 _mm_set1_epi32(7)));
+	_mm_storeu_si128((__m128i *)(b->src1 + i),
+									 _mm_srli_epi32(w[2], 15));
+	_mm_storeu_si128((__m128i *)(b->version + i),
+									 _mm_srli_epi32(w[3], 5));
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  transpose 4x4 matrix of 32bit values                            *
+ *                                                                  *
+ *  v: pointer to 4 vectors (rows), replaced by columns             *
+ *                                                                  *
+ *  result: none                                                    *
+ *                                                                  *
+ ********************************************************************/
+static SSSE3 void Transpose4(__m128i *v) {
+	/* interleaved rows */
+	__m128i t0, t1, t2, t3;
+
+
+	/* interleave pairs of rows, then pairs of pairs */
+	t0 = _mm_unpacklo_epi32(v[0], v[1]);
+	t1 = _mm_unpacklo_epi32(v[2], v[3]);
+	t2 = _mm_unpackhi_epi32(v[0], v[1]);
+	t3 = _mm_unpackhi_epi32(v[2], v[3]);
+	v[0] = _mm_unpacklo_epi64(t0, t1);
+	v[1] = _mm_unpackhi_epi64(t0, t1);
+	v[2] = _mm_unpacklo_epi64(t2, t3);
+	v[3] = _mm_unpackhi_epi64(t2, t3);
+}
+#endif
+
+
+/********************************************************************
+ *                                                                  *
+ *  convert calendar date to julian day                             *
+ *                                                                  *
+ *  minute: minute of time to convert                               *
+ *  hour:   hour of time to convert                                 *
+ *  day:    day of date to convert                                  *
+ *  month:  month of date to convert                                *
+ *  year:   year of date to convert                                 *
+ *  jul:    pointer to store julian day                             *
+ *                                                                  *
+ *  result: none                                                    *
+ *                                                                  *
+ ********************************************************************/
+void julday(int minute, int hour, int day, int month, int year,
+						double *jul) {
+	/* julian day as long */
+	long ljul;
+	/* helping variables */
+	int ja, jy, jm;
+
+
+	jy = year;
+
+	if(jy < 0)
+		++jy;
+	if(month > 2) {
+		jm = month + 1;
+	} else {
+		--jy;
+		jm = month + 13;
+	}
+	ljul = (long)(floor(365.25 * jy) + floor(30.6001 * jm) + day +
+								1720995);
+	if(day + 31L * (month + 12L * year) >= (15+31L*(10+12L*1582))) {
+		ja = (int)(0.01 * jy);
+		ljul += 2 - ja + (int)(0.25 * ja);
+	}
+
+	*jul =
+		(double)ljul +
+		(double)hour / 24.0 +
+		(double)minute / 1440.0 +
+		0.000001; /* add about 0.1s to avoid precision problems */
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  convert julian day to calendar date                             *
+ *                                                                  *
+ *  minute: pointer to store minute                                 *
+ *  hour:   pointer to store hour                                   *
+ *  day:    pointer to store day                                    *
+ *  month:  pointer to store month                                  *
+ *  year:   pointer to store year                                   *
+ *  jul:    julian day                                              *
+ *                                                                  *
+ *  result: none                                                    *
+ *                                                                  *
+ ********************************************************************/
+void caldat(int *minute, int *hour, int *day, int *month, int *year,
+						double jul) {
+	/* julian day as long */
+	long ljul;
+	/* helping variables */
+	long ja, jalpha, jb, jc, jd, je;
+
+
+	ljul = (long)floor(jul);
+	jul -= (double)ljul;
+	*hour = (int)(floor(jul * 24.0));
+	jul -= (double)*hour / 24.0;
+	*minute = (int)(floor(jul * 1440.0));
+
+	if(ljul >= 2299161) {
+		jalpha = (long)(((float)(ljul - 1867216) - 0.25) / 36524.25);
+		ja = ljul + 1 + jalpha -(long)(0.25 * jalpha);
+	} else
+		ja = ljul;
+	jb = ja + 1524;
+	jc = (long)(6680.0 + ((float)(jb - 2439870) - 122.1) / 365.25);
+	jd = (long)(365 * jc + (0.25 * jc));
+	je = (long)((jb - jd) / 30.6001);
+	*day = jb - jd -(long)(30.6001*je);
+	*month = je - 1;
+	if(*month > 12)
+		*month -= 12;
+	*year = jc - 4715;
+	if(*month > 2)
+		--(*year);
+	if(*year <= 0)
+		--(*year);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  convert packet days to calendar date                            *
+ *                                                                  *
+ *  Integer only, so cheap enough to be called per packet, and      *
+ *  exact for all days of the time code (no rounding like julday()  *
+ *  and caldat()). The days are shifted to a year starting on 1st   *
+ *  of March, so the leap day is the last day of the year, and      *
+ *  split into 400 year cycles of 146097 days.                      *
+ *                                                                  *
+ *  days:  days since 01/01/1958                                    *
+ *  year:  pointer to store year                                    *
+ *  month: pointer to store month                                   *
+ *  day:   pointer to store day                                     *
+ *                                                                  *
+ *  result: none                                                    *
+ *                                                                  *
+ ********************************************************************/
+void PDSCivilDate(long days, int *year, int *month, int *day) {
+	/* days since 01/03/0000 */
+	long z;
+	/* 400 year cycle, day and year of cycle */
+	long era, doe, yoe;
+	/* day of year and month starting in March */
+	long doy, mp;
+
+
+	/* 01/01/1958 is day 715085 since 01/03/0000 */
+	z = days + 715085L;
+	era = ((z >= 0) ? z : z - 146096L) / 146097L;
+	doe = z - era * 146097L;
+
+	/* year of cycle, corrected by leap days of 4, 100 and 400 years */
+	yoe = (doe - doe / 1460L + doe / 36524L - doe / 146096L) / 365L;
+	doy = doe - (365L * yoe + yoe / 4L - yoe / 100L);
+
+	/* month and day, January and February belong to next year */
+	mp = (5L * doy + 2L) / 153L;
+	*day = doy - (153L * mp + 2L) / 5L + 1L;
+	*month = (mp < 10L) ? mp + 3L : mp - 9L;
+	*year = yoe + era * 400L + (*month <= 2);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  format packet time as YYYY/MM/DD hh:mm:ss[.uuuuuu]              *
+ *                                                                  *
+ *  s:    pointer to buffer (at least 27 characters)                *
+ *  t:    microseconds since 01/01/1958                             *
+ *  usec: append microseconds of second                             *
+ *                                                                  *
+ *  result: none                                                    *
+ *                                                                  *
+ ********************************************************************/
+void PDSFormatTime(char *s, unsigned long long t, int usec) {
+	/* date */
+	int day, month, year;
+	/* microseconds of day */
+	unsigned long long us;
+
+
+	/* date */
+	PDSCivilDate((long)(t / 86400000000ULL), &year, &month, &day);
+
+	/* time */
+	us = t % 86400000000ULL;
+	sprintf(s, "%04d/%02d/%02d %02d:%02d:%02d", year, month, day,
+					(int)(us / 3600000000ULL), (int)(us / 60000000ULL % 60),
+					(int)(us / 1000000ULL % 60));
+	if(usec)
+		sprintf(s + 19, ".%06d", (int)(us % 1000000ULL));
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  calculate 12bit checksum                                        *
+ *                                                                  *
+ *  buf: pointer to data buffer                                     *
+ *  n:   number of 12bit values in buffer                           *
+ *                                                                  *
+ *  result: checksum                                                *
+ *                                                                  *
+ ********************************************************************/
+int CalcChecksum12(unsigned char *buf, int n) {
+	/* return checksum */
+	return(Unpack12(buf, n, NULL));
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  unpack 12bit values and calculate their checksum                *
+ *                                                                  *
+ *  Two values are packed into three bytes, most significant bits   *
+ *  first. On CPUs with SSSE3 8 values are unpacked per step by a   *
+ *  byte shuffle (Unpack12SSSE3()).                                 *
+ *                                                                  *
+ *  buf: pointer to data buffer                                     *
+ *  n:   number of 12bit values in buffer                           *
+ *  out: pointer to store values (NULL = checksum only)             *
+ *                                                                  *
+ *  result: checksum                                                *
+ *                                                                  *
+ ********************************************************************/
+int Unpack12(unsigned char *buf, int n, unsigned short *out) {
+	/* counter */
+	int i = 0;
+	/* pointer to pair of values */
+	unsigned char *p;
+	/* data value */
+	unsigned long x;
+	/* checksum */
+	unsigned long s = 0;
+
+
+#ifdef HAVE_SSSE3_KERNELS
+	/* most values 8 at a time */
+	if(HaveSSSE3())
+		i = Unpack12SSSE3(buf, n, out, &s);
+#endif
+
+	/* remaining values */
+	for(; i < n; i += 2) {
+		/* get 1. value */
+		p = buf + i / 2 * 3;
+		x = (((unsigned long)p[0]) << 4) + (p[1] >> 4);
+		s += x;
+		if(out)
+			out[i] = x;
+
+		/* do we have a second value */
+		if(i + 1 >= n)
+			break;
+
+		/* get 2. value */
+		x = (((unsigned long)(p[1] & 0x0F)) << 8) + p[2];
+		s += x;
+		if(out)
+			out[i + 1] = x;
+	}
+
+	/* return checksum */
+	return((s >> 4) & 0xFFF);
+}
+
+
+#ifdef HAVE_SSSE3_KERNELS
+/********************************************************************
+ *                                                                  *
+ *  unpack 12bit values 8 at a time with SSSE3 (see Unpack12())     *
+ *                                                                  *
+ *  buf: pointer to data buffer                                     *
+ *  n:   number of 12bit values in buffer                           *
+ *  out: pointer to store values (NULL = checksum only)             *
+ *  s:   pointer to store sum of values                             *
+ *                                                                  *
+ *  result: number of values unpacked (even, the rest is left to    *
+ *          the caller)                                             *
+ *                                                                  *
+ ********************************************************************/
+static SSSE3 int Unpack12SSSE3(unsigned char *buf, int n,
+															 unsigned short *out, unsigned long *s) {
+	/* byte shuffle, masks of even and odd values, packed values */
+	__m128i shuffle, even, odd, ones, v, sum;
+	/* partial sums */
+	int sums[4];
+	/* counter */
+	int i;
+
+
+	/* 8 values (12 bytes) per step, the 16 byte load stays within
+		 the n values */
+	shuffle = _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+	even = _mm_set1_epi32(0x00000FFF);
+	odd = _mm_set1_epi32(0x0FFF0000);
+	ones = _mm_set1_epi16(1);
+	sum = _mm_setzero_si128();
+	for(i = 0; i + 11 <= n; i += 8) {
+		v = _mm_shuffle_epi8(_mm_loadu_si128((__m128i *)(buf + i / 2 * 3)),
+												 shuffle);
+		v = _mm_or_si128(_mm_and_si128(_mm_srli_epi16(v, 4), even),
+										 _mm_and_si128(v, odd));
+		sum = _mm_add_epi32(sum, _mm_madd_epi16(v, ones));
+		if(out)
+			_mm_storeu_si128((__m128i *)(out + i), v);
+	}
+	_mm_storeu_si128((__m128i *)sums, sum);
+	*s = (unsigned long)sums[0] + sums[1] + sums[2] + sums[3];
+
+	/* voila */
+	return(i);
+}
+#endif
+
+
+/********************************************************************
+ *                                                                  *
+ *  write samples of packet                                         *
+ *                                                                  *
+ *  Writes number of samples (2 bytes) followed by the samples (2   *
+ *  bytes each), all little endian.                                 *
+ *                                                                  *
+ *  f:   output file                                                *
+ *  pkt: pointer to decoded packet with samples                     *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          -1 - write error                                        *
+ *                                                                  *
+ ********************************************************************/
+int PDSWriteSamples(FILE *f, struct pds_packet *pkt) {
+	/* buffer */
+	unsigned char buf[2 * SAMPLE_CHUNK];
+	/* counters */
+	int i, j;
+
+
+	/* number of samples */
+	buf[0] = pkt->nsamples & 0xFF;
+	buf[1] = pkt->nsamples >> 8;
+	if(fwrite(buf, 2, 1, f) != 1)
+		return(-1);
+
+	/* samples */
+	for(i = 0; i < pkt->nsamples; i += j) {
+		for(j = 0; (j < SAMPLE_CHUNK) && (i + j < pkt->nsamples); j++) {
+			buf[2 * j] = pkt->samples[i + j] & 0xFF;
+			buf[2 * j + 1] = pkt->samples[i + j] >> 8;
+		}
+		if(fwrite(buf, 2 * j, 1, f) != 1)
+			return(-1);
+	}
+
+	/* gut */
+	return(0);
+}
@@ -0,0 +1,209 @@
+/********************************************************************
+ *                                                                  *
+ *  Copyright (C) 2026                                              *
+ *  Geoscience Australia, Canberra, Australia                       *
+ *                                                                  *
+ *  This program is free software; you can redistribute it and/or   *
+ *  modify it under the terms of the GNU General Public License as  *
+ *  published by the Free Software Foundation; either version 2 of  *
+ *  the License, or (at your option) any later version.             *
+ *                                                                  *
+ *  This program is distributed in the hope that it will be         *
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied      *
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR         *
+ *  PURPOSE.  See the GNU General Public License for more details.  *
+ *                                                                  *
+ *  You should have received a copy of the GNU General Public       *
+ *  License along with this program; if not, write to the Free      *
+ *  Software Foundation, Inc., 59 Temple Place, Suite 330, Boston,  *
+ *  MA  02111-1307  USA                                             *
+ *                                                                  *
+ ********************************************************************
+ *                                                                  *
+ *  libpds: MODIS Level-0 PDS packet decoding                       *
+ *                                                                  *
+ *  Decoding of the CCSDS primary header and the MODIS secondary    *
+ *  header, the 12bit MODIS checksum, julian day conversion and a   *
+ *  packet iterator over PDS files opened with PDSOpen().           *
+ *                                                                  *
+ *  The secondary header is decoded by the decoder of the           *
+ *  instrument, looked up by APID in a table (PDSDecoder()). Known  *
+ *  are MODIS (APID 64 to 127) and the Aqua instruments CERES       *
+ *  (141 to 171), AMSU-A (257 to 290), HSB (342), AIRS (404 to      *
+ *  417) and GBAD (957), whose packets carry the time like MODIS.   *
+ *                                                                  *
+ *  The library keeps no global state: packet buffers belong to     *
+ *  the caller, PDSNextPacket() doesn't allocate memory and         *
+ *  different PDS files and statistics (pdsstat.h) can be used by   *
+ *  different threads at the same time.                             *
+ *                                                                  *
+ *  Passes over the headers only can decode packets held in memory  *
+ *  in batches (PDSFindPackets(), PDSDecodeBatch()) into one array  *
+ *  per field instead of one structure per packet.                  *
+ *                                                                  *
+ *  typical use:                                                    *
+ *   unsigned char buf[PDS_PKT_SIZE];                               *
+ *   struct pds_packet pkt = { 0 };                                 *
+ *   f = PDSOpen(name, threads);                                    *
+ *   while(!PDSNextPacket(f, buf, &pkt))                            *
+ *     StatAdd(&stats, &pkt.info);                                  *
+ *   PDSClose(f);                                                   *
+ *                                                                  *
+ ********************************************************************/
+
+#ifndef PDS_H
+#define PDS_H
+
+#include <stdio.h>
+
+#include "pdsio.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/********************************************************************
+ *                                                                  *
+ *  defines                                                         *
+ *                                                                  *
+ ********************************************************************/
+/* size of primary header */
+#define PRI_HDR_SIZE 6
+/* size of MODIS header */
+#define MODIS_HDR_SIZE 12
+/* size of data buffer */
+#define DATA_SIZE 100000
+/* size of packet buffer (primary header and data) */
+#define PDS_PKT_SIZE (PRI_HDR_SIZE + DATA_SIZE)
+/* maximum number of 12bit samples of packet */
+#define PDS_MAX_SAMPLES (DATA_SIZE * 2 / 3)
+/* verification levels of PDSReadPacket() */
+#define PDS_LEVEL_HEADER 0
+#define PDS_LEVEL_SECONDARY 1
+#define PDS_LEVEL_DATA 2
+#define PDS_LEVEL_FULL 3
+/* maximum number of packets of batch (PDSDecodeBatch()) */
+#define PDS_BATCH 256
+/* reference date (julian day of 01/01/1958) */
+#define MODIS_REF_DATE 2436205.0
+
+
+/********************************************************************
+ *                                                                  *
+ *  structure definitions                                           *
+ *                                                                  *
+ ********************************************************************/
+/* primary header */
+struct pri_hdr {
+	int version;
+	int type;
+	int sec_hdr_flag;
+	int apid;
+	int seq_flags;
+	int pkt_count;
+	int pkt_length;
+};
+
+/* MODIS header */
+struct modis_hdr {
+	int days;
+	unsigned long int millisec;
+	int microsec;
+	int ql;
+	int pkt_type;
+	int scan_count;
+	int mirror_side;
+	int src1;
+	int src2;
+	int conf;
+	int sci_state;
+	int sci_abnorm;
+	int checksum;
+};
+
+/* decoded packet */
+struct pds_packet {
+	/* primary header */
+	struct pri_hdr hdr;
+	/* MODIS header (MODIS packets only) */
+	struct modis_hdr mhdr;
+	/* packet info for statistics and output files, time and validity
+		 set for all packets with decoder */
+	struct pkt_info info;
+	/* decoder of APID (NULL = unknown instrument) */
+	const struct pds_decoder *decoder;
+	/* array of PDS_MAX_SAMPLES to store 12bit samples of MODIS packets
+		 (set by caller, NULL = don't unpack) and number of samples */
+	unsigned short *samples;
+	int nsamples;
+	/* size of packet in buffer (primary header and data) */
+	int size;
+};
+
+/* headers of batch of packets, one array per field */
+struct pds_batch {
+	/* number of packets */
+	int n;
+	/* primary header */
+	int version[PDS_BATCH];
+	int apid[PDS_BATCH];
+	int pkt_count[PDS_BATCH];
+	int pkt_length[PDS_BATCH];
+	/* time of secondary header */
+	int days[PDS_BATCH];
+	unsigned int millisec[PDS_BATCH];
+	int microsec[PDS_BATCH];
+	/* MODIS packet (APID of MODIS), packet type, source
+		 identification and checksum in last word of packet */
+	int modis[PDS_BATCH];
+	int pkt_type[PDS_BATCH];
+	int src1[PDS_BATCH];
+	int checksum[PDS_BATCH];
+};
+
+/* decoder of instrument */
+struct pds_decoder {
+	/* name of instrument */
+	char *name;
+	/* size of secondary header */
+	int hdr_size;
+	/* decode secondary header, set time and validity in packet info */
+	void (*decode)(unsigned char *data, int length,
+								 struct pds_packet *pkt);
+};
+
+
+/********************************************************************
+ *                                                                  *
+ *  function declarations                                           *
+ *                                                                  *
+ ********************************************************************/
+int PDSNextPacket(struct pds_file *f, unsigned char *buf,
+									struct pds_packet *pkt);
+int PDSReadPacket(struct pds_file *f, unsigned char *buf,
+									struct pds_packet *pkt, int level);
+int PDSCheckPacket(unsigned char *buf, struct pds_packet *pkt);
+const struct pds_decoder *PDSDecoder(int apid);
+int ReadPriHdr(struct pds_file *f, unsigned char *buf);
+int DecodePriHdr(unsigned char *buf, struct pri_hdr *hdr);
+int DecodeMODISHdr(unsigned char *buf, int len,
+									 struct modis_hdr *hdr);
+int PDSFindPackets(unsigned char *buf, long n, long *offsets, int max);
+int PDSDecodeBatch(unsigned char *buf, long n, long *offsets, int count,
+									 struct pds_batch *b);
+void julday(int minute, int hour, int day, int month, int year,
+						double *jul);
+void caldat(int *minute, int *hour, int *day, int *month, int *year,
+						double jul);
+void PDSCivilDate(long days, int *year, int *month, int *day);
+void PDSFormatTime(char *s, unsigned long long t, int usec);
+int CalcChecksum12(unsigned char *buf, int n);
+int Unpack12(unsigned char *buf, int n, unsigned short *out);
+int PDSWriteSamples(FILE *f, struct pds_packet *pkt);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,875 @@
+/********************************************************************
+ *                                                                  *
+ *  Copyright (C) 2026                                              *
+ *  Geoscience Australia, Canberra, Australia                       *
+ *                                                                  *
+ *  This program is free software; you can redistribute it and/or   *
+ *  modify it under the terms of the GNU General Public License as  *
+ *  published by the Free Software Foundation; either version 2 of  *
+ *  the License, or (at your option) any later version.             *
+ *                                                                  *
+ *  This program is distributed in the hope that it will be         *
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied      *
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR         *
+ *  PURPOSE.  See the GNU General Public License for more details.  *
+ *                                                                  *
+ *  You should have received a copy of the GNU General Public       *
+ *  License along with this program; if not, write to the Free      *
+ *  Software Foundation, Inc., 59 Temple Place, Suite 330, Boston,  *
+ *  MA  02111-1307  USA                                             *
+ *                                                                  *
+ ********************************************************************
+ *                                                                  *
+ *  catalog of PDS files                                            *
+ *                                                                  *
+ *  Scans directory trees for PDS files and stores time coverage,   *
+ *  APIDs, packet counts and gaps of each file in a catalog. Files  *
+ *  not modified since the last run are taken from the existing     *
+ *  catalog. Queries return the files overlapping a time range      *
+ *  by a binary search of the catalog.                              *
+ *                                                                  *
+ *  18/10/2026  GA           initial version                        *
+ *  18/10/2026  GA           store first and last packet count of   *
+ *                           each APID (catalog version 2)          *
+ *  18/10/2026  GA           packet decoding moved to libpds        *
+ *                           (pds.c)                                *
+ *  18/10/2026  GA           catalog format moved to libpds         *
+ *                           (pdscatalog.c)                         *
+ *  18/10/2026  GA           files stored by canonical path, table  *
+ *                           of names (catalog version 3)           *
+ *                                                                  *
+ ********************************************************************
+ *                                                                  *
+ *  usage: pdscat [-t threads] [-p pattern] <catalog> <dir/file>    *
+ *                [<dir/file> [...]]                                *
+ *         pdscat -q [-a APID] [-l] <catalog> start_date end_date   *
+ *                                                                  *
+ ********************************************************************
+ *                                                                  *
+ *  catalog layout see pdscatalog.h                                 *
+ *                                                                  *
+ ********************************************************************
+ *                                                                  *
+ *  build: cc -DHAVE_ZLIB -DHAVE_BZLIB pdscat.c pds.c pdscatalog.c  *
+ *         pdsio.c pdsstat.c -lz -lbz2 -lpthread -lm -o pdscat      *
+ *                                                                  *
+ ********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+#include <dirent.h>
+#include <fnmatch.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "pds.h"
+#include "pdscatalog.h"
+
+
+/********************************************************************
+ *                                                                  *
+ *  defines                                                         *
+ *                                                                  *
+ ********************************************************************/
+/* name */
+#define NAME "pdscat"
+/* version */
+#define VERSION 1
+/* revision */
+#define REVISION 4
+/* usage */
+#define USAGE "[-t threads] [-p pattern] <catalog> <dir/file> [<dir/file> [...]]\n       %s -q [-a APID] [-l] <catalog> start_date end_date\nstart_date/end_date: YYYY/MM/DD,hh:mm:ss or -"
+/* microseconds per day */
+#define USEC_PER_DAY 86400000000ULL
+/* minimum time step between packets counted as gap (microseconds) */
+#define GAP_USEC 2000000ULL
+
+
+/********************************************************************
+ *                                                                  *
+ *  structure definitions                                           *
+ *                                                                  *
+ ********************************************************************/
+/* catalog */
+struct catalog {
+	long nfiles, cap;
+	struct cat_file *files;
+};
+
+
+/********************************************************************
+ *                                                                  *
+ *  function declarations                                           *
+ *                                                                  *
+ ********************************************************************/
+int ScanPath(char *path, struct catalog *old, struct catalog *cat,
+						 int threads, char *pattern, struct stat *self);
+int ScanFile(char *name, int threads, struct cat_file *e);
+int AddGap(struct cat_file *e, unsigned long long start,
+					 unsigned long long end);
+struct cat_file *AddFile(struct catalog *cat);
+void FreeCatalog(struct catalog *cat);
+int LoadCatalog(char *name, struct catalog *cat);
+int QueryCatalog(char *name, unsigned long long start,
+								 unsigned long long end, int apid, int verbose);
+void PrintFile(struct cat_file *e);
+void PrintTime(char *text, unsigned long long t);
+int GetDate(char *s, unsigned long long *t);
+int CompareName(const void *a, const void *b);
+int CompareTime(const void *a, const void *b);
+
+
+/********************************************************************
+ *                                                                  *
+ *  main function                                                   *
+ *                                                                  *
+ ********************************************************************/
+int main(int argc, char *argv[]) {
+	/* existing and new catalog */
+	struct catalog old, cat;
+	/* status of catalog file */
+	struct stat self;
+	/* number of decompression threads */
+	int threads = 1;
+	/* file name pattern */
+	char *pattern = "*";
+	/* query mode */
+	int query = 0;
+	/* APID to look for in query mode (-1 = any) */
+	int apid = -1;
+	/* list details in query mode */
+	int verbose = 0;
+	/* start and end of query */
+	unsigned long long start, end;
+	/* return value */
+	int retvalue = 0;
+	/* counters */
+	long i, j;
+	/* option character */
+	int c;
+
+
+	/* print version information */
+	fprintf(stderr, "%s V%d.%d ("__DATE__")\n",
+					NAME,	VERSION, REVISION);
+
+	/* get options */
+	while((c = getopt(argc, argv, "t:p:qa:l")) != -1) {
+		switch(c) {
+		case 't':
+			threads = atoi(optarg);
+			if(threads < 1) {
+				fprintf(stderr, "USAGE: %s " USAGE "\n", NAME, NAME);
+				return(20);
+			}
+			break;
+		case 'p':
+			pattern = optarg;
+			break;
+		case 'q':
+			query = 1;
+			break;
+		case 'a':
+			apid = atoi(optarg);
+			break;
+		case 'l':
+			verbose = 1;
+			break;
+		default:
+			fprintf(stderr, "USAGE: %s " USAGE "\n", NAME, NAME);
+			return(20);
+		}
+	}
+
+	/* query catalog */
+	if(query) {
+		if(argc - optind != 3) {
+			fprintf(stderr, "USAGE: %s " USAGE "\n", NAME, NAME);
+			return(20);
+		}
+
+		/* get start and end date */
+		if(strcmp(argv[optind + 1], "-") == 0)
+			start = 0;
+		else if(GetDate(argv[optind + 1], &start)) {
+			fprintf(stderr, "USAGE: %s " USAGE "\n", NAME, NAME);
+			return(20);
+		}
+		if(strcmp(argv[optind + 2], "-") == 0)
+			end = ~0ULL;
+		else if(GetDate(argv[optind + 2], &end)) {
+			fprintf(stderr, "USAGE: %s " USAGE "\n", NAME, NAME);
+			return(20);
+		}
+		if(end <= start) {
+			fprintf(stderr, "USAGE: %s " USAGE "\n", NAME, NAME);
+			return(10);
+		}
+
+		/* go */
+		return(QueryCatalog(argv[optind], start, end, apid, verbose));
+	}
+
+	/* check number of arguments */
+	if(argc - optind < 2) {
+		fprintf(stderr, "USAGE: %s " USAGE "\n", NAME, NAME);
+		return(20);
+	}
+
+	/* load existing catalog */
+	memset(&cat, 0, sizeof(struct catalog));
+	switch(LoadCatalog(argv[optind], &old)) {
+	case 0:
+	case 1:
+		break;
+	default:
+		fprintf(stderr, "can't read catalog (%s)\n", argv[optind]);
+		return(10);
+	}
+	qsort(old.files, old.nfiles, sizeof(struct cat_file), CompareName);
+
+	/* don't catalog the catalog */
+	if(stat(argv[optind], &self))
+		memset(&self, 0, sizeof(struct stat));
+
+	/* scan directories */
+	for(i = optind + 1; i < argc; i++) {
+		if(ScanPath(argv[i], &old, &cat, threads, pattern, &self)) {
+			fprintf(stderr, "not enough memory\n");
+			return(10);
+		}
+	}
+
+	/* drop files found twice (by different paths) */
+	qsort(cat.files, cat.nfiles, sizeof(struct cat_file), CompareName);
+	for(i = 1, j = 0; i < cat.nfiles; i++) {
+		if(!strcmp(cat.files[i].name, cat.files[j].name))
+			CatFreeFile(&(cat.files[i]));
+		else
+			cat.files[++j] = cat.files[i];
+	}
+	if(cat.nfiles)
+		cat.nfiles = j + 1;
+
+	/* sort by start time and write catalog */
+	qsort(cat.files, cat.nfiles, sizeof(struct cat_file), CompareTime);
+	if(CatWrite(argv[optind], cat.files, cat.nfiles)) {
+		fprintf(stderr, "can't write catalog (%s)\n", argv[optind]);
+		retvalue = 5;
+	}
+	fprintf(stderr, "%ld files in catalog\n", cat.nfiles);
+
+	/* free catalogs */
+	FreeCatalog(&old);
+	FreeCatalog(&cat);
+
+	/* Ja das war's. Der Pop-Shop ist zu Ende */
+	return(retvalue);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  add file or directory tree to catalog                           *
+ *                                                                  *
+ *  Files are catalogued by their canonical path. Files found       *
+ *  unchanged (same mtime and size) in the existing catalog are     *
+ *  moved from there, all others are scanned.                       *
+ *                                                                  *
+ *  path:    file or directory name                                 *
+ *  old:     pointer to existing catalog (sorted by name)           *
+ *  cat:     pointer to new catalog                                 *
+ *  threads: number of decompression threads                        *
+ *  pattern: pattern of file names to scan                          *
+ *  self:    status of catalog file                                 *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          -1 - out of memory                                      *
+ *                                                                  *
+ ********************************************************************/
+int ScanPath(char *path, struct catalog *old, struct catalog *cat,
+						 int threads, char *pattern, struct stat *self) {
+	/* file status */
+	struct stat st;
+	/* directory */
+	DIR *dir;
+	/* directory entry */
+	struct dirent *de;
+	/* full name of directory entry */
+	char *name;
+	/* pointer to base name */
+	char *base;
+	/* canonical path */
+	char *canon;
+	/* pointer to new and existing catalog entry */
+	struct cat_file *e, *o, key;
+	/* error code */
+	int error = 0;
+
+
+	/* get file status, don't follow links to directories */
+	if(lstat(path, &st)) {
+		fprintf(stderr, "can't access %s\n", path);
+		return(0);
+	}
+	if(S_ISLNK(st.st_mode) && (stat(path, &st) || S_ISDIR(st.st_mode)))
+		return(0);
+
+	/* directory? then scan all entries */
+	if(S_ISDIR(st.st_mode)) {
+		if(!(dir = opendir(path))) {
+			fprintf(stderr, "can't open directory %s\n", path);
+			return(0);
+		}
+		while(!error && (de = readdir(dir))) {
+			if(!strcmp(de->d_name, ".") || !strcmp(de->d_name, ".."))
+				continue;
+			if(!(name = malloc(strlen(path) + strlen(de->d_name) + 2))) {
+				error = -1;
+				break;
+			}
+			sprintf(name, "%s/%s", path, de->d_name);
+			error = ScanPath(name, old, cat, threads, pattern, self);
+			free(name);
+		}
+		closedir(dir);
+		return(error);
+	}
+
+	/* regular file with matching name? */
+	if(!S_ISREG(st.st_mode))
+		return(0);
+	base = (base = strrchr(path, '/')) ? base + 1 : path;
+	if(fnmatch(pattern, base, 0))
+		return(0);
+	if((st.st_dev == self->st_dev) && (st.st_ino == self->st_ino))
+		return(0);
+
+	/* canonical path, pdsmerge -c finds the file by any name */
+	if(!(canon = realpath(path, NULL))) {
+		fprintf(stderr, "can't access %s\n", path);
+		return(0);
+	}
+
+	/* unchanged since last run? then move entry to new catalog */
+	key.name = canon;
+	if((o = bsearch(&key, old->files, old->nfiles, sizeof(struct cat_file),
+									CompareName)) &&
+		 (o->mtime == st.st_mtime) && (o->size == st.st_size)) {
+		if(!(e = AddFile(cat))) {
+			free(canon);
+			return(-1);
+		}
+		*e = *o;
+		e->name = canon;
+		o->mtime = -1;
+		o->apids = NULL;
+		o->gaps = NULL;
+		return(0);
+	}
+
+	/* scan file */
+	if(!(e = AddFile(cat))) {
+		free(canon);
+		return(-1);
+	}
+	e->name = canon;
+	e->mtime = st.st_mtime;
+	e->size = st.st_size;
+	fprintf(stderr, "scanning %s\n", path);
+	switch(ScanFile(path, threads, e)) {
+	case 0:
+		return(0);
+	case 1:
+		fprintf(stderr, "no valid MODIS packets in %s, skipped\n", path);
+		break;
+	default:
+		fprintf(stderr, "can't read %s, skipped\n", path);
+		break;
+	}
+	CatFreeFile(e);
+	cat->nfiles--;
+
+	/* tschuess */
+	return(0);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  scan PDS file                                                   *
+ *                                                                  *
+ *  Time coverage and gaps are taken from MODIS packets with valid  *
+ *  checksum only, the time of a corrupted packet can't be trusted. *
+ *                                                                  *
+ *  name:    file name                                              *
+ *  threads: number of decompression threads                        *
+ *  e:       pointer to catalog entry to fill                       *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *           1 - no valid MODIS packets                             *
+ *          -1 - error                                              *
+ *                                                                  *
+ ********************************************************************/
+int ScanFile(char *name, int threads, struct cat_file *e) {
+	/* PDS file pointer */
+	struct pds_file *fin;
+	/* decoded packet */
+	struct pds_packet pkt;
+	/* statistics */
+	struct pds_stats stats;
+	/* pointer to APID Info object */
+	struct apid_info *ai;
+	/* packet buffer */
+	unsigned char *buf;
+	/* packet time and time of previous valid packet */
+	unsigned long long t, prev = 0;
+	/* counter */
+	long i;
+	/* result of reading packet */
+	int result;
+	/* error code */
+	int error = 0;
+
+
+	/* open file */
+	if(!(buf = malloc(PDS_PKT_SIZE)))
+		return(-1);
+	if(!(fin = PDSOpen(name, threads))) {
+		free(buf);
+		return(-1);
+	}
+	StatInit(&stats);
+	pkt.samples = NULL;
+
+	/* main loop */
+	for(;;) {
+		/* read next packet, skip unsupported packets */
+		if((result = PDSNextPacket(fin, buf, &pkt)) == 1)
+			break;
+		if(result == -2)
+			continue;
+
+		/* count packet */
+		if((result != -1) && !pkt.hdr.version &&
+			 (StatAddPacket(&stats, pkt.hdr.apid, pkt.hdr.pkt_count) < 0)) {
+			error = -1;
+			break;
+		}
+
+		/* read error or packet too long? */
+		if(result) {
+			fprintf(stderr, "%s might be corrupted\n", name);
+			break;
+		}
+
+		/* is it a MODIS packet? */
+		if(!pkt.info.modis)
+			continue;
+
+		/* add to statistics, skip invalid packets */
+		StatAddMODIS(&stats, &pkt.info);
+		if(!pkt.info.valid)
+			continue;
+
+		/* time coverage */
+		t =
+			(unsigned long long)pkt.mhdr.days * USEC_PER_DAY +
+			(unsigned long long)pkt.mhdr.millisec * 1000ULL +
+			pkt.mhdr.microsec;
+		if((prev == 0) || (t < e->start))
+			e->start = t;
+		if(t > e->end)
+			e->end = t;
+
+		/* gap since previous valid packet? */
+		if((prev != 0) && (t > prev + GAP_USEC) && AddGap(e, prev, t)) {
+			error = -1;
+			break;
+		}
+		prev = t;
+	}
+
+	/* close file */
+	PDSClose(fin);
+	free(buf);
+
+	/* store APIDs */
+	for(ai = stats.apidlist, e->napids = 0; ai; ai = ai->next)
+		e->napids++;
+	if(!error && e->napids &&
+		 !(e->apids = malloc(e->napids * sizeof(struct cat_apid))))
+		error = -1;
+	for(ai = stats.apidlist, i = 0; !error && ai; ai = ai->next, i++) {
+		e->apids[i].apid = ai->apid;
+		e->apids[i].count = ai->count;
+		e->apids[i].invalid = ai->invalid;
+		e->apids[i].missing = ai->missing;
+		e->apids[i].first_count = ai->first_pkt_count;
+		e->apids[i].last_count = ai->last_pkt_count;
+		e->packets += ai->count;
+		e->invalid += ai->invalid;
+	}
+	StatFree(&stats);
+
+	/* any valid MODIS packets? */
+	if(!error && (prev == 0))
+		return(1);
+
+	/* ois rodger */
+	return(error);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  add gap to catalog entry                                        *
+ *                                                                  *
+ *  e:     pointer to catalog entry                                 *
+ *  start: time of last packet before gap                           *
+ *  end:   time of first packet after gap                           *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          -1 - out of memory                                      *
+ *                                                                  *
+ ********************************************************************/
+int AddGap(struct cat_file *e, unsigned long long start,
+					 unsigned long long end) {
+	/* new buffer */
+	unsigned long long *p;
+
+
+	/* make room */
+	if(e->ngaps == e->gapcap) {
+		if(!(p = realloc(e->gaps,
+										 (e->gapcap * 2 + 16) * 2 *
+										 sizeof(unsigned long long))))
+			return(-1);
+		e->gaps = p;
+		e->gapcap = e->gapcap * 2 + 16;
+	}
+
+	/* store gap */
+	e->gaps[e->ngaps * 2] = start;
+	e->gaps[e->ngaps * 2 + 1] = end;
+	e->ngaps++;
+
+	/* alles klar */
+	return(0);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  add empty entry to catalog                                      *
+ *                                                                  *
+ *  cat: pointer to catalog                                         *
+ *                                                                  *
+ *  result:  pointer to new entry                                   *
+ *           NULL - out of memory                                   *
+ *                                                                  *
+ ********************************************************************/
+struct cat_file *AddFile(struct catalog *cat) {
+	/* new buffer */
+	struct cat_file *p;
+
+
+	/* make room */
+	if(cat->nfiles == cat->cap) {
+		if(!(p = realloc(cat->files,
+										 (cat->cap * 2 + 64) * sizeof(struct cat_file))))
+			return(NULL);
+		cat->files = p;
+		cat->cap = cat->cap * 2 + 64;
+	}
+
+	/* clear entry */
+	p = &(cat->files[cat->nfiles++]);
+	memset(p, 0, sizeof(struct cat_file));
+
+	/* here you are */
+	return(p);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  free memory of catalog                                          *
+ *                                                                  *
+ *  cat: pointer to catalog                                         *
+ *                                                                  *
+ *  result: none                                                    *
+ *                                                                  *
+ ********************************************************************/
+void FreeCatalog(struct catalog *cat) {
+	/* counter */
+	long i;
+
+
+	for(i = 0; i < cat->nfiles; i++)
+		CatFreeFile(&(cat->files[i]));
+	free(cat->files);
+	memset(cat, 0, sizeof(struct catalog));
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  load catalog                                                    *
+ *                                                                  *
+ *  name: catalog file name                                         *
+ *  cat:  pointer to catalog                                        *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *           1 - catalog doesn't exist (empty catalog)              *
+ *          -1 - error                                              *
+ *                                                                  *
+ ********************************************************************/
+int LoadCatalog(char *name, struct catalog *cat) {
+	/* mapped catalog */
+	struct pds_catalog c;
+	/* counter */
+	long i;
+	/* pointer to entry */
+	struct cat_file *e;
+
+
+	/* map catalog, catalogs of an older version are rebuilt */
+	memset(cat, 0, sizeof(struct catalog));
+	switch(CatOpen(name, &c)) {
+	case 0:
+		break;
+	case 1:
+		return(1);
+	default:
+		return((access(name, F_OK) != 0) ? 1 : -1);
+	}
+
+	/* decode records */
+	for(i = 0; i < c.nfiles; i++) {
+		if(!(e = AddFile(cat)) || CatRead(&c, i, e)) {
+			CatClose(&c);
+			FreeCatalog(cat);
+			return(-1);
+		}
+	}
+
+	/* that's it */
+	CatClose(&c);
+	return(0);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  print files overlapping a time range                            *
+ *                                                                  *
+ *  Only the files CatRange() finds are looked at.                  *
+ *                                                                  *
+ *  name:    catalog file name                                      *
+ *  start:   start of time range                                    *
+ *  end:     end of time range (not included)                       *
+ *  apid:    APID files must contain (-1 = any)                     *
+ *  verbose: print details of files                                 *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          10 - can't read catalog                                 *
+ *                                                                  *
+ ********************************************************************/
+int QueryCatalog(char *name, unsigned long long start,
+								 unsigned long long end, int apid, int verbose) {
+	/* mapped catalog */
+	struct pds_catalog c;
+	/* catalog entry */
+	struct cat_file e;
+	/* files which might overlap range */
+	long first, last;
+	/* flag for APID found */
+	int found;
+	/* counter */
+	long i, j;
+
+
+	/* map catalog */
+	switch(CatOpen(name, &c)) {
+	case 0:
+		break;
+	case 1:
+		fprintf(stderr, "catalog (%s) of older version, please update\n",
+						name);
+		return(10);
+	default:
+		fprintf(stderr, "can't read catalog (%s)\n", name);
+		return(10);
+	}
+
+	/* print files overlapping range */
+	CatRange(&c, start, end, &first, &last);
+	for(i = first; i < last; i++) {
+		if(CatRead(&c, i, &e)) {
+			fprintf(stderr, "can't read catalog (%s)\n", name);
+			CatFreeFile(&e);
+			CatClose(&c);
+			return(10);
+		}
+		if(e.end < start) {
+			CatFreeFile(&e);
+			continue;
+		}
+		for(j = 0, found = (apid < 0); !found && (j < e.napids); j++)
+			found = (e.apids[j].apid == apid);
+		if(found && verbose)
+			PrintFile(&e);
+		else if(found)
+			printf("%s\n", e.name);
+		CatFreeFile(&e);
+	}
+
+	/* okeydokey */
+	CatClose(&c);
+	return(0);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  print details of catalogued file                                *
+ *                                                                  *
+ *  e: pointer to catalog entry                                     *
+ *                                                                  *
+ *  result: none                                                    *
+ *                                                                  *
+ ********************************************************************/
+void PrintFile(struct cat_file *e) {
+	/* counter */
+	long i;
+
+
+	printf("%s\n", e->name);
+	PrintTime("  first packet: ", e->start);
+	PrintTime("  last packet: ", e->end);
+	printf("  packets: %ld invalid %ld\n", e->packets, e->invalid);
+	for(i = 0; i < e->napids; i++)
+		printf("  APID %ld: count %ld invalid %ld missing %ld\n",
+					 e->apids[i].apid, e->apids[i].count,
+					 e->apids[i].invalid, e->apids[i].missing);
+	for(i = 0; i < e->ngaps; i++) {
+		PrintTime("  gap: ", e->gaps[i * 2]);
+		PrintTime("    to ", e->gaps[i * 2 + 1]);
+	}
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  print time                                                      *
+ *                                                                  *
+ *  text: text to print before time                                 *
+ *  t:    microseconds since 01/01/1958                             *
+ *                                                                  *
+ *  result: none                                                    *
+ *                                                                  *
+ ********************************************************************/
+void PrintTime(char *text, unsigned long long t) {
+	/* date buffer */
+	int minute, hour, day, month, year;
+	/* microseconds of day */
+	unsigned long long us;
+
+
+	caldat(&minute, &hour, &day, &month, &year,
+				 (double)(t / USEC_PER_DAY) + MODIS_REF_DATE);
+	us = t % USEC_PER_DAY;
+	printf("%s%04d/%02d/%02d %02d:%02d:%02d.%06d\n", text,
+				 year, month, day,
+				 (int)(us / 3600000000ULL),
+				 (int)(us / 60000000ULL % 60),
+				 (int)(us / 1000000ULL % 60),
+				 (int)(us % 1000000ULL));
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  convert date string to time                                     *
+ *                                                                  *
+ *  s: date string (YYYY/MM/DD,hh:mm:ss)                            *
+ *  t: pointer to store microseconds since 01/01/1958               *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          -1 - invalid date                                       *
+ *                                                                  *
+ ********************************************************************/
+int GetDate(char *s, unsigned long long *t) {
+	/* date/time */
+	int year, month, day, hour, min, sec;
+	/* julian day */
+	double x;
+
+
+	/* decode and check date */
+	if(sscanf(s, " %d/%d/%d,%d:%d:%d",
+						&year, &month, &day, &hour, &min, &sec) != 6)
+		return(-1);
+	if((year < 1958) ||
+		 (month < 1) || (month > 12) ||
+		 (day < 1) || (day > 31) ||
+		 (hour < 0) || (hour > 23) ||
+		 (min < 0) || (min > 59) ||
+		 (sec < 0) || (sec >59))
+		return(-1);
+
+	/* convert */
+	julday(0, 0, day, month, year, &x);
+	*t =
+		(unsigned long long)(x - MODIS_REF_DATE) * USEC_PER_DAY +
+		((unsigned long long)hour * 3600ULL +
+		 (unsigned long long)min * 60ULL +
+		 (unsigned long long)sec) * 1000000ULL;
+
+	/* ok */
+	return(0);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  compare catalog entries by name                                 *
+ *                                                                  *
+ *  a: pointer to 1. entry                                          *
+ *  b: pointer to 2. entry                                          *
+ *                                                                  *
+ *  result: <0, 0, >0 like strcmp                                   *
+ *                                                                  *
+ ********************************************************************/
+int CompareName(const void *a, const void *b) {
+	return(strcmp(((struct cat_file *)a)->name,
+								((struct cat_file *)b)->name));
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  compare catalog entries by start time, end time and name        *
+ *                                                                  *
+ *  a: pointer to 1. entry                                          *
+ *  b: pointer to 2. entry                                          *
+ *                                                                  *
+ *  result: <0, 0, >0 like strcmp                                   *
+ *                                                                  *
+ ********************************************************************/
+int CompareTime(const void *a, const void *b) {
+	/* pointers to entries */
+	const struct cat_file *x = a, *y = b;
+
+
+	if(x->start != y->start)
+		return((x->start < y->start) ? -1 : 1);
+	if(x->end != y->end)
+		return((x->end < y->end) ? -1 : 1);
+	return(strcmp(x->name, y->name));
+}
+
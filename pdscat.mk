@@ -0,0 +1,23 @@
+# ===========================================================================
+#	Begin Program Specific Block
+# ===========================================================================
+
+MAKEFILE = pdscat.mk
+
+# Progam to make
+EXE	= pdscat 
+
+# Object modules for EXE
+OBJ    	= pdscat.o pds.o pdscatalog.o pdsio.o pdsstat.o 
+
+# Library locations
+LIBS 	= 
+
+# LIBS needed to compile EXE
+LLIBS 	= -lz -lbz2 -lpthread -lm
+
+
+# Include file locations
+INCLUDE = -DHAVE_ZLIB -DHAVE_BZLIB
+
+include $(MAKEFILE_APP_TEMPLATE)
@@ -0,0 +1,501 @@
+/********************************************************************
+ *                                                                  *
+ *  Copyright (C) 2026                                              *
+ *  Geoscience Australia, Canberra, Australia                       *
+ *                                                                  *
+ *  This program is free software; you can redistribute it and/or   *
+ *  modify it under the terms of the GNU General Public License as  *
+ *  published by the Free Software Foundation; either version 2 of  *
+ *  the License, or (at your option) any later version.             *
+ *                                                                  *
+ *  This program is distributed in the hope that it will be         *
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied      *
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR         *
+ *  PURPOSE.  See the GNU General Public License for more details.  *
+ *                                                                  *
+ *  You should have received a copy of the GNU General Public       *
+ *  License along with this program; if not, write to the Free      *
+ *  Software Foundation, Inc., 59 Temple Place, Suite 330, Boston,  *
+ *  MA  02111-1307  USA                                             *
+ *                                                                  *
+ ********************************************************************
+ *                                                                  *
+ *  catalog of PDS files (layout see pdscatalog.h)                  *
+ *                                                                  *
+ *  18/10/2026  GA           initial version, moved from pdscat.c   *
+ *  18/10/2026  GA           table of files sorted by name, files   *
+ *                           found by binary search (version 3)     *
+ *                                                                  *
+ ********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#include "pdscatalog.h"
+#include "pdsio.h"
+
+
+/********************************************************************
+ *                                                                  *
+ *  structure definitions                                           *
+ *                                                                  *
+ ********************************************************************/
+/* file of name table */
+struct cat_name {
+	char *name;
+	long i;
+};
+
+
+/********************************************************************
+ *                                                                  *
+ *  function declarations                                           *
+ *                                                                  *
+ ********************************************************************/
+static int CompareName(const void *a, const void *b);
+
+
+/********************************************************************
+ *                                                                  *
+ *  map catalog file into memory and check header and table         *
+ *                                                                  *
+ *  name: catalog file name                                         *
+ *  c:    pointer to catalog                                        *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *           1 - catalog of an older version (not mapped)           *
+ *          -1 - error (errno ENOENT if file doesn't exist)         *
+ *                                                                  *
+ ********************************************************************/
+int CatOpen(char *name, struct pds_catalog *c) {
+	/* file descriptor */
+	int fd;
+	/* file status */
+	struct stat st;
+
+
+	/* map file */
+	memset(c, 0, sizeof(struct pds_catalog));
+	if((fd = open(name, O_RDONLY)) < 0)
+		return(-1);
+	if(fstat(fd, &st) || (st.st_size < PDS_CAT_HDR_SIZE)) {
+		close(fd);
+		return(-1);
+	}
+	c->base = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if(c->base == MAP_FAILED) {
+		c->base = NULL;
+		return(-1);
+	}
+	c->size = st.st_size;
+
+	/* check header and size of tables */
+	c->nfiles = GetLE(c->base + 8, 4);
+	if(memcmp(c->base, PDS_CAT_MAGIC, 4) ||
+		 (PDS_CAT_HDR_SIZE + (unsigned long long)c->nfiles *
+			(PDS_CAT_ENTRY_SIZE + PDS_CAT_NAME_SIZE) > c->size)) {
+		CatClose(c);
+		return(-1);
+	}
+	if(GetLE(c->base + 4, 2) != PDS_CAT_VERSION) {
+		CatClose(c);
+		return(1);
+	}
+
+	/* there we go */
+	return(0);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  unmap catalog                                                   *
+ *                                                                  *
+ *  c: pointer to catalog                                           *
+ *                                                                  *
+ *  result: none                                                    *
+ *                                                                  *
+ ********************************************************************/
+void CatClose(struct pds_catalog *c) {
+	if(c->base)
+		munmap(c->base, c->size);
+	memset(c, 0, sizeof(struct pds_catalog));
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  decode catalog record                                           *
+ *                                                                  *
+ *  c: pointer to catalog                                           *
+ *  i: number of file in table                                      *
+ *  e: pointer to catalog entry to fill (free with CatFreeFile())   *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          -1 - corrupted record or out of memory                  *
+ *                                                                  *
+ ********************************************************************/
+int CatRead(struct pds_catalog *c, long i, struct cat_file *e) {
+	/* pointer to table entry and record */
+	unsigned char *entry, *r;
+	/* record offset and size */
+	unsigned long long off, len;
+	/* name length */
+	unsigned long namelen;
+	/* counter */
+	long j;
+
+
+	/* check record */
+	memset(e, 0, sizeof(struct cat_file));
+	if((i < 0) || (i >= c->nfiles))
+		return(-1);
+	entry = c->base + PDS_CAT_HDR_SIZE + i * PDS_CAT_ENTRY_SIZE;
+	off = GetLE(entry + 24, 8);
+	if(off + PDS_CAT_REC_SIZE > c->size)
+		return(-1);
+	r = c->base + off;
+	len = GetLE(r, 4);
+	namelen = GetLE(r + 4, 4);
+	e->napids = GetLE(r + 32, 4);
+	e->ngaps = GetLE(r + 36, 4);
+	if((off + len > c->size) ||
+		 (len != PDS_CAT_REC_SIZE + namelen +
+			(unsigned long long)e->napids * PDS_CAT_APID_SIZE +
+			(unsigned long long)e->ngaps * PDS_CAT_GAP_SIZE)) {
+		e->napids = e->ngaps = 0;
+		return(-1);
+	}
+
+	/* times and counts */
+	e->start = GetLE(entry, 8);
+	e->end = GetLE(entry + 8, 8);
+	e->mtime = GetLE(r + 8, 8);
+	e->size = GetLE(r + 16, 8);
+	e->packets = GetLE(r + 24, 4);
+	e->invalid = GetLE(r + 28, 4);
+	r += PDS_CAT_REC_SIZE;
+
+	/* name */
+	if(!(e->name = malloc(namelen + 1)))
+		return(-1);
+	memcpy(e->name, r, namelen);
+	e->name[namelen] = 0;
+	r += namelen;
+
+	/* APIDs */
+	if(e->napids &&
+		 !(e->apids = malloc(e->napids * sizeof(struct cat_apid))))
+		return(-1);
+	for(j = 0; j < e->napids; j++, r += PDS_CAT_APID_SIZE) {
+		e->apids[j].apid = GetLE(r, 4);
+		e->apids[j].count = GetLE(r + 4, 4);
+		e->apids[j].invalid = GetLE(r + 8, 4);
+		e->apids[j].missing = GetLE(r + 12, 4);
+		e->apids[j].first_count = GetLE(r + 16, 4);
+		e->apids[j].last_count = GetLE(r + 20, 4);
+	}
+
+	/* gaps */
+	if(e->ngaps &&
+		 !(e->gaps = malloc(e->ngaps * 2 * sizeof(unsigned long long))))
+		return(-1);
+	e->gapcap = e->ngaps;
+	for(j = 0; j < e->ngaps * 2; j++, r += 8)
+		e->gaps[j] = GetLE(r, 8);
+
+	/* good */
+	return(0);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  find file in catalog                                            *
+ *                                                                  *
+ *  Binary search of the name table, only the names of the records  *
+ *  are compared, nothing is decoded.                               *
+ *                                                                  *
+ *  c:    pointer to catalog                                        *
+ *  name: canonical file name (see realpath())                      *
+ *                                                                  *
+ *  result:  number of file in table                                *
+ *          -1 - file not in catalog or catalog corrupted           *
+ *                                                                  *
+ ********************************************************************/
+long CatFind(struct pds_catalog *c, char *name) {
+	/* pointer to name table */
+	unsigned char *names;
+	/* record offset and name length */
+	unsigned long long off, namelen;
+	/* pointer to record */
+	unsigned char *r;
+	/* length of name */
+	size_t len;
+	/* search range, number of file in table */
+	long lo, hi, mid, i;
+	/* result of comparison */
+	int cmp;
+
+
+	len = strlen(name);
+	names = c->base + PDS_CAT_HDR_SIZE + c->nfiles * PDS_CAT_ENTRY_SIZE;
+	for(lo = 0, hi = c->nfiles; lo < hi;) {
+		/* name of file in middle */
+		mid = (lo + hi) / 2;
+		i = GetLE(names + mid * PDS_CAT_NAME_SIZE, 4);
+		if(i >= c->nfiles)
+			return(-1);
+		off = GetLE(c->base + PDS_CAT_HDR_SIZE + i * PDS_CAT_ENTRY_SIZE +
+								24, 8);
+		if(off + PDS_CAT_REC_SIZE > c->size)
+			return(-1);
+		r = c->base + off;
+		namelen = GetLE(r + 4, 4);
+		if(off + PDS_CAT_REC_SIZE + namelen > c->size)
+			return(-1);
+
+		/* compare like strcmp() */
+		cmp = memcmp(r + PDS_CAT_REC_SIZE, name,
+								 (namelen < len) ? namelen : len);
+		if(!cmp)
+			cmp = (namelen > len) - (namelen < len);
+		if(!cmp)
+			return(i);
+		if(cmp < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	/* not there */
+	return(-1);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  files which might overlap a time range                          *
+ *                                                                  *
+ *  The table is sorted by start time, so the files starting before *
+ *  the end of the range are found by a binary search. The maximum  *
+ *  end time of all previous files never decreases, so the first    *
+ *  file which might reach into the range is found the same way.    *
+ *  Files in between ending before the range still have to be       *
+ *  skipped by the caller.                                          *
+ *                                                                  *
+ *  c:     pointer to catalog                                       *
+ *  start: start of time range                                      *
+ *  end:   end of time range (not included)                         *
+ *  first: pointer to store number of first file                    *
+ *  last:  pointer to store number of file after last file          *
+ *                                                                  *
+ *  result: none                                                    *
+ *                                                                  *
+ ********************************************************************/
+void CatRange(struct pds_catalog *c, unsigned long long start,
+							unsigned long long end, long *first, long *last) {
+	/* pointer to table */
+	unsigned char *table;
+	/* search range */
+	long lo, hi, mid;
+
+
+	/* first file starting at or after end of range */
+	table = c->base + PDS_CAT_HDR_SIZE;
+	for(lo = 0, hi = c->nfiles; lo < hi;) {
+		mid = (lo + hi) / 2;
+		if(GetLE(table + mid * PDS_CAT_ENTRY_SIZE, 8) < end)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	*last = lo;
+
+	/* first file with maximum end time in range */
+	for(lo = 0, hi = *last; lo < hi;) {
+		mid = (lo + hi) / 2;
+		if(GetLE(table + mid * PDS_CAT_ENTRY_SIZE + 16, 8) < start)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	*first = lo;
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  write catalog                                                   *
+ *                                                                  *
+ *  The catalog is written to a temporary file first, which then    *
+ *  replaces the old catalog.                                       *
+ *                                                                  *
+ *  name:  catalog file name                                        *
+ *  files: catalogued files (sorted by start time, canonical and    *
+ *         unique names)                                            *
+ *  n:     number of files                                          *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          -1 - error                                              *
+ *                                                                  *
+ ********************************************************************/
+int CatWrite(char *name, struct cat_file *files, long n) {
+	/* catalog file pointer */
+	FILE *f;
+	/* temporary file name */
+	char *tmp;
+	/* files sorted by name */
+	struct cat_name *sorted;
+	/* buffer */
+	unsigned char buf[PDS_CAT_REC_SIZE];
+	/* pointer to entry */
+	struct cat_file *e;
+	/* record offset and size */
+	unsigned long long off, len;
+	/* maximum end time so far */
+	unsigned long long maxend = 0;
+	/* counter */
+	long i, j;
+	/* error flag */
+	int error = 0;
+
+
+	/* sort files by name */
+	if(!(sorted = malloc((n ? n : 1) * sizeof(struct cat_name))))
+		return(-1);
+	for(i = 0; i < n; i++) {
+		sorted[i].name = files[i].name;
+		sorted[i].i = i;
+	}
+	qsort(sorted, n, sizeof(struct cat_name), CompareName);
+
+	/* create temporary file */
+	if(!(tmp = malloc(strlen(name) + 5))) {
+		free(sorted);
+		return(-1);
+	}
+	sprintf(tmp, "%s.tmp", name);
+	if(!(f = fopen(tmp, "wb"))) {
+		free(sorted);
+		free(tmp);
+		return(-1);
+	}
+
+	/* header */
+	memset(buf, 0, PDS_CAT_HDR_SIZE);
+	memcpy(buf, PDS_CAT_MAGIC, 4);
+	PutLE(buf + 4, PDS_CAT_VERSION, 2);
+	PutLE(buf + 8, n, 4);
+	if(fwrite(buf, PDS_CAT_HDR_SIZE, 1, f) != 1)
+		error = -1;
+
+	/* table */
+	off = PDS_CAT_HDR_SIZE +
+		(unsigned long long)n * (PDS_CAT_ENTRY_SIZE + PDS_CAT_NAME_SIZE);
+	for(i = 0; !error && (i < n); i++) {
+		e = &(files[i]);
+		if(e->end > maxend)
+			maxend = e->end;
+		PutLE(buf, e->start, 8);
+		PutLE(buf + 8, e->end, 8);
+		PutLE(buf + 16, maxend, 8);
+		PutLE(buf + 24, off, 8);
+		if(fwrite(buf, PDS_CAT_ENTRY_SIZE, 1, f) != 1)
+			error = -1;
+		off += PDS_CAT_REC_SIZE + strlen(e->name) +
+			e->napids * PDS_CAT_APID_SIZE + e->ngaps * PDS_CAT_GAP_SIZE;
+	}
+
+	/* name table */
+	for(i = 0; !error && (i < n); i++) {
+		PutLE(buf, sorted[i].i, 4);
+		if(fwrite(buf, PDS_CAT_NAME_SIZE, 1, f) != 1)
+			error = -1;
+	}
+	free(sorted);
+
+	/* records */
+	for(i = 0; !error && (i < n); i++) {
+		e = &(files[i]);
+		len = PDS_CAT_REC_SIZE + strlen(e->name) +
+			e->napids * PDS_CAT_APID_SIZE + e->ngaps * PDS_CAT_GAP_SIZE;
+		PutLE(buf, len, 4);
+		PutLE(buf + 4, strlen(e->name), 4);
+		PutLE(buf + 8, e->mtime, 8);
+		PutLE(buf + 16, e->size, 8);
+		PutLE(buf + 24, e->packets, 4);
+		PutLE(buf + 28, e->invalid, 4);
+		PutLE(buf + 32, e->napids, 4);
+		PutLE(buf + 36, e->ngaps, 4);
+		if((fwrite(buf, PDS_CAT_REC_SIZE, 1, f) != 1) ||
+			 (fwrite(e->name, strlen(e->name), 1, f) != 1))
+			error = -1;
+		for(j = 0; !error && (j < e->napids); j++) {
+			PutLE(buf, e->apids[j].apid, 4);
+			PutLE(buf + 4, e->apids[j].count, 4);
+			PutLE(buf + 8, e->apids[j].invalid, 4);
+			PutLE(buf + 12, e->apids[j].missing, 4);
+			PutLE(buf + 16, e->apids[j].first_count, 4);
+			PutLE(buf + 20, e->apids[j].last_count, 4);
+			if(fwrite(buf, PDS_CAT_APID_SIZE, 1, f) != 1)
+				error = -1;
+		}
+		for(j = 0; !error && (j < e->ngaps); j++) {
+			PutLE(buf, e->gaps[j * 2], 8);
+			PutLE(buf + 8, e->gaps[j * 2 + 1], 8);
+			if(fwrite(buf, PDS_CAT_GAP_SIZE, 1, f) != 1)
+				error = -1;
+		}
+	}
+
+	/* replace old catalog */
+	if(fclose(f) || error || rename(tmp, name)) {
+		remove(tmp);
+		error = -1;
+	}
+	free(tmp);
+
+	/* done */
+	return(error);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  free memory of catalog entry                                    *
+ *                                                                  *
+ *  e: pointer to catalog entry                                     *
+ *                                                                  *
+ *  result: none                                                    *
+ *                                                                  *
+ ********************************************************************/
+void CatFreeFile(struct cat_file *e) {
+	free(e->name);
+	free(e->apids);
+	free(e->gaps);
+	memset(e, 0, sizeof(struct cat_file));
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  compare files of name table by name                             *
+ *                                                                  *
+ *  a: pointer to 1. file                                           *
+ *  b: pointer to 2. file                                           *
+ *                                                                  *
+ *  result: <0, 0, >0 like strcmp                                   *
+ *                                                                  *
+ ********************************************************************/
+static int CompareName(const void *a, const void *b) {
+	return(strcmp(((const struct cat_name *)a)->name,
+								((const struct cat_name *)b)->name));
+}
@@ -0,0 +1,138 @@
+/********************************************************************
+ *                                                                  *
+ *  Copyright (C) 2026                                              *
+ *  Geoscience Australia, Canberra, Australia                       *
+ *                                                                  *
+ *  This program is free software; you can redistribute it and/or   *
+ *  modify it under the terms of the GNU General Public License as  *
+ *  published by the Free Software Foundation; either version 2 of  *
+ *  the License, or (at your option) any later version.             *
+ *                                                                  *
+ *  This program is distributed in the hope that it will be         *
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied      *
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR         *
+ *  PURPOSE.  See the GNU General Public License for more details.  *
+ *                                                                  *
+ *  You should have received a copy of the GNU General Public       *
+ *  License along with this program; if not, write to the Free      *
+ *  Software Foundation, Inc., 59 Temple Place, Suite 330, Boston,  *
+ *  MA  02111-1307  USA                                             *
+ *                                                                  *
+ ********************************************************************
+ *                                                                  *
+ *  catalog of PDS files (written by pdscat, read by pdsmerge -c)   *
+ *                                                                  *
+ *  The catalog is mapped into memory and records are decoded only  *
+ *  when asked for, so looking up a file or a time range doesn't    *
+ *  read the whole catalog.                                         *
+ *                                                                  *
+ *  layout (all values little endian):                              *
+ *   header:  "PDSC", version (2), reserved (2), number of files    *
+ *            (4), reserved (4)                                     *
+ *   table:   per file sorted by start time: start time (8), end    *
+ *            time (8), maximum end time of this and all previous   *
+ *            files (8), record offset (8)                          *
+ *   names:   per file sorted by name: number of file in table (4)  *
+ *   records: record size (4), name length (4), mtime (8), size     *
+ *            (8), packets (4), invalid packets (4), number of      *
+ *            APIDs (4), number of gaps (4), name, per APID: APID,  *
+ *            count, invalid, missing, first and last packet count  *
+ *            (4 each), per gap: start and end time (8 each)        *
+ *   names are canonical paths (see realpath()), times are          *
+ *   microseconds since 01/01/1958                                  *
+ *                                                                  *
+ ********************************************************************/
+
+#ifndef PDSCATALOG_H
+#define PDSCATALOG_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/********************************************************************
+ *                                                                  *
+ *  defines                                                         *
+ *                                                                  *
+ ********************************************************************/
+/* magic number */
+#define PDS_CAT_MAGIC "PDSC"
+/* version */
+#define PDS_CAT_VERSION 3
+/* header size */
+#define PDS_CAT_HDR_SIZE 16
+/* table entry size */
+#define PDS_CAT_ENTRY_SIZE 32
+/* name table entry size */
+#define PDS_CAT_NAME_SIZE 4
+/* record size (without name, APIDs and gaps) */
+#define PDS_CAT_REC_SIZE 40
+/* APID entry size */
+#define PDS_CAT_APID_SIZE 24
+/* gap entry size */
+#define PDS_CAT_GAP_SIZE 16
+
+
+/********************************************************************
+ *                                                                  *
+ *  structure definitions                                           *
+ *                                                                  *
+ ********************************************************************/
+/* APID of catalogued file */
+struct cat_apid {
+	long apid;
+	long count;
+	long invalid;
+	long missing;
+	long first_count;
+	long last_count;
+};
+
+/* catalogued file */
+struct cat_file {
+	/* file name */
+	char *name;
+	/* modification time and size of file */
+	long long mtime, size;
+	/* time of first and last valid packet */
+	unsigned long long start, end;
+	/* number of packets and invalid packets */
+	long packets, invalid;
+	/* APIDs */
+	long napids;
+	struct cat_apid *apids;
+	/* gaps (start and end time of each) */
+	long ngaps, gapcap;
+	unsigned long long *gaps;
+};
+
+/* mapped catalog */
+struct pds_catalog {
+	unsigned char *base;
+	size_t size;
+	long nfiles;
+};
+
+
+/********************************************************************
+ *                                                                  *
+ *  function declarations                                           *
+ *                                                                  *
+ ********************************************************************/
+int CatOpen(char *name, struct pds_catalog *c);
+void CatClose(struct pds_catalog *c);
+int CatRead(struct pds_catalog *c, long i, struct cat_file *e);
+long CatFind(struct pds_catalog *c, char *name);
+void CatRange(struct pds_catalog *c, unsigned long long start,
+							unsigned long long end, long *first, long *last);
+int CatWrite(char *name, struct cat_file *files, long n);
+void CatFreeFile(struct cat_file *e);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,280 @@
+/********************************************************************
+ *                                                                  *
+ *  Copyright (C) 2026                                              *
+ *  Geoscience Australia, Canberra, Australia                       *
+ *                                                                  *
+ *  This program is free software; you can redistribute it and/or   *
+ *  modify it under the terms of the GNU General Public License as  *
+ *  published by the Free Software Foundation; either version 2 of  *
+ *  the License, or (at your option) any later version.             *
+ *                                                                  *
+ *  This program is distributed in the hope that it will be         *
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied      *
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR         *
+ *  PURPOSE.  See the GNU General Public License for more details.  *
+ *                                                                  *
+ *  You should have received a copy of the GNU General Public       *
+ *  License along with this program; if not, write to the Free      *
+ *  Software Foundation, Inc., 59 Temple Place, Suite 330, Boston,  *
+ *  MA  02111-1307  USA                                             *
+ *                                                                  *
+ ********************************************************************
+ *                                                                  *
+ *  columnar export of packet headers (layout see pdscol.h)         *
+ *                                                                  *
+ *  18/10/2026  GA           initial version                        *
+ *                                                                  *
+ ********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pdscol.h"
+
+
+/********************************************************************
+ *                                                                  *
+ *  defines                                                         *
+ *                                                                  *
+ ********************************************************************/
+/* number of columns */
+#define COL_COUNT 22
+/* header size */
+#define COL_HDR_SIZE 16
+/* directory entry size */
+#define COL_DIR_SIZE 32
+/* column name size */
+#define COL_NAME_SIZE 16
+/* initial number of rows */
+#define COL_ROWS 65536
+
+
+/********************************************************************
+ *                                                                  *
+ *  structure definitions                                           *
+ *                                                                  *
+ ********************************************************************/
+/* column file */
+struct pds_col {
+	/* output file */
+	FILE *f;
+	/* number of rows and allocated rows */
+	long long rows, cap;
+	/* column arrays */
+	unsigned char *data[COL_COUNT];
+};
+
+/* column */
+struct col_def {
+	/* name */
+	char *name;
+	/* size of values */
+	int size;
+};
+
+
+/********************************************************************
+ *                                                                  *
+ *  columns                                                         *
+ *                                                                  *
+ ********************************************************************/
+static const struct col_def cols[COL_COUNT] = {
+	{ "offset", 8 },
+	{ "apid", 2 },
+	{ "version", 1 },
+	{ "type", 1 },
+	{ "sec_hdr_flag", 1 },
+	{ "seq_flags", 1 },
+	{ "pkt_count", 2 },
+	{ "pkt_length", 2 },
+	{ "status", 1 },
+	{ "days", 2 },
+	{ "millisec", 4 },
+	{ "microsec", 2 },
+	{ "ql", 1 },
+	{ "pkt_type", 1 },
+	{ "scan_count", 1 },
+	{ "mirror_side", 1 },
+	{ "src1", 1 },
+	{ "src2", 2 },
+	{ "conf", 2 },
+	{ "sci_state", 1 },
+	{ "sci_abnorm", 1 },
+	{ "checksum", 2 }
+};
+
+
+/********************************************************************
+ *                                                                  *
+ *  create column file                                              *
+ *                                                                  *
+ *  name: file name                                                 *
+ *                                                                  *
+ *  result:  pointer to column file                                 *
+ *           NULL - error                                           *
+ *                                                                  *
+ ********************************************************************/
+struct pds_col *ColCreate(char *name) {
+	/* column file */
+	struct pds_col *c;
+
+
+	/* allocate memory */
+	if(!(c = calloc(1, sizeof(struct pds_col))))
+		return(NULL);
+
+	/* create file */
+	if(!(c->f = fopen(name, "wb"))) {
+		free(c);
+		return(NULL);
+	}
+
+	/* tschuess */
+	return(c);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  add packet                                                      *
+ *                                                                  *
+ *  c:      pointer to column file                                  *
+ *  offset: offset of packet in (uncompressed) PDS file             *
+ *  pkt:    pointer to decoded packet (see PDSNextPacket())         *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          -1 - out of memory                                      *
+ *                                                                  *
+ ********************************************************************/
+int ColAdd(struct pds_col *c, long long offset, struct pds_packet *pkt) {
+	/* values of row */
+	unsigned long long v[COL_COUNT];
+	/* new array */
+	unsigned char *p;
+	/* counter */
+	int i;
+
+
+	/* grow arrays */
+	if(c->rows == c->cap) {
+		for(i = 0; i < COL_COUNT; i++) {
+			if(!(p = realloc(c->data[i],
+											 (c->cap ? 2 * c->cap : COL_ROWS) * cols[i].size)))
+				return(-1);
+			c->data[i] = p;
+		}
+		c->cap = c->cap ? 2 * c->cap : COL_ROWS;
+	}
+
+	/* primary header, only version and length of unsupported packets */
+	memset(v, 0, sizeof(v));
+	v[0] = offset;
+	v[2] = pkt->hdr.version;
+	v[7] = pkt->size - PRI_HDR_SIZE - 1;
+	if(pkt->hdr.version) {
+		v[8] = PDS_COL_VERSION_ERROR;
+	} else {
+		v[1] = pkt->hdr.apid;
+		v[3] = pkt->hdr.type;
+		v[4] = pkt->hdr.sec_hdr_flag;
+		v[5] = pkt->hdr.seq_flags;
+		v[6] = pkt->hdr.pkt_count;
+		v[8] = !pkt->decoder ? PDS_COL_UNKNOWN :
+			pkt->info.valid ? PDS_COL_VALID : PDS_COL_INVALID;
+	}
+
+	/* time of packets with decoder */
+	if(pkt->decoder && !pkt->hdr.version) {
+		v[9] = pkt->info.days;
+		v[10] = pkt->info.millisec;
+		v[11] = pkt->info.microsec;
+	}
+
+	/* MODIS header */
+	if(!pkt->hdr.version && pkt->info.modis) {
+		v[12] = pkt->mhdr.ql;
+		v[13] = pkt->mhdr.pkt_type;
+		v[14] = pkt->mhdr.scan_count;
+		v[15] = pkt->mhdr.mirror_side;
+		v[16] = pkt->mhdr.src1;
+		v[17] = pkt->mhdr.src2;
+		v[18] = pkt->mhdr.conf;
+		v[19] = pkt->mhdr.sci_state;
+		v[20] = pkt->mhdr.sci_abnorm;
+		v[21] = pkt->mhdr.checksum;
+	}
+
+	/* store row */
+	for(i = 0; i < COL_COUNT; i++)
+		PutLE(c->data[i] + c->rows * cols[i].size, v[i], cols[i].size);
+	c->rows++;
+
+	/* ois rodger */
+	return(0);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  write columns and close file                                    *
+ *                                                                  *
+ *  c: pointer to column file                                       *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          -1 - write error                                        *
+ *                                                                  *
+ ********************************************************************/
+int ColFinish(struct pds_col *c) {
+	/* header and directory */
+	unsigned char hdr[COL_HDR_SIZE + COL_COUNT * COL_DIR_SIZE];
+	/* padding */
+	unsigned char pad[8];
+	/* offset of array */
+	long long offset;
+	/* size of array */
+	long long size;
+	/* counter */
+	int i;
+	/* error code */
+	int error = 0;
+
+
+	/* header */
+	memset(hdr, 0, sizeof(hdr));
+	memset(pad, 0, sizeof(pad));
+	memcpy(hdr, PDS_COL_MAGIC, 4);
+	PutLE(hdr + 4, PDS_COL_VERSION, 2);
+	PutLE(hdr + 6, COL_COUNT, 2);
+	PutLE(hdr + 8, c->rows, 8);
+
+	/* directory, arrays follow at multiples of 8 bytes */
+	offset = sizeof(hdr);
+	for(i = 0; i < COL_COUNT; i++) {
+		strncpy((char *)hdr + COL_HDR_SIZE + i * COL_DIR_SIZE, cols[i].name,
+						COL_NAME_SIZE);
+		hdr[COL_HDR_SIZE + i * COL_DIR_SIZE + COL_NAME_SIZE] = cols[i].size;
+		PutLE(hdr + COL_HDR_SIZE + i * COL_DIR_SIZE + 24, offset, 8);
+		offset += (c->rows * cols[i].size + 7) & ~7LL;
+	}
+
+	/* write header and arrays */
+	if(fwrite(hdr, sizeof(hdr), 1, c->f) != 1)
+		error = -1;
+	for(i = 0; !error && (i < COL_COUNT); i++) {
+		size = c->rows * cols[i].size;
+		if((size && (fwrite(c->data[i], size, 1, c->f) != 1)) ||
+			 ((size & 7) && (fwrite(pad, 8 - (size & 7), 1, c->f) != 1)))
+			error = -1;
+	}
+	if(fclose(c->f))
+		error = -1;
+
+	/* free memory */
+	for(i = 0; i < COL_COUNT; i++)
+		free(c->data[i]);
+	free(c);
+
+	/* voila */
+	return(error);
+}
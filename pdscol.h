@@ -0,0 +1,96 @@
+/********************************************************************
+ *                                                                  *
+ *  Copyright (C) 2026                                              *
+ *  Geoscience Australia, Canberra, Australia                       *
+ *                                                                  *
+ *  This program is free software; you can redistribute it and/or   *
+ *  modify it under the terms of the GNU General Public License as  *
+ *  published by the Free Software Foundation; either version 2 of  *
+ *  the License, or (at your option) any later version.             *
+ *                                                                  *
+ *  This program is distributed in the hope that it will be         *
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied      *
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR         *
+ *  PURPOSE.  See the GNU General Public License for more details.  *
+ *                                                                  *
+ *  You should have received a copy of the GNU General Public       *
+ *  License along with this program; if not, write to the Free      *
+ *  Software Foundation, Inc., 59 Temple Place, Suite 330, Boston,  *
+ *  MA  02111-1307  USA                                             *
+ *                                                                  *
+ ********************************************************************
+ *                                                                  *
+ *  columnar export of packet headers                               *
+ *                                                                  *
+ *  The decoded headers of all packets of a file are written as one *
+ *  contiguous array per field, so analysis tools can map the file  *
+ *  and work on single fields without parsing PDS files.            *
+ *                                                                  *
+ *  layout (all values unsigned little endian):                     *
+ *   header:    "PDSX", version (2), number of columns (2), number  *
+ *              of rows (8)                                         *
+ *   directory: per column: name (16, zero padded), size of values  *
+ *              in bytes (1), reserved (7), offset of array (8)     *
+ *   arrays:    one value per row and column, each array starting   *
+ *              at a multiple of 8 bytes                            *
+ *                                                                  *
+ *  columns: offset (8, of packet in uncompressed file), apid (2),  *
+ *   version, type, sec_hdr_flag, seq_flags (1), pkt_count,         *
+ *   pkt_length (2), status (1, 0 = unknown instrument, 1 = valid,  *
+ *   2 = invalid, 3 = unsupported version), days (2), millisec (4), *
+ *   microsec (2), ql, pkt_type, scan_count, mirror_side, src1 (1), *
+ *   src2, conf (2), sci_state, sci_abnorm (1), checksum (2)        *
+ *  Time is set for all packets with decoder, the other MODIS       *
+ *  fields are 0 for packets of other instruments.                  *
+ *                                                                  *
+ ********************************************************************/
+
+#ifndef PDSCOL_H
+#define PDSCOL_H
+
+#include "pds.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/********************************************************************
+ *                                                                  *
+ *  defines                                                         *
+ *                                                                  *
+ ********************************************************************/
+/* magic number */
+#define PDS_COL_MAGIC "PDSX"
+/* version */
+#define PDS_COL_VERSION 1
+/* packet status */
+#define PDS_COL_UNKNOWN 0
+#define PDS_COL_VALID 1
+#define PDS_COL_INVALID 2
+#define PDS_COL_VERSION_ERROR 3
+
+
+/********************************************************************
+ *                                                                  *
+ *  structure definitions                                           *
+ *                                                                  *
+ ********************************************************************/
+/* column file (private) */
+struct pds_col;
+
+
+/********************************************************************
+ *                                                                  *
+ *  function declarations                                           *
+ *                                                                  *
+ ********************************************************************/
+struct pds_col *ColCreate(char *name);
+int ColAdd(struct pds_col *c, long long offset, struct pds_packet *pkt);
+int ColFinish(struct pds_col *c);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,433 @@
+/********************************************************************
+ *                                                                  *
+ *  Copyright (C) 2026                                              *
+ *  Geoscience Australia, Canberra, Australia                       *
+ *                                                                  *
+ *  This program is free software; you can redistribute it and/or   *
+ *  modify it under the terms of the GNU General Public License as  *
+ *  published by the Free Software Foundation; either version 2 of  *
+ *  the License, or (at your option) any later version.             *
+ *                                                                  *
+ *  This program is distributed in the hope that it will be         *
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied      *
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR         *
+ *  PURPOSE.  See the GNU General Public License for more details.  *
+ *                                                                  *
+ *  You should have received a copy of the GNU General Public       *
+ *  License along with this program; if not, write to the Free      *
+ *  Software Foundation, Inc., 59 Temple Place, Suite 330, Boston,  *
+ *  MA  02111-1307  USA                                             *
+ *                                                                  *
+ ********************************************************************
+ *                                                                  *
+ *  packet level comparison of two PDS files                        *
+ *                                                                  *
+ *  Both files are read in one pass and joined on packet time,      *
+ *  APID and packet count (ordered like pdsmerge orders packets),   *
+ *  so memory doesn't grow with the file size. Packets are          *
+ *  reported as only in A, only in B, or in both and same or        *
+ *  different (with checksum status on each side), and counted per  *
+ *  time bin. The checksum is only tested for packets which aren't  *
+ *  the same in both files.                                         *
+ *                                                                  *
+ *  18/10/2026  GA           initial version                        *
+ *  18/10/2026  GA           packet count order of libpds           *
+ *                           (JoinCompare())                        *
+ *  18/10/2026  GA           time of libpds (PDSFormatTime())       *
+ *                                                                  *
+ ********************************************************************
+ *                                                                  *
+ *  usage: pdsdiff [-t threads] [-a APID] [-b seconds] [-l]         *
+ *                 <file A> <file B>                                *
+ *                                                                  *
+ *  exit code: 0 - same packets, 1 - differences, >1 - error        *
+ *                                                                  *
+ ********************************************************************
+ *                                                                  *
+ *  build: cc -DHAVE_ZLIB -DHAVE_BZLIB pdsdiff.c pds.c pdsio.c      *
+ *         pdsstat.c pdsjoin.c pdsfilter.c -lz -lbz2 -lpthread -lm  *
+ *         -o pdsdiff                                               *
+ *                                                                  *
+ ********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "pds.h"
+#include "pdsjoin.h"
+
+
+/********************************************************************
+ *                                                                  *
+ *  defines                                                         *
+ *                                                                  *
+ ********************************************************************/
+/* name */
+#define NAME "pdsdiff"
+/* version */
+#define VERSION 1
+/* revision */
+#define REVISION 2
+/* usage */
+#define USAGE "[-t threads] [-a APID] [-b seconds] [-l] <file A> <file B>\n-a: only compare packets of APID\n-b: count differences in time bins of seconds (default 60)\n-l: list packets only in one file or different"
+/* microseconds per day */
+#define USEC_PER_DAY 86400000000ULL
+/* default size of time bins (seconds) */
+#define BIN_SECS 60
+
+
+/********************************************************************
+ *                                                                  *
+ *  structure definitions                                           *
+ *                                                                  *
+ ********************************************************************/
+/* compared file */
+struct diff_file {
+	/* file name and label */
+	char *name;
+	char *label;
+	/* PDS file pointer */
+	struct pds_file *f;
+	/* packet buffer and decoded packet */
+	unsigned char *buf;
+	struct pds_packet pkt;
+	/* packet available (0 = end of file) */
+	int avail;
+	/* packet time (microseconds since 01/01/1958) and of previous
+		 packet */
+	unsigned long long t, last;
+	/* packets compared, only in this file, not in time order and
+		 skipped (unsupported version or unknown instrument) */
+	long packets, only, unordered, skipped;
+};
+
+/* counts of time bin */
+struct diff_bin {
+	/* bin number (start time / bin size) */
+	unsigned long long bin;
+	/* packets same and different in both files, only in A and B */
+	long same, differ, only_a, only_b;
+};
+
+
+/********************************************************************
+ *                                                                  *
+ *  function declarations                                           *
+ *                                                                  *
+ ********************************************************************/
+int NextPacket(struct diff_file *d, int apid);
+int ComparePackets(struct diff_file *a, struct diff_file *b);
+void CountBin(struct diff_bin *bin, unsigned long long t,
+							unsigned long long size);
+void PrintPacket(char *label, struct diff_file *d);
+
+
+/********************************************************************
+ *                                                                  *
+ *  main function                                                   *
+ *                                                                  *
+ ********************************************************************/
+int main(int argc, char *argv[]) {
+	/* compared files */
+	struct diff_file file[2];
+	/* number of decompression threads */
+	int threads = 1;
+	/* APID to compare (-1 = all) */
+	int apid = -1;
+	/* size of time bins (microseconds) */
+	unsigned long long binsize = BIN_SECS * 1000000ULL;
+	/* counts of current time bin */
+	struct diff_bin bin = { ~0ULL, 0, 0, 0, 0 };
+	/* list packets */
+	int list = 0;
+	/* packets same and different in both files */
+	long same = 0, differ = 0;
+	/* order of current packets */
+	int order;
+	/* checksums valid */
+	int valid_a, valid_b;
+	/* error code */
+	int error = 0;
+	/* counter */
+	int i;
+	/* option character */
+	int c;
+
+
+	/* print version information */
+	fprintf(stderr, "%s V%d.%d ("__DATE__")\n",
+					NAME,	VERSION, REVISION);
+
+	/* get options */
+	while((c = getopt(argc, argv, "t:a:b:l")) != -1) {
+		switch(c) {
+		case 't':
+			threads = atoi(optarg);
+			if(threads < 1) {
+				fprintf(stderr, "USAGE: %s %s\n", NAME, USAGE);
+				return(20);
+			}
+			break;
+		case 'a':
+			apid = atoi(optarg);
+			break;
+		case 'b':
+			if(atoi(optarg) < 1) {
+				fprintf(stderr, "USAGE: %s %s\n", NAME, USAGE);
+				return(20);
+			}
+			binsize = atoi(optarg) * 1000000ULL;
+			break;
+		case 'l':
+			list = 1;
+			break;
+		default:
+			fprintf(stderr, "USAGE: %s %s\n", NAME, USAGE);
+			return(20);
+		}
+	}
+	if(argc - optind != 2) {
+		fprintf(stderr, "USAGE: %s %s\n", NAME, USAGE);
+		return(20);
+	}
+
+	/* open files */
+	for(i = 0; i < 2; i++) {
+		memset(&(file[i]), 0, sizeof(struct diff_file));
+		file[i].name = argv[optind + i];
+		file[i].label = i ? "B" : "A";
+		if(!(file[i].buf = malloc(sizeof(unsigned char) * PDS_PKT_SIZE))) {
+			fprintf(stderr, "not enough memory\n");
+			return(10);
+		}
+		if(!(file[i].f = PDSOpen(file[i].name, threads))) {
+			fprintf(stderr, "can't open input file (%s)\n", file[i].name);
+			return(10);
+		}
+		if((error = NextPacket(&(file[i]), apid)))
+			break;
+	}
+
+	/* join packets of both files */
+	while(!error && (file[0].avail || file[1].avail)) {
+		order = ComparePackets(&(file[0]), &(file[1]));
+
+		/* only in A? */
+		if(order < 0) {
+			file[0].only++;
+			CountBin(&bin, file[0].t, binsize);
+			bin.only_a++;
+			if(list)
+				PrintPacket("only A", &(file[0]));
+			error = NextPacket(&(file[0]), apid);
+			continue;
+		}
+
+		/* only in B? */
+		if(order > 0) {
+			file[1].only++;
+			CountBin(&bin, file[1].t, binsize);
+			bin.only_b++;
+			if(list)
+				PrintPacket("only B", &(file[1]));
+			error = NextPacket(&(file[1]), apid);
+			continue;
+		}
+
+		/* in both, same bytes? */
+		CountBin(&bin, file[0].t, binsize);
+		if((file[0].pkt.size == file[1].pkt.size) &&
+			 !memcmp(file[0].buf, file[1].buf, file[0].pkt.size)) {
+			same++;
+			bin.same++;
+		} else {
+			differ++;
+			bin.differ++;
+			if(list) {
+				valid_a = PDSCheckPacket(file[0].buf, &(file[0].pkt));
+				valid_b = PDSCheckPacket(file[1].buf, &(file[1].pkt));
+				PrintPacket("differ", &(file[0]));
+				printf(" checksum A %s B %s\n", valid_a ? "ok" : "bad",
+							 valid_b ? "ok" : "bad");
+			}
+		}
+		if(!(error = NextPacket(&(file[0]), apid)))
+			error = NextPacket(&(file[1]), apid);
+	}
+	CountBin(&bin, ~0ULL, binsize);
+
+	/* read error? */
+	if(error) {
+		fprintf(stderr, "error reading input file (%s)\n",
+						file[error - 1].name);
+		return(5);
+	}
+
+	/* totals */
+	for(i = 0; i < 2; i++)
+		printf("%s: %s packets %ld only %s %ld not in order %ld "
+					 "skipped %ld\n", file[i].label, file[i].name,
+					 file[i].packets, file[i].label, file[i].only,
+					 file[i].unordered, file[i].skipped);
+	printf("both: same %ld different %ld\n", same, differ);
+
+	/* close files */
+	for(i = 0; i < 2; i++) {
+		PDSClose(file[i].f);
+		free(file[i].buf);
+	}
+
+	/* tschuess */
+	return((differ || file[0].only || file[1].only) ? 1 : 0);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  read next packet to compare                                     *
+ *                                                                  *
+ *  Packets are read without checking the checksum, packets of      *
+ *  unsupported version or unknown instrument are skipped.          *
+ *                                                                  *
+ *  d:    pointer to compared file                                  *
+ *  apid: APID to compare (-1 = all)                                *
+ *                                                                  *
+ *  result: 0 - ok (or end of file, see d->avail)                   *
+ *          1 - read error in file A                                *
+ *          2 - read error in file B                                *
+ *                                                                  *
+ ********************************************************************/
+int NextPacket(struct diff_file *d, int apid) {
+	/* error code */
+	int error;
+
+
+	for(;;) {
+		/* read packet */
+		error = PDSReadPacket(d->f, d->buf, &(d->pkt), PDS_LEVEL_DATA);
+		if(error == 1) {
+			d->avail = 0;
+			return(0);
+		}
+		if((error == -1) || (error == -3) || (error == -4))
+			return((d->label[0] == 'A') ? 1 : 2);
+
+		/* packet to compare? */
+		if((apid >= 0) && !error && (d->pkt.hdr.apid != apid))
+			continue;
+		if(error || !d->pkt.decoder) {
+			d->skipped++;
+			continue;
+		}
+		break;
+	}
+
+	/* packet time, order */
+	d->t = (unsigned long long)d->pkt.info.days * USEC_PER_DAY +
+		d->pkt.info.millisec * 1000ULL + d->pkt.info.microsec;
+	if(d->packets && (d->t < d->last))
+		d->unordered++;
+	d->last = d->t;
+	d->packets++;
+	d->avail = 1;
+
+	/* ois rodger */
+	return(0);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  compare order of current packets of both files                  *
+ *                                                                  *
+ *  Packets are ordered by time, APID and packet count (with wrap   *
+ *  around, see JoinCompare()), a file at its end comes last.       *
+ *                                                                  *
+ *  a: pointer to file A                                            *
+ *  b: pointer to file B                                            *
+ *                                                                  *
+ *  result: <0 - packet of A first                                  *
+ *           0 - same packet                                        *
+ *          >0 - packet of B first                                  *
+ *                                                                  *
+ ********************************************************************/
+int ComparePackets(struct diff_file *a, struct diff_file *b) {
+	/* end of file? */
+	if(!a->avail || !b->avail)
+		return(a->avail ? -1 : 1);
+
+	/* time and APID */
+	if(a->t != b->t)
+		return((a->t < b->t) ? -1 : 1);
+	if(a->pkt.hdr.apid != b->pkt.hdr.apid)
+		return(a->pkt.hdr.apid - b->pkt.hdr.apid);
+
+	/* packet count, alles klar */
+	return(JoinCompare(&(a->pkt.info), &(b->pkt.info)));
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  count packet in time bin, print bin when done                   *
+ *                                                                  *
+ *  Packets are joined in time order, so a bin is done when the     *
+ *  first packet of a later bin arrives (or t is ~0 at the end).    *
+ *                                                                  *
+ *  bin:  pointer to counts of current bin                          *
+ *  t:    packet time (microseconds since 01/01/1958)               *
+ *  size: size of bins (microseconds)                               *
+ *                                                                  *
+ *  result: none                                                    *
+ *                                                                  *
+ ********************************************************************/
+void CountBin(struct diff_bin *bin, unsigned long long t,
+							unsigned long long size) {
+	/* time string */
+	char s[32];
+
+
+	/* same bin? */
+	if((t != ~0ULL) && (t / size == bin->bin))
+		return;
+
+	/* print finished bin */
+	if(bin->bin != ~0ULL) {
+		PDSFormatTime(s, bin->bin * size, 1);
+		printf("bin %s: same %ld different %ld only A %ld only B %ld\n",
+					 s, bin->same, bin->differ, bin->only_a, bin->only_b);
+	}
+
+	/* start new bin */
+	bin->bin = (t == ~0ULL) ? ~0ULL : t / size;
+	bin->same = bin->differ = bin->only_a = bin->only_b = 0;
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  print packet of file                                            *
+ *                                                                  *
+ *  Packets only in one file are printed with their checksum        *
+ *  status, different packets without (see main()).                 *
+ *                                                                  *
+ *  label: label of line                                            *
+ *  d:     pointer to file                                          *
+ *                                                                  *
+ *  result: none                                                    *
+ *                                                                  *
+ ********************************************************************/
+void PrintPacket(char *label, struct diff_file *d) {
+	/* time string */
+	char s[32];
+
+
+	PDSFormatTime(s, d->t, 1);
+	printf("%s: APID %d %s count %d", label, d->pkt.hdr.apid, s,
+				 d->pkt.hdr.pkt_count);
+	if(label[0] == 'o')
+		printf(" checksum %s\n",
+					 PDSCheckPacket(d->buf, &(d->pkt)) ? "ok" : "bad");
+}
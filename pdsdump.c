@@ -0,0 +1,343 @@
+/********************************************************************
+ *                                                                  *
+ *  Copyright (C) 2026                                              *
+ *  Geoscience Australia, Canberra, Australia                       *
+ *                                                                  *
+ *  This program is free software; you can redistribute it and/or   *
+ *  modify it under the terms of the GNU General Public License as  *
+ *  published by the Free Software Foundation; either version 2 of  *
+ *  the License, or (at your option) any later version.             *
+ *                                                                  *
+ *  This program is distributed in the hope that it will be         *
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied      *
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR         *
+ *  PURPOSE.  See the GNU General Public License for more details.  *
+ *                                                                  *
+ *  You should have received a copy of the GNU General Public       *
+ *  License along with this program; if not, write to the Free      *
+ *  Software Foundation, Inc., 59 Temple Place, Suite 330, Boston,  *
+ *  MA  02111-1307  USA                                             *
+ *                                                                  *
+ ********************************************************************
+ *                                                                  *
+ *  per packet listing of PDS files (fields see pdsdump.h)          *
+ *                                                                  *
+ *  18/10/2026  GA           initial version                        *
+ *                                                                  *
+ ********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pdsdump.h"
+
+
+/********************************************************************
+ *                                                                  *
+ *  defines                                                         *
+ *                                                                  *
+ ********************************************************************/
+/* size of output buffer */
+#define DUMP_BUF_SIZE 1048576
+/* maximum length of line */
+#define DUMP_LINE_SIZE 128
+/* milliseconds of day */
+#define DUMP_DAY_MS 86400000UL
+/* names of fields */
+#define DUMP_HEADER "# offset apid pkt_count time pkt_type src1 src2 " \
+	"mirror_side checksum\n"
+
+
+/********************************************************************
+ *                                                                  *
+ *  structure definitions                                           *
+ *                                                                  *
+ ********************************************************************/
+/* packet listing */
+struct pds_dump {
+	/* output file, flag for stdout */
+	FILE *f;
+	int std;
+	/* verification level of packets */
+	int level;
+	/* output buffer and number of bytes in it */
+	char *buf;
+	long n;
+	/* day of cached date and date as YYYY/MM/DD, */
+	long day;
+	char date[11];
+	/* error code */
+	int error;
+};
+
+
+/********************************************************************
+ *                                                                  *
+ *  two digit numbers                                               *
+ *                                                                  *
+ ********************************************************************/
+static const char digits[201] =
+	"00010203040506070809101112131415161718192021222324252627282930313233"
+	"34353637383940414243444546474849505152535455565758596061626364656667"
+	"6869707172737475767778798081828384858687888990919293949596979899";
+
+
+/********************************************************************
+ *                                                                  *
+ *  function declarations                                           *
+ *                                                                  *
+ ********************************************************************/
+static char *PutNum(char *p, unsigned long long x, int width);
+static int Flush(struct pds_dump *d);
+
+
+/********************************************************************
+ *                                                                  *
+ *  create packet listing                                           *
+ *                                                                  *
+ *  name:  file name, - for stdout                                  *
+ *  level: verification level of packets (see                       *
+ *         PDSReadPacket()), the checksum is listed at              *
+ *         PDS_LEVEL_FULL only                                      *
+ *                                                                  *
+ *  result:  pointer to packet listing                              *
+ *           NULL - error                                           *
+ *                                                                  *
+ ********************************************************************/
+struct pds_dump *DumpCreate(char *name, int level) {
+	/* packet listing */
+	struct pds_dump *d;
+
+
+	/* allocate memory */
+	if(!(d = calloc(1, sizeof(struct pds_dump))) ||
+		 !(d->buf = malloc(DUMP_BUF_SIZE))) {
+		free(d);
+		return(NULL);
+	}
+	d->level = level;
+	d->day = -1;
+
+	/* create file */
+	d->std = !strcmp(name, "-");
+	if(!(d->f = d->std ? stdout : fopen(name, "w"))) {
+		free(d->buf);
+		free(d);
+		return(NULL);
+	}
+
+	/* names of fields */
+	d->n = strlen(DUMP_HEADER);
+	memcpy(d->buf, DUMP_HEADER, d->n);
+
+	/* tschuess */
+	return(d);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  add line of packet                                              *
+ *                                                                  *
+ *  d:      pointer to packet listing                               *
+ *  offset: offset of packet in (uncompressed) PDS file             *
+ *  pkt:    pointer to decoded packet (see PDSReadPacket())         *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          -1 - write error                                        *
+ *                                                                  *
+ ********************************************************************/
+int DumpAdd(struct pds_dump *d, long long offset, struct pds_packet *pkt) {
+	/* end of line */
+	char *p;
+	/* time of day */
+	unsigned long ms;
+	int hour, minute, second;
+	/* date */
+	int year, month, day;
+
+
+	/* buffer full? */
+	if((d->n > DUMP_BUF_SIZE - DUMP_LINE_SIZE) && Flush(d))
+		return(-1);
+	p = d->buf + d->n;
+
+	/* offset, unsupported version? then nothing else is known */
+	p = PutNum(p, offset, 1);
+	if(pkt->hdr.version) {
+		memcpy(p, " - - - - - - - -\n", 17);
+		d->n = p + 17 - d->buf;
+		return(0);
+	}
+
+	/* primary header */
+	*p++ = ' ';
+	p = PutNum(p, pkt->hdr.apid, 1);
+	*p++ = ' ';
+	p = PutNum(p, pkt->hdr.pkt_count, 1);
+	*p++ = ' ';
+
+	/* time of packets with decoder, date converted once per day */
+	if(pkt->decoder) {
+		if(pkt->info.days != d->day) {
+			d->day = pkt->info.days;
+			PDSCivilDate(d->day, &year, &month, &day);
+			PutNum(d->date, year, 4);
+			d->date[4] = '/';
+			memcpy(d->date + 5, digits + 2 * month, 2);
+			d->date[7] = '/';
+			memcpy(d->date + 8, digits + 2 * day, 2);
+			d->date[10] = ',';
+		}
+		memcpy(p, d->date, 11);
+		p += 11;
+
+		/* time of day, a leap second is 23:59:60 */
+		ms = pkt->info.millisec;
+		if(ms >= DUMP_DAY_MS) {
+			hour = 23;
+			minute = 59;
+			second = 60 + (ms - DUMP_DAY_MS) / 1000UL;
+		} else {
+			hour = ms / 3600000UL;
+			minute = (ms / 60000UL) % 60;
+			second = (ms / 1000UL) % 60;
+		}
+		memcpy(p, digits + 2 * hour, 2);
+		p[2] = ':';
+		memcpy(p + 3, digits + 2 * minute, 2);
+		p[5] = ':';
+		p = PutNum(p + 6, second, 2);
+		*p++ = '.';
+		p = PutNum(p, ms % 1000UL, 3);
+		p = PutNum(p, pkt->info.microsec, 3);
+	} else
+		*p++ = '-';
+
+	/* MODIS header */
+	if(pkt->info.modis) {
+		*p++ = ' ';
+		p = PutNum(p, pkt->mhdr.pkt_type, 1);
+		*p++ = ' ';
+		p = PutNum(p, pkt->mhdr.src1, 1);
+		*p++ = ' ';
+		p = PutNum(p, pkt->mhdr.src2, 1);
+		*p++ = ' ';
+		p = PutNum(p, pkt->mhdr.mirror_side, 1);
+	} else {
+		memcpy(p, " - - - -", 8);
+		p += 8;
+	}
+
+	/* checksum of checked MODIS packets */
+	if(pkt->info.modis && (d->level >= PDS_LEVEL_FULL)) {
+		memcpy(p, pkt->info.valid ? " ok\n" : " bad\n",
+					 pkt->info.valid ? 4 : 5);
+		p += pkt->info.valid ? 4 : 5;
+	} else {
+		memcpy(p, " -\n", 3);
+		p += 3;
+	}
+	d->n = p - d->buf;
+
+	/* ois rodger */
+	return(0);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  write rest of buffer and close file                             *
+ *                                                                  *
+ *  d: pointer to packet listing                                    *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          -1 - write error                                        *
+ *                                                                  *
+ ********************************************************************/
+int DumpFinish(struct pds_dump *d) {
+	/* error code */
+	int error;
+
+
+	/* write buffer, close file (stdout is only flushed) */
+	error = Flush(d);
+	if(d->std ? fflush(d->f) : fclose(d->f))
+		error = -1;
+
+	/* free memory */
+	free(d->buf);
+	free(d);
+
+	/* voila */
+	return(error);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  put decimal number                                              *
+ *                                                                  *
+ *  The digits are produced in pairs from the end, using the table  *
+ *  of two digit numbers.                                           *
+ *                                                                  *
+ *  p:     pointer to buffer                                        *
+ *  x:     number                                                   *
+ *  width: minimum number of digits (zero padded)                   *
+ *                                                                  *
+ *  result: pointer to end of number in buffer                      *
+ *                                                                  *
+ ********************************************************************/
+static char *PutNum(char *p, unsigned long long x, int width) {
+	/* digits from the end */
+	char tmp[24];
+	char *q = tmp + sizeof(tmp);
+	/* number of digits */
+	int n;
+
+
+	/* pairs of digits, then the odd one */
+	while(x >= 100) {
+		q -= 2;
+		memcpy(q, digits + 2 * (x % 100), 2);
+		x /= 100;
+	}
+	if(x >= 10) {
+		q -= 2;
+		memcpy(q, digits + 2 * x, 2);
+	} else
+		*--q = '0' + x;
+
+	/* zero padding */
+	while(tmp + sizeof(tmp) - q < width)
+		*--q = '0';
+
+	/* copy */
+	n = tmp + sizeof(tmp) - q;
+	memcpy(p, q, n);
+
+	/* fine */
+	return(p + n);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  write buffer                                                    *
+ *                                                                  *
+ *  d: pointer to packet listing                                    *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          -1 - write error (also of earlier writes)               *
+ *                                                                  *
+ ********************************************************************/
+static int Flush(struct pds_dump *d) {
+	/* write and empty buffer */
+	if(d->n && (fwrite(d->buf, d->n, 1, d->f) != 1))
+		d->error = -1;
+	d->n = 0;
+
+	/* passt */
+	return(d->error);
+}
@@ -0,0 +1,74 @@
+/********************************************************************
+ *                                                                  *
+ *  Copyright (C) 2026                                              *
+ *  Geoscience Australia, Canberra, Australia                       *
+ *                                                                  *
+ *  This program is free software; you can redistribute it and/or   *
+ *  modify it under the terms of the GNU General Public License as  *
+ *  published by the Free Software Foundation; either version 2 of  *
+ *  the License, or (at your option) any later version.             *
+ *                                                                  *
+ *  This program is distributed in the hope that it will be         *
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied      *
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR         *
+ *  PURPOSE.  See the GNU General Public License for more details.  *
+ *                                                                  *
+ *  You should have received a copy of the GNU General Public       *
+ *  License along with this program; if not, write to the Free      *
+ *  Software Foundation, Inc., 59 Temple Place, Suite 330, Boston,  *
+ *  MA  02111-1307  USA                                             *
+ *                                                                  *
+ ********************************************************************
+ *                                                                  *
+ *  per packet listing of PDS files                                 *
+ *                                                                  *
+ *  One text line per packet, fields separated by a space, for      *
+ *  debugging and for tools reading text. Lines are formatted by    *
+ *  hand into a large buffer (no printf) and the calendar date is   *
+ *  converted once per day (PDSCivilDate()), so millions of lines   *
+ *  per second are written.                                         *
+ *                                                                  *
+ *  fields: offset of packet in (uncompressed) PDS file, APID,      *
+ *   packet count, time (YYYY/MM/DD,hh:mm:ss.uuuuuu), packet type,  *
+ *   src1, src2, mirror side, checksum (ok or bad)                  *
+ *  Fields not known for the packet are written as -: the time of   *
+ *  packets without decoder, the MODIS fields of other instruments, *
+ *  the checksum below PDS_LEVEL_FULL and everything but the offset *
+ *  of packets with unsupported version. The first line is a        *
+ *  comment (#) with the names of the fields.                       *
+ *                                                                  *
+ ********************************************************************/
+
+#ifndef PDSDUMP_H
+#define PDSDUMP_H
+
+#include "pds.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/********************************************************************
+ *                                                                  *
+ *  structure definitions                                           *
+ *                                                                  *
+ ********************************************************************/
+/* packet listing (private) */
+struct pds_dump;
+
+
+/********************************************************************
+ *                                                                  *
+ *  function declarations                                           *
+ *                                                                  *
+ ********************************************************************/
+struct pds_dump *DumpCreate(char *name, int level);
+int DumpAdd(struct pds_dump *d, long long offset, struct pds_packet *pkt);
+int DumpFinish(struct pds_dump *d);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
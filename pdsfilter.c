@@ -0,0 +1,452 @@
+/********************************************************************
+ *                                                                  *
+ *  Copyright (C) 2026                                              *
+ *  Geoscience Australia, Canberra, Australia                       *
+ *                                                                  *
+ *  This program is free software; you can redistribute it and/or   *
+ *  modify it under the terms of the GNU General Public License as  *
+ *  published by the Free Software Foundation; either version 2 of  *
+ *  the License, or (at your option) any later version.             *
+ *                                                                  *
+ *  This program is distributed in the hope that it will be         *
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied      *
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR         *
+ *  PURPOSE.  See the GNU General Public License for more details.  *
+ *                                                                  *
+ *  You should have received a copy of the GNU General Public       *
+ *  License along with this program; if not, write to the Free      *
+ *  Software Foundation, Inc., 59 Temple Place, Suite 330, Boston,  *
+ *  MA  02111-1307  USA                                             *
+ *                                                                  *
+ ********************************************************************
+ *                                                                  *
+ *  packet filter expressions (syntax see pdsfilter.h)              *
+ *                                                                  *
+ *  18/10/2026  GA           initial version                        *
+ *                                                                  *
+ ********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "pdsfilter.h"
+
+
+/********************************************************************
+ *                                                                  *
+ *  defines                                                         *
+ *                                                                  *
+ ********************************************************************/
+/* operations */
+#define OP_CMP 0
+#define OP_AND 1
+#define OP_OR 2
+#define OP_NOT 3
+/* relations accepted by comparison (bits of mask) */
+#define REL_LT 1
+#define REL_EQ 2
+#define REL_GT 4
+/* maximum length of field name */
+#define NAME_SIZE 16
+
+
+/********************************************************************
+ *                                                                  *
+ *  structure definitions                                           *
+ *                                                                  *
+ ********************************************************************/
+/* operation */
+struct filter_op {
+	/* operation code */
+	int code;
+	/* field: MODIS header, offset in header, unsigned long value */
+	int modis;
+	size_t offset;
+	int ulong;
+	/* accepted relations and value of comparison */
+	int mask;
+	long value;
+};
+
+/* compiled filter */
+struct pds_filter {
+	/* program */
+	struct filter_op *ops;
+	int nops;
+	/* stack */
+	int *stack;
+};
+
+/* field */
+struct filter_field {
+	char *name;
+	int modis;
+	size_t offset;
+	int ulong;
+};
+
+
+/********************************************************************
+ *                                                                  *
+ *  fields                                                          *
+ *                                                                  *
+ ********************************************************************/
+static const struct filter_field fields[] = {
+	{ "version", 0, offsetof(struct pri_hdr, version), 0 },
+	{ "type", 0, offsetof(struct pri_hdr, type), 0 },
+	{ "sec_hdr_flag", 0, offsetof(struct pri_hdr, sec_hdr_flag), 0 },
+	{ "apid", 0, offsetof(struct pri_hdr, apid), 0 },
+	{ "seq_flags", 0, offsetof(struct pri_hdr, seq_flags), 0 },
+	{ "pkt_count", 0, offsetof(struct pri_hdr, pkt_count), 0 },
+	{ "pkt_length", 0, offsetof(struct pri_hdr, pkt_length), 0 },
+	{ "days", 1, offsetof(struct modis_hdr, days), 0 },
+	{ "millisec", 1, offsetof(struct modis_hdr, millisec), 1 },
+	{ "microsec", 1, offsetof(struct modis_hdr, microsec), 0 },
+	{ "ql", 1, offsetof(struct modis_hdr, ql), 0 },
+	{ "pkt_type", 1, offsetof(struct modis_hdr, pkt_type), 0 },
+	{ "scan_count", 1, offsetof(struct modis_hdr, scan_count), 0 },
+	{ "mirror_side", 1, offsetof(struct modis_hdr, mirror_side), 0 },
+	{ "src1", 1, offsetof(struct modis_hdr, src1), 0 },
+	{ "src2", 1, offsetof(struct modis_hdr, src2), 0 },
+	{ "conf", 1, offsetof(struct modis_hdr, conf), 0 },
+	{ "sci_state", 1, offsetof(struct modis_hdr, sci_state), 0 },
+	{ "sci_abnorm", 1, offsetof(struct modis_hdr, sci_abnorm), 0 },
+	{ NULL, 0, 0, 0 }
+};
+
+/* MODIS header of packets of other instruments */
+static const struct modis_hdr no_modis_hdr;
+
+
+/********************************************************************
+ *                                                                  *
+ *  function declarations                                           *
+ *                                                                  *
+ ********************************************************************/
+static int ParseOr(char **p, struct pds_filter *f);
+static int ParseAnd(char **p, struct pds_filter *f);
+static int ParseFactor(char **p, struct pds_filter *f);
+static int ParseCompare(char **p, struct pds_filter *f);
+static void AddOp(struct pds_filter *f, int code);
+static void SkipSpace(char **p);
+
+
+/********************************************************************
+ *                                                                  *
+ *  compile filter expression                                       *
+ *                                                                  *
+ *  expr:  filter expression                                        *
+ *  error: pointer to store position of syntax error (or NULL)      *
+ *                                                                  *
+ *  result: pointer to compiled filter                              *
+ *          NULL - syntax error or out of memory                    *
+ *                                                                  *
+ ********************************************************************/
+struct pds_filter *FilterCompile(char *expr, char **error) {
+	/* compiled filter */
+	struct pds_filter *f;
+	/* position in expression */
+	char *p = expr;
+
+
+	/* allocate memory, every operation takes at least one character */
+	if(error)
+		*error = NULL;
+	if(!(f = calloc(1, sizeof(struct pds_filter))) ||
+		 !(f->ops = malloc(sizeof(struct filter_op) * (strlen(expr) + 1))) ||
+		 !(f->stack = malloc(sizeof(int) * (strlen(expr) + 1)))) {
+		FilterFree(f);
+		return(NULL);
+	}
+
+	/* parse expression */
+	if(ParseOr(&p, f) || (SkipSpace(&p), *p)) {
+		if(error)
+			*error = p;
+		FilterFree(f);
+		return(NULL);
+	}
+
+	/* tschuess */
+	return(f);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  test if packet matches filter                                   *
+ *                                                                  *
+ *  f:   pointer to compiled filter                                 *
+ *  pkt: pointer to decoded packet                                  *
+ *                                                                  *
+ *  result: 1 - packet matches                                      *
+ *          0 - packet doesn't match                                *
+ *                                                                  *
+ ********************************************************************/
+int FilterMatch(struct pds_filter *f, struct pds_packet *pkt) {
+	/* operation */
+	struct filter_op *op;
+	/* stack pointer */
+	int *sp = f->stack;
+	/* headers */
+	const char *hdr[2];
+	/* value of field */
+	long v;
+
+
+	/* headers of fields */
+	hdr[0] = (const char *)&(pkt->hdr);
+	hdr[1] = (const char *)(pkt->info.modis ? &(pkt->mhdr) : &no_modis_hdr);
+
+	/* run program */
+	for(op = f->ops; op < f->ops + f->nops; op++) {
+		switch(op->code) {
+		case OP_CMP:
+			v = op->ulong ?
+				(long)*(const unsigned long *)(hdr[op->modis] + op->offset) :
+				*(const int *)(hdr[op->modis] + op->offset);
+			*sp++ = (op->mask >> ((v > op->value) - (v < op->value) + 1)) & 1;
+			break;
+		case OP_AND:
+			sp--;
+			sp[-1] &= sp[0];
+			break;
+		case OP_OR:
+			sp--;
+			sp[-1] |= sp[0];
+			break;
+		case OP_NOT:
+			sp[-1] ^= 1;
+			break;
+		}
+	}
+
+	/* result */
+	return(sp[-1]);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  free compiled filter                                            *
+ *                                                                  *
+ *  f: pointer to compiled filter (or NULL)                         *
+ *                                                                  *
+ *  result: none                                                    *
+ *                                                                  *
+ ********************************************************************/
+void FilterFree(struct pds_filter *f) {
+	if(!f)
+		return;
+	free(f->ops);
+	free(f->stack);
+	free(f);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  parse alternatives (expr)                                       *
+ *                                                                  *
+ *  p: pointer to position in expression (updated)                  *
+ *  f: pointer to filter                                            *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          -1 - syntax error                                       *
+ *                                                                  *
+ ********************************************************************/
+static int ParseOr(char **p, struct pds_filter *f) {
+	/* first term */
+	if(ParseAnd(p, f))
+		return(-1);
+
+	/* further terms */
+	for(SkipSpace(p); **p == '|'; SkipSpace(p)) {
+		*p += ((*p)[1] == '|') ? 2 : 1;
+		if(ParseAnd(p, f))
+			return(-1);
+		AddOp(f, OP_OR);
+	}
+
+	/* ois rodger */
+	return(0);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  parse conjunction (term)                                        *
+ *                                                                  *
+ *  p: pointer to position in expression (updated)                  *
+ *  f: pointer to filter                                            *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          -1 - syntax error                                       *
+ *                                                                  *
+ ********************************************************************/
+static int ParseAnd(char **p, struct pds_filter *f) {
+	/* first factor */
+	if(ParseFactor(p, f))
+		return(-1);
+
+	/* further factors */
+	for(SkipSpace(p); **p == '&'; SkipSpace(p)) {
+		*p += ((*p)[1] == '&') ? 2 : 1;
+		if(ParseFactor(p, f))
+			return(-1);
+		AddOp(f, OP_AND);
+	}
+
+	/* alles klar */
+	return(0);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  parse negation, parentheses or comparison (factor)              *
+ *                                                                  *
+ *  p: pointer to position in expression (updated)                  *
+ *  f: pointer to filter                                            *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          -1 - syntax error                                       *
+ *                                                                  *
+ ********************************************************************/
+static int ParseFactor(char **p, struct pds_filter *f) {
+	SkipSpace(p);
+
+	/* negation? */
+	if((**p == '!') && ((*p)[1] != '=')) {
+		(*p)++;
+		if(ParseFactor(p, f))
+			return(-1);
+		AddOp(f, OP_NOT);
+		return(0);
+	}
+
+	/* parentheses? */
+	if(**p == '(') {
+		(*p)++;
+		if(ParseOr(p, f))
+			return(-1);
+		SkipSpace(p);
+		if(**p != ')')
+			return(-1);
+		(*p)++;
+		return(0);
+	}
+
+	/* comparison */
+	return(ParseCompare(p, f));
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  parse comparison of field with number                           *
+ *                                                                  *
+ *  p: pointer to position in expression (updated)                  *
+ *  f: pointer to filter                                            *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          -1 - syntax error                                       *
+ *                                                                  *
+ ********************************************************************/
+static int ParseCompare(char **p, struct pds_filter *f) {
+	/* field name */
+	char name[NAME_SIZE];
+	/* operation */
+	struct filter_op *op = &(f->ops[f->nops]);
+	/* end of number */
+	char *end;
+	/* counter */
+	int i;
+
+
+	/* field */
+	for(i = 0; (isalnum((unsigned char)**p) || (**p == '_')) &&
+				(i < NAME_SIZE - 1); i++, (*p)++)
+		name[i] = **p;
+	name[i] = 0;
+	for(i = 0; fields[i].name && strcmp(fields[i].name, name); i++);
+	if(!fields[i].name) {
+		*p -= strlen(name);
+		return(-1);
+	}
+	op->code = OP_CMP;
+	op->modis = fields[i].modis;
+	op->offset = fields[i].offset;
+	op->ulong = fields[i].ulong;
+
+	/* relation */
+	SkipSpace(p);
+	if(!strncmp(*p, "!=", 2)) {
+		op->mask = REL_LT | REL_GT;
+		*p += 2;
+	} else if(!strncmp(*p, "<=", 2)) {
+		op->mask = REL_LT | REL_EQ;
+		*p += 2;
+	} else if(!strncmp(*p, ">=", 2)) {
+		op->mask = REL_GT | REL_EQ;
+		*p += 2;
+	} else if(!strncmp(*p, "==", 2)) {
+		op->mask = REL_EQ;
+		*p += 2;
+	} else if(**p == '=') {
+		op->mask = REL_EQ;
+		(*p)++;
+	} else if(**p == '<') {
+		op->mask = REL_LT;
+		(*p)++;
+	} else if(**p == '>') {
+		op->mask = REL_GT;
+		(*p)++;
+	} else
+		return(-1);
+
+	/* number */
+	SkipSpace(p);
+	op->value = strtol(*p, &end, 0);
+	if(end == *p)
+		return(-1);
+	*p = end;
+	f->nops++;
+
+	/* passt */
+	return(0);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  add operation without operands to program                       *
+ *                                                                  *
+ *  f:    pointer to filter                                         *
+ *  code: operation code                                            *
+ *                                                                  *
+ *  result: none                                                    *
+ *                                                                  *
+ ********************************************************************/
+static void AddOp(struct pds_filter *f, int code) {
+	memset(&(f->ops[f->nops]), 0, sizeof(struct filter_op));
+	f->ops[f->nops++].code = code;
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  skip white space                                                *
+ *                                                                  *
+ *  p: pointer to position in expression (updated)                  *
+ *                                                                  *
+ *  result: none                                                    *
+ *                                                                  *
+ ********************************************************************/
+static void SkipSpace(char **p) {
+	while(isspace((unsigned char)**p))
+		(*p)++;
+}
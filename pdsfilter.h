@@ -0,0 +1,81 @@
+/********************************************************************
+ *                                                                  *
+ *  Copyright (C) 2026                                              *
+ *  Geoscience Australia, Canberra, Australia                       *
+ *                                                                  *
+ *  This program is free software; you can redistribute it and/or   *
+ *  modify it under the terms of the GNU General Public License as  *
+ *  published by the Free Software Foundation; either version 2 of  *
+ *  the License, or (at your option) any later version.             *
+ *                                                                  *
+ *  This program is distributed in the hope that it will be         *
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied      *
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR         *
+ *  PURPOSE.  See the GNU General Public License for more details.  *
+ *                                                                  *
+ *  You should have received a copy of the GNU General Public       *
+ *  License along with this program; if not, write to the Free      *
+ *  Software Foundation, Inc., 59 Temple Place, Suite 330, Boston,  *
+ *  MA  02111-1307  USA                                             *
+ *                                                                  *
+ ********************************************************************
+ *                                                                  *
+ *  packet filter expressions                                       *
+ *                                                                  *
+ *  A filter expression over the decoded primary and MODIS header   *
+ *  is compiled once into a small postfix program, which is run for *
+ *  each packet. Comparisons are evaluated without branches, so     *
+ *  packets can be selected before their checksum is calculated.    *
+ *                                                                  *
+ *  syntax:                                                         *
+ *   expr:  term { "|" term }                                       *
+ *   term:  factor { "&" factor }                                   *
+ *   factor: "!" factor | "(" expr ")" | field op number            *
+ *   op:    "=" | "==" | "!=" | "<" | "<=" | ">" | ">="             *
+ *  ("||" and "&&" are accepted as well, numbers are decimal or     *
+ *  hexadecimal with 0x)                                            *
+ *                                                                  *
+ *  fields: version, type, sec_hdr_flag, apid, seq_flags,           *
+ *   pkt_count, pkt_length (primary header), days, millisec,        *
+ *   microsec, ql, pkt_type, scan_count, mirror_side, src1, src2,   *
+ *   conf, sci_state, sci_abnorm (MODIS header, 0 for packets of    *
+ *   other instruments)                                             *
+ *                                                                  *
+ *  example: engineering packets of mirror side 1                   *
+ *   "(pkt_type = 2 | pkt_type = 4) & mirror_side = 1"              *
+ *                                                                  *
+ ********************************************************************/
+
+#ifndef PDSFILTER_H
+#define PDSFILTER_H
+
+#include "pds.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/********************************************************************
+ *                                                                  *
+ *  structure definitions                                           *
+ *                                                                  *
+ ********************************************************************/
+/* compiled filter (private) */
+struct pds_filter;
+
+
+/********************************************************************
+ *                                                                  *
+ *  function declarations                                           *
+ *                                                                  *
+ ********************************************************************/
+struct pds_filter *FilterCompile(char *expr, char **error);
+int FilterMatch(struct pds_filter *f, struct pds_packet *pkt);
+void FilterFree(struct pds_filter *f);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -34,10 +34,48 @@
  *  14/02/2009  S W Maier    output number of day, night and eng.   *
  *                           pkts                                   *
  *  24/03/2009  S W Maier    proper handling of corrupted files     *
+ *  18/10/2026  GA           read gzip, bzip2 and zstd compressed   *
+ *                           files, decompress in parallel (-t)     *
+ *  18/10/2026  GA           statistics moved to pdsstat.c, copy    *
+ *                           input to PDS archive (-o, -A), take    *
+ *                           archive statistics from block headers  *
+ *  18/10/2026  GA           packet decoding moved to libpds        *
+ *                           (pds.c)                                *
+ *  18/10/2026  GA           export of packet headers as columns    *
+ *                           (-c)                                   *
+ *  18/10/2026  GA           export of MODIS science samples (-u)   *
+ *  18/10/2026  GA           scan index (-S)                        *
+ *  18/10/2026  GA           check for clean files (-C), stops at   *
+ *                           first incomplete scan                  *
+ *  18/10/2026  GA           estimates from evenly spaced blocks of *
+ *                           plain files (-s)                       *
+ *  18/10/2026  GA           verification levels (-l), only headers *
+ *                           read below full level                  *
+ *  18/10/2026  GA           duplicates anywhere in window of       *
+ *                           recent packets (-d), not counted as    *
+ *                           missing                                *
+ *  18/10/2026  GA           scan of list of files (-L), read in    *
+ *                           large chunks with io_uring, headers    *
+ *                           decoded in batches                     *
+ *  18/10/2026  GA           listing of packets (-p), dates without *
+ *                           floating point                         *
+ *  18/10/2026  GA           reassembly of segmented packets (-g),  *
+ *                           orphaned segments counted              *
+ *  18/10/2026  GA           -d: packets with bad checksum looked   *
+ *                           up too, packets not after the last     *
+ *                           packet of their APID aren't missing    *
+ *  18/10/2026  GA           -d: statistics and duplicates of APID  *
+ *                           kept per APID, no list walk per packet *
  *                                                                  *
  ********************************************************************
  *                                                                  *
- *  usage: pdsinfo <input>                                          *
+ *  usage: pdsinfo [-t threads] [-l level] [-o output [-A]          *
+ *                 [-z level] [-B block_kb]] [-c columns]           *
+ *                 [-u samples] [-S scans] [-d] [-p packets] [-g]   *
+ *                 <input>                                          *
+ *         pdsinfo [-t threads] -C <input>                          *
+ *         pdsinfo -s fraction <input>                              *
+ *         pdsinfo [-t threads] [-l level] -L <list>                *
  *                                                                  *
  ********************************************************************
  *                                                                  *
@@ -46,13 +84,26 @@
  *                                                                  *
  ********************************************************************
  *                                                                  *
- *  build: cc pdsinfo.c -lm -o pdsinfo                              *
+ *  build: cc -DHAVE_ZLIB -DHAVE_BZLIB -DHAVE_IO_URING pdsinfo.c    *
+ *         pds.c pdscol.c pdsdump.c pdsscan.c pdsseg.c pdsio.c      *
+ *         pdsread.c pdsstat.c pdsjoin.c pdsfilter.c                *
+ *         -lz -lbz2 -lpthread -lm -o pdsinfo                       *
  *                                                                  *
  ********************************************************************/
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 #include <math.h>
+#include <pthread.h>
+
+#include "pdscol.h"
+#include "pdsdump.h"
+#include "pdsscan.h"
+#include "pdsseg.h"
+#include "pdsread.h"
+#include "pdsjoin.h"
 
 
 /********************************************************************
@@ -65,15 +116,31 @@
 /* version */
 #define VERSION 1
 /* revision */
-#define REVISION 6
-/* primary header size */
-#define PRI_HDR_SIZE 6
-/* MODIS secondary header size */
-#define MODIS_HDR_SIZE 12
-/* Julian Day of MODIS reference date (01/01/1958)*/
-#define MODIS_REF_DATE 2436205.0
-/* data buffer size */
-#define DATA_SIZE 100000
+#define REVISION 21
+/* usage */
+#define USAGE "USAGE: %s [-t threads] [-l level] [-o output [-A] [-z level] " \
+	"[-B block_kb]] [-c columns] [-u samples] [-S scans] [-d] " \
+	"[-p packets] [-g] <input>\n" \
+	"       %s [-t threads] -C <input>\n" \
+	"       %s -s fraction <input>\n" \
+	"       %s [-t threads] [-l level] -L <list>\n"
+/* size of sampled blocks */
+#define SAMPLE_BLOCK 1048576
+/* bytes read after sampled block to find packet boundary */
+#define SAMPLE_EXTRA 65536
+/* number of consecutive packet headers of packet boundary */
+#define SAMPLE_SYNC 4
+/* factor of standard error for 95% confidence bounds */
+#define SAMPLE_Z 1.96
+/* log2 of buckets of duplicate set (4 packets each, 4 MB) */
+#define DUP_BITS 18
+/* number of APIDs */
+#define DUP_APIDS 2048
+/* files read at the same time and bytes per chunk of list scan */
+#define LIST_FILES 32
+#define LIST_CHUNK 2097152
+/* maximum length of file name in list */
+#define LIST_NAME_SIZE 4096
 
 
 /********************************************************************
@@ -81,42 +148,50 @@
  *  structure definitions                                           *
  *                                                                  *
  ********************************************************************/
-/* primary header */
-struct pri_hdr {
-	int version;
-	int type;
-	int sec_hdr_flag;
+/* sums over sampled blocks of packets (x), invalid (y) and missing
+	 (z) packets of APID, their squares and products, and product of
+	 packets and bytes of block (l) */
+struct sample_apid {
 	int apid;
-	int seq_flags;
-	int pkt_count;
-	int pkt_length;
+	double x, y, z, xx, yy, zz, xy, xz, xl;
+	struct sample_apid *next;
 };
 
-/* APID info */
-struct apid_info {
+/* duplicates of APID: number, number of runs of consecutive
+	 duplicates, date/time of first and last duplicate, flag for
+	 previous packet of APID duplicate */
+struct dup_apid {
 	int apid;
-	long int count;
-	long int invalid;
-	long int missing;
-	long int last_pkt_count;
-	struct apid_info *next;
+	long count, runs;
+	long firstday, firstms, firstmics;
+	long lastday, lastms, lastmics;
+	int run;
+	struct dup_apid *next;
+};
+
+/* sequence of APID (-d): last packet, statistics and duplicates */
+struct apid_seq {
+	struct pkt_info last;
+	struct apid_info *ai;
+	struct dup_apid *dup;
+};
+
+/* file of list scan: statistics, first chunk seen, error message */
+struct list_file {
+	struct pds_stats stats;
+	int started;
+	char *error;
 };
 
-/* MODIS header */
-struct modis_hdr {
-	int days;
-	unsigned long int millisec;
-	int microsec;
-	int ql;
-	int pkt_type;
-	int scan_count;
-	int mirror_side;
-	int src1;
-	int src2;
-	int conf;
-	int sci_state;
-	int sci_abnorm;
-	int checksum;
+/* list scan shared by threads: reader, file names and files,
+	 verification level, lock of output, return value */
+struct list_scan {
+	struct pds_reader *reader;
+	char **names;
+	struct list_file *files;
+	int verify;
+	pthread_mutex_t lock;
+	int retvalue;
 };
 
 
@@ -125,17 +200,19 @@ struct modis_hdr {
  *  function declarations                                           *
  *                                                                  *
  ********************************************************************/
-int ReadPriHdr(FILE *f, unsigned char *buf);
-int DecodePriHdr(unsigned char *buf, struct pri_hdr *hdr);
-int DecodeMODISHdr(unsigned char *buf, int len,
-									 struct modis_hdr *hdr);
-struct apid_info *AllocAPIDInfo(int apid);
-void AddAPIDInfo(struct apid_info **list, struct apid_info *ai);
-void FreeAPIDInfoList(struct apid_info *list);
-struct apid_info *FindAPIDInfo(struct apid_info *list, int apid);
-void caldat(int *minute, int *hour, int *day, int *month, int *year,
-						double jul);
-int CalcChecksum12(unsigned char *buf, int n);
+int SampleInfo(struct pds_file *f, double fraction);
+long FindSync(unsigned char *buf, long n, long len, int eof);
+void PrintTime(char *label, long day, long ms, long mics);
+struct dup_apid *AddDuplicate(struct dup_apid **list, struct dup_apid *da,
+															struct pds_packet *pkt);
+int ListInfo(char *listname, int threads, int verify);
+void *ListWorker(void *arg);
+long ListChunk(struct list_scan *l, struct pds_stats *s,
+							 struct pds_chunk *c);
+int ListFile(struct list_scan *l, struct list_file *lf, char *name);
+void ListReport(struct list_scan *l, int file);
+void PrintAPIDs(struct pds_stats *s, int verify);
+void PrintMODIS(struct pds_stats *s);
 
 
 /********************************************************************
@@ -145,362 +222,602 @@ int CalcChecksum12(unsigned char *buf, int n);
  ********************************************************************/
 int main(int argc, char *argv[])
 {
-	/* file pointer */
-  FILE *fin;
-	/* primary header structure */
-	struct pri_hdr hdr;
-	/* MODIS header structure */
-	struct modis_hdr mhdr;
-	/* header buffer */
-	unsigned char buf_hdr[PRI_HDR_SIZE];
-	/* data buffer */
-	unsigned char *buf_data;
-	/* pointer to APID Info list */
-	struct apid_info *apidlist = NULL;
-	/* pointer to current APID Info object */
-	struct apid_info *apidinfo = NULL;
-	/* first packet date/time */
-	long int firstday = 1.E6, firstms = 1.E6, firstmics = 1.E6;
-	/* last packet date/time */
-	long int lastday = 0, lastms = 0, lastmics = 0;
-	/* previous packet date/time */
-	long int prevday = 0, prevms = 0, prevmics = 0;
-	/* date buffer */
-	int second, minute, hour, day, month, year;
-	long int ms;
-	double jul;
-	/* checksum */
-	int chksum;
+	/* PDS file pointer */
+  struct pds_file *fin;
+	/* PDS output file pointer */
+	struct pds_out *fout = NULL;
+	/* decoded packet */
+	struct pds_packet pkt;
+	/* statistics */
+	struct pds_stats stats;
+	/* packet buffer */
+	unsigned char *buf = NULL;
 	/* error code */
 	int error;
 	/* number of missing packets */
-	long int missing;
-	/* number of missing seconds */
-	long int missingsecs = 0;
-	/* millisecs difference between packets */
-	long int diffms;
+	long int missing = 0;
 	/* */
 	int lastdays, lastmicrosec, lastsrc;
 	unsigned long int lastmillisec;
-	/* number of day packets */
-	long int daypkts1 = 0, daypkts2 = 0;
-	/* number of night packets */
-	long int nightpkts1 = 0, nightpkts2 = 0;
-	/* number of engineering packets */
-	long int engpkts1 = 0, engpkts2 = 0;
 	/* return value */
 	int retvalue = 0;
+	/* number of decompression threads */
+	int threads = 1;
+	/* output file name */
+	char *outname = NULL;
+	/* output file format */
+	int format = PDS_FMT_PLAIN;
+	/* output compression level */
+	int level = 0;
+	/* output block size */
+	long frame_size = 0;
+	/* column file name */
+	char *colname = NULL;
+	/* column file */
+	struct pds_col *col = NULL;
+	/* offset of packet in input file */
+	long long offset = 0;
+	/* sample file name */
+	char *samplename = NULL;
+	/* sample file */
+	FILE *fsample = NULL;
+	/* scan index file name */
+	char *scanname = NULL;
+	/* scan index */
+	struct pds_scan *scan = NULL;
+	/* number of complete and partial scans */
+	long complete, partial;
+	/* check if file is clean */
+	int clean = 0;
+	/* flag for file not clean */
+	int dirty = 0;
+	/* sampled fraction of file */
+	double fraction = 0;
+	/* verification level */
+	int verify = PDS_LEVEL_FULL;
+	/* find duplicates, set of recent packets */
+	int dupcheck = 0;
+	struct pds_dupset *dups = NULL;
+	/* duplicates of APIDs */
+	struct dup_apid *duplist = NULL, *da;
+	/* flag for duplicated packet */
+	int dup;
+	/* sequence of each APID (-d), flag for packet not after its last
+		 packet */
+	struct apid_seq *seq = NULL, *sq;
+	int old;
+	/* name of file list */
+	char *listname = NULL;
+	/* packet listing file name */
+	char *dumpname = NULL;
+	/* packet listing */
+	struct pds_dump *dump = NULL;
+	/* flag for packet listing on stdout (no statistics) */
+	int quiet;
+	/* reassemble segmented packets */
+	int segments = 0;
+	/* reassembly, logical packet, counts of APID */
+	struct pds_seg *seg = NULL;
+	struct pds_logical lp;
+	const struct seg_count *sc;
+	/* APID info */
+	struct apid_info *ai;
+	/* counter */
+	int i;
+	/* option character */
+	int c;
 
 
 	/* print version information */
 	fprintf(stderr, "%s V%d.%d ("__DATE__")\n",
 					NAME,	VERSION, REVISION);
 
+	/* get options */
+	while((c = getopt(argc, argv, "t:o:Az:B:c:u:S:Cs:l:dL:p:g")) != -1) {
+		switch(c) {
+		case 't':
+			threads = atoi(optarg);
+			if(threads < 1) {
+				fprintf(stderr, USAGE, argv[0], argv[0], argv[0], argv[0]);
+				return(20);
+			}
+			break;
+		case 'o':
+			outname = optarg;
+			break;
+		case 'c':
+			colname = optarg;
+			break;
+		case 'u':
+			samplename = optarg;
+			break;
+		case 'S':
+			scanname = optarg;
+			break;
+		case 'C':
+			clean = 1;
+			break;
+		case 'd':
+			dupcheck = 1;
+			break;
+		case 'L':
+			listname = optarg;
+			break;
+		case 'p':
+			dumpname = optarg;
+			break;
+		case 'g':
+			segments = 1;
+			break;
+		case 'l':
+			/* levels 0 and 1 as in pds.h, level 2 is full check */
+			verify = atoi(optarg);
+			if((verify < PDS_LEVEL_HEADER) || (verify > 2)) {
+				fprintf(stderr, USAGE, argv[0], argv[0], argv[0], argv[0]);
+				return(20);
+			}
+			if(verify == 2)
+				verify = PDS_LEVEL_FULL;
+			break;
+		case 's':
+			fraction = atof(optarg);
+			if((fraction <= 0) || (fraction > 1)) {
+				fprintf(stderr, USAGE, argv[0], argv[0], argv[0], argv[0]);
+				return(20);
+			}
+			break;
+		case 'A':
+			format = PDS_FMT_ARCHIVE;
+			break;
+		case 'z':
+			level = atoi(optarg);
+			break;
+		case 'B':
+			frame_size = atol(optarg) * 1024L;
+			if(frame_size <= 0) {
+				fprintf(stderr, USAGE, argv[0], argv[0], argv[0], argv[0]);
+				return(20);
+			}
+			break;
+		default:
+			fprintf(stderr, USAGE, argv[0], argv[0], argv[0], argv[0]);
+			return(20);
+		}
+	}
+
+	/* list of files? then scan them */
+	if(listname) {
+		if((argc != optind) || outname || colname || samplename ||
+			 scanname || clean || fraction || dupcheck || dumpname ||
+			 segments) {
+			fprintf(stderr, USAGE, argv[0], argv[0], argv[0], argv[0]);
+			return(20);
+		}
+		return(ListInfo(listname, threads, verify));
+	}
+
 	/* check number of arguments */
-	if(argc != 2) {
-		fprintf(stderr, "USAGE: %s <input>\n", argv[0]);
+	if(argc - optind != 1) {
+		fprintf(stderr, USAGE, argv[0], argv[0], argv[0], argv[0]);
 		return(20);
 	}
 
-	/* allocate memory */
-	if(!(buf_data = malloc(sizeof(unsigned char) * DATA_SIZE))) {
+	/* archive output without output file or clean check with output? */
+	if(((format == PDS_FMT_ARCHIVE) && !outname) ||
+		 ((clean || fraction) &&
+			(outname || colname || samplename || scanname || dumpname)) ||
+		 (clean && fraction) ||
+		 (segments && (clean || fraction)) ||
+		 ((verify < PDS_LEVEL_FULL) &&
+			(outname || colname || samplename || scanname || clean ||
+			 fraction)) ||
+		 (dupcheck &&
+			(clean || fraction || (verify < PDS_LEVEL_SECONDARY)))) {
+		fprintf(stderr, USAGE, argv[0], argv[0], argv[0], argv[0]);
+		return(20);
+	}
+
+	/* allocate memory, reassembly has its own packet buffers */
+	if(segments ? !(seg = SegCreate()) :
+		 !(buf = malloc(sizeof(unsigned char) * PDS_PKT_SIZE))) {
 		fprintf(stderr, "not enough memory\n");
 		return(10);
 	}
 
 	/* open input file */
-	if(!(fin = fopen(argv[1], "rb"))) {
-		fprintf(stderr, "can't open input file (%s)\n", argv[1]);
+	if(!(fin = PDSOpen(argv[optind], threads))) {
+		fprintf(stderr, "can't open input file (%s)\n", argv[optind]);
 		return(10);
 	}
 
-	/* main loop */
-	for(;;) {
-		/* read primary header */
-		if(ReadPriHdr(fin, buf_hdr)) {
-			/* end of file? */
-			if(feof(fin))
-				break;
-			else {
-				fprintf(stderr,
-								"error 1 reading input file (%s): "
-								"file might be corrupted\n",
-								argv[1]);
-				retvalue = 5;
-				break;
-			}
+	/* sampling? then only estimate statistics */
+	if(fraction) {
+		if((retvalue = SampleInfo(fin, fraction)) == 10)
+			fprintf(stderr, "sampling needs a plain PDS file (%s)\n",
+							argv[optind]);
+		PDSClose(fin);
+		free(buf);
+		return(retvalue);
+	}
+
+	/* create output file, zstd compressed if a level is given */
+	if(outname) {
+		if((format == PDS_FMT_PLAIN) && (level > 0))
+			format = PDS_FMT_ZSTD;
+		if(!(fout = PDSCreate(outname, format, level, threads, frame_size))) {
+			fprintf(stderr, "can't create output file (%s)\n", outname);
+			return(10);
 		}
+	}
 
-		/* decode primary header */
-		switch(error = DecodePriHdr(buf_hdr, &hdr)) {
-		case 0:
+	/* create column file */
+	if(colname && !(col = ColCreate(colname))) {
+		fprintf(stderr, "can't create column file (%s)\n", colname);
+		return(10);
+	}
+
+	/* create packet listing */
+	if(dumpname && !(dump = DumpCreate(dumpname, verify))) {
+		fprintf(stderr, "can't create packet listing (%s)\n", dumpname);
+		return(10);
+	}
+
+	/* create scan index, without file for clean check */
+	if((scanname || clean) && !(scan = ScanCreate(scanname))) {
+		if(scanname)
+			fprintf(stderr, "can't create scan index (%s)\n", scanname);
+		else
+			fprintf(stderr, "not enough memory\n");
+		return(10);
+	}
+
+	/* create sample file, samples are unpacked with the checksum */
+	pkt.samples = NULL;
+	if(samplename) {
+		if(!(fsample = fopen(samplename, "wb")) ||
+			 !(pkt.samples = malloc(sizeof(unsigned short) * PDS_MAX_SAMPLES))) {
+			fprintf(stderr, "can't create sample file (%s)\n", samplename);
+			return(10);
+		}
+	}
+
+	/* initialise statistics */
+	StatInit(&stats);
+
+	/* create set of recent packets */
+	if(dupcheck &&
+		 (!(dups = DupCreate(DUP_BITS)) ||
+			!(seq = calloc(DUP_APIDS, sizeof(struct apid_seq))))) {
+		fprintf(stderr, "not enough memory\n");
+		return(10);
+	}
+	for(i = 0; seq && (i < DUP_APIDS); i++)
+		seq[i].last.apid = -1;
+
+	/* archive? then take statistics from block headers */
+	if((PDSFormat(fin) == PDS_FMT_ARCHIVE) && !fout && !col && !fsample &&
+		 !scan && !dups && !dump && !seg) {
+		if(PDSArchiveStats(fin, &stats)) {
+			fprintf(stderr,
+							"error reading archive index (%s): "
+							"file might be corrupted\n",
+							argv[optind]);
+			return(5);
+		}
+	} else for(;;) {
+		/* buffer of reassembly */
+		if(seg && !(buf = SegBuffer(seg))) {
+			fprintf(stderr, "can't allocate memory\n");
+			return(5);
+		}
+
+		/* read next packet */
+		error = PDSReadPacket(fin, buf, &pkt, verify);
+
+		/* end of file? */
+		if(error == 1)
 			break;
-		case -1:
+		if(error == -1) {
+			fprintf(stderr,
+							"error 1 reading input file (%s): "
+							"file might be corrupted\n",
+							argv[optind]);
+			retvalue = 5;
+			break;
+		}
+
+		/* unsupported packet version? */
+		if(pkt.hdr.version != 0) {
+			if(clean) {
+				dirty = 1;
+				break;
+			}
 			fprintf(stderr,
 							"unsupported packet version (%d): "
 							"file might be corrupted, trying to resyncronise\n",
-							hdr.version);
-
-			/* read data block */
-			if(fread(buf_data, hdr.pkt_length + 1, 1, fin) != 1) {
+							pkt.hdr.version);
+			if(error == -4) {
+				fprintf(stderr,
+								"buffer overflow, please contact developer\n");
+				return(20);
+			}
+			if(error == -3) {
 				fprintf(stderr,
 								"error 2 reading input file (%s): "
 								"file might be corrupted\n",
-								argv[1]);
+								argv[optind]);
 				retvalue = 5;
 				break;
 			}
-			continue;
-		default:
-			fprintf(stderr,
-							"unknown error (%d) while decoding primary header\n",
-							error);
-			return(5);
-		}
 
-		/* do we have a current APID Info object? */
-		if(apidinfo != NULL) {
-			/* APID different as of current APID Info object? */
-			if(apidinfo->apid != hdr.apid) {
-				/* find APID Info object */
-				if(!(apidinfo = FindAPIDInfo(apidlist, hdr.apid))) {
-					/* allocate an APID Info object */
-					if(!(apidinfo = AllocAPIDInfo(hdr.apid))) {
-						fprintf(stderr, "can't allocate memory\n");
-						return(5);
-					}
-
-					/* add APID Info object to list */
-					AddAPIDInfo(&apidlist, apidinfo);
-				}
+			/* copy to output file, it's not counted */
+			if(fout) {
+				PDSMark(fout, &pkt.info);
+				PDSWrite(fout, buf, pkt.size);
 			}
-		} else {
-			/* allocate an APID Info object */
-			if(!(apidinfo = AllocAPIDInfo(hdr.apid))) {
+			if(col && ColAdd(col, offset, &pkt)) {
 				fprintf(stderr, "can't allocate memory\n");
 				return(5);
 			}
-			
-			/* add APID Info object to list */
-			AddAPIDInfo(&apidlist, apidinfo);
+			if(scan && ScanAdd(scan, offset, &pkt)) {
+				fprintf(stderr, "error writing scan index (%s)\n", scanname);
+				return(5);
+			}
+			if(dump && DumpAdd(dump, offset, &pkt)) {
+				fprintf(stderr, "error writing packet listing (%s)\n", dumpname);
+				return(5);
+			}
+			if(seg && (SegAdd(seg, buf, &pkt, offset, &lp) < 0)) {
+				fprintf(stderr, "can't allocate memory\n");
+				return(5);
+			}
+			offset += pkt.size;
+			continue;
 		}
 
-		/* increase packet counter */
-		apidinfo->count = apidinfo->count + 1;
+		/* duplicate of a recent packet or not after the last packet of
+			 the sequence of its APID (time, then packet count) without
+			 continuing its packet count? then it's counted, but not part
+			 of the packet sequence */
+		dup = 0;
+		old = 0;
+		sq = seq ? seq + pkt.hdr.apid : NULL;
+		if(dups && pkt.decoder) {
+			dup = DupTest(dups, pkt.hdr.apid, pkt.info.days,
+										pkt.info.millisec, pkt.info.microsec,
+										pkt.hdr.pkt_count);
+			old = pkt.info.valid && (sq->last.apid == pkt.hdr.apid) &&
+				(JoinCompare(&pkt.info, &(sq->last)) <= 0) &&
+				(pkt.hdr.pkt_count != (sq->ai->last_pkt_count + 1) % 16384);
+
+			/* only packets of the sequence are added, times of invalid
+				 packets can't be trusted */
+			if(!dup && !old) {
+				DupAdd(dups, pkt.hdr.apid, pkt.info.days, pkt.info.millisec,
+							 pkt.info.microsec, pkt.hdr.pkt_count);
+				if(pkt.info.valid)
+					sq->last = pkt.info;
+			}
+
+			/* end of run of duplicates */
+			if(!dup && sq->dup)
+				sq->dup->run = 0;
+		}
+		if(dup && !(sq->dup = AddDuplicate(&duplist, sq->dup, &pkt))) {
+			fprintf(stderr, "can't allocate memory\n");
+			return(5);
+		}
+		if(dup || old) {
+			sq->ai->count++;
+			missing = 0;
+		}
 
-		/* check if there are missing packets */
-		/* first packet with this APID? */
-		if(apidinfo->last_pkt_count != -1) {
-			/* calculate number of missing packets */
-			missing =
-				(hdr.pkt_count > apidinfo->last_pkt_count)?
-				(hdr.pkt_count - apidinfo->last_pkt_count - 1):
-				(hdr.pkt_count - apidinfo->last_pkt_count + 16383);
+		/* count packet and check if there are missing packets */
+		else if((missing = StatAddPacket(&stats, pkt.hdr.apid,
+																		 pkt.hdr.pkt_count)) < 0) {
+			fprintf(stderr, "can't allocate memory\n");
+			return(5);
+		}
 
-			/* duplicated packet? */
-			if(missing == 16383)
-				fprintf(stderr, "duplicated packet!!!\n");
+		/* statistics of APID for the next packets */
+		else if(sq)
+			sq->ai = stats.apidinfo;
 
-			/* add to counter for missing packets */
-			apidinfo->missing += missing;
+		/* looking for duplicates? then jumps back aren't missing */
+		if(dups && (missing >= 8192)) {
+			stats.apidinfo->missing -= missing;
+			missing = 0;
 		}
 
-		/* store packet count */
-		apidinfo->last_pkt_count = hdr.pkt_count;
+		/* duplicated packet? */
+		if(missing == 16383)
+			fprintf(stderr, "duplicated packet!!!\n");
 
-		/* read data block */
-		if(hdr.pkt_length + 1 > DATA_SIZE) {
+		/* packet too long or data not read? */
+		if(error == -4) {
 			fprintf(stderr,
 							"buffer overflow (%d), "
 							"please contact developer\n",
-							hdr.pkt_length);
+							pkt.hdr.pkt_length);
 			return(20);
 		}
-		if(fread(buf_data, hdr.pkt_length + 1, 1, fin) != 1) {
+		if(error == -3) {
 			fprintf(stderr,
 							"error 3 reading input file (%s): "
 							"file might be corrupted\n",
-							argv[1]);
+							argv[optind]);
 			retvalue = 5;
 			break;
 		}
 
 		/* is it a MODIS packet? */
-		if((hdr.apid >= 64) && (hdr.apid <=127)) {
-			/* decode MODIS header */
-			DecodeMODISHdr(buf_data, hdr.pkt_length + 1, &mhdr);
-
+		if(pkt.info.modis) {
 			/* duplicated packet? */
 			if(missing == 16383) {
 				fprintf(stderr, "duplicated MODIS packet: %d/%d %ld/%ld %d/%d %d/%d\n",
-								mhdr.days, lastdays,
-								mhdr.millisec, lastmillisec,
-								mhdr.microsec, lastmicrosec,
-								mhdr.src2, lastsrc);
+								pkt.mhdr.days, lastdays,
+								pkt.mhdr.millisec, lastmillisec,
+								pkt.mhdr.microsec, lastmicrosec,
+								pkt.mhdr.src2, lastsrc);
 			}
-			lastdays = mhdr.days;
-			lastmillisec = mhdr.millisec;
-			lastmicrosec = mhdr.microsec;
-			lastsrc = mhdr.src2;
-
-			/* calculate checksum */
-			chksum = CalcChecksum12(&(buf_data[MODIS_HDR_SIZE]),
-															(hdr.pkt_length + 1 - MODIS_HDR_SIZE) /
-															1.5 - 1);
-
-			/* valid packet? */
-			if(chksum != mhdr.checksum) {
-				/* increase invalid packet counter */
-				apidinfo->invalid = apidinfo->invalid + 1;
+			lastdays = pkt.mhdr.days;
+			lastmillisec = pkt.mhdr.millisec;
+			lastmicrosec = pkt.mhdr.microsec;
+			lastsrc = pkt.mhdr.src2;
+
+			/* add to statistics */
+			if(!dup && !old)
+				StatAddMODIS(&stats, &pkt.info);
+
+			/* write samples */
+			if(fsample && PDSWriteSamples(fsample, &pkt)) {
+				fprintf(stderr, "error writing sample file (%s)\n", samplename);
+				return(5);
 			}
+		}
 
-			/* determine first and last packet date/time */
-			if(mhdr.days < firstday) {
-				firstday = mhdr.days;
-				firstms = mhdr.millisec;
-				firstmics = mhdr.microsec;
-			} else {
-				if(mhdr.days == firstday) {
-					if(mhdr.millisec < firstms) {
-						firstday = mhdr.days;
-						firstms = mhdr.millisec;
-						firstmics = mhdr.microsec;
-					} else {
-						if(mhdr.millisec == firstms) {
-							if(mhdr.microsec < firstmics) {
-								firstday = mhdr.days;
-								firstms = mhdr.millisec;
-								firstmics = mhdr.microsec;
-							}
-						}
-					}
-				}
-			}
-			if(mhdr.days > lastday) {
-				lastday = mhdr.days;
-				lastms = mhdr.millisec;
-				lastmics = mhdr.microsec;
-			} else {
-				if(mhdr.days == lastday) {
-					if(mhdr.millisec > lastms) {
-						lastday = mhdr.days;
-						lastms = mhdr.millisec;
-						lastmics = mhdr.microsec;
-					} else {
-						if(mhdr.millisec == lastms) {
-							if(mhdr.microsec > lastmics) {
-								lastday = mhdr.days;
-								lastms = mhdr.millisec;
-								lastmics = mhdr.microsec;
-							}
-						}
-					}
-				}
-			}
+		/* copy to output file */
+		if(fout) {
+			PDSMark(fout, &pkt.info);
+			PDSWrite(fout, buf, pkt.size);
+		}
 
-			/* check if there are missing seconds */
-			if(prevday != 0) {
-				diffms =
-					mhdr.millisec - prevms +
-					(mhdr.days - prevday) * 86400000;
-				missingsecs += diffms / 1000;
-			}
-			prevday = mhdr.days;
-			prevms = mhdr.millisec;
-			prevmics = mhdr.microsec;
-
-			/* earth view packet? */
-			if(mhdr.src1 == 0) {
-				/* increase packet type counters? */
-				switch(mhdr.pkt_type) {
-				case 0:
-					daypkts1++;
-					break;
-				case 1:
-					nightpkts1++;
-					break;
-				case 2:
-				case 4:
-					engpkts1++;
-					break;
-				}
-			} else {
-				/* increase packet type counters? */
-				switch(mhdr.pkt_type) {
-				case 0:
-					daypkts2++;
-					break;
-				case 1:
-					nightpkts2++;
-					break;
-				case 2:
-				case 4:
-					engpkts2++;
-					break;
-				}
-			}
+		/* add to columns */
+		if(col && ColAdd(col, offset, &pkt)) {
+			fprintf(stderr, "can't allocate memory\n");
+			return(5);
 		}
+
+		/* add to scan index */
+		if(scan && ScanAdd(scan, offset, &pkt)) {
+			fprintf(stderr, "error writing scan index (%s)\n", scanname);
+			return(5);
+		}
+
+		/* add to packet listing */
+		if(dump && DumpAdd(dump, offset, &pkt)) {
+			fprintf(stderr, "error writing packet listing (%s)\n", dumpname);
+			return(5);
+		}
+
+		/* reassemble segmented packets */
+		if(seg && (SegAdd(seg, buf, &pkt, offset, &lp) < 0)) {
+			fprintf(stderr, "can't allocate memory\n");
+			return(5);
+		}
+		offset += pkt.size;
+
+		/* clean check and incomplete scan? then we are done */
+		if(clean && ScanPartial(scan)) {
+			dirty = 1;
+			break;
+		}
+	}
+
+	/* write column file */
+	if(col && ColFinish(col)) {
+		fprintf(stderr, "error writing column file (%s)\n", colname);
+		retvalue = 5;
+	}
+
+	/* orphan segments of packets still open */
+	if(seg)
+		SegEnd(seg);
+
+	/* write packet listing */
+	if(dump && DumpFinish(dump)) {
+		fprintf(stderr, "error writing packet listing (%s)\n", dumpname);
+		retvalue = 5;
+	}
+
+	/* write scan index */
+	if(scan && ScanFinish(scan, &complete, &partial)) {
+		fprintf(stderr, "error writing scan index (%s)\n", scanname);
+		retvalue = 5;
+		scanname = NULL;
+	}
+
+	/* clean check? then only report result */
+	if(clean) {
+		if(!retvalue) {
+			dirty = dirty || partial || !complete;
+			printf("%s\n", dirty ? "not clean" : "clean");
+			retvalue = dirty;
+		}
+		StatFree(&stats);
+		PDSClose(fin);
+		free(buf);
+		return(retvalue);
+	}
+
+	/* close sample file */
+	if(fsample && fclose(fsample)) {
+		fprintf(stderr, "error writing sample file (%s)\n", samplename);
+		retvalue = 5;
 	}
 
 	/* have we read any valid packets? */
-	if(apidinfo == NULL) {
+	if(stats.apidlist == NULL) {
 		fprintf(stderr, "no valid packets found\n");
 		return(5);
 	}	
 
+	/* packet listing on stdout? then no statistics */
+	quiet = dumpname && !strcmp(dumpname, "-");
+
 	/* print APID statistics */
-	for(apidinfo = apidlist;
-			apidinfo != NULL;
-			apidinfo = apidinfo->next) {
-		printf("APID %d: count %ld invalid %ld missing %ld\n",
-					 apidinfo->apid,
-					 apidinfo->count,
-					 apidinfo->invalid,
-					 apidinfo->missing);
+	if(!quiet)
+		PrintAPIDs(&stats, verify);
+
+	/* print reassembled packets and orphaned segments */
+	for(ai = stats.apidlist; seg && !quiet && ai; ai = ai->next) {
+		if((sc = SegCount(seg, ai->apid)) && (sc->segments || sc->orphans))
+			printf("APID %d: segmented packets %ld (%ld segments) "
+						 "orphaned segments %ld\n",
+						 ai->apid, sc->packets, sc->segments, sc->orphans);
 	}
 
-	/* print first and last packet date/time */
-	jul = firstday + MODIS_REF_DATE;
-	caldat(&minute, &hour, &day, &month, &year, jul);
-	hour = firstms / (1000L * 60L * 60L);
-	ms = firstms - hour * 1000L * 60L * 60L;
-	minute = ms / (1000L * 60L);
-	ms = ms - minute * 1000L * 60L;
-	second = ms / 1000L;
-	ms = ms - second * 1000L;
-	printf("first packet: %04d/%02d/%02d %02d:%02d:%d.%03d%03d\n",
-				 year, month, day, hour, minute, second, ms, firstmics);
-	jul = lastday + MODIS_REF_DATE;
-	caldat(&minute, &hour, &day, &month, &year, jul);
-	hour = lastms / (1000L * 60L * 60L);
-	ms = lastms - hour * 1000L * 60L * 60L;
-	minute = ms / (1000L * 60L);
-	ms = ms - minute * 1000L * 60L;
-	second = ms / 1000L;
-	ms = ms - second * 1000L;
-	printf("last packet: %04d/%02d/%02d %02d:%02d:%d.%03d%03d\n",
-				 year, month, day, hour, minute, second, ms, lastmics);
-
-	/* print number of missing secs */
-	printf("missing seconds: %ld\n", missingsecs);
-
-	/* print number of day packets */
-	printf("day packets: %ld/%ld\n", daypkts1, daypkts2);
-
-	/* print number of night packets */
-	printf("night packets: %ld/%ld\n", nightpkts1, nightpkts2);
+	/* print duplicates */
+	for(da = duplist; da && !quiet; da = da->next) {
+		printf("APID %d: duplicates %ld in %ld runs\n", da->apid, da->count,
+					 da->runs);
+		PrintTime("first duplicate", da->firstday, da->firstms,
+							da->firstmics);
+		PrintTime("last duplicate", da->lastday, da->lastms, da->lastmics);
+	}
 
-	/* print number of engineering packets */
-	printf("engineering packets: %ld/%ld\n", engpkts1, engpkts2);
+	/* secondary headers decoded? then print MODIS statistics */
+	if((verify >= PDS_LEVEL_SECONDARY) && !quiet)
+		PrintMODIS(&stats);
+
+	/* print number of complete and partial scans */
+	if(scanname && !quiet)
+		printf("scans: complete %ld partial %ld\n", complete, partial);
+
+	/* free statistics */
+	StatFree(&stats);
+	DupFree(dups);
+	free(seq);
+	while(duplist) {
+		da = duplist->next;
+		free(duplist);
+		duplist = da;
+	}
 
-	/* free APID Info list */
-	FreeAPIDInfoList(apidlist);
+	/* close output file */
+	if(fout && PDSFinish(fout)) {
+		fprintf(stderr, "error writing output file (%s)\n", outname);
+		retvalue = 5;
+	}
 
 	/* close input file */
-	fclose(fin);
+	PDSClose(fin);
 
-	/* free memory */
-	free(buf_data);
+	/* free memory, buffers of reassembly with it */
+	if(seg)
+		SegFree(seg);
+	else
+		free(buf);
 
 	/* Ja das war's. Der Pop-Shop ist zu Ende */
   return(retvalue);
@@ -509,61 +826,190 @@ int main(int argc, char *argv[])
 
 /********************************************************************
  *                                                                  *
- *  read primary header from file                                   *
- *                                                                  *
- *  f:   file pointer                                               *
- *  buf: pointer to buffer                                          *
+ *  estimate statistics from evenly spaced blocks of plain file     *
  *                                                                  *
- *  result:  0 - ok                                                 *
- *          -1 - read error                                         *
+ *  The first and the last block are always read, so the time of    *
+ *  the first and last packet is exact. In each block reading       *
+ *  starts at the first packet boundary (see FindSync()) and ends   *
+ *  with the packet overlapping the end of the block. Packet counts *
+ *  are extrapolated from the packets per byte of the blocks,       *
+ *  invalid and missing packets are estimated as ratios over the    *
+ *  sampled blocks, each with 95% confidence bounds from the        *
+ *  variance between blocks.                                        *
  *                                                                  *
- ********************************************************************/
-int ReadPriHdr(FILE *f, unsigned char *buf) {
-	/* read header */
-	if(fread(buf, PRI_HDR_SIZE, 1, f) != 1)
-		return(-1);
-
-	/* ois rodger */
-	return(0);
-}
-
-
-/********************************************************************
- *                                                                  *
- *  decode primary header                                           *
- *                                                                  *
- *  buf: pointer to buffer                                          *
- *  hdr: pointer to header structure                                *
+ *  f:        pointer to PDS file                                   *
+ *  fraction: fraction of file to read                              *
  *                                                                  *
  *  result:  0 - ok                                                 *
- *          -1 - decode error (version not supported)               *
+ *           5 - no valid packets found                             *
+ *          10 - not a plain file or not enough memory              *
  *                                                                  *
  ********************************************************************/
-int DecodePriHdr(unsigned char *buf, struct pri_hdr *hdr) {
-	/* version */
-	hdr->version = (buf[0] & 0xE0) >> 5;
+int SampleInfo(struct pds_file *f, double fraction) {
+	/* size of file, start of block */
+	long long size, start;
+	/* number of blocks in file and sampled, block, counter */
+	long nblocks, nsampled, block, j;
+	/* buffers of block and packet */
+	unsigned char *buf, *pktbuf;
+	/* bytes of block, bytes read, packet boundary */
+	long len, n, sync;
+	/* position in file */
+	long long pos;
+	/* decoded packet */
+	struct pds_packet pkt;
+	/* statistics of block */
+	struct pds_stats bs;
+	struct apid_info *ai;
+	/* estimates of APIDs */
+	struct sample_apid *list = NULL, *sa, **next;
+	/* number of missing packets */
+	long missing;
+	/* first and last packet date/time */
+	long firstday = 0, firstms = 0, firstmics = 0;
+	long lastday = 0, lastms = 0, lastmics = 0;
+	/* sum of bytes of sampled blocks and of their squares */
+	double sl = 0, sll = 0;
+	/* finite population correction, ratio, standard error */
+	double fpc, r, se;
+
+
+	/* plain file? */
+	if((size = PDSSize(f)) < 0)
+		return(10);
 
-	/* version supported? */
-	if(hdr->version != 0)
-		return(-1);
+	/* number of blocks */
+	nblocks = (size + SAMPLE_BLOCK - 1) / SAMPLE_BLOCK;
+	nsampled = ceil(fraction * nblocks);
+	if(nsampled < 2)
+		nsampled = 2;
+	if(nsampled > nblocks)
+		nsampled = nblocks;
+
+	/* allocate memory */
+	if(!(buf = malloc(SAMPLE_BLOCK + SAMPLE_EXTRA)) ||
+		 !(pktbuf = malloc(PDS_PKT_SIZE)))
+		return(10);
+	pkt.samples = NULL;
+
+	/* for each sampled block */
+	for(j = 0; j < nsampled; j++) {
+		/* block, first and last of file included */
+		block = (nsampled > 1) ?
+			(j * (nblocks - 1) + (nsampled - 1) / 2) / (nsampled - 1) : 0;
+		start = (long long)block * SAMPLE_BLOCK;
+		len = (size - start < SAMPLE_BLOCK) ? size - start : SAMPLE_BLOCK;
+
+		/* read block and find first packet boundary */
+		n = (size - start < SAMPLE_BLOCK + SAMPLE_EXTRA) ?
+			size - start : SAMPLE_BLOCK + SAMPLE_EXTRA;
+		if(PDSSeek(f, start) || PDSRead(f, buf, n))
+			continue;
+		sl += len;
+		sll += (double)len * len;
+		if((sync = FindSync(buf, n, len, start + n == size)) < 0)
+			continue;
 
-	/* type */
-	hdr->type = (buf[0] & 0x10) >> 4;
+		/* read packets starting in block */
+		StatInit(&bs);
+		PDSSeek(f, start + sync);
+		for(pos = start + sync; pos < start + len; pos += pkt.size) {
+			if(PDSNextPacket(f, pktbuf, &pkt))
+				break;
+			if(!pkt.decoder)
+				continue;
+			if((missing = StatAddPacket(&bs, pkt.hdr.apid,
+																	pkt.hdr.pkt_count)) < 0)
+				return(10);
+
+			/* duplicates and packets out of order aren't missing */
+			if(missing >= 8192)
+				bs.apidinfo->missing -= missing;
+			if(pkt.info.modis)
+				StatAddMODIS(&bs, &pkt.info);
+		}
 
-	/* secondary header flag */
-	hdr->sec_hdr_flag = (buf[0] & 0x08) >> 3;
+		/* exact first and last packet date/time */
+		if((j == 0) && bs.firstday) {
+			firstday = bs.firstday;
+			firstms = bs.firstms;
+			firstmics = bs.firstmics;
+		}
+		if((j == nsampled - 1) && bs.lastday) {
+			lastday = bs.lastday;
+			lastms = bs.lastms;
+			lastmics = bs.lastmics;
+		}
 
-	/* APID */
-	hdr->apid = (((int)(buf[0] & 0x07)) << 8) + buf[1];
+		/* add counts of block to sums of APIDs */
+		for(ai = bs.apidlist; ai; ai = ai->next) {
+			for(next = &list; *next && ((*next)->apid < ai->apid);
+					next = &((*next)->next));
+			if(!*next || ((*next)->apid != ai->apid)) {
+				if(!(sa = calloc(1, sizeof(struct sample_apid))))
+					return(10);
+				sa->apid = ai->apid;
+				sa->next = *next;
+				*next = sa;
+			}
+			sa = *next;
+			sa->x += ai->count;
+			sa->y += ai->invalid;
+			sa->z += ai->missing;
+			sa->xx += (double)ai->count * ai->count;
+			sa->yy += (double)ai->invalid * ai->invalid;
+			sa->zz += (double)ai->missing * ai->missing;
+			sa->xy += (double)ai->count * ai->invalid;
+			sa->xz += (double)ai->count * ai->missing;
+			sa->xl += (double)ai->count * len;
+		}
+		StatFree(&bs);
+	}
+	free(buf);
+	free(pktbuf);
 
-	/* sequence flags */
-	hdr->seq_flags = (buf[2] & 0xC0) >> 6;
+	/* have we found any valid packets? */
+	if(!list) {
+		fprintf(stderr, "no valid packets found\n");
+		return(5);
+	}
 
-	/* packet count per APID */
-	hdr->pkt_count = (((int)(buf[2] & 0x3F)) << 8) + buf[3];
+	/* print estimates of APIDs */
+	printf("sampled blocks: %ld of %ld\n", nsampled, nblocks);
+	fpc = 1.0 - (double)nsampled / nblocks;
+	for(sa = list; sa; sa = list) {
+		/* packets, from packets per byte */
+		r = sa->x / sl;
+		se = (nsampled > 1) ?
+			size * sqrt(fpc * fabs(sa->xx - 2 * r * sa->xl + r * r * sll) /
+									nsampled / (nsampled - 1)) / (sl / nsampled) : 0;
+		printf("APID %d: count %.0f +- %.0f", sa->apid, r * size,
+					 SAMPLE_Z * se);
+
+		/* invalid packets */
+		r = sa->y / sa->x;
+		se = (nsampled > 1) ?
+			sqrt(fpc * fabs(sa->yy - 2 * r * sa->xy + r * r * sa->xx) /
+					 nsampled / (nsampled - 1)) / (sa->x / nsampled) : 0;
+		printf(" invalid %.3f%% +- %.3f%%", 100 * r, 100 * SAMPLE_Z * se);
+
+		/* missing packets, relative to expected packets */
+		r = sa->z / (sa->x + sa->z);
+		se = (nsampled > 1) ?
+			sqrt(fpc *
+					 fabs(sa->zz - 2 * r * (sa->xz + sa->zz) +
+								r * r * (sa->xx + 2 * sa->xz + sa->zz)) /
+					 nsampled / (nsampled - 1)) /
+			((sa->x + sa->z) / nsampled) : 0;
+		printf(" missing %.3f%% +- %.3f%%\n", 100 * r, 100 * SAMPLE_Z * se);
+
+		list = sa->next;
+		free(sa);
+	}
 
-	/* packet length (length - 1) */
-	hdr->pkt_length = (((int)buf[4]) << 8) + buf[5];
+	/* print first and last packet date/time */
+	PrintTime("first packet", firstday, firstms, firstmics);
+	PrintTime("last packet", lastday, lastms, lastmics);
 
 	/* okeydokey */
 	return(0);
@@ -572,323 +1018,540 @@ int DecodePriHdr(unsigned char *buf, struct pri_hdr *hdr) {
 
 /********************************************************************
  *                                                                  *
- *  allocate and initialise APID Info object                        *
+ *  find first packet boundary in block                             *
  *                                                                  *
- *  apid: APID                                                      *
+ *  A packet boundary is a position followed by SAMPLE_SYNC packet  *
+ *  headers of version 0 and of APIDs with decoder, each starting   *
+ *  where the previous packet ends, or by fewer up to the end of    *
+ *  the file.                                                       *
  *                                                                  *
- *  result:  pointer to APID Info object                            *
- *           0 - error                                              *
+ *  buf: pointer to data of block                                   *
+ *  n:   number of bytes in buffer                                  *
+ *  len: number of bytes of block (packet has to start there)       *
+ *  eof: buffer ends at end of file                                 *
+ *                                                                  *
+ *  result: offset of packet boundary in block                      *
+ *          -1 - no packet boundary found                           *
  *                                                                  *
  ********************************************************************/
-struct apid_info *AllocAPIDInfo(int apid) {
-	/* pointer to APID Info object */
-	struct apid_info *ai;
-
+long FindSync(unsigned char *buf, long n, long len, int eof) {
+	/* candidate, position of packet header */
+	long p, q;
+	/* counter */
+	int i;
+	/* primary header */
+	struct pri_hdr hdr;
 
-	/* allocate memory for object */
-	if(!(ai = malloc(sizeof(struct apid_info))))
-		return(0);
 
-	/* store APID */
-	ai->apid = apid;
+	for(p = 0; p < len; p++) {
+		for(i = 0, q = p; (i < SAMPLE_SYNC) && (q + PRI_HDR_SIZE <= n); i++) {
+			if(DecodePriHdr(&(buf[q]), &hdr) || !PDSDecoder(hdr.apid))
+				break;
+			q += PRI_HDR_SIZE + hdr.pkt_length + 1;
+		}
+		if((i == SAMPLE_SYNC) || (eof && i && (q == n)))
+			return(p);
+	}
 
-	/* initialise packet counter */
-	ai->count = 0;
+	/* nix */
+	return(-1);
+}
 
-	/* initialise invalid packet counter */
-	ai->invalid = 0;
 
-	/* initialise missing packet counter */
-	ai->missing = 0;
+/********************************************************************
+ *                                                                  *
+ *  print packet date/time                                          *
+ *                                                                  *
+ *  label: label of line                                            *
+ *  day:   days since 01/01/1958                                    *
+ *  ms:    milliseconds of day                                      *
+ *  mics:  microseconds of millisecond                              *
+ *                                                                  *
+ *  result: none                                                    *
+ *                                                                  *
+ ********************************************************************/
+void PrintTime(char *label, long day, long ms, long mics) {
+	/* date buffer */
+	int second, minute, hour, dd, month, year;
 
-	/* initialise last packet count value */
-	ai->last_pkt_count = -1;
 
-	/* initialise pointer to next object */
-	ai->next = NULL;
+	/* date */
+	PDSCivilDate(day, &year, &month, &dd);
 
-	/* all done */
-	return(ai);
+	/* time */
+	hour = ms / (1000L * 60L * 60L);
+	ms = ms - hour * 1000L * 60L * 60L;
+	minute = ms / (1000L * 60L);
+	ms = ms - minute * 1000L * 60L;
+	second = ms / 1000L;
+	ms = ms - second * 1000L;
+	printf("%s: %04d/%02d/%02d %02d:%02d:%d.%03d%03d\n",
+				 label, year, month, dd, hour, minute, second, (int)ms, (int)mics);
 }
 
 
 /********************************************************************
  *                                                                  *
- *  add APID Info object to list                                    *
+ *  count duplicated packet                                         *
  *                                                                  *
- *  list: pointer to pointer to first object in list                *
- *  ai:   pointer to APID Info object to be added                   *
+ *  list: pointer to list of duplicates of APIDs                    *
+ *  da:   pointer to duplicates of APID (NULL = first duplicate,    *
+ *        added at end of list)                                     *
+ *  pkt:  pointer to duplicated packet                              *
  *                                                                  *
- *  result:  none                                                   *
+ *  result: pointer to duplicates of APID                           *
+ *          NULL - out of memory                                    *
  *                                                                  *
  ********************************************************************/
-void AddAPIDInfo(struct apid_info **list, struct apid_info *ai) {
-	/* pointer to APID Info object */
-	struct apid_info *p;
+struct dup_apid *AddDuplicate(struct dup_apid **list, struct dup_apid *da,
+															struct pds_packet *pkt) {
+	/* first duplicate of APID? then add at end of list */
+	if(!da) {
+		for(; *list; list = &((*list)->next));
+		if(!(da = *list = calloc(1, sizeof(struct dup_apid))))
+			return(NULL);
+		da->apid = pkt->hdr.apid;
+		da->firstday = pkt->info.days;
+		da->firstms = pkt->info.millisec;
+		da->firstmics = pkt->info.microsec;
+	}
 
+	/* count, new run? */
+	da->count++;
+	if(!da->run)
+		da->runs++;
+	da->run = 1;
+	da->lastday = pkt->info.days;
+	da->lastms = pkt->info.millisec;
+	da->lastmics = pkt->info.microsec;
+
+	/* gut */
+	return(da);
+}
 
-	/* empty list? */
-	if(*list == NULL) {
-		/* add object as first in list */
-		*list = ai;
 
-		/* ciao */
-		return;
-	}
+/********************************************************************
+ *                                                                  *
+ *  print statistics of APIDs                                       *
+ *                                                                  *
+ *  Invalid packets are only printed when the packets were checked. *
+ *                                                                  *
+ *  s:      pointer to statistics                                   *
+ *  verify: verification level                                      *
+ *                                                                  *
+ *  result: none                                                    *
+ *                                                                  *
+ ********************************************************************/
+void PrintAPIDs(struct pds_stats *s, int verify) {
+	/* pointer to current APID Info object */
+	struct apid_info *apidinfo;
 
-	/* first object? */
-	if((*list)->apid > ai->apid) {
-		/* add object as first in list */
-		ai->next = *list;
-		*list = ai;
 
-		/* Tschuess */
-		return;
+	for(apidinfo = s->apidlist;
+			apidinfo != NULL;
+			apidinfo = apidinfo->next) {
+		if(verify == PDS_LEVEL_FULL)
+			printf("APID %d: count %ld invalid %ld missing %ld\n",
+						 apidinfo->apid,
+						 apidinfo->count,
+						 apidinfo->invalid,
+						 apidinfo->missing);
+		else
+			printf("APID %d: count %ld missing %ld\n",
+						 apidinfo->apid,
+						 apidinfo->count,
+						 apidinfo->missing);
 	}
+}
 
-	/* find right place in list */
-	for(p = *list; p->next != NULL; p = p->next) {
-		/* reached right position */
-		if(p->next->apid > ai->apid) {
-			/* add object to list */
-			ai->next = p->next;
-			p->next = ai;
 
-			/* all good */
-			return;
-		}
-	}
+/********************************************************************
+ *                                                                  *
+ *  print statistics of MODIS packets                               *
+ *                                                                  *
+ *  s: pointer to statistics                                        *
+ *                                                                  *
+ *  result: none                                                    *
+ *                                                                  *
+ ********************************************************************/
+void PrintMODIS(struct pds_stats *s) {
+	/* print first and last packet date/time */
+	PrintTime("first packet", s->firstday, s->firstms, s->firstmics);
+	PrintTime("last packet", s->lastday, s->lastms, s->lastmics);
+
+	/* print number of missing secs */
+	printf("missing seconds: %ld\n", s->missingsecs);
 
-	/* add object as last in list */
-	p->next = ai;
-	
-	/* hasta la vista*/
-	return;
+	/* print number of day packets */
+	printf("day packets: %ld/%ld\n", s->daypkts1, s->daypkts2);
+
+	/* print number of night packets */
+	printf("night packets: %ld/%ld\n", s->nightpkts1, s->nightpkts2);
+
+	/* print number of engineering packets */
+	printf("engineering packets: %ld/%ld\n", s->engpkts1, s->engpkts2);
 }
 
 
 /********************************************************************
  *                                                                  *
- *  free memory in APID list                                        *
+ *  scan list of files                                              *
  *                                                                  *
- *  list: pointer to first object in list                           *
+ *  The files named in the list (one per line, "-" = stdin) are     *
+ *  read by a reader with LIST_FILES files in flight and decoded by *
+ *  a pool of threads. For each file its name and the statistics a  *
+ *  single run with the same verification level would print are     *
+ *  printed as soon as the file is done, so files come out in the   *
+ *  order they complete. Compressed files and archives are read     *
+ *  through PDSOpen() instead.                                      *
  *                                                                  *
- *  result:  none                                                   *
+ *  listname: name of file list                                     *
+ *  threads:  number of threads                                     *
+ *  verify:   verification level                                    *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *           5 - error in a file                                    *
+ *          10 - can't read list or not enough memory               *
  *                                                                  *
  ********************************************************************/
-void FreeAPIDInfoList(struct apid_info *list) {
-	/* pointers to APID Info objects */
-	struct apid_info *p1, *p2;
-
+int ListInfo(char *listname, int threads, int verify) {
+	/* file list */
+	FILE *f;
+	/* line of list */
+	char line[LIST_NAME_SIZE];
+	/* file names, number and allocated number of names */
+	char **names = NULL, **p;
+	int n = 0, cap = 0;
+	/* list scan */
+	struct list_scan l;
+	/* threads */
+	pthread_t *tid;
+	/* counter */
+	int i;
+	/* length of name */
+	size_t len;
 
-	/* go through list */
-	for(p1 = list; p1 != NULL; p1 = p2) {
-		/* get pointer to next object */
-		p2 = p1->next;
 
-		/* free memory of current object */
-		free(p1);
+	/* read list */
+	if(!(f = strcmp(listname, "-") ? fopen(listname, "r") : stdin)) {
+		fprintf(stderr, "can't open file list (%s)\n", listname);
+		return(10);
+	}
+	while(fgets(line, LIST_NAME_SIZE, f)) {
+		len = strlen(line);
+		while(len && ((line[len - 1] == '\n') || (line[len - 1] == '\r')))
+			line[--len] = 0;
+		if(!len)
+			continue;
+		if(n == cap) {
+			cap = cap ? 2 * cap : 1024;
+			if(!(p = realloc(names, cap * sizeof(char *)))) {
+				fprintf(stderr, "not enough memory\n");
+				return(10);
+			}
+			names = p;
+		}
+		if(!(names[n++] = strdup(line))) {
+			fprintf(stderr, "not enough memory\n");
+			return(10);
+		}
 	}
+	if(f != stdin)
+		fclose(f);
+
+	/* set up scan */
+	l.names = names;
+	l.verify = verify;
+	l.retvalue = 0;
+	pthread_mutex_init(&(l.lock), NULL);
+	if(!(l.files = calloc(n ? n : 1, sizeof(struct list_file))) ||
+		 !(tid = malloc(threads * sizeof(pthread_t))) ||
+		 !(l.reader = ReaderCreate(names, n, LIST_FILES, LIST_CHUNK))) {
+		fprintf(stderr, "not enough memory\n");
+		return(10);
+	}
+	for(i = 0; i < n; i++)
+		StatInit(&(l.files[i].stats));
+
+	/* run threads, the first one is us */
+	for(i = 1; i < threads; i++)
+		if(pthread_create(&(tid[i]), NULL, ListWorker, &l))
+			break;
+	threads = i;
+	ListWorker(&l);
+	for(i = 1; i < threads; i++)
+		pthread_join(tid[i], NULL);
+
+	/* free memory */
+	ReaderFree(l.reader);
+	pthread_mutex_destroy(&(l.lock));
+	for(i = 0; i < n; i++)
+		free(names[i]);
+	free(names);
+	free(l.files);
+	free(tid);
+
+	/* tschuess */
+	return(l.retvalue);
 }
 
 
 /********************************************************************
  *                                                                  *
- *  find APID Info object                                           *
+ *  thread scanning files of list                                   *
  *                                                                  *
- *  list: pointer to first object in list                           *
- *  apid: APID                                                      *
+ *  Takes chunks from the reader until all files are done.          *
  *                                                                  *
- *  result:  pointer to APID Info object                            *
- *           0 - APID Info object not found                         *
+ *  arg: pointer to list scan                                       *
+ *                                                                  *
+ *  result: NULL                                                    *
  *                                                                  *
  ********************************************************************/
-struct apid_info *FindAPIDInfo(struct apid_info *list, int apid) {
-	/* pointer to APID Info object */
-	struct apid_info *p;
+void *ListWorker(void *arg) {
+	/* list scan */
+	struct list_scan *l = arg;
+	/* chunk */
+	struct pds_chunk c;
+	/* file */
+	struct list_file *lf;
+	/* bytes used */
+	long used;
+	/* primary header */
+	struct pri_hdr hdr;
 
 
-	/* go through list */
-	for(p = list; p != NULL; p = p->next) {
-		/* right APID? */
-		if(p->apid == apid)
-			/* return object address */
-			return(p);
+	while(!ReaderNext(l->reader, &c)) {
+		lf = &(l->files[c.file]);
+
+		/* can't open or read file? */
+		if(c.error) {
+			ReaderDone(l->reader, &c, -1);
+			lf->error = "can't read file";
+			ListReport(l, c.file);
+			continue;
+		}
+
+		/* compressed file or archive? then read it as usual */
+		if(!lf->started && (PDSMagic(c.data, c.size) != PDS_FMT_PLAIN)) {
+			ReaderDone(l->reader, &c, -1);
+			if(ListFile(l, lf, l->names[c.file]))
+				lf->error = "not enough memory";
+			ListReport(l, c.file);
+			continue;
+		}
+		lf->started = 1;
+
+		/* packets in chunk */
+		if((used = ListChunk(l, &(lf->stats), &c)) < 0) {
+			ReaderDone(l->reader, &c, -1);
+			lf->error = "not enough memory";
+			ListReport(l, c.file);
+			continue;
+		}
+		if(!c.eof) {
+			ReaderDone(l->reader, &c, used);
+			continue;
+		}
+
+		/* packet cut by end of file? it's counted like in a single run */
+		if(c.size - used >= PRI_HDR_SIZE) {
+			if(!DecodePriHdr(c.data + used, &hdr) &&
+				 (StatAddPacket(&(lf->stats), hdr.apid, hdr.pkt_count) < 0))
+				lf->error = "not enough memory";
+			else
+				lf->error = "file might be corrupted";
+		}
+		ReaderDone(l->reader, &c, -1);
+		ListReport(l, c.file);
 	}
 
-	/* couldn't find object */
+	/* nix */
 	return(NULL);
 }
 
 
 /********************************************************************
  *                                                                  *
- *  decode MODIS header                                             *
+ *  add packets of chunk to statistics                              *
  *                                                                  *
- *  buf: pointer to buffer                                          *
- *  len: data lengh                                                 *
- *  hdr: pointer to header structure                                *
+ *  The headers of the complete packets in the chunk are decoded in *
+ *  batches. Like in a single run, packets of unsupported version   *
+ *  aren't counted, MODIS packets are added to the MODIS statistics *
+ *  from level 1 on and their checksum is checked at full level.    *
  *                                                                  *
- *  result:  0 - ok                                                 *
- *          -1 - decode error                                       *
- *          -2 - decode error                                       *
+ *  l: pointer to list scan                                         *
+ *  s: pointer to statistics of file                                *
+ *  c: pointer to chunk                                             *
+ *                                                                  *
+ *  result: bytes of complete packets                               *
+ *          -1 - not enough memory                                  *
  *                                                                  *
  ********************************************************************/
-int DecodeMODISHdr(unsigned char *buf, int len,
-									 struct modis_hdr *hdr) {
-	/* days since 01/01/1958 */
-	hdr->days =
-		(((int)buf[0]) << 8) +
-		(((int)buf[1]));
-	
-	/* milliseconds of day */
-	hdr->millisec =
-		(((unsigned long int)buf[2]) << 24) +
-		(((unsigned long int)buf[3]) << 16) +
-		(((unsigned long int)buf[4]) << 8) +
-		(((unsigned long int)buf[5]));
-	
-	/* microseconds of milliseconds */
-	hdr->microsec =
-		(((int)buf[6]) << 8) +
-		(((int)buf[7]));
-	
-	/* quicklook flag */
-	hdr->ql = (buf[8] & 0x80) >> 7;
-	
-	/* packet type (000 = day, 001 = night, 010 = eng1, 100 = eng2 */
-	hdr->pkt_type = (buf[8] & 0x70) >> 4;
-	
-	/* scan count */
-	hdr->scan_count = (buf[8] & 0x0E) >> 1;
-	
-	/* mirror side */
-	hdr->mirror_side = (buf[8] & 1);
-	
-	/* source identification (0 = earth, 1 = calibration) */
-	hdr->src1 = (buf[9] & 0x80) >> 7;
-
-	/* source identification (0 = eng., 1 to 1354 = sample count) */
-	hdr->src2 =
-		(((int)buf[9] & 0x7F) << 4) +
-		(((int)buf[10] & 0xF0) >> 4);
-
-	/* FPA/AEM config */
-	hdr->conf =
-		(((int)buf[10] & 0x0F) << 6) +
-		(((int)buf[11] & 0xFC) >> 2);
-
-	/* sci state */
-	hdr->sci_state = (((int)buf[11] & 0x02) >> 1);
-
-	/* sci abnorm */
-	hdr->sci_abnorm = (((int)buf[11] & 0x01));
-
-	/* check sum */
-	hdr->checksum =
-		(((int)buf[len - 2] & 0x0F) << 8) +
-		(((int)buf[len - 1]));
+long ListChunk(struct list_scan *l, struct pds_stats *s,
+							 struct pds_chunk *c) {
+	/* offsets and headers of batch */
+	long offsets[PDS_BATCH];
+	struct pds_batch b;
+	/* number of packets of batch, counter */
+	int n, i;
+	/* position in chunk */
+	long pos = 0;
+	/* packet info */
+	struct pkt_info info;
+	/* decoded packet for checksum */
+	struct pds_packet pkt;
+
+
+	pkt.samples = NULL;
+	while((n = PDSFindPackets(c->data + pos, c->size - pos, offsets,
+														PDS_BATCH)) > 0) {
+		PDSDecodeBatch(c->data + pos, c->size - pos, offsets, n, &b);
+		for(i = 0; i < n; i++) {
+			/* unsupported version? */
+			if(b.version[i])
+				continue;
+
+			/* count packet and missing packets */
+			if(StatAddPacket(s, b.apid[i], b.pkt_count[i]) < 0)
+				return(-1);
+			if(!b.modis[i] || (l->verify < PDS_LEVEL_SECONDARY))
+				continue;
+
+			/* check packet at full level */
+			if(l->verify == PDS_LEVEL_FULL) {
+				pkt.decoder = PDSDecoder(b.apid[i]);
+				pkt.size = PRI_HDR_SIZE + b.pkt_length[i] + 1;
+				PDSCheckPacket(c->data + pos + offsets[i], &pkt);
+				StatAddMODIS(s, &(pkt.info));
+				continue;
+			}
+
+			/* or take MODIS header from batch */
+			info.modis = 1;
+			info.valid = 1;
+			info.days = b.days[i];
+			info.millisec = b.millisec[i];
+			info.microsec = b.microsec[i];
+			info.pkt_type = b.pkt_type[i];
+			info.src1 = b.src1[i];
+			StatAddMODIS(s, &info);
+		}
+		pos += offsets[n - 1] + PRI_HDR_SIZE + b.pkt_length[n - 1] + 1;
+	}
+
+	/* fine */
+	return(pos);
 }
 
 
 /********************************************************************
  *                                                                  *
- *  convert julian day to calendar date                             *
+ *  add packets of compressed file to statistics                    *
  *                                                                  *
- *  minute: pointer to store minute                                 *
- *  hour:   pointer to store hour                                   *
- *  day:    pointer to store day                                    *
- *  month:  pointer to store month                                  *
- *  year:   pointer to store year                                   *
- *  jul:    julian day                                              *
+ *  l:    pointer to list scan                                      *
+ *  lf:   pointer to file                                           *
+ *  name: file name                                                 *
  *                                                                  *
- *  result: none                                                    *
+ *  result:  0 - ok (errors in file set in lf)                      *
+ *          -1 - not enough memory                                  *
  *                                                                  *
  ********************************************************************/
-void caldat(int *minute, int *hour, int *day, int *month, int *year,
-						double jul) {
-	/* julian day as long */
-	long ljul;
-	/* helping variables */
-	long ja, jalpha, jb, jc, jd, je;
-
-
-	ljul = (long)floor(jul);
-	jul -= (double)ljul;
-	*hour = (int)(floor(jul * 24.0));
-	jul -= (double)*hour / 24.0;
-	*minute = (int)(floor(jul * 1440.0));
-
-	if(ljul >= 2299161) {
-		jalpha = (long)(((float)(ljul - 1867216) - 0.25) / 36524.25);
-		ja = ljul + 1 + jalpha -(long)(0.25 * jalpha);
-	} else
-		ja = ljul;
-	jb = ja + 1524;
-	jc = (long)(6680.0 + ((float)(jb - 2439870) - 122.1) / 365.25);
-	jd = (long)(365 * jc + (0.25 * jc));
-	je = (long)((jb - jd) / 30.6001);
-	*day = jb - jd -(long)(30.6001*je);
-	*month = je - 1;
-	if(*month > 12)
-		*month -= 12;
-	*year = jc - 4715;
-	if(*month > 2)
-		--(*year);
-	if(*year <= 0)
-		--(*year);
+int ListFile(struct list_scan *l, struct list_file *lf, char *name) {
+	/* PDS file pointer */
+	struct pds_file *f;
+	/* packet buffer */
+	unsigned char *buf;
+	/* decoded packet */
+	struct pds_packet pkt;
+	/* error code */
+	int error;
+
+
+	/* open file */
+	if(!(buf = malloc(PDS_PKT_SIZE)))
+		return(-1);
+	if(!(f = PDSOpen(name, 1))) {
+		lf->error = "can't read file";
+		free(buf);
+		return(0);
+	}
+
+	/* all packets */
+	pkt.samples = NULL;
+	while((error = PDSReadPacket(f, buf, &pkt, l->verify)) != 1) {
+		if(error == -1) {
+			lf->error = "file might be corrupted";
+			break;
+		}
+
+		/* unsupported packet version? then it's not counted */
+		if(pkt.hdr.version != 0) {
+			if(error == -3) {
+				lf->error = "file might be corrupted";
+				break;
+			}
+			continue;
+		}
+
+		/* count packet and missing packets */
+		if(StatAddPacket(&(lf->stats), pkt.hdr.apid, pkt.hdr.pkt_count) < 0) {
+			PDSClose(f);
+			free(buf);
+			return(-1);
+		}
+		if(error) {
+			lf->error = "file might be corrupted";
+			break;
+		}
+		if(pkt.info.modis)
+			StatAddMODIS(&(lf->stats), &(pkt.info));
+	}
+
+	/* close file */
+	PDSClose(f);
+	free(buf);
+
+	/* passt */
+	return(0);
 }
 
 
 /********************************************************************
  *                                                                  *
- *  calculate 12bit checksum                                        *
+ *  print statistics of file of list                                *
  *                                                                  *
- *  buf: pointer to data buffer                                     *
- *  n:   number of bytes in buffer                                  *
+ *  Prints the name of the file, an error if there was one, and the *
+ *  statistics like a single run, then frees the statistics.        *
  *                                                                  *
- *  result: checksum                                                *
+ *  l:    pointer to list scan                                      *
+ *  file: index of file                                             *
+ *                                                                  *
+ *  result: none                                                    *
  *                                                                  *
  ********************************************************************/
-int CalcChecksum12(unsigned char *buf, int n) {
-	/* counter */
-	int i;
-	/* data value */
-	unsigned long x;
-	/* checksum */
-	unsigned long s = 0;
-
-	
-	/* main loop */
-	for(i = 0; i < n; i++) {
-		/* get 1. value */
-		x =
-			(((unsigned long)buf[(int)(1.5 * i)]) << 4) +
-			(((unsigned long)buf[(int)(1.5 * i) + 1] & 0xF0) >> 4);
-
-		/* add to checksum */
-		s = s + x;
-
-		/* increase counter */
-		i++;
-
-		/* do we have a second value */
-		if(i >= n)
-			break;
+void ListReport(struct list_scan *l, int file) {
+	/* file */
+	struct list_file *lf = &(l->files[file]);
 
-		/* get 2. value */
-		x =
-			(((unsigned long)buf[(int)(1.5 * (i - 1)) + 1] & 0x0F) << 8) +
-			(((unsigned long)buf[(int)(1.5 * (i - 1)) + 2]));
 
-		/* add to checksum */
-		s = s + x;
-	}
+	/* no packets? */
+	if(!lf->error && !lf->stats.apidlist)
+		lf->error = "no valid packets found";
 
-	
-	s = s >> 4;
-	s = s & 0xFFF;
+	/* print, one file at a time */
+	pthread_mutex_lock(&(l->lock));
+	printf("file: %s\n", l->names[file]);
+	if(lf->error) {
+		printf("error: %s\n", lf->error);
+		l->retvalue = 5;
+	}
+	if(lf->stats.apidlist) {
+		PrintAPIDs(&(lf->stats), l->verify);
+		if(l->verify >= PDS_LEVEL_SECONDARY)
+			PrintMODIS(&(lf->stats));
+	}
+	pthread_mutex_unlock(&(l->lock));
 
-	/* return checksum */
-	return(s);
+	/* free statistics */
+	StatFree(&(lf->stats));
 }
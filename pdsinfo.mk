@@ -8,16 +8,16 @@ MAKEFILE = pdsinfo.mk
 EXE	= pdsinfo 
 
 # Object modules for EXE
-OBJ    	= pdsinfo.o 
+OBJ    	= pdsinfo.o pds.o pdscol.o pdsdump.o pdsscan.o pdsseg.o pdsio.o pdsread.o pdsstat.o pdsjoin.o pdsfilter.o 
 
 # Library locations
 LIBS 	= 
 
 # LIBS needed to compile EXE
-LLIBS 	= -lm
+LLIBS 	= -lz -lbz2 -lpthread -lm
 
 
 # Include file locations
-INCLUDE = 
+INCLUDE = -DHAVE_ZLIB -DHAVE_BZLIB
 
 include $(MAKEFILE_APP_TEMPLATE)
@@ -0,0 +1,1689 @@
+/********************************************************************
+ *                                                                  *
+ *  Copyright (C) 2026                                              *
+ *  Geoscience Australia, Canberra, Australia                       *
+ *                                                                  *
+ *  This program is free software; you can redistribute it and/or   *
+ *  modify it under the terms of the GNU General Public License as  *
+ *  published by the Free Software Foundation; either version 2 of  *
+ *  the License, or (at your option) any later version.             *
+ *                                                                  *
+ *  This program is distributed in the hope that it will be         *
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied      *
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR         *
+ *  PURPOSE.  See the GNU General Public License for more details.  *
+ *                                                                  *
+ *  You should have received a copy of the GNU General Public       *
+ *  License along with this program; if not, write to the Free      *
+ *  Software Foundation, Inc., 59 Temple Place, Suite 330, Boston,  *
+ *  MA  02111-1307  USA                                             *
+ *                                                                  *
+ ********************************************************************
+ *                                                                  *
+ *  ingest daemon for PDS files                                     *
+ *                                                                  *
+ *  Watches drop directories with inotify. Every file written or    *
+ *  moved there is validated by a pool of threads like pdsinfo      *
+ *  does it and joins the group of files of the same APID whose     *
+ *  time range it overlaps. A group is merged like pdsmerge does it *
+ *  as soon as it holds the expected number of copies or no file    *
+ *  has joined it for a while. Files arriving after the merge are   *
+ *  merged with the existing output. Merges run on the same pool    *
+ *  of threads (see pdsjoin.h), at most a given number at a time.   *
+ *  The inotify queue isn't read while the validation queue is      *
+ *  full, events lost by the kernel then are recovered by scanning  *
+ *  the drop directories again.                                     *
+ *                                                                  *
+ *  18/10/2026  GA           initial version                        *
+ *  18/10/2026  GA           time of libpds (PDSFormatTime())       *
+ *  18/10/2026  GA           merges run by pool threads with merge  *
+ *                           of libpds instead of pdsmerge          *
+ *                           processes, -m dropped                  *
+ *  18/10/2026  GA           merge loop of libpds (JoinStep())      *
+ *  18/10/2026  GA           failed merges tried again, files given *
+ *                           up forgotten, temporary names skipped  *
+ *  18/10/2026  GA           queued merges taken before validations *
+ *                                                                  *
+ ********************************************************************
+ *                                                                  *
+ *  usage: pdsingest [-t threads] [-j jobs] [-n copies]             *
+ *                   [-w seconds] [-p pattern] [-x done_dir] [-1]   *
+ *                   <output dir> <drop dir> [<drop dir> [...]]     *
+ *                                                                  *
+ ********************************************************************
+ *                                                                  *
+ *  build: cc -DHAVE_ZLIB -DHAVE_BZLIB pdsingest.c pds.c pdsio.c    *
+ *         pdsstat.c pdsjoin.c pdsfilter.c -lz -lbz2 -lpthread -lm  *
+ *         -o pdsingest                                             *
+ *                                                                  *
+ ********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <poll.h>
+#include <signal.h>
+#include <pthread.h>
+#include <dirent.h>
+#include <fnmatch.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/inotify.h>
+
+#include "pds.h"
+#include "pdsjoin.h"
+
+
+/********************************************************************
+ *                                                                  *
+ *  defines                                                         *
+ *                                                                  *
+ ********************************************************************/
+/* name */
+#define NAME "pdsingest"
+/* version */
+#define VERSION 1
+/* revision */
+#define REVISION 5
+/* usage */
+#define USAGE "[-t threads] [-j jobs] [-n copies] [-w seconds] [-p pattern] [-x done_dir] [-1] <output dir> <drop dir> [<drop dir> [...]]\n-t: number of threads validating and merging files (default 1)\n-j: maximum number of merges at a time (default 2)\n-n: merge a group when it holds copies files (default 2)\n-w: merge a group when no file has joined it for seconds (default 300)\n-p: only ingest files matching pattern (*.tmp and *.part never)\n-x: move files to done_dir after merging them\n-1: ingest the files in the drop directories, merge and exit"
+/* microseconds per day */
+#define USEC_PER_DAY 86400000000ULL
+/* size of validation queue (files) */
+#define QUEUE_SIZE 64
+/* size of hash table of seen files */
+#define SEEN_HASH 4096
+/* size of inotify event with name */
+#define EVENT_SIZE (sizeof(struct inotify_event) + NAME_MAX + 1)
+/* maximum time between checks of groups (milliseconds) */
+#define TICK_MSEC 1000
+/* tries of a merge, seconds between them */
+#define MERGE_TRIES 3
+#define RETRY_SECS 60
+
+
+/********************************************************************
+ *                                                                  *
+ *  structure definitions                                           *
+ *                                                                  *
+ ********************************************************************/
+/* APID of validated file */
+struct ingest_apid {
+	int apid;
+	/* number of packets, invalid and missing packets */
+	long count, invalid, missing;
+	/* time of first and last valid packet */
+	unsigned long long start, end;
+};
+
+/* file to ingest */
+struct ingest_file {
+	/* file name */
+	char *name;
+	/* result of validation (0 = valid) */
+	int error;
+	/* APIDs with decoder */
+	int napids;
+	struct ingest_apid *apids;
+	/* number of groups still to merge the file */
+	int refs;
+	/* a merge of the file failed */
+	int failed;
+	/* next file in list of validated files */
+	struct ingest_file *next;
+};
+
+/* file seen in drop directory */
+struct seen_file {
+	char *name;
+	/* modification time and size when seen */
+	long long mtime, size;
+	struct seen_file *next;
+};
+
+/* group of overlapping files */
+struct ingest_group {
+	int apid;
+	/* time range of files */
+	unsigned long long start, end;
+	/* output file */
+	char *output;
+	/* number of files joined, output exists */
+	int copies, merged;
+	/* files waiting for merge */
+	struct ingest_file **files;
+	int nfiles, size;
+	/* files of running merge */
+	struct ingest_file **job;
+	int njob;
+	/* merge queued or running, merge finished and its result (see
+		 MergeGroup()), failed tries */
+	int busy, finished, result, failures;
+	/* next group in merge queue */
+	struct ingest_group *qnext;
+	/* time to merge without further files, to try failed merge
+		 again */
+	time_t deadline, retry;
+	struct ingest_group *next;
+};
+
+/* inputs of merge (read by ReadGroupInput()) */
+struct group_inputs {
+	/* files, packet buffers and decoded packets */
+	struct pds_file **fin;
+	unsigned char **buf;
+	struct pds_packet *pkt;
+};
+
+/* ingest state */
+struct ingest {
+	/* options */
+	int copies, wait, once;
+	char *pattern, *outdir, *donedir;
+	/* drop directories and their inotify watches */
+	char **dirs;
+	int *wds, ndirs;
+	/* validation queue */
+	struct ingest_file *queue[QUEUE_SIZE];
+	int head, count;
+	/* validated files (first and last) */
+	struct ingest_file *done, *last;
+	/* number of files queued and not collected yet */
+	int pending;
+	/* groups to merge */
+	struct ingest_group *merges;
+	/* stop threads (after queued merges) */
+	int stop;
+	/* lock and signal of queues */
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	/* files seen */
+	struct seen_file *seen[SEEN_HASH];
+	/* groups */
+	struct ingest_group *groups;
+	/* number of queued or running merges */
+	int running;
+};
+
+
+/********************************************************************
+ *                                                                  *
+ *  function declarations                                           *
+ *                                                                  *
+ ********************************************************************/
+void Ingest(struct ingest *g, int inotify, int wake, int jobs);
+int ScanDirs(struct ingest *g);
+int ReadEvents(struct ingest *g, int inotify);
+int AddName(struct ingest *g, char *dir, char *name);
+int Seen(struct ingest *g, char *name, struct stat *st);
+void Forget(struct ingest *g, char *name);
+void *Worker(void *arg);
+void ValidateFile(struct ingest_file *e);
+int AddTime(struct ingest_file *e, int apid, unsigned long long t);
+int CollectFiles(struct ingest *g);
+int JoinGroup(struct ingest *g, struct ingest_file *e,
+							struct ingest_apid *a);
+void StartMerges(struct ingest *g, int jobs);
+void StartMerge(struct ingest *g, struct ingest_group *grp);
+int MergeGroup(struct ingest_group *grp);
+int ReadGroupInput(void *arg, int i, unsigned char **buf,
+									 struct pds_packet **pkt);
+void ReapMerges(struct ingest *g);
+void RetryMerge(struct ingest *g, struct ingest_group *grp);
+void ReleaseFile(struct ingest *g, struct ingest_file *e);
+int Idle(struct ingest *g);
+void FreeFile(struct ingest_file *e);
+void Log(char *fmt, ...);
+void OnSignal(int sig);
+
+
+/********************************************************************
+ *                                                                  *
+ *  global variables (used by signal handler)                       *
+ *                                                                  *
+ ********************************************************************/
+/* write end of wake up pipe */
+static int wake_fd = -1;
+/* termination requested */
+static volatile sig_atomic_t terminate = 0;
+
+
+/********************************************************************
+ *                                                                  *
+ *  main function                                                   *
+ *                                                                  *
+ ********************************************************************/
+int main(int argc, char *argv[]) {
+	/* ingest state */
+	struct ingest g;
+	/* signal action */
+	struct sigaction sa;
+	/* signal masks */
+	sigset_t block, old;
+	/* threads */
+	pthread_t *tid;
+	/* number of threads */
+	int threads = 1;
+	/* maximum number of merges at a time */
+	int jobs = 2;
+	/* inotify instance */
+	int inotify = -1;
+	/* wake up pipe */
+	int wake[2];
+	/* counter */
+	int i;
+	/* option character */
+	int c;
+
+
+	/* print version information */
+	fprintf(stderr, "%s V%d.%d ("__DATE__")\n",
+					NAME,	VERSION, REVISION);
+
+	/* defaults */
+	memset(&g, 0, sizeof(struct ingest));
+	g.copies = 2;
+	g.wait = 300;
+	g.pattern = "*";
+
+	/* get options */
+	while((c = getopt(argc, argv, "t:j:n:w:p:x:1")) != -1) {
+		switch(c) {
+		case 't':
+			threads = atoi(optarg);
+			if(threads < 1) {
+				fprintf(stderr, "USAGE: %s " USAGE "\n", NAME);
+				return(20);
+			}
+			break;
+		case 'j':
+			jobs = atoi(optarg);
+			if(jobs < 1) {
+				fprintf(stderr, "USAGE: %s " USAGE "\n", NAME);
+				return(20);
+			}
+			break;
+		case 'n':
+			g.copies = atoi(optarg);
+			if(g.copies < 1) {
+				fprintf(stderr, "USAGE: %s " USAGE "\n", NAME);
+				return(20);
+			}
+			break;
+		case 'w':
+			g.wait = atoi(optarg);
+			if(g.wait < 0) {
+				fprintf(stderr, "USAGE: %s " USAGE "\n", NAME);
+				return(20);
+			}
+			break;
+		case 'p':
+			g.pattern = optarg;
+			break;
+		case 'x':
+			g.donedir = optarg;
+			break;
+		case '1':
+			g.once = 1;
+			break;
+		default:
+			fprintf(stderr, "USAGE: %s " USAGE "\n", NAME);
+			return(20);
+		}
+	}
+
+	/* check number of arguments */
+	if(argc - optind < 2) {
+		fprintf(stderr, "USAGE: %s " USAGE "\n", NAME);
+		return(20);
+	}
+	g.outdir = argv[optind];
+	g.dirs = argv + optind + 1;
+	g.ndirs = argc - optind - 1;
+
+	/* wake up pipe for threads and signals */
+	if(pipe(wake) ||
+		 (fcntl(wake[0], F_SETFL, O_NONBLOCK) < 0) ||
+		 (fcntl(wake[1], F_SETFL, O_NONBLOCK) < 0)) {
+		fprintf(stderr, "can't create pipe\n");
+		return(10);
+	}
+	wake_fd = wake[1];
+
+	/* handle signals */
+	memset(&sa, 0, sizeof(struct sigaction));
+	sa.sa_handler = OnSignal;
+	sa.sa_flags = SA_RESTART;
+	sigemptyset(&sa.sa_mask);
+	sigaction(SIGINT, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+
+	/* watch drop directories */
+	if(!(g.wds = malloc(g.ndirs * sizeof(int)))) {
+		fprintf(stderr, "not enough memory\n");
+		return(10);
+	}
+	if(!g.once && ((inotify = inotify_init1(IN_NONBLOCK)) < 0)) {
+		fprintf(stderr, "can't initialise inotify\n");
+		return(10);
+	}
+	for(i = 0; i < g.ndirs; i++) {
+		g.wds[i] = -1;
+		if(!g.once &&
+			 ((g.wds[i] = inotify_add_watch(inotify, g.dirs[i],
+																			 IN_CLOSE_WRITE | IN_MOVED_TO |
+																			 IN_ONLYDIR)) < 0)) {
+			fprintf(stderr, "can't watch %s\n", g.dirs[i]);
+			return(10);
+		}
+	}
+
+	/* start threads (signals go to main thread) */
+	pthread_mutex_init(&(g.lock), NULL);
+	pthread_cond_init(&(g.cond), NULL);
+	if(!(tid = malloc(threads * sizeof(pthread_t)))) {
+		fprintf(stderr, "not enough memory\n");
+		return(10);
+	}
+	sigfillset(&block);
+	pthread_sigmask(SIG_BLOCK, &block, &old);
+	for(i = 0; i < threads; i++) {
+		if(pthread_create(&(tid[i]), NULL, Worker, &g)) {
+			fprintf(stderr, "can't start threads\n");
+			return(10);
+		}
+	}
+	pthread_sigmask(SIG_SETMASK, &old, NULL);
+
+	/* go */
+	Ingest(&g, inotify, wake[0], jobs);
+
+	/* stop threads when queued merges are done, collect them */
+	pthread_mutex_lock(&(g.lock));
+	g.stop = 1;
+	pthread_cond_broadcast(&(g.cond));
+	pthread_mutex_unlock(&(g.lock));
+	for(i = 0; i < threads; i++)
+		pthread_join(tid[i], NULL);
+	free(tid);
+	ReapMerges(&g);
+
+	/* clean up */
+	if(inotify >= 0)
+		close(inotify);
+	free(g.wds);
+
+	/* Ja das war's. Der Pop-Shop ist zu Ende */
+	return(terminate ? 1 : 0);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  main loop of daemon                                             *
+ *                                                                  *
+ *  Files found in the drop directories at start and later          *
+ *  reported by inotify are queued for validation, validated files  *
+ *  are grouped and complete groups merged. Returns on SIGINT or    *
+ *  SIGTERM, or in single pass mode when all files are merged.      *
+ *                                                                  *
+ *  g:       pointer to ingest state                                *
+ *  inotify: inotify instance (-1 = none)                           *
+ *  wake:    read end of wake up pipe                               *
+ *  jobs:    maximum number of merges at a time                     *
+ *                                                                  *
+ *  result: none                                                    *
+ *                                                                  *
+ ********************************************************************/
+void Ingest(struct ingest *g, int inotify, int wake, int jobs) {
+	/* descriptors to poll */
+	struct pollfd fds[2];
+	/* buffer to drain wake up pipe */
+	char buf[256];
+	/* directories to scan (again) */
+	int rescan = 1;
+	/* room in validation queue */
+	int room;
+	/* number of files queued or validated */
+	int pending;
+
+
+	for(;;) {
+		/* scan drop directories as long as there is room in queue */
+		pthread_mutex_lock(&(g->lock));
+		room = QUEUE_SIZE - g->count;
+		pthread_mutex_unlock(&(g->lock));
+		if(rescan && room) {
+			if((rescan = ScanDirs(g)) < 0) {
+				Log("not enough memory");
+				return;
+			}
+			pthread_mutex_lock(&(g->lock));
+			room = QUEUE_SIZE - g->count;
+			pthread_mutex_unlock(&(g->lock));
+		}
+
+		/* done? */
+		if(terminate || (g->once && !rescan && Idle(g)))
+			return;
+
+		/* wait for validated files, events (if room in queue), merges
+			 or timeout */
+		fds[0].fd = wake;
+		fds[0].events = POLLIN;
+		fds[1].fd = inotify;
+		fds[1].events = (room && !rescan) ? POLLIN : 0;
+		if((poll(fds, (inotify >= 0) ? 2 : 1, TICK_MSEC) < 0) &&
+			 (errno != EINTR)) {
+			Log("can't poll");
+			return;
+		}
+		while(read(wake, buf, sizeof(buf)) > 0)
+			;
+		if(terminate)
+			return;
+
+		/* read inotify events */
+		if((inotify >= 0) && (fds[1].revents & POLLIN)) {
+			switch(ReadEvents(g, inotify)) {
+			case 0:
+				break;
+			case 1:
+				Log("event queue overflow, scanning drop directories");
+				rescan = 1;
+				break;
+			default:
+				Log("not enough memory");
+				return;
+			}
+		}
+
+		/* group validated files, collect finished merges and start
+			 merges of complete groups (in single pass mode when all
+			 files are validated) */
+		if(CollectFiles(g)) {
+			Log("not enough memory");
+			return;
+		}
+		ReapMerges(g);
+		pthread_mutex_lock(&(g->lock));
+		pending = g->pending;
+		pthread_mutex_unlock(&(g->lock));
+		if(!g->once || (!rescan && !pending))
+			StartMerges(g, jobs);
+	}
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  queue files in drop directories not seen before                 *
+ *                                                                  *
+ *  Stops when the validation queue is full.                        *
+ *                                                                  *
+ *  g: pointer to ingest state                                      *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *           1 - queue full, scan again later                       *
+ *          -1 - out of memory                                      *
+ *                                                                  *
+ ********************************************************************/
+int ScanDirs(struct ingest *g) {
+	/* directory */
+	DIR *dir;
+	/* directory entry */
+	struct dirent *de;
+	/* counter */
+	int i;
+	/* result of adding file */
+	int result = 0;
+
+
+	for(i = 0; (result <= 0) && (i < g->ndirs); i++) {
+		/* open directory */
+		if(!(dir = opendir(g->dirs[i]))) {
+			Log("can't read %s", g->dirs[i]);
+			continue;
+		}
+
+		/* queue files */
+		while((result >= 0) && (de = readdir(dir)))
+			if((result = AddName(g, g->dirs[i], de->d_name)) > 0)
+				break;
+		closedir(dir);
+		if(result < 0)
+			return(-1);
+	}
+
+	/* alles klar */
+	return((result > 0) ? 1 : 0);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  queue files of inotify events                                   *
+ *                                                                  *
+ *  Reads no more events than there is room in the validation       *
+ *  queue for, so the kernel holds back the rest.                   *
+ *                                                                  *
+ *  g:       pointer to ingest state                                *
+ *  inotify: inotify instance                                       *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *           1 - events lost, scan drop directories again           *
+ *          -1 - out of memory                                      *
+ *                                                                  *
+ ********************************************************************/
+int ReadEvents(struct ingest *g, int inotify) {
+	/* event buffer */
+	char *buf;
+	/* event */
+	struct inotify_event *ev;
+	/* number of bytes read */
+	ssize_t n;
+	/* offset of event */
+	ssize_t i;
+	/* room in validation queue */
+	int room;
+	/* counter */
+	int j;
+	/* result */
+	int result = 0;
+
+
+	/* room in queue */
+	pthread_mutex_lock(&(g->lock));
+	room = QUEUE_SIZE - g->count;
+	pthread_mutex_unlock(&(g->lock));
+	if(!room)
+		return(0);
+
+	/* read events */
+	if(!(buf = malloc(room * EVENT_SIZE)))
+		return(-1);
+	if((n = read(inotify, buf, room * EVENT_SIZE)) <= 0) {
+		free(buf);
+		return(0);
+	}
+
+	/* queue files */
+	for(i = 0; i < n; i += sizeof(struct inotify_event) + ev->len) {
+		ev = (struct inotify_event *)(buf + i);
+		if(ev->mask & IN_Q_OVERFLOW) {
+			result = 1;
+			continue;
+		}
+		if((ev->mask & IN_ISDIR) || !ev->len)
+			continue;
+		for(j = 0; (j < g->ndirs) && (g->wds[j] != ev->wd); j++)
+			;
+		if(j == g->ndirs)
+			continue;
+		switch(AddName(g, g->dirs[j], ev->name)) {
+		case 0:
+			break;
+		case 1:
+			result = 1;
+			break;
+		default:
+			free(buf);
+			return(-1);
+		}
+	}
+	free(buf);
+
+	/* passt */
+	return(result);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  queue file for validation                                       *
+ *                                                                  *
+ *  Skips names not matching the pattern, temporary names (*.tmp,   *
+ *  *.part) of files still being written, anything but regular      *
+ *  files and files seen before with the same modification time     *
+ *  and size.                                                       *
+ *                                                                  *
+ *  g:    pointer to ingest state                                   *
+ *  dir:  drop directory                                            *
+ *  name: file name in directory                                    *
+ *                                                                  *
+ *  result:  0 - ok (queued or skipped)                             *
+ *           1 - queue full                                         *
+ *          -1 - out of memory                                      *
+ *                                                                  *
+ ********************************************************************/
+int AddName(struct ingest *g, char *dir, char *name) {
+	/* temporary names */
+	static char *temp[] = {"*.tmp", "*.part", NULL};
+	/* file to ingest */
+	struct ingest_file *e;
+	/* status of file */
+	struct stat st;
+	/* path */
+	char *path;
+	/* counter */
+	int i;
+
+
+	/* matching name? */
+	if(fnmatch(g->pattern, name, FNM_PERIOD))
+		return(0);
+	for(i = 0; temp[i]; i++)
+		if(!fnmatch(temp[i], name, 0))
+			return(0);
+
+	/* queue full? */
+	pthread_mutex_lock(&(g->lock));
+	if(g->count == QUEUE_SIZE) {
+		pthread_mutex_unlock(&(g->lock));
+		return(1);
+	}
+	pthread_mutex_unlock(&(g->lock));
+
+	/* regular file not seen before? */
+	if(!(path = malloc(strlen(dir) + strlen(name) + 2)))
+		return(-1);
+	sprintf(path, "%s/%s", dir, name);
+	if(stat(path, &st) || !S_ISREG(st.st_mode)) {
+		free(path);
+		return(0);
+	}
+	switch(Seen(g, path, &st)) {
+	case 0:
+		break;
+	case 1:
+		free(path);
+		return(0);
+	default:
+		free(path);
+		return(-1);
+	}
+
+	/* queue file */
+	if(!(e = calloc(1, sizeof(struct ingest_file)))) {
+		free(path);
+		return(-1);
+	}
+	e->name = path;
+	pthread_mutex_lock(&(g->lock));
+	g->queue[(g->head + g->count) % QUEUE_SIZE] = e;
+	g->count++;
+	g->pending++;
+	pthread_cond_signal(&(g->cond));
+	pthread_mutex_unlock(&(g->lock));
+
+	/* voila */
+	return(0);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  look up file in set of seen files and add it                    *
+ *                                                                  *
+ *  g:    pointer to ingest state                                   *
+ *  name: path of file                                              *
+ *  st:   status of file                                            *
+ *                                                                  *
+ *  result:  0 - not seen or changed since                          *
+ *           1 - seen with same modification time and size          *
+ *          -1 - out of memory                                      *
+ *                                                                  *
+ ********************************************************************/
+int Seen(struct ingest *g, char *name, struct stat *st) {
+	/* seen file */
+	struct seen_file *s;
+	/* hash of name */
+	unsigned long h = 5381;
+	/* pointer to name */
+	char *p;
+
+
+	/* find file */
+	for(p = name; *p; p++)
+		h = h * 33 + (unsigned char)*p;
+	h %= SEEN_HASH;
+	for(s = g->seen[h]; s && strcmp(s->name, name); s = s->next)
+		;
+
+	/* unchanged? */
+	if(s && (s->mtime == (long long)st->st_mtime) &&
+		 (s->size == (long long)st->st_size))
+		return(1);
+
+	/* add file */
+	if(!s) {
+		if(!(s = malloc(sizeof(struct seen_file))))
+			return(-1);
+		if(!(s->name = strdup(name))) {
+			free(s);
+			return(-1);
+		}
+		s->next = g->seen[h];
+		g->seen[h] = s;
+	}
+	s->mtime = st->st_mtime;
+	s->size = st->st_size;
+
+	/* new */
+	return(0);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  remove file from set of seen files                              *
+ *                                                                  *
+ *  g:    pointer to ingest state                                   *
+ *  name: path of file                                              *
+ *                                                                  *
+ *  result: none                                                    *
+ *                                                                  *
+ ********************************************************************/
+void Forget(struct ingest *g, char *name) {
+	/* pointer to seen file and to link to it */
+	struct seen_file *s, **link;
+	/* hash of name */
+	unsigned long h = 5381;
+	/* pointer to name */
+	char *p;
+
+
+	/* find file */
+	for(p = name; *p; p++)
+		h = h * 33 + (unsigned char)*p;
+	h %= SEEN_HASH;
+	for(link = &(g->seen[h]); (s = *link) && strcmp(s->name, name);
+			link = &(s->next))
+		;
+
+	/* remove it */
+	if(s) {
+		*link = s->next;
+		free(s->name);
+		free(s);
+	}
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  pool thread                                                     *
+ *                                                                  *
+ *  Validates queued files and merges queued groups. A queued       *
+ *  merge is taken first (at most -j are queued or running), so a   *
+ *  steady stream of files can't hold merges back. When stopped the *
+ *  merges still queued are done, the files are left.               *
+ *                                                                  *
+ *  arg: pointer to ingest state                                    *
+ *                                                                  *
+ *  result: NULL                                                    *
+ *                                                                  *
+ ********************************************************************/
+void *Worker(void *arg) {
+	/* ingest state */
+	struct ingest *g = arg;
+	/* file to validate */
+	struct ingest_file *e;
+	/* group to merge */
+	struct ingest_group *grp;
+	/* result of merge */
+	int result;
+
+
+	for(;;) {
+		/* take next file or group */
+		pthread_mutex_lock(&(g->lock));
+		while(!g->count && !g->merges && !g->stop)
+			pthread_cond_wait(&(g->cond), &(g->lock));
+		e = NULL;
+		if((grp = g->merges))
+			g->merges = grp->qnext;
+		else if(g->count && !g->stop) {
+			e = g->queue[g->head];
+			g->head = (g->head + 1) % QUEUE_SIZE;
+			g->count--;
+		}
+		pthread_mutex_unlock(&(g->lock));
+		if(!e && !grp)
+			return(NULL);
+
+		/* merge group, hand result to main loop */
+		if(grp) {
+			result = MergeGroup(grp);
+			pthread_mutex_lock(&(g->lock));
+			grp->result = result;
+			grp->finished = 1;
+			pthread_mutex_unlock(&(g->lock));
+			if(write(wake_fd, "m", 1) < 0) {
+				/* pipe full, main loop wakes up anyway */
+			}
+			continue;
+		}
+
+		/* validate file */
+		ValidateFile(e);
+
+		/* hand it to main loop */
+		pthread_mutex_lock(&(g->lock));
+		e->next = NULL;
+		if(g->last)
+			g->last->next = e;
+		else
+			g->done = e;
+		g->last = e;
+		pthread_mutex_unlock(&(g->lock));
+		if(write(wake_fd, "v", 1) < 0) {
+			/* pipe full, main loop wakes up anyway */
+		}
+	}
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  validate file                                                   *
+ *                                                                  *
+ *  Reads all packets with full verification like pdsinfo and       *
+ *  stores time range and packet counts of each APID with decoder.  *
+ *                                                                  *
+ *  e: pointer to file (error and APIDs are set)                    *
+ *                                                                  *
+ *  result: none (e->error: 0 - valid, -1 - can't read or out of    *
+ *          memory, 1 - read error or packet too long, 2 - no       *
+ *          valid packets)                                          *
+ *                                                                  *
+ ********************************************************************/
+void ValidateFile(struct ingest_file *e) {
+	/* PDS file pointer */
+	struct pds_file *fin;
+	/* decoded packet */
+	struct pds_packet pkt;
+	/* statistics */
+	struct pds_stats stats;
+	/* pointer to APID Info object */
+	struct apid_info *ai;
+	/* packet buffer */
+	unsigned char *buf;
+	/* counter */
+	int i;
+	/* result of reading packet */
+	int result;
+
+
+	/* open file */
+	e->error = -1;
+	if(!(buf = malloc(PDS_PKT_SIZE)))
+		return;
+	if(!(fin = PDSOpen(e->name, 1))) {
+		free(buf);
+		return;
+	}
+	StatInit(&stats);
+	pkt.samples = NULL;
+	e->error = 0;
+
+	/* main loop */
+	for(;;) {
+		/* read next packet, skip unsupported packets */
+		if((result = PDSNextPacket(fin, buf, &pkt)) == 1)
+			break;
+		if(result == -2)
+			continue;
+
+		/* count packet */
+		if((result != -1) && !pkt.hdr.version &&
+			 (StatAddPacket(&stats, pkt.hdr.apid, pkt.hdr.pkt_count) < 0)) {
+			e->error = -1;
+			break;
+		}
+
+		/* read error or packet too long? */
+		if(result) {
+			e->error = 1;
+			break;
+		}
+
+		/* add to statistics */
+		if(pkt.info.modis)
+			StatAddMODIS(&stats, &pkt.info);
+
+		/* time range of valid packets with decoder */
+		if(!pkt.decoder || !pkt.info.valid)
+			continue;
+		if(AddTime(e, pkt.info.apid,
+							 (unsigned long long)pkt.info.days * USEC_PER_DAY +
+							 (unsigned long long)pkt.info.millisec * 1000ULL +
+							 pkt.info.microsec)) {
+			e->error = -1;
+			break;
+		}
+	}
+
+	/* close file */
+	PDSClose(fin);
+	free(buf);
+
+	/* packet counts */
+	for(i = 0; i < e->napids; i++) {
+		if(!(ai = FindAPIDInfo(stats.apidlist, e->apids[i].apid)))
+			continue;
+		e->apids[i].count = ai->count;
+		e->apids[i].invalid = ai->invalid;
+		e->apids[i].missing = ai->missing;
+	}
+	StatFree(&stats);
+
+	/* any valid packets? */
+	if(!e->error && !e->napids)
+		e->error = 2;
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  add time of valid packet to time range of APID                  *
+ *                                                                  *
+ *  e:    pointer to file                                           *
+ *  apid: APID of packet                                            *
+ *  t:    packet time (microseconds since 01/01/1958)               *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          -1 - out of memory                                      *
+ *                                                                  *
+ ********************************************************************/
+int AddTime(struct ingest_file *e, int apid, unsigned long long t) {
+	/* new APID array */
+	struct ingest_apid *p;
+	/* counter */
+	int i;
+
+
+	/* known APID? */
+	for(i = 0; (i < e->napids) && (e->apids[i].apid != apid); i++)
+		;
+	if(i < e->napids) {
+		if(t < e->apids[i].start)
+			e->apids[i].start = t;
+		if(t > e->apids[i].end)
+			e->apids[i].end = t;
+		return(0);
+	}
+
+	/* add APID */
+	if(!(p = realloc(e->apids, (e->napids + 1) *
+									 sizeof(struct ingest_apid))))
+		return(-1);
+	e->apids = p;
+	memset(&(p[i]), 0, sizeof(struct ingest_apid));
+	p[i].apid = apid;
+	p[i].start = p[i].end = t;
+	e->napids++;
+
+	/* gut */
+	return(0);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  log validated files and add valid ones to groups                *
+ *                                                                  *
+ *  g: pointer to ingest state                                      *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          -1 - out of memory                                      *
+ *                                                                  *
+ ********************************************************************/
+int CollectFiles(struct ingest *g) {
+	/* validated files */
+	struct ingest_file *list, *e;
+	/* start and end time */
+	char start[32], end[32];
+	/* counter */
+	int i;
+
+
+	/* take list */
+	pthread_mutex_lock(&(g->lock));
+	list = g->done;
+	g->done = g->last = NULL;
+	pthread_mutex_unlock(&(g->lock));
+
+	while((e = list)) {
+		list = e->next;
+		pthread_mutex_lock(&(g->lock));
+		g->pending--;
+		pthread_mutex_unlock(&(g->lock));
+
+		/* invalid file? */
+		switch(e->error) {
+		case 0:
+			break;
+		case 1:
+			Log("invalid %s: file might be corrupted", e->name);
+			break;
+		case 2:
+			Log("invalid %s: no valid packets", e->name);
+			break;
+		default:
+			Log("invalid %s: can't read file", e->name);
+			break;
+		}
+		if(e->error) {
+			FreeFile(e);
+			continue;
+		}
+
+		/* add to group of each APID */
+		for(i = 0; i < e->napids; i++) {
+			PDSFormatTime(start, e->apids[i].start, 0);
+			PDSFormatTime(end, e->apids[i].end, 0);
+			Log("valid %s: APID %d, %ld packets, %ld invalid, %ld missing, "
+					"%s to %s", e->name, e->apids[i].apid, e->apids[i].count,
+					e->apids[i].invalid, e->apids[i].missing, start, end);
+			if(JoinGroup(g, e, &(e->apids[i])))
+				return(-1);
+		}
+	}
+
+	/* fine */
+	return(0);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  add file to group of overlapping files of APID                  *
+ *                                                                  *
+ *  The file joins the first group of the APID whose time range it  *
+ *  overlaps, or a new group. The output of a new group is named    *
+ *  after APID and start time; if it exists already (file of a      *
+ *  previous run) the group counts as merged and complete.          *
+ *                                                                  *
+ *  g: pointer to ingest state                                      *
+ *  e: pointer to file                                              *
+ *  a: pointer to APID of file                                      *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          -1 - out of memory                                      *
+ *                                                                  *
+ ********************************************************************/
+int JoinGroup(struct ingest *g, struct ingest_file *e,
+							struct ingest_apid *a) {
+	/* pointer to group and to link to it */
+	struct ingest_group *grp, **link;
+	/* new file array */
+	struct ingest_file **p;
+	/* date buffer */
+	int minute, hour, day, month, year;
+	/* julian day of start and of 1st of January */
+	double jul, jan;
+	/* microseconds of day */
+	unsigned long long us;
+
+
+	/* overlapping group? */
+	for(link = &(g->groups); (grp = *link); link = &(grp->next))
+		if((grp->apid == a->apid) &&
+			 (a->start <= grp->end) && (a->end >= grp->start))
+			break;
+
+	/* new group */
+	if(!grp) {
+		if(!(grp = calloc(1, sizeof(struct ingest_group))))
+			return(-1);
+		grp->apid = a->apid;
+		grp->start = a->start;
+		grp->end = a->end;
+
+		/* output name: APID<apid>.P<year><day of year>.<hhmmss>.PDS */
+		jul = (double)(a->start / USEC_PER_DAY) + MODIS_REF_DATE;
+		caldat(&minute, &hour, &day, &month, &year, jul);
+		julday(0, 0, 1, 1, year, &jan);
+		us = a->start % USEC_PER_DAY;
+		if(!(grp->output = malloc(strlen(g->outdir) + 64))) {
+			free(grp);
+			return(-1);
+		}
+		sprintf(grp->output, "%s/APID%d.P%04d%03d.%02d%02d%02d.PDS",
+						g->outdir, a->apid, year, (int)(jul - jan + 1.5),
+						(int)(us / 3600000000ULL),
+						(int)(us / 60000000ULL % 60),
+						(int)(us / 1000000ULL % 60));
+		if(!access(grp->output, F_OK)) {
+			grp->merged = 1;
+			grp->copies = g->copies;
+		}
+		*link = grp;
+	}
+
+	/* add file */
+	if(grp->nfiles == grp->size) {
+		if(!(p = realloc(grp->files, (grp->size + 4) *
+										 sizeof(struct ingest_file *))))
+			return(-1);
+		grp->files = p;
+		grp->size += 4;
+	}
+	grp->files[grp->nfiles++] = e;
+	grp->copies++;
+	e->refs++;
+	if(a->start < grp->start)
+		grp->start = a->start;
+	if(a->end > grp->end)
+		grp->end = a->end;
+	grp->deadline = time(NULL) + g->wait;
+
+	/* okeydokey */
+	return(0);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  start merges of complete groups                                 *
+ *                                                                  *
+ *  A group is complete when it holds the expected number of        *
+ *  copies or its deadline has passed (always in single pass mode). *
+ *  Groups are merged in the order they were created, a failed      *
+ *  merge not before its time to try again.                         *
+ *                                                                  *
+ *  g:    pointer to ingest state                                   *
+ *  jobs: maximum number of merges at a time                        *
+ *                                                                  *
+ *  result: none                                                    *
+ *                                                                  *
+ ********************************************************************/
+void StartMerges(struct ingest *g, int jobs) {
+	/* pointer to group */
+	struct ingest_group *grp;
+	/* current time */
+	time_t now;
+
+
+	now = time(NULL);
+	for(grp = g->groups; grp && (g->running < jobs); grp = grp->next) {
+		/* complete group waiting for merge? */
+		if(grp->busy || !grp->nfiles || (now < grp->retry))
+			continue;
+		if(!g->once && (grp->copies < g->copies) && (now < grp->deadline))
+			continue;
+
+		/* start merge */
+		StartMerge(g, grp);
+	}
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  start merge of group                                            *
+ *                                                                  *
+ *  Hands the files of the group to the merge and queues it for     *
+ *  the pool threads (see MergeGroup()).                            *
+ *                                                                  *
+ *  g:   pointer to ingest state                                    *
+ *  grp: pointer to group                                           *
+ *                                                                  *
+ *  result: none                                                    *
+ *                                                                  *
+ ********************************************************************/
+void StartMerge(struct ingest *g, struct ingest_group *grp) {
+	/* pointer to queued group */
+	struct ingest_group **link;
+
+
+	/* files belong to merge now */
+	Log("merge %s: %d file%s%s", grp->output, grp->nfiles,
+			(grp->nfiles == 1) ? "" : "s", grp->merged ? " into output" : "");
+	free(grp->job);
+	grp->job = grp->files;
+	grp->njob = grp->nfiles;
+	grp->files = NULL;
+	grp->nfiles = grp->size = 0;
+	grp->busy = 1;
+	g->running++;
+
+	/* queue it */
+	pthread_mutex_lock(&(g->lock));
+	grp->finished = 0;
+	grp->qnext = NULL;
+	for(link = &(g->merges); *link; link = &((*link)->qnext))
+		;
+	*link = grp;
+	pthread_cond_signal(&(g->cond));
+	pthread_mutex_unlock(&(g->lock));
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  merge group                                                     *
+ *                                                                  *
+ *  Merges the files of the running merge like pdsmerge into        *
+ *  <output>.tmp, an existing output is merged as the last input    *
+ *  (its packets aren't tested again). Called by pool threads, the  *
+ *  group is left alone by the main loop while the merge runs.      *
+ *                                                                  *
+ *  grp: pointer to group                                           *
+ *                                                                  *
+ *  result: 0 - ok                                                  *
+ *          1 - can't read input file                               *
+ *          2 - can't write output file                             *
+ *          3 - out of memory                                       *
+ *                                                                  *
+ ********************************************************************/
+int MergeGroup(struct ingest_group *grp) {
+	/* merge */
+	struct pds_join join;
+	/* inputs */
+	struct group_inputs in;
+	/* output file */
+	struct pds_out *fout = NULL;
+	/* temporary output */
+	char *tmp;
+	/* number of inputs */
+	int n;
+	/* counter, input of oldest packet */
+	int i, oldest = JOIN_DONE;
+	/* result */
+	int result = 0;
+
+
+	/* allocate inputs, existing output is the last one */
+	n = grp->njob + (grp->merged ? 1 : 0);
+	in.fin = calloc(n, sizeof(struct pds_file *));
+	in.pkt = calloc(n, sizeof(struct pds_packet));
+	in.buf = calloc(n, sizeof(unsigned char *));
+	tmp = malloc(strlen(grp->output) + 5);
+	if(!in.fin || !in.pkt || !in.buf || !tmp ||
+		 JoinInit(&join, n, grp->apid, 0, 0, 4000000, 90000000L, NULL)) {
+		free(in.fin);
+		free(in.pkt);
+		free(in.buf);
+		free(tmp);
+		return(3);
+	}
+	sprintf(tmp, "%s.tmp", grp->output);
+	if(grp->merged)
+		join.in[n - 1].check = JOIN_TRUSTED;
+
+	/* open inputs and output */
+	for(i = 0; !result && (i < n); i++) {
+		if(!(in.buf[i] = malloc(PDS_PKT_SIZE)))
+			result = 3;
+		else if(!(in.fin[i] = PDSOpen((i < grp->njob) ? grp->job[i]->name :
+																	grp->output, 1)))
+			result = 1;
+	}
+	if(!result &&
+		 !(fout = PDSCreate(tmp, PDS_FMT_PLAIN, 0, 1, PDS_FRAME_SIZE)))
+		result = 2;
+
+	/* merge */
+	while(!result &&
+				((oldest = JoinStep(&join, ReadGroupInput, &in)) >= 0)) {
+		PDSMark(fout, &(in.pkt[oldest].info));
+		if(PDSWrite(fout, in.buf[oldest], in.pkt[oldest].size))
+			result = 2;
+	}
+	if(!result && (oldest != JOIN_DONE))
+		result = 1;
+
+	/* close files */
+	if(fout && PDSFinish(fout) && !result)
+		result = 2;
+	if(result)
+		unlink(tmp);
+	for(i = 0; i < n; i++) {
+		if(in.fin[i])
+			PDSClose(in.fin[i]);
+		free(in.buf[i]);
+	}
+	JoinFree(&join);
+	free(in.fin);
+	free(in.pkt);
+	free(in.buf);
+	free(tmp);
+
+	/* alles klar */
+	return(result);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  read next packet of merge input (read function of JoinStep())   *
+ *                                                                  *
+ *  arg: pointer to inputs (struct group_inputs)                    *
+ *  i:   input                                                      *
+ *  buf: pointer to store pointer to packet buffer                  *
+ *  pkt: pointer to store pointer to decoded packet                 *
+ *                                                                  *
+ *  result: JOIN_PACKET, JOIN_END, JOIN_SKIP (see pdsjoin.h)        *
+ *          -1 - read error or packet too long                      *
+ *                                                                  *
+ ********************************************************************/
+int ReadGroupInput(void *arg, int i, unsigned char **buf,
+									 struct pds_packet **pkt) {
+	/* inputs */
+	struct group_inputs *in = arg;
+	/* result of reading packet */
+	int error;
+
+
+	error = PDSReadPacket(in->fin[i], in->buf[i], &(in->pkt[i]),
+												PDS_LEVEL_DATA);
+	if(error == 1)
+		return(JOIN_END);
+	if(error == -2)
+		return(JOIN_SKIP);
+	if(error)
+		return(-1);
+
+	/* fine */
+	*buf = in->buf[i];
+	*pkt = &(in->pkt[i]);
+	return(JOIN_PACKET);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  collect finished merges                                         *
+ *                                                                  *
+ *  The new output replaces the output of the group. The files of   *
+ *  a failed merge go back to the group (see RetryMerge()).         *
+ *                                                                  *
+ *  g: pointer to ingest state                                      *
+ *                                                                  *
+ *  result: none                                                    *
+ *                                                                  *
+ ********************************************************************/
+void ReapMerges(struct ingest *g) {
+	/* reasons of failed merges */
+	static char *reason[] = {"", "can't read input file",
+		"can't write output file", "not enough memory"};
+	/* pointer to group */
+	struct ingest_group *grp;
+	/* temporary output */
+	char *tmp;
+	/* merge finished and its result */
+	int finished, result;
+	/* counter */
+	int i;
+
+
+	for(grp = g->groups; grp; grp = grp->next) {
+		/* finished merge? */
+		if(!grp->busy)
+			continue;
+		pthread_mutex_lock(&(g->lock));
+		finished = grp->finished;
+		result = grp->result;
+		grp->finished = 0;
+		pthread_mutex_unlock(&(g->lock));
+		if(!finished)
+			continue;
+		grp->busy = 0;
+		g->running--;
+
+		/* move new output into place */
+		if(!result) {
+			if(!(tmp = malloc(strlen(grp->output) + 5)))
+				result = 3;
+			else {
+				sprintf(tmp, "%s.tmp", grp->output);
+				if(rename(tmp, grp->output)) {
+					unlink(tmp);
+					result = 2;
+				}
+				free(tmp);
+			}
+		}
+
+		/* failed? then try again */
+		if(result) {
+			Log("merge of %s failed (%s)", grp->output, reason[result]);
+			RetryMerge(g, grp);
+			continue;
+		}
+		Log("merged %s", grp->output);
+		grp->merged = 1;
+		grp->failures = 0;
+
+		/* release files */
+		for(i = 0; i < grp->njob; i++)
+			ReleaseFile(g, grp->job[i]);
+		free(grp->job);
+		grp->job = NULL;
+		grp->njob = 0;
+	}
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  hand files of failed merge back to group                        *
+ *                                                                  *
+ *  The files go before those joined during the merge and are       *
+ *  merged again after RETRY_SECS seconds, files gone from the      *
+ *  drop directory are dropped. After MERGE_TRIES failed merges (at *
+ *  once in single pass mode) the files are given up: they stay in  *
+ *  the drop directory and are forgotten (see ReleaseFile()), so    *
+ *  they are ingested again when written or found by a scan of the  *
+ *  drop directories.                                               *
+ *                                                                  *
+ *  g:   pointer to ingest state                                    *
+ *  grp: pointer to group                                           *
+ *                                                                  *
+ *  result: none                                                    *
+ *                                                                  *
+ ********************************************************************/
+void RetryMerge(struct ingest *g, struct ingest_group *grp) {
+	/* new file array */
+	struct ingest_file **p = NULL;
+	/* counters */
+	int i, n;
+
+
+	/* tries left? then files of merge first, files joined since after
+		 them */
+	grp->failures++;
+	if(!g->once && (grp->failures < MERGE_TRIES) &&
+		 (p = realloc(grp->job, (grp->njob + grp->nfiles) *
+									sizeof(struct ingest_file *)))) {
+		grp->job = p;
+		for(i = n = 0; i < grp->njob; i++) {
+			if(access(grp->job[i]->name, F_OK)) {
+				Log("%s gone, dropped from %s", grp->job[i]->name, grp->output);
+				grp->job[i]->failed = 1;
+				grp->copies--;
+				ReleaseFile(g, grp->job[i]);
+			}
+			else
+				p[n++] = grp->job[i];
+		}
+		if(grp->nfiles)
+			memcpy(p + n, grp->files, grp->nfiles * sizeof(struct ingest_file *));
+		free(grp->files);
+		grp->files = p;
+		grp->nfiles = grp->size = n + grp->nfiles;
+		grp->job = NULL;
+		grp->njob = 0;
+		grp->retry = time(NULL) + RETRY_SECS;
+		Log("merge of %s tried again in %d seconds", grp->output, RETRY_SECS);
+		return;
+	}
+
+	/* give up files */
+	for(i = 0; i < grp->njob; i++) {
+		Log("%s given up", grp->job[i]->name);
+		grp->job[i]->failed = 1;
+		grp->copies--;
+		ReleaseFile(g, grp->job[i]);
+	}
+	free(grp->job);
+	grp->job = NULL;
+	grp->njob = 0;
+	grp->failures = 0;
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  release file after merge of one of its groups                   *
+ *                                                                  *
+ *  When all groups of the file are merged the file is moved to     *
+ *  the done directory (if all merges succeeded) and freed. A file  *
+ *  given up after failed merges is forgotten, so it is ingested    *
+ *  again when it is seen next.                                     *
+ *                                                                  *
+ *  g: pointer to ingest state                                      *
+ *  e: pointer to file                                              *
+ *                                                                  *
+ *  result: none                                                    *
+ *                                                                  *
+ ********************************************************************/
+void ReleaseFile(struct ingest *g, struct ingest_file *e) {
+	/* new path */
+	char *path;
+	/* base name */
+	char *base;
+
+
+	/* still needed? */
+	if(--e->refs > 0)
+		return;
+
+	/* forget file of failed merge, move others to done directory */
+	if(e->failed)
+		Forget(g, e->name);
+	else if(g->donedir) {
+		base = strrchr(e->name, '/') ? strrchr(e->name, '/') + 1 : e->name;
+		if((path = malloc(strlen(g->donedir) + strlen(base) + 2))) {
+			sprintf(path, "%s/%s", g->donedir, base);
+			if(rename(e->name, path))
+				Log("can't move %s to %s", e->name, g->donedir);
+			else
+				Forget(g, e->name);
+			free(path);
+		}
+	}
+
+	/* free file */
+	FreeFile(e);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  test for nothing left to do                                     *
+ *                                                                  *
+ *  g: pointer to ingest state                                      *
+ *                                                                  *
+ *  result: 1 - no files queued, validated or waiting for merge     *
+ *              and no merge running                                *
+ *          0 - otherwise                                           *
+ *                                                                  *
+ ********************************************************************/
+int Idle(struct ingest *g) {
+	/* pointer to group */
+	struct ingest_group *grp;
+	/* number of files queued or validated */
+	int pending;
+
+
+	pthread_mutex_lock(&(g->lock));
+	pending = g->pending;
+	pthread_mutex_unlock(&(g->lock));
+	if(pending || g->running)
+		return(0);
+	for(grp = g->groups; grp; grp = grp->next)
+		if(grp->nfiles)
+			return(0);
+
+	/* idle */
+	return(1);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  free file                                                       *
+ *                                                                  *
+ *  e: pointer to file                                              *
+ *                                                                  *
+ *  result: none                                                    *
+ *                                                                  *
+ ********************************************************************/
+void FreeFile(struct ingest_file *e) {
+	free(e->name);
+	free(e->apids);
+	free(e);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  print log line with date and time (UTC)                         *
+ *                                                                  *
+ *  fmt: format like printf()                                       *
+ *                                                                  *
+ *  result: none                                                    *
+ *                                                                  *
+ ********************************************************************/
+void Log(char *fmt, ...) {
+	/* argument list */
+	va_list ap;
+	/* current time */
+	time_t now;
+	struct tm tm;
+
+
+	now = time(NULL);
+	gmtime_r(&now, &tm);
+	printf("%04d/%02d/%02d %02d:%02d:%02d ",
+				 tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
+				 tm.tm_hour, tm.tm_min, tm.tm_sec);
+	va_start(ap, fmt);
+	vprintf(fmt, ap);
+	va_end(ap);
+	printf("\n");
+	fflush(stdout);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  signal handler                                                  *
+ *                                                                  *
+ *  Wakes up and terminates the main loop.                          *
+ *                                                                  *
+ *  sig: signal number                                              *
+ *                                                                  *
+ *  result: none                                                    *
+ *                                                                  *
+ ********************************************************************/
+void OnSignal(int sig) {
+	/* saved errno */
+	int saved = errno;
+
+
+	terminate = 1;
+	if(write(wake_fd, "s", 1) < 0) {
+		/* pipe full, main loop wakes up anyway */
+	}
+	errno = saved;
+}
@@ -0,0 +1,23 @@
+# ===========================================================================
+#	Begin Program Specific Block
+# ===========================================================================
+
+MAKEFILE = pdsingest.mk
+
+# Progam to make
+EXE	= pdsingest 
+
+# Object modules for EXE
+OBJ    	= pdsingest.o pds.o pdsio.o pdsstat.o pdsjoin.o pdsfilter.o 
+
+# Library locations
+LIBS 	= 
+
+# LIBS needed to compile EXE
+LLIBS 	= -lz -lbz2 -lpthread -lm
+
+
+# Include file locations
+INCLUDE = -DHAVE_ZLIB -DHAVE_BZLIB
+
+include $(MAKEFILE_APP_TEMPLATE)
@@ -0,0 +1,2307 @@
+/********************************************************************
+ *                                                                  *
+ *  Copyright (C) 2026                                              *
+ *  Geoscience Australia, Canberra, Australia                       *
+ *                                                                  *
+ *  This program is free software; you can redistribute it and/or   *
+ *  modify it under the terms of the GNU General Public License as  *
+ *  published by the Free Software Foundation; either version 2 of  *
+ *  the License, or (at your option) any later version.             *
+ *                                                                  *
+ *  This program is distributed in the hope that it will be         *
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied      *
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR         *
+ *  PURPOSE.  See the GNU General Public License for more details.  *
+ *                                                                  *
+ *  You should have received a copy of the GNU General Public       *
+ *  License along with this program; if not, write to the Free      *
+ *  Software Foundation, Inc., 59 Temple Place, Suite 330, Boston,  *
+ *  MA  02111-1307  USA                                             *
+ *                                                                  *
+ ********************************************************************
+ *                                                                  *
+ *  PDS file input and output with transparent (de)compression      *
+ *                                                                  *
+ *  18/10/2026  GA           initial version                        *
+ *  18/10/2026  GA           zstd compressed output in independent  *
+ *                           frames with time index and seek table  *
+ *  18/10/2026  GA           PDS archives (blocks with statistics   *
+ *                           and index)                             *
+ *  18/10/2026  GA           random access to plain files (PDSSeek, *
+ *                           PDSSize)                               *
+ *  18/10/2026  GA           plain files read from memory map, so   *
+ *                           skipped data isn't touched             *
+ *  18/10/2026  GA           format detection available to callers  *
+ *                           (PDSMagic)                             *
+ *                                                                  *
+ ********************************************************************
+ *                                                                  *
+ *  notes:                                                          *
+ *   - bgzip files and zstd files with more than one frame are      *
+ *     mapped into memory and their blocks/frames are decompressed  *
+ *     by a pool of threads into a ring of slots, which are handed  *
+ *     back to the reader in file order                             *
+ *   - plain files are mapped into memory if possible, data skipped *
+ *     by PDSSkip() isn't read at all                               *
+ *   - everything else is decompressed as a stream                 *
+ *   - compressed output is collected in frames, which are queued   *
+ *     to a pool of threads and written in order as they complete   *
+ *   - PDS archives are always mapped, their blocks are read in     *
+ *     index order, serially or by the thread pool                  *
+ *                                                                  *
+ ********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef HAVE_BZLIB
+#include <bzlib.h>
+#endif
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "pdsio.h"
+
+
+/********************************************************************
+ *                                                                  *
+ *  defines                                                         *
+ *                                                                  *
+ ********************************************************************/
+/* input buffer size for stream decompression */
+#define IN_SIZE 262144
+/* number of decompression slots per thread */
+#define SLOTS_PER_THREAD 4
+/* gzip header size of a bgzip block */
+#define BGZF_HDR_SIZE 18
+/* zstd frame magic number */
+#define ZSTD_MAGIC 0xFD2FB528UL
+/* zstd skippable frame magic number (lower 4 bits are user defined) */
+#define ZSTD_SKIP_MAGIC 0x184D2A50UL
+/* slot states */
+#define SLOT_FREE 0
+#define SLOT_BUSY 1
+#define SLOT_DONE 2
+#define SLOT_ERROR -1
+#define SLOT_QUEUED 3
+/* size of a time index entry */
+#define TIME_ENTRY_SIZE 16
+/* archive file header size */
+#define ARC_HDR_SIZE 8
+/* archive block header size (without statistics) */
+#define ARC_BLK_HDR_SIZE 24
+/* archive index entry size */
+#define ARC_ENTRY_SIZE 24
+/* archive trailer size */
+#define ARC_TRAILER_SIZE 16
+/* default compression levels of archive blocks */
+#define ZSTD_LEVEL 3
+#define DEFLATE_LEVEL 6
+
+
+/********************************************************************
+ *                                                                  *
+ *  structure definitions                                           *
+ *                                                                  *
+ ********************************************************************/
+/* decompression slot */
+struct pds_slot {
+	long seq;
+	int state;
+	unsigned char *out;
+	size_t outlen;
+	size_t outcap;
+};
+
+/* decompression thread pool */
+struct pds_pool {
+	pthread_t *thread;
+	int nthreads;
+	int maxthreads;
+	pthread_mutex_t lock;
+	pthread_cond_t work;
+	pthread_cond_t done;
+	struct pds_slot *slot;
+	int nslots;
+	long next;
+	long head;
+	int have;
+	int last;
+	int error;
+	int stop;
+	size_t pos;
+	size_t rpos;
+};
+
+/* compressed output frame */
+struct pds_frame {
+	long seq;
+	int state;
+	unsigned char *in;
+	size_t inlen;
+	size_t incap;
+	unsigned char *out;
+	size_t outlen;
+	size_t outcap;
+	int firstday, lastday;
+	unsigned long firstms, lastms;
+	int firstmics, lastmics;
+	int timed;
+	long packets;
+	struct pds_stats stats;
+};
+
+/* frame index entry */
+struct pds_index {
+	unsigned long long offset;
+	unsigned long csize;
+	unsigned long dsize;
+	int firstday, lastday;
+	unsigned long firstms, lastms;
+	int firstmics, lastmics;
+};
+
+/* PDS output file */
+struct pds_out {
+	FILE *f;
+	int format;
+	int codec;
+	int level;
+	unsigned long long offset;
+	int error;
+	size_t frame_size;
+	struct pds_frame *frame;
+	int nframes;
+	struct pds_frame *cur;
+	long next;
+	long queued;
+	long todo;
+	long written;
+	pthread_t *thread;
+	int nthreads;
+	pthread_mutex_t lock;
+	pthread_cond_t work;
+	pthread_cond_t done;
+	int stop;
+	void *ctx;
+	struct pds_index *index;
+	long nindex;
+	long capindex;
+};
+
+/* PDS file */
+struct pds_file {
+	int format;
+	int eof;
+	int error;
+	FILE *f;
+#ifdef HAVE_ZLIB
+	gzFile gz;
+#endif
+#ifdef HAVE_BZLIB
+	BZFILE *bz;
+#endif
+#ifdef HAVE_ZSTD
+	ZSTD_DStream *zd;
+	ZSTD_inBuffer zin;
+	size_t zret;
+#endif
+	unsigned char *in;
+	unsigned char *base;
+	size_t size;
+	struct pds_pool *pool;
+	unsigned char *aindex;
+	long nblocks;
+	size_t apos;
+	void *dctx;
+	unsigned char *blk;
+	size_t blklen;
+	size_t blkcap;
+	size_t blkpos;
+	int window;
+	long startday, startms;
+	long endday, endms;
+	int apid;
+	size_t pos;
+};
+
+
+/********************************************************************
+ *                                                                  *
+ *  function declarations                                           *
+ *                                                                  *
+ ********************************************************************/
+static int OpenStream(struct pds_file *f, char *name);
+static int OpenPool(struct pds_file *f, int threads);
+static int StartPool(struct pds_file *f);
+static int OpenArchive(struct pds_file *f);
+static int MapFile(struct pds_file *f);
+static int NextBlock(struct pds_file *f, size_t *pos,
+										 size_t *off, size_t *len, size_t *outlen);
+static int Decompress(struct pds_file *f, void *ctx,
+											unsigned char *in, size_t len,
+											unsigned char *out, size_t outlen);
+static void *PoolWorker(void *arg);
+static size_t ReadPool(struct pds_file *f, unsigned char *buf, size_t size);
+static size_t ReadStream(struct pds_file *f, unsigned char *buf,
+												 size_t size);
+static int SubmitFrame(struct pds_out *o);
+static int WriteFrame(struct pds_out *o);
+static int CompressFrame(struct pds_out *o, void *ctx,
+												 struct pds_frame *fr);
+static void *FrameWorker(void *arg);
+static int WriteIndex(struct pds_out *o);
+
+
+/********************************************************************
+ *                                                                  *
+ *  open PDS file                                                   *
+ *                                                                  *
+ *  name:    file name                                              *
+ *  threads: number of decompression threads (1 = no threads)       *
+ *                                                                  *
+ *  result:  pointer to PDS file                                    *
+ *           NULL - error                                           *
+ *                                                                  *
+ ********************************************************************/
+struct pds_file *PDSOpen(char *name, int threads) {
+	/* PDS file */
+	struct pds_file *f;
+	/* magic bytes */
+	unsigned char magic[BGZF_HDR_SIZE];
+	/* number of magic bytes read */
+	size_t n;
+
+
+	/* allocate memory */
+	if(!(f = calloc(1, sizeof(struct pds_file))))
+		return(NULL);
+
+	/* open file */
+	if(!(f->f = fopen(name, "rb"))) {
+		free(f);
+		return(NULL);
+	}
+
+	/* determine format from magic bytes */
+	n = fread(magic, 1, BGZF_HDR_SIZE, f->f);
+	f->format = PDSMagic(magic, n);
+	rewind(f->f);
+
+	/* read archive index */
+	if((f->format == PDS_FMT_ARCHIVE) && OpenArchive(f)) {
+		fprintf(stderr, "corrupted PDS archive (%s)\n", name);
+		PDSClose(f);
+		return(NULL);
+	}
+
+	/* try to decompress in parallel */
+	if((threads > 1) &&
+		 ((f->format == PDS_FMT_BGZF) || (f->format == PDS_FMT_ZSTD) ||
+			(f->format == PDS_FMT_ARCHIVE))) {
+		switch(OpenPool(f, threads)) {
+		case 0:
+			return(f);
+		case 1:
+			break;
+		default:
+			PDSClose(f);
+			return(NULL);
+		}
+	}
+
+	/* decompress as a stream */
+	if(OpenStream(f, name)) {
+		PDSClose(f);
+		return(NULL);
+	}
+
+	/* alles klar */
+	return(f);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  determine file format from magic bytes                          *
+ *                                                                  *
+ *  buf: pointer to start of file (18 bytes to tell bgzip from      *
+ *       gzip)                                                      *
+ *  n:   number of bytes in buffer                                  *
+ *                                                                  *
+ *  result: file format (PDS_FMT_...)                               *
+ *                                                                  *
+ ********************************************************************/
+int PDSMagic(unsigned char *buf, long n) {
+	/* file format */
+	int format = PDS_FMT_PLAIN;
+
+
+	/* gzip */
+	if((n >= 3) && (buf[0] == 0x1F) && (buf[1] == 0x8B) && (buf[2] == 8)) {
+		format = PDS_FMT_GZIP;
+
+		/* bgzip block? */
+		if((n >= BGZF_HDR_SIZE) && (buf[3] & 0x04) &&
+			 (buf[10] == 6) && (buf[11] == 0) &&
+			 (buf[12] == 'B') && (buf[13] == 'C') &&
+			 (buf[14] == 2) && (buf[15] == 0))
+			format = PDS_FMT_BGZF;
+	}
+
+	/* bzip2 */
+	if((n >= 3) && (buf[0] == 'B') && (buf[1] == 'Z') && (buf[2] == 'h'))
+		format = PDS_FMT_BZIP2;
+
+	/* zstd frame or skippable frame */
+	if((n >= 4) &&
+		 ((GetLE(buf, 4) == ZSTD_MAGIC) ||
+			((GetLE(buf, 4) & 0xFFFFFFF0UL) == ZSTD_SKIP_MAGIC)))
+		format = PDS_FMT_ZSTD;
+
+	/* PDS archive */
+	if((n >= 4) && !memcmp(buf, PDS_ARC_MAGIC, 4))
+		format = PDS_FMT_ARCHIVE;
+
+	/* fine */
+	return(format);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  read from PDS file                                              *
+ *                                                                  *
+ *  f:    pointer to PDS file                                       *
+ *  buf:  pointer to buffer                                         *
+ *  size: number of bytes to read                                   *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          -1 - read error or end of file                          *
+ *                                                                  *
+ ********************************************************************/
+int PDSRead(struct pds_file *f, unsigned char *buf, int size) {
+	/* number of bytes read */
+	size_t n;
+
+
+	/* read data */
+	if(f->pool)
+		n = ReadPool(f, buf, size);
+	else
+		n = ReadStream(f, buf, size);
+
+	/* all data read? */
+	if(n != size)
+		return(-1);
+
+	/* ois rodger */
+	return(0);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  skip data of PDS file                                           *
+ *                                                                  *
+ *  Plain files are positioned directly, compressed files have to   *
+ *  be decompressed anyway.                                         *
+ *                                                                  *
+ *  f:    pointer to PDS file                                       *
+ *  size: number of bytes to skip                                   *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          -1 - read error or end of file                          *
+ *                                                                  *
+ ********************************************************************/
+int PDSSkip(struct pds_file *f, long size) {
+	/* buffer */
+	unsigned char buf[IN_SIZE / 16];
+	/* number of bytes to read */
+	long n;
+
+
+	/* plain file? not past its end */
+	if((f->format == PDS_FMT_PLAIN) && f->base) {
+		if(f->pos + size > f->size) {
+			f->pos = f->size;
+			f->eof = 1;
+			return(-1);
+		}
+		f->pos += size;
+		return(0);
+	}
+	if((f->format == PDS_FMT_PLAIN) && !f->pool) {
+		if(fseek(f->f, size, SEEK_CUR)) {
+			f->error = 1;
+			return(-1);
+		}
+		return(0);
+	}
+
+	/* read and forget */
+	for(; size > 0; size -= n) {
+		n = (size > sizeof(buf)) ? sizeof(buf) : size;
+		if(PDSRead(f, buf, n))
+			return(-1);
+	}
+
+	/* passt */
+	return(0);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  position plain PDS file                                         *
+ *                                                                  *
+ *  f:      pointer to PDS file                                     *
+ *  offset: offset from start of file                               *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          -1 - not a plain file or seek error                     *
+ *                                                                  *
+ ********************************************************************/
+int PDSSeek(struct pds_file *f, long long offset) {
+	/* plain file? */
+	if((f->format != PDS_FMT_PLAIN) || f->pool)
+		return(-1);
+
+	/* position file, forget end of file */
+	if(f->base)
+		f->pos = offset;
+	else if(fseek(f->f, offset, SEEK_SET)) {
+		f->error = 1;
+		return(-1);
+	}
+	f->eof = 0;
+	f->error = 0;
+
+	/* gut */
+	return(0);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  get position in plain PDS file                                  *
+ *                                                                  *
+ *  f: pointer to PDS file                                          *
+ *                                                                  *
+ *  result: offset from start of file                               *
+ *          -1 - not a plain file                                   *
+ *                                                                  *
+ ********************************************************************/
+long long PDSTell(struct pds_file *f) {
+	/* plain file? */
+	if((f->format != PDS_FMT_PLAIN) || f->pool)
+		return(-1);
+
+	/* alles klar */
+	return(f->base ? (long long)f->pos : (long long)ftello(f->f));
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  get size of plain PDS file                                      *
+ *                                                                  *
+ *  f: pointer to PDS file                                          *
+ *                                                                  *
+ *  result: size of file                                            *
+ *          -1 - not a plain file                                   *
+ *                                                                  *
+ ********************************************************************/
+long long PDSSize(struct pds_file *f) {
+	/* file status */
+	struct stat st;
+
+
+	/* plain file? */
+	if((f->format != PDS_FMT_PLAIN) || f->pool ||
+		 fstat(fileno(f->f), &st))
+		return(-1);
+
+	/* passt */
+	return(st.st_size);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  test for end of PDS file                                        *
+ *                                                                  *
+ *  f: pointer to PDS file                                          *
+ *                                                                  *
+ *  result:  0 - not at end of file                                 *
+ *           1 - end of file reached                                *
+ *                                                                  *
+ ********************************************************************/
+int PDSEof(struct pds_file *f) {
+	return(f->eof && !f->error);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  get format of PDS file                                          *
+ *                                                                  *
+ *  f: pointer to PDS file                                          *
+ *                                                                  *
+ *  result:  format (PDS_FMT_...)                                   *
+ *                                                                  *
+ ********************************************************************/
+int PDSFormat(struct pds_file *f) {
+	return(f->format);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  limit reading of a PDS archive to a time range and an APID      *
+ *  (has to be called before reading)                               *
+ *                                                                  *
+ *  Blocks which have no packet in the time range or no packet of   *
+ *  the APID are skipped. Other formats are not affected.           *
+ *                                                                  *
+ *  f:             pointer to PDS file                              *
+ *  startday:      start date/time (days)                           *
+ *  startmillisec: start date/time (milliseconds)                   *
+ *  endday:        end date/time (days)                             *
+ *  endmillisec:   end date/time (milliseconds)                     *
+ *  apid:          APID (-1 = all APIDs)                            *
+ *                                                                  *
+ *  result:  none                                                   *
+ *                                                                  *
+ ********************************************************************/
+void PDSSetWindow(struct pds_file *f, int startday,
+									unsigned long startmillisec, int endday,
+									unsigned long endmillisec, int apid) {
+	f->window = 1;
+	f->startday = startday;
+	f->startms = startmillisec;
+	f->endday = endday;
+	f->endms = endmillisec;
+	f->apid = apid;
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  get statistics of a PDS archive from its block headers          *
+ *                                                                  *
+ *  f: pointer to PDS file                                          *
+ *  s: pointer to statistics                                        *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          -1 - not an archive, corrupted archive or out of memory *
+ *                                                                  *
+ ********************************************************************/
+int PDSArchiveStats(struct pds_file *f, struct pds_stats *s) {
+	/* block statistics */
+	struct pds_stats bs;
+	/* pointer to block */
+	unsigned char *b;
+	/* block offset and header size */
+	unsigned long long off, hsize;
+	/* counter */
+	long i;
+
+
+	/* initialise statistics */
+	StatInit(s);
+	if(f->format != PDS_FMT_ARCHIVE)
+		return(-1);
+
+	/* merge statistics of all blocks */
+	for(i = 0; i < f->nblocks; i++) {
+		off = GetLE(f->aindex + i * ARC_ENTRY_SIZE, 8);
+		if(off + ARC_BLK_HDR_SIZE > f->size)
+			return(-1);
+		b = f->base + off;
+		hsize = GetLE(b + 8, 4);
+		if(memcmp(b, PDS_BLK_MAGIC, 4) || (hsize < ARC_BLK_HDR_SIZE) ||
+			 (off + hsize > f->size))
+			return(-1);
+		if(StatDecode(b + ARC_BLK_HDR_SIZE, hsize - ARC_BLK_HDR_SIZE, &bs))
+			return(-1);
+		if(StatMerge(s, &bs)) {
+			StatFree(&bs);
+			return(-1);
+		}
+		StatFree(&bs);
+	}
+
+	/* gut */
+	return(0);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  close PDS file                                                  *
+ *                                                                  *
+ *  f: pointer to PDS file                                          *
+ *                                                                  *
+ *  result:  none                                                   *
+ *                                                                  *
+ ********************************************************************/
+void PDSClose(struct pds_file *f) {
+	/* pointer to thread pool */
+	struct pds_pool *p;
+	/* counter */
+	int i;
+
+
+	/* stop thread pool */
+	if((p = f->pool)) {
+		pthread_mutex_lock(&p->lock);
+		p->stop = 1;
+		pthread_cond_broadcast(&p->work);
+		pthread_mutex_unlock(&p->lock);
+		for(i = 0; i < p->nthreads; i++)
+			pthread_join(p->thread[i], NULL);
+		for(i = 0; i < p->nslots; i++)
+			free(p->slot[i].out);
+		pthread_cond_destroy(&p->done);
+		pthread_cond_destroy(&p->work);
+		pthread_mutex_destroy(&p->lock);
+		free(p->slot);
+		free(p->thread);
+		free(p);
+	}
+
+	/* close decompressors */
+#ifdef HAVE_ZLIB
+	if(f->gz)
+		gzclose(f->gz);
+#endif
+#ifdef HAVE_BZLIB
+	if(f->bz) {
+		int bzerror;
+		BZ2_bzReadClose(&bzerror, f->bz);
+	}
+#endif
+#ifdef HAVE_ZSTD
+	if(f->zd)
+		ZSTD_freeDStream(f->zd);
+	if(f->dctx)
+		ZSTD_freeDCtx(f->dctx);
+#endif
+
+	/* unmap file */
+	if(f->base)
+		munmap(f->base, f->size);
+
+	/* close file */
+	if(f->f)
+		fclose(f->f);
+
+	/* free memory */
+	free(f->blk);
+	free(f->in);
+	free(f);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  set up stream decompression                                     *
+ *                                                                  *
+ *  f:    pointer to PDS file                                       *
+ *  name: file name                                                 *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          -1 - error                                              *
+ *                                                                  *
+ ********************************************************************/
+static int OpenStream(struct pds_file *f, char *name) {
+	/* error code */
+	int error = 0;
+
+
+	switch(f->format) {
+	case PDS_FMT_PLAIN:
+		/* read from memory map if possible */
+		MapFile(f);
+		return(0);
+	case PDS_FMT_GZIP:
+	case PDS_FMT_BGZF:
+#ifdef HAVE_ZLIB
+		if(!(f->gz = gzopen(name, "rb")))
+			return(-1);
+		gzbuffer(f->gz, IN_SIZE);
+		return(0);
+#else
+		break;
+#endif
+	case PDS_FMT_BZIP2:
+#ifdef HAVE_BZLIB
+		f->bz = BZ2_bzReadOpen(&error, f->f, 0, 0, NULL, 0);
+		if(error != BZ_OK)
+			return(-1);
+		return(0);
+#else
+		break;
+#endif
+	case PDS_FMT_ZSTD:
+#ifdef HAVE_ZSTD
+		if(!(f->in = malloc(IN_SIZE)))
+			return(-1);
+		if(!(f->zd = ZSTD_createDStream()))
+			return(-1);
+		ZSTD_initDStream(f->zd);
+		f->zin.src = f->in;
+		f->zin.size = 0;
+		f->zin.pos = 0;
+		return(0);
+#else
+		break;
+#endif
+	case PDS_FMT_ARCHIVE:
+#ifdef HAVE_ZSTD
+		if(!(f->dctx = ZSTD_createDCtx()))
+			return(-1);
+#endif
+		return(0);
+	}
+
+	/* format not compiled in */
+	fprintf(stderr,
+					"compressed input not supported by this build (%s)\n",
+					name);
+	return(-1);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  set up parallel decompression                                   *
+ *                                                                  *
+ *  f:       pointer to PDS file                                    *
+ *  threads: number of threads                                      *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *           1 - file can't be decompressed in parallel             *
+ *          -1 - error                                              *
+ *                                                                  *
+ ********************************************************************/
+static int OpenPool(struct pds_file *f, int threads) {
+	/* pointer to thread pool */
+	struct pds_pool *p;
+	/* block position and size */
+	size_t pos, off, len, outlen;
+	/* number of blocks */
+	long blocks;
+	/* error code */
+	int error;
+	/* counter */
+	int i;
+
+
+	/* format compiled in? */
+#ifndef HAVE_ZLIB
+	if(f->format == PDS_FMT_BGZF)
+		return(1);
+#endif
+#ifndef HAVE_ZSTD
+	if(f->format == PDS_FMT_ZSTD)
+		return(1);
+#endif
+
+	/* map file */
+	if(!f->base && MapFile(f))
+		return(1);
+
+	/* zstd frames need to have their size stored, and more than
+		 one frame is needed to make threads worthwhile */
+	if(f->format == PDS_FMT_ZSTD) {
+		for(pos = 0, blocks = 0;
+				(error = NextBlock(f, &pos, &off, &len, &outlen)) > 0;
+				blocks++);
+		if((error < 0) || (blocks < 2)) {
+			munmap(f->base, f->size);
+			f->base = NULL;
+			return(1);
+		}
+	}
+
+	/* allocate thread pool */
+	if(!(p = calloc(1, sizeof(struct pds_pool))))
+		return(-1);
+	pthread_mutex_init(&p->lock, NULL);
+	pthread_cond_init(&p->work, NULL);
+	pthread_cond_init(&p->done, NULL);
+	f->pool = p;
+	p->nslots = threads * SLOTS_PER_THREAD;
+	if(!(p->slot = calloc(p->nslots, sizeof(struct pds_slot))))
+		return(-1);
+	for(i = 0; i < p->nslots; i++)
+		p->slot[i].seq = -1;
+	if(!(p->thread = calloc(threads, sizeof(pthread_t))))
+		return(-1);
+
+	/* threads are started on first read, after PDSSetWindow() */
+	p->maxthreads = threads;
+
+	/* all set */
+	return(0);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  start threads of thread pool                                    *
+ *                                                                  *
+ *  f: pointer to PDS file                                          *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          -1 - error                                              *
+ *                                                                  *
+ ********************************************************************/
+static int StartPool(struct pds_file *f) {
+	/* pointer to thread pool */
+	struct pds_pool *p = f->pool;
+	/* counter */
+	int i;
+
+
+	/* start threads */
+	for(i = 0; i < p->maxthreads; i++) {
+		if(pthread_create(&(p->thread[i]), NULL, PoolWorker, f))
+			break;
+		p->nthreads++;
+	}
+	if(p->nthreads == 0)
+		return(-1);
+
+	/* running */
+	return(0);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  map PDS archive and read its index                              *
+ *                                                                  *
+ *  f: pointer to PDS file                                          *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          -1 - error                                              *
+ *                                                                  *
+ ********************************************************************/
+static int OpenArchive(struct pds_file *f) {
+	/* pointer to trailer */
+	unsigned char *t;
+	/* index offset */
+	unsigned long long off;
+
+
+	/* map file */
+	if(MapFile(f) || (f->size < ARC_HDR_SIZE + ARC_TRAILER_SIZE))
+		return(-1);
+
+	/* check version */
+	if(GetLE(f->base + 4, 2) > PDS_ARC_VERSION)
+		return(-1);
+
+	/* read trailer */
+	t = f->base + f->size - ARC_TRAILER_SIZE;
+	if(memcmp(t + 12, PDS_END_MAGIC, 4))
+		return(-1);
+	off = GetLE(t, 8);
+	f->nblocks = GetLE(t + 8, 4);
+
+	/* check index */
+	if((off + 8 + (unsigned long long)f->nblocks * ARC_ENTRY_SIZE >
+			f->size - ARC_TRAILER_SIZE) ||
+		 memcmp(f->base + off, PDS_IDX_MAGIC, 4) ||
+		 (GetLE(f->base + off + 4, 4) != f->nblocks))
+		return(-1);
+	f->aindex = f->base + off + 8;
+
+	/* bon */
+	return(0);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  map PDS file into memory                                        *
+ *                                                                  *
+ *  f: pointer to PDS file                                          *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          -1 - error                                              *
+ *                                                                  *
+ ********************************************************************/
+static int MapFile(struct pds_file *f) {
+	/* file status */
+	struct stat st;
+	/* mapped memory */
+	void *base;
+
+
+	/* get file size */
+	if(fstat(fileno(f->f), &st) || !S_ISREG(st.st_mode) ||
+		 (st.st_size == 0))
+		return(-1);
+
+	/* map file */
+	base = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fileno(f->f), 0);
+	if(base == MAP_FAILED)
+		return(-1);
+	madvise(base, st.st_size, MADV_SEQUENTIAL);
+	f->base = base;
+	f->size = st.st_size;
+
+	/* fertig */
+	return(0);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  find next compressed block in mapped file                       *
+ *                                                                  *
+ *  f:      pointer to PDS file                                     *
+ *  pos:    pointer to scan position (updated)                      *
+ *  off:    pointer to store block offset                           *
+ *  len:    pointer to store compressed block size                  *
+ *  outlen: pointer to store decompressed block size                *
+ *                                                                  *
+ *  result:  1 - block found                                        *
+ *           0 - end of file                                        *
+ *          -1 - corrupted block                                    *
+ *                                                                  *
+ ********************************************************************/
+static int NextBlock(struct pds_file *f, size_t *pos,
+										 size_t *off, size_t *len, size_t *outlen) {
+	/* pointer to block */
+	unsigned char *b;
+	/* remaining bytes */
+	size_t remain;
+	/* pointer to archive index entry */
+	unsigned char *e;
+	/* archive block offset and sizes */
+	unsigned long long boff, hsize;
+	/* block statistics */
+	struct pds_stats bs;
+	/* flag for APID found in block */
+	int found;
+#ifdef HAVE_ZSTD
+	/* frame sizes */
+	unsigned long long csize, dsize;
+#endif
+
+
+	/* archive block (pos counts index entries) */
+	while(f->format == PDS_FMT_ARCHIVE) {
+		if(*pos >= f->nblocks)
+			return(0);
+		e = f->aindex + (*pos)++ * ARC_ENTRY_SIZE;
+
+		/* outside of time window? (blocks without time aren't skipped) */
+		if(f->window && (e[8] | e[9] | e[16] | e[17])) {
+			if(((int)GetLE(e + 16, 2) < f->startday) ||
+				 (((int)GetLE(e + 16, 2) == f->startday) &&
+					(GetLE(e + 18, 4) < f->startms)))
+				continue;
+			if(((int)GetLE(e + 8, 2) > f->endday) ||
+				 (((int)GetLE(e + 8, 2) == f->endday) &&
+					(GetLE(e + 10, 4) >= f->endms)))
+				continue;
+		}
+
+		/* check block */
+		boff = GetLE(e, 8);
+		if(boff + ARC_BLK_HDR_SIZE > f->size)
+			return(-1);
+		b = f->base + boff;
+		hsize = GetLE(b + 8, 4);
+		if(memcmp(b, PDS_BLK_MAGIC, 4) || (hsize < ARC_BLK_HDR_SIZE) ||
+			 (boff + hsize + GetLE(b + 12, 4) > f->size))
+			return(-1);
+
+		/* APID in block? */
+		if(f->window && (f->apid >= 0)) {
+			if(StatDecode(b + ARC_BLK_HDR_SIZE, hsize - ARC_BLK_HDR_SIZE, &bs))
+				return(-1);
+			found = (FindAPIDInfo(bs.apidlist, f->apid) != NULL);
+			StatFree(&bs);
+			if(!found)
+				continue;
+		}
+
+		*off = boff;
+		*len = hsize + GetLE(b + 12, 4);
+		*outlen = GetLE(b + 16, 4);
+		return(1);
+	}
+
+	for(;;) {
+		/* end of file? */
+		if(*pos >= f->size)
+			return(0);
+		b = f->base + *pos;
+		remain = f->size - *pos;
+
+		/* bgzip block */
+		if(f->format == PDS_FMT_BGZF) {
+			if((remain < BGZF_HDR_SIZE) ||
+				 (b[0] != 0x1F) || (b[1] != 0x8B) || (b[2] != 8) ||
+				 !(b[3] & 0x04) || (b[10] != 6) || (b[11] != 0) ||
+				 (b[12] != 'B') || (b[13] != 'C'))
+				return(-1);
+			*len = GetLE(b + 16, 2) + 1;
+			if((*len > remain) || (*len < BGZF_HDR_SIZE + 8))
+				return(-1);
+			*off = *pos;
+			*outlen = GetLE(b + *len - 4, 4);
+			*pos += *len;
+			return(1);
+		}
+
+#ifdef HAVE_ZSTD
+		/* skip skippable zstd frames */
+		if(remain < 8)
+			return(-1);
+		if((GetLE(b, 4) & 0xFFFFFFF0UL) == ZSTD_SKIP_MAGIC) {
+			csize = GetLE(b + 4, 4) + 8ULL;
+			if(csize > remain)
+				return(-1);
+			*pos += csize;
+			continue;
+		}
+
+		/* zstd frame */
+		csize = ZSTD_findFrameCompressedSize(b, remain);
+		dsize = ZSTD_getFrameContentSize(b, remain);
+		if(ZSTD_isError(csize) ||
+			 (dsize == ZSTD_CONTENTSIZE_UNKNOWN) ||
+			 (dsize == ZSTD_CONTENTSIZE_ERROR))
+			return(-1);
+		*off = *pos;
+		*len = csize;
+		*outlen = dsize;
+		*pos += csize;
+		return(1);
+#else
+		return(-1);
+#endif
+	}
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  decompress a single block                                       *
+ *                                                                  *
+ *  f:      pointer to PDS file                                     *
+ *  ctx:    decompression context of calling thread                 *
+ *  in:     pointer to compressed block                             *
+ *  len:    compressed block size                                   *
+ *  out:    pointer to output buffer                                *
+ *  outlen: decompressed block size                                 *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          -1 - error                                              *
+ *                                                                  *
+ ********************************************************************/
+static int Decompress(struct pds_file *f, void *ctx,
+											unsigned char *in, size_t len,
+											unsigned char *out, size_t outlen) {
+#ifdef HAVE_ZLIB
+	/* deflate stream */
+	z_stream z;
+	/* error code */
+	int error;
+	/* uncompressed size */
+	uLongf n;
+#endif
+	/* archive block header size */
+	size_t hsize;
+
+
+	/* archive block */
+	if(f->format == PDS_FMT_ARCHIVE) {
+		hsize = GetLE(in + 8, 4);
+		switch(in[4]) {
+		case PDS_CODEC_STORE:
+			if(len - hsize != outlen)
+				return(-1);
+			memcpy(out, in + hsize, outlen);
+			return(0);
+#ifdef HAVE_ZLIB
+		case PDS_CODEC_DEFLATE:
+			n = outlen;
+			if((uncompress(out, &n, in + hsize, len - hsize) != Z_OK) ||
+				 (n != outlen))
+				return(-1);
+			return(0);
+#endif
+#ifdef HAVE_ZSTD
+		case PDS_CODEC_ZSTD:
+			if(ZSTD_decompressDCtx(ctx, out, outlen,
+														 in + hsize, len - hsize) != outlen)
+				return(-1);
+			return(0);
+#endif
+		}
+		return(-1);
+	}
+
+#ifdef HAVE_ZLIB
+	if(f->format == PDS_FMT_BGZF) {
+		/* raw deflate data between header and CRC32/ISIZE */
+		memset(&z, 0, sizeof(z));
+		if(inflateInit2(&z, -15) != Z_OK)
+			return(-1);
+		z.next_in = in + BGZF_HDR_SIZE;
+		z.avail_in = len - BGZF_HDR_SIZE - 8;
+		z.next_out = out;
+		z.avail_out = outlen;
+		error = inflate(&z, Z_FINISH);
+		inflateEnd(&z);
+		if((error != Z_STREAM_END) || (z.total_out != outlen))
+			return(-1);
+
+		/* check CRC */
+		if(crc32(crc32(0L, Z_NULL, 0), out, outlen) !=
+			 GetLE(in + len - 8, 4))
+			return(-1);
+		return(0);
+	}
+#endif
+
+#ifdef HAVE_ZSTD
+	if(f->format == PDS_FMT_ZSTD) {
+		if(ZSTD_decompressDCtx(ctx, out, outlen, in, len) != outlen)
+			return(-1);
+		return(0);
+	}
+#endif
+
+	/* unsupported format */
+	return(-1);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  decompression thread                                            *
+ *                                                                  *
+ *  arg: pointer to PDS file                                        *
+ *                                                                  *
+ *  result: NULL                                                    *
+ *                                                                  *
+ ********************************************************************/
+static void *PoolWorker(void *arg) {
+	/* PDS file */
+	struct pds_file *f = arg;
+	/* pointer to thread pool */
+	struct pds_pool *p = f->pool;
+	/* pointer to slot */
+	struct pds_slot *s;
+	/* block position and size */
+	size_t off, len, outlen;
+	/* buffer */
+	unsigned char *buf;
+	/* decompression context */
+	void *ctx = NULL;
+	/* error code */
+	int error;
+
+
+#ifdef HAVE_ZSTD
+	if((f->format == PDS_FMT_ZSTD) || (f->format == PDS_FMT_ARCHIVE))
+		ctx = ZSTD_createDCtx();
+#endif
+
+	for(;;) {
+		/* wait for a free slot */
+		pthread_mutex_lock(&p->lock);
+		while(!p->stop && !p->last && (p->next >= p->head + p->nslots))
+			pthread_cond_wait(&p->work, &p->lock);
+		if(p->stop || p->last) {
+			pthread_mutex_unlock(&p->lock);
+			break;
+		}
+
+		/* get next block */
+		if((error = NextBlock(f, &p->pos, &off, &len, &outlen)) <= 0) {
+			p->last = 1;
+			p->error = (error < 0);
+			pthread_cond_broadcast(&p->work);
+			pthread_cond_broadcast(&p->done);
+			pthread_mutex_unlock(&p->lock);
+			break;
+		}
+		s = &(p->slot[p->next % p->nslots]);
+		s->seq = p->next++;
+		s->state = SLOT_BUSY;
+		pthread_mutex_unlock(&p->lock);
+
+		/* decompress block */
+		error = 0;
+		if(s->outcap < outlen) {
+			if((buf = realloc(s->out, outlen))) {
+				s->out = buf;
+				s->outcap = outlen;
+			} else
+				error = -1;
+		}
+		if(!error)
+			error = Decompress(f, ctx, f->base + off, len, s->out, outlen);
+
+		/* hand block to reader */
+		pthread_mutex_lock(&p->lock);
+		s->outlen = outlen;
+		s->state = error ? SLOT_ERROR : SLOT_DONE;
+		pthread_cond_broadcast(&p->done);
+		pthread_mutex_unlock(&p->lock);
+	}
+
+#ifdef HAVE_ZSTD
+	if(ctx)
+		ZSTD_freeDCtx(ctx);
+#endif
+
+	/* tschuess */
+	return(NULL);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  read from thread pool                                           *
+ *                                                                  *
+ *  f:    pointer to PDS file                                       *
+ *  buf:  pointer to buffer                                         *
+ *  size: number of bytes to read                                   *
+ *                                                                  *
+ *  result: number of bytes read                                    *
+ *                                                                  *
+ ********************************************************************/
+static size_t ReadPool(struct pds_file *f, unsigned char *buf, size_t size) {
+	/* pointer to thread pool */
+	struct pds_pool *p = f->pool;
+	/* pointer to slot */
+	struct pds_slot *s;
+	/* number of bytes read */
+	size_t total = 0, n;
+
+
+	/* start threads on first read */
+	if((p->nthreads == 0) && StartPool(f)) {
+		f->error = 1;
+		return(0);
+	}
+
+	while(total < size) {
+		s = &(p->slot[p->head % p->nslots]);
+
+		/* wait for next block */
+		if(!p->have) {
+			pthread_mutex_lock(&p->lock);
+			while(!((s->seq == p->head) &&
+							((s->state == SLOT_DONE) || (s->state == SLOT_ERROR))) &&
+						!(p->last && (p->head >= p->next)))
+				pthread_cond_wait(&p->done, &p->lock);
+			if((s->seq != p->head) || (s->state != SLOT_DONE)) {
+				if((s->seq == p->head) || p->error)
+					f->error = 1;
+				f->eof = 1;
+				pthread_mutex_unlock(&p->lock);
+				break;
+			}
+			pthread_mutex_unlock(&p->lock);
+			p->have = 1;
+		}
+
+		/* copy data */
+		n = s->outlen - p->rpos;
+		if(n > size - total)
+			n = size - total;
+		memcpy(buf + total, s->out + p->rpos, n);
+		total += n;
+		p->rpos += n;
+
+		/* release slot */
+		if(p->rpos == s->outlen) {
+			pthread_mutex_lock(&p->lock);
+			s->state = SLOT_FREE;
+			p->head++;
+			p->have = 0;
+			p->rpos = 0;
+			pthread_cond_broadcast(&p->work);
+			pthread_mutex_unlock(&p->lock);
+		}
+	}
+
+	/* that's it */
+	return(total);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  read from decompression stream                                  *
+ *                                                                  *
+ *  f:    pointer to PDS file                                       *
+ *  buf:  pointer to buffer                                         *
+ *  size: number of bytes to read                                   *
+ *                                                                  *
+ *  result: number of bytes read                                    *
+ *                                                                  *
+ ********************************************************************/
+static size_t ReadStream(struct pds_file *f, unsigned char *buf,
+												 size_t size) {
+	/* number of bytes read */
+	size_t total = 0;
+	/* error code */
+	int error;
+#ifdef HAVE_BZLIB
+	/* character buffer */
+	int c;
+	/* unused data after bzip2 stream */
+	void *unused;
+	int nunused;
+	unsigned char tmp[BZ_MAX_UNUSED];
+#endif
+#ifdef HAVE_ZSTD
+	/* output buffer */
+	ZSTD_outBuffer zout;
+#endif
+	/* number of bytes read/copied */
+	size_t n;
+	/* archive block position and size */
+	size_t off, len, outlen;
+	/* new buffer */
+	unsigned char *p;
+
+
+	switch(f->format) {
+	case PDS_FMT_PLAIN:
+		if(f->base) {
+			total = (f->pos < f->size) ? f->size - f->pos : 0;
+			if(total > size)
+				total = size;
+			memcpy(buf, f->base + f->pos, total);
+			f->pos += total;
+			if(total != size)
+				f->eof = 1;
+			break;
+		}
+		total = fread(buf, 1, size, f->f);
+		if(total != size) {
+			if(feof(f->f))
+				f->eof = 1;
+			else
+				f->error = 1;
+		}
+		break;
+
+#ifdef HAVE_ZLIB
+	case PDS_FMT_GZIP:
+	case PDS_FMT_BGZF:
+		if((error = gzread(f->gz, buf, size)) < 0) {
+			f->error = 1;
+			break;
+		}
+		total = error;
+		if(total != size) {
+			gzerror(f->gz, &error);
+			if(gzeof(f->gz) && (error == Z_OK || error == Z_BUF_ERROR))
+				f->eof = 1;
+			else
+				f->error = 1;
+		}
+		break;
+#endif
+
+#ifdef HAVE_BZLIB
+	case PDS_FMT_BZIP2:
+		while((total < size) && f->bz) {
+			total += BZ2_bzRead(&error, f->bz, buf + total, size - total);
+			if(error == BZ_OK)
+				continue;
+			if(error != BZ_STREAM_END) {
+				f->error = 1;
+				break;
+			}
+
+			/* another stream concatenated to this one (e.g. pbzip2)? */
+			BZ2_bzReadGetUnused(&error, f->bz, &unused, &nunused);
+			memcpy(tmp, unused, nunused);
+			BZ2_bzReadClose(&error, f->bz);
+			f->bz = NULL;
+			if((nunused == 0) && ((c = fgetc(f->f)) == EOF))
+				break;
+			if(nunused == 0)
+				ungetc(c, f->f);
+			f->bz = BZ2_bzReadOpen(&error, f->f, 0, 0, tmp, nunused);
+			if(error != BZ_OK) {
+				f->bz = NULL;
+				f->error = 1;
+			}
+		}
+		if((total != size) && !f->error)
+			f->eof = 1;
+		break;
+#endif
+
+#ifdef HAVE_ZSTD
+	case PDS_FMT_ZSTD:
+		zout.dst = buf;
+		zout.size = size;
+		zout.pos = 0;
+		while(zout.pos < zout.size) {
+			/* refill input buffer */
+			if(f->zin.pos == f->zin.size) {
+				n = fread(f->in, 1, IN_SIZE, f->f);
+				if(n == 0) {
+					/* end of file in the middle of a frame? */
+					if(ferror(f->f) || (f->zret != 0))
+						f->error = 1;
+					f->eof = 1;
+					break;
+				}
+				f->zin.size = n;
+				f->zin.pos = 0;
+			}
+
+			/* decompress */
+			f->zret = ZSTD_decompressStream(f->zd, &zout, &(f->zin));
+			if(ZSTD_isError(f->zret)) {
+				f->error = 1;
+				break;
+			}
+		}
+		total = zout.pos;
+		break;
+#endif
+
+	case PDS_FMT_ARCHIVE:
+		while(total < size) {
+			/* decompress next block */
+			if(f->blkpos == f->blklen) {
+				if((error = NextBlock(f, &(f->apos), &off, &len, &outlen)) <= 0) {
+					if(error < 0)
+						f->error = 1;
+					f->eof = 1;
+					break;
+				}
+				if(f->blkcap < outlen) {
+					if(!(p = realloc(f->blk, outlen))) {
+						f->error = 1;
+						break;
+					}
+					f->blk = p;
+					f->blkcap = outlen;
+				}
+				if(Decompress(f, f->dctx, f->base + off, len, f->blk, outlen)) {
+					f->error = 1;
+					break;
+				}
+				f->blklen = outlen;
+				f->blkpos = 0;
+			}
+
+			/* copy data */
+			n = f->blklen - f->blkpos;
+			if(n > size - total)
+				n = size - total;
+			memcpy(buf + total, f->blk + f->blkpos, n);
+			total += n;
+			f->blkpos += n;
+		}
+		break;
+
+	default:
+		f->error = 1;
+		break;
+	}
+
+	/* done */
+	return(total);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  create PDS output file                                          *
+ *                                                                  *
+ *  name:       file name                                           *
+ *  format:     PDS_FMT_PLAIN, PDS_FMT_ZSTD or PDS_FMT_ARCHIVE      *
+ *  level:      compression level (archive: 0 = default)            *
+ *  threads:    number of compression threads (1 = no threads)      *
+ *  frame_size: uncompressed size of compressed frames/blocks       *
+ *                                                                  *
+ *  result:  pointer to PDS output file                             *
+ *           NULL - error                                           *
+ *                                                                  *
+ ********************************************************************/
+struct pds_out *PDSCreate(char *name, int format, int level, int threads,
+													long frame_size) {
+	/* PDS output file */
+	struct pds_out *o;
+	/* archive file header */
+	unsigned char buf[ARC_HDR_SIZE];
+	/* counter */
+	int i;
+
+
+#ifndef HAVE_ZSTD
+	/* compression compiled in? */
+	if(format == PDS_FMT_ZSTD) {
+		fprintf(stderr, "zstd output not supported by this build\n");
+		return(NULL);
+	}
+#endif
+
+	/* allocate memory */
+	if(!(o = calloc(1, sizeof(struct pds_out))))
+		return(NULL);
+	pthread_mutex_init(&o->lock, NULL);
+	pthread_cond_init(&o->work, NULL);
+	pthread_cond_init(&o->done, NULL);
+	o->format = format;
+	o->level = level;
+	o->frame_size = (frame_size > 0) ? frame_size : PDS_FRAME_SIZE;
+
+	/* block codec, best available for archives */
+	o->codec = PDS_CODEC_ZSTD;
+	if(format == PDS_FMT_ARCHIVE) {
+#if defined(HAVE_ZSTD)
+		if(level <= 0)
+			o->level = ZSTD_LEVEL;
+#elif defined(HAVE_ZLIB)
+		o->codec = PDS_CODEC_DEFLATE;
+		if((level <= 0) || (level > 9))
+			o->level = DEFLATE_LEVEL;
+#else
+		o->codec = PDS_CODEC_STORE;
+#endif
+	}
+
+	/* create file */
+	if(!(o->f = fopen(name, "wb"))) {
+		PDSFinish(o);
+		return(NULL);
+	}
+
+	/* plain output? */
+	if(format == PDS_FMT_PLAIN)
+		return(o);
+
+	/* archive file header */
+	if(format == PDS_FMT_ARCHIVE) {
+		memcpy(buf, PDS_ARC_MAGIC, 4);
+		PutLE(buf + 4, PDS_ARC_VERSION, 2);
+		buf[6] = 0;
+		buf[7] = 0;
+		if(fwrite(buf, ARC_HDR_SIZE, 1, o->f) != 1) {
+			o->error = 1;
+			PDSFinish(o);
+			return(NULL);
+		}
+		o->offset = ARC_HDR_SIZE;
+	}
+
+	/* allocate frames, two per thread so threads are kept busy
+		 while finished frames are written */
+	o->nframes = (threads > 1) ? 2 * threads : 1;
+	if(!(o->frame = calloc(o->nframes, sizeof(struct pds_frame)))) {
+		o->error = 1;
+		PDSFinish(o);
+		return(NULL);
+	}
+	for(i = 0; i < o->nframes; i++)
+		o->frame[i].seq = -1;
+	o->cur = &(o->frame[0]);
+	o->cur->seq = 0;
+	o->cur->state = SLOT_BUSY;
+	StatInit(&(o->cur->stats));
+
+	/* start threads */
+	if(threads > 1) {
+		if(!(o->thread = calloc(threads, sizeof(pthread_t)))) {
+			o->error = 1;
+			PDSFinish(o);
+			return(NULL);
+		}
+		for(i = 0; i < threads; i++) {
+			if(pthread_create(&(o->thread[i]), NULL, FrameWorker, o))
+				break;
+			o->nthreads++;
+		}
+	}
+
+#ifdef HAVE_ZSTD
+	/* compression context for main thread */
+	if((o->nthreads == 0) && (o->codec == PDS_CODEC_ZSTD)) {
+		if(!(o->ctx = ZSTD_createCCtx())) {
+			o->error = 1;
+			PDSFinish(o);
+			return(NULL);
+		}
+	}
+#endif
+
+	/* voila */
+	return(o);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  mark start of a packet in PDS output file                       *
+ *                                                                  *
+ *  o:    pointer to PDS output file                                *
+ *  info: pointer to info of packet written next                    *
+ *                                                                  *
+ *  result:  none                                                   *
+ *                                                                  *
+ ********************************************************************/
+void PDSMark(struct pds_out *o, struct pkt_info *info) {
+	/* pointer to current frame */
+	struct pds_frame *fr;
+
+
+	/* plain output? */
+	if(o->format == PDS_FMT_PLAIN)
+		return;
+
+	/* frame full? then start a new frame at this packet */
+	if(o->cur->inlen >= o->frame_size) {
+		if(SubmitFrame(o))
+			o->error = 1;
+	}
+	fr = o->cur;
+	fr->packets++;
+
+	/* add packet to block statistics */
+	if((o->format == PDS_FMT_ARCHIVE) && StatAdd(&(fr->stats), info))
+		o->error = 1;
+
+	/* store time range of frame */
+	if((info->apid < 0) || !info->modis)
+		return;
+	if(!fr->timed) {
+		fr->firstday = info->days;
+		fr->firstms = info->millisec;
+		fr->firstmics = info->microsec;
+		fr->timed = 1;
+	}
+	fr->lastday = info->days;
+	fr->lastms = info->millisec;
+	fr->lastmics = info->microsec;
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  continue plain PDS output file                                  *
+ *                                                                  *
+ *  The file is cut to the given size (e.g. the size at a           *
+ *  checkpoint) and written from there on.                          *
+ *                                                                  *
+ *  name: file name                                                 *
+ *  size: size of file to keep                                      *
+ *                                                                  *
+ *  result:  pointer to PDS output file                             *
+ *           NULL - error                                           *
+ *                                                                  *
+ ********************************************************************/
+struct pds_out *PDSAppend(char *name, long long size) {
+	/* PDS output file */
+	struct pds_out *o;
+
+
+	/* allocate memory */
+	if(!(o = calloc(1, sizeof(struct pds_out))))
+		return(NULL);
+	pthread_mutex_init(&o->lock, NULL);
+	pthread_cond_init(&o->work, NULL);
+	pthread_cond_init(&o->done, NULL);
+	o->format = PDS_FMT_PLAIN;
+
+	/* cut file and position at end */
+	if(truncate(name, (off_t)size) || !(o->f = fopen(name, "r+b")) ||
+		 fseeko(o->f, (off_t)size, SEEK_SET)) {
+		PDSFinish(o);
+		return(NULL);
+	}
+
+	/* tschuess */
+	return(o);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  flush plain PDS output file                                     *
+ *                                                                  *
+ *  o: pointer to PDS output file                                   *
+ *                                                                  *
+ *  result: size of file written so far                             *
+ *          -1 - not a plain file or write error                    *
+ *                                                                  *
+ ********************************************************************/
+long long PDSFlush(struct pds_out *o) {
+	/* plain file? */
+	if((o->format != PDS_FMT_PLAIN) || o->error)
+		return(-1);
+
+	/* flush buffer */
+	if(fflush(o->f)) {
+		o->error = 1;
+		return(-1);
+	}
+
+	/* voila */
+	return((long long)ftello(o->f));
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  write to PDS output file                                        *
+ *                                                                  *
+ *  o:    pointer to PDS output file                                *
+ *  buf:  pointer to buffer                                         *
+ *  size: number of bytes to write                                  *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          -1 - write error                                        *
+ *                                                                  *
+ ********************************************************************/
+int PDSWrite(struct pds_out *o, unsigned char *buf, int size) {
+	/* pointer to current frame */
+	struct pds_frame *fr;
+	/* new buffer */
+	unsigned char *p;
+	/* new buffer size */
+	size_t n;
+
+
+	/* previous error? */
+	if(o->error)
+		return(-1);
+
+	/* plain output */
+	if(o->format == PDS_FMT_PLAIN) {
+		if(fwrite(buf, size, 1, o->f) != 1) {
+			o->error = 1;
+			return(-1);
+		}
+		return(0);
+	}
+
+	/* make room in frame buffer */
+	fr = o->cur;
+	if(fr->inlen + size > fr->incap) {
+		n = (fr->incap > 0) ? fr->incap : o->frame_size + 65536;
+		while(n < fr->inlen + size)
+			n *= 2;
+		if(!(p = realloc(fr->in, n))) {
+			o->error = 1;
+			return(-1);
+		}
+		fr->in = p;
+		fr->incap = n;
+	}
+
+	/* append data to frame */
+	memcpy(fr->in + fr->inlen, buf, size);
+	fr->inlen += size;
+
+	/* passt */
+	return(0);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  finish and close PDS output file                                *
+ *                                                                  *
+ *  o: pointer to PDS output file                                   *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          -1 - write error                                        *
+ *                                                                  *
+ ********************************************************************/
+int PDSFinish(struct pds_out *o) {
+	/* counter */
+	int i;
+	/* return value */
+	int retvalue;
+
+
+	/* flush frames and write index */
+	if(o->f && (o->format != PDS_FMT_PLAIN) && !o->error) {
+		if(o->cur->inlen > 0)
+			if(SubmitFrame(o))
+				o->error = 1;
+		while(!o->error && (o->written < o->queued))
+			if(WriteFrame(o))
+				o->error = 1;
+		if(!o->error && WriteIndex(o))
+			o->error = 1;
+	}
+
+	/* stop threads */
+	pthread_mutex_lock(&o->lock);
+	o->stop = 1;
+	pthread_cond_broadcast(&o->work);
+	pthread_mutex_unlock(&o->lock);
+	for(i = 0; i < o->nthreads; i++)
+		pthread_join(o->thread[i], NULL);
+
+	/* close file */
+	if(o->f && fclose(o->f))
+		o->error = 1;
+	retvalue = o->error ? -1 : 0;
+
+	/* free memory */
+#ifdef HAVE_ZSTD
+	if(o->ctx)
+		ZSTD_freeCCtx(o->ctx);
+#endif
+	for(i = 0; i < o->nframes; i++) {
+		free(o->frame[i].in);
+		free(o->frame[i].out);
+		StatFree(&(o->frame[i].stats));
+	}
+	pthread_cond_destroy(&o->done);
+	pthread_cond_destroy(&o->work);
+	pthread_mutex_destroy(&o->lock);
+	free(o->frame);
+	free(o->thread);
+	free(o->index);
+	free(o);
+
+	/* und tschuess */
+	return(retvalue);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  queue current frame for compression and start a new one         *
+ *                                                                  *
+ *  o: pointer to PDS output file                                   *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          -1 - error                                              *
+ *                                                                  *
+ ********************************************************************/
+static int SubmitFrame(struct pds_out *o) {
+	/* pointer to frame */
+	struct pds_frame *fr = o->cur;
+
+
+	/* compress frame */
+	if(o->nthreads == 0) {
+		if(CompressFrame(o, o->ctx, fr))
+			return(-1);
+		fr->state = SLOT_DONE;
+		o->queued++;
+	} else {
+		pthread_mutex_lock(&o->lock);
+		fr->state = SLOT_QUEUED;
+		o->queued++;
+		pthread_cond_broadcast(&o->work);
+		pthread_mutex_unlock(&o->lock);
+	}
+
+	/* write finished frames until the next slot is free */
+	o->next++;
+	while(o->written <= o->next - o->nframes)
+		if(WriteFrame(o))
+			return(-1);
+
+	/* start new frame */
+	fr = o->cur = &(o->frame[o->next % o->nframes]);
+	fr->seq = o->next;
+	fr->state = SLOT_BUSY;
+	fr->inlen = 0;
+	fr->timed = 0;
+	fr->packets = 0;
+	StatInit(&(fr->stats));
+
+	/* gut */
+	return(0);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  write oldest frame to file                                      *
+ *                                                                  *
+ *  o: pointer to PDS output file                                   *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          -1 - error                                              *
+ *                                                                  *
+ ********************************************************************/
+static int WriteFrame(struct pds_out *o) {
+	/* pointer to frame */
+	struct pds_frame *fr = &(o->frame[o->written % o->nframes]);
+	/* pointer to index entry */
+	struct pds_index *ix;
+	/* block header */
+	unsigned char *hdr;
+	/* block header size */
+	int hsize = 0;
+
+
+	/* wait for frame to be compressed */
+	pthread_mutex_lock(&o->lock);
+	while((fr->state != SLOT_DONE) && (fr->state != SLOT_ERROR))
+		pthread_cond_wait(&o->done, &o->lock);
+	pthread_mutex_unlock(&o->lock);
+	if(fr->state == SLOT_ERROR)
+		return(-1);
+
+	/* write archive block header */
+	if(o->format == PDS_FMT_ARCHIVE) {
+		hsize = ARC_BLK_HDR_SIZE + StatEncode(&(fr->stats), NULL);
+		if(!(hdr = calloc(hsize, 1)))
+			return(-1);
+		memcpy(hdr, PDS_BLK_MAGIC, 4);
+		hdr[4] = o->codec;
+		PutLE(hdr + 8, hsize, 4);
+		PutLE(hdr + 12, fr->outlen, 4);
+		PutLE(hdr + 16, fr->inlen, 4);
+		PutLE(hdr + 20, fr->packets, 4);
+		StatEncode(&(fr->stats), hdr + ARC_BLK_HDR_SIZE);
+		if(fwrite(hdr, hsize, 1, o->f) != 1) {
+			free(hdr);
+			return(-1);
+		}
+		free(hdr);
+	}
+
+	/* write frame */
+	if(fwrite(fr->out, fr->outlen, 1, o->f) != 1)
+		return(-1);
+
+	/* add frame to index */
+	if(o->nindex == o->capindex) {
+		o->capindex = o->capindex ? 2 * o->capindex : 256;
+		if(!(ix = realloc(o->index,
+											o->capindex * sizeof(struct pds_index))))
+			return(-1);
+		o->index = ix;
+	}
+	ix = &(o->index[o->nindex++]);
+	ix->offset = o->offset;
+	o->offset += hsize + fr->outlen;
+	ix->csize = fr->outlen;
+	ix->dsize = fr->inlen;
+	ix->firstday = fr->firstday;
+	ix->firstms = fr->firstms;
+	ix->firstmics = fr->firstmics;
+	ix->lastday = fr->lastday;
+	ix->lastms = fr->lastms;
+	ix->lastmics = fr->lastmics;
+	if(!fr->timed) {
+		ix->firstday = 0;
+		ix->lastday = 0;
+	}
+
+	/* archive blocks are indexed by their earliest and latest packet */
+	if((o->format == PDS_FMT_ARCHIVE) && fr->timed) {
+		ix->firstday = fr->stats.firstday;
+		ix->firstms = fr->stats.firstms;
+		ix->firstmics = fr->stats.firstmics;
+		ix->lastday = fr->stats.lastday;
+		ix->lastms = fr->stats.lastms;
+		ix->lastmics = fr->stats.lastmics;
+	}
+
+	/* free slot */
+	StatFree(&(fr->stats));
+	fr->state = SLOT_FREE;
+	o->written++;
+
+	/* ok */
+	return(0);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  compress a frame                                                *
+ *                                                                  *
+ *  o:   pointer to PDS output file                                 *
+ *  ctx: compression context of calling thread                      *
+ *  fr:  pointer to frame                                           *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          -1 - error                                              *
+ *                                                                  *
+ ********************************************************************/
+static int CompressFrame(struct pds_out *o, void *ctx,
+												 struct pds_frame *fr) {
+	/* buffer size */
+	size_t n;
+	/* new buffer */
+	unsigned char *p;
+#ifdef HAVE_ZLIB
+	/* compressed size */
+	uLongf len;
+#endif
+
+
+	/* make room for compressed frame */
+	n = fr->inlen + 64;
+#ifdef HAVE_ZLIB
+	if(o->codec == PDS_CODEC_DEFLATE)
+		n = compressBound(fr->inlen);
+#endif
+#ifdef HAVE_ZSTD
+	if(o->codec == PDS_CODEC_ZSTD)
+		n = ZSTD_compressBound(fr->inlen);
+#endif
+	if(fr->outcap < n) {
+		if(!(p = realloc(fr->out, n)))
+			return(-1);
+		fr->out = p;
+		fr->outcap = n;
+	}
+
+	switch(o->codec) {
+	case PDS_CODEC_STORE:
+		memcpy(fr->out, fr->in, fr->inlen);
+		fr->outlen = fr->inlen;
+		return(0);
+#ifdef HAVE_ZLIB
+	case PDS_CODEC_DEFLATE:
+		len = fr->outcap;
+		if(compress2(fr->out, &len, fr->in, fr->inlen, o->level) != Z_OK)
+			return(-1);
+		fr->outlen = len;
+		return(0);
+#endif
+#ifdef HAVE_ZSTD
+	case PDS_CODEC_ZSTD:
+		/* compress frame with content size and checksum */
+		if(!ctx)
+			return(-1);
+		ZSTD_CCtx_setParameter(ctx, ZSTD_c_compressionLevel, o->level);
+		ZSTD_CCtx_setParameter(ctx, ZSTD_c_checksumFlag, 1);
+		n = ZSTD_compress2(ctx, fr->out, fr->outcap, fr->in, fr->inlen);
+		if(ZSTD_isError(n))
+			return(-1);
+		fr->outlen = n;
+		return(0);
+#endif
+	}
+
+	/* unsupported codec */
+	return(-1);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  compression thread                                              *
+ *                                                                  *
+ *  arg: pointer to PDS output file                                 *
+ *                                                                  *
+ *  result: NULL                                                    *
+ *                                                                  *
+ ********************************************************************/
+static void *FrameWorker(void *arg) {
+	/* PDS output file */
+	struct pds_out *o = arg;
+	/* pointer to frame */
+	struct pds_frame *fr;
+	/* compression context */
+	void *ctx = NULL;
+	/* error code */
+	int error;
+
+
+#ifdef HAVE_ZSTD
+	if(o->codec == PDS_CODEC_ZSTD)
+		ctx = ZSTD_createCCtx();
+#endif
+
+	for(;;) {
+		/* wait for a queued frame */
+		pthread_mutex_lock(&o->lock);
+		while(!o->stop && (o->todo >= o->queued))
+			pthread_cond_wait(&o->work, &o->lock);
+		if(o->todo >= o->queued) {
+			pthread_mutex_unlock(&o->lock);
+			break;
+		}
+		fr = &(o->frame[o->todo++ % o->nframes]);
+		pthread_mutex_unlock(&o->lock);
+
+		/* compress frame */
+		error = CompressFrame(o, ctx, fr);
+
+		/* hand frame to writer */
+		pthread_mutex_lock(&o->lock);
+		fr->state = error ? SLOT_ERROR : SLOT_DONE;
+		pthread_cond_broadcast(&o->done);
+		pthread_mutex_unlock(&o->lock);
+	}
+
+#ifdef HAVE_ZSTD
+	if(ctx)
+		ZSTD_freeCCtx(ctx);
+#endif
+
+	/* servus */
+	return(NULL);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  write time index and seek table or archive index               *
+ *                                                                  *
+ *  The time index is a skippable frame holding the number of       *
+ *  frames followed by the first and last packet time of each       *
+ *  frame (days (2), milliseconds (4) and microseconds (2) each,    *
+ *  little endian). The seek table follows the zstd seekable        *
+ *  format, without checksums.                                      *
+ *                                                                  *
+ *  o: pointer to PDS output file                                   *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          -1 - write error                                        *
+ *                                                                  *
+ ********************************************************************/
+static int WriteIndex(struct pds_out *o) {
+	/* buffer */
+	unsigned char buf[ARC_ENTRY_SIZE];
+	/* pointer to index entry */
+	struct pds_index *ix;
+	/* counter */
+	long i;
+
+
+	/* archive index and trailer */
+	if(o->format == PDS_FMT_ARCHIVE) {
+		memcpy(buf, PDS_IDX_MAGIC, 4);
+		PutLE(buf + 4, o->nindex, 4);
+		if(fwrite(buf, 8, 1, o->f) != 1)
+			return(-1);
+		for(i = 0; i < o->nindex; i++) {
+			ix = &(o->index[i]);
+			PutLE(buf, ix->offset, 8);
+			PutLE(buf + 8, ix->firstday, 2);
+			PutLE(buf + 10, ix->firstms, 4);
+			PutLE(buf + 14, ix->firstmics, 2);
+			PutLE(buf + 16, ix->lastday, 2);
+			PutLE(buf + 18, ix->lastms, 4);
+			PutLE(buf + 22, ix->lastmics, 2);
+			if(fwrite(buf, ARC_ENTRY_SIZE, 1, o->f) != 1)
+				return(-1);
+		}
+		PutLE(buf, o->offset, 8);
+		PutLE(buf + 8, o->nindex, 4);
+		memcpy(buf + 12, PDS_END_MAGIC, 4);
+		if(fwrite(buf, ARC_TRAILER_SIZE, 1, o->f) != 1)
+			return(-1);
+		return(0);
+	}
+
+	/* time index */
+	PutLE(buf, PDS_TIME_MAGIC, 4);
+	PutLE(buf + 4, 4 + o->nindex * TIME_ENTRY_SIZE, 4);
+	PutLE(buf + 8, o->nindex, 4);
+	if(fwrite(buf, 12, 1, o->f) != 1)
+		return(-1);
+	for(i = 0; i < o->nindex; i++) {
+		ix = &(o->index[i]);
+		PutLE(buf, ix->firstday, 2);
+		PutLE(buf + 2, ix->firstms, 4);
+		PutLE(buf + 6, ix->firstmics, 2);
+		PutLE(buf + 8, ix->lastday, 2);
+		PutLE(buf + 10, ix->lastms, 4);
+		PutLE(buf + 14, ix->lastmics, 2);
+		if(fwrite(buf, TIME_ENTRY_SIZE, 1, o->f) != 1)
+			return(-1);
+	}
+
+	/* seek table */
+	PutLE(buf, PDS_SEEK_MAGIC, 4);
+	PutLE(buf + 4, o->nindex * 8 + 9, 4);
+	if(fwrite(buf, 8, 1, o->f) != 1)
+		return(-1);
+	for(i = 0; i < o->nindex; i++) {
+		PutLE(buf, o->index[i].csize, 4);
+		PutLE(buf + 4, o->index[i].dsize, 4);
+		if(fwrite(buf, 8, 1, o->f) != 1)
+			return(-1);
+	}
+	PutLE(buf, o->nindex, 4);
+	buf[4] = 0;
+	PutLE(buf + 5, PDS_SEEKABLE_MAGIC, 4);
+	if(fwrite(buf, 9, 1, o->f) != 1)
+		return(-1);
+
+	/* done */
+	return(0);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  get little endian value                                         *
+ *                                                                  *
+ *  buf:  pointer to buffer                                         *
+ *  size: size of value in bytes (up to 8)                          *
+ *                                                                  *
+ *  result: value                                                   *
+ *                                                                  *
+ ********************************************************************/
+unsigned long long GetLE(unsigned char *buf, int size) {
+	/* value */
+	unsigned long long x = 0;
+	/* counter */
+	int i;
+
+
+	for(i = size - 1; i >= 0; i--)
+		x = (x << 8) | buf[i];
+	return(x);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  put little endian value                                         *
+ *                                                                  *
+ *  buf:  pointer to buffer                                         *
+ *  x:    value                                                     *
+ *  size: size of value in bytes (up to 8)                          *
+ *                                                                  *
+ *  result: none                                                    *
+ *                                                                  *
+ ********************************************************************/
+void PutLE(unsigned char *buf, unsigned long long x, int size) {
+	/* counter */
+	int i;
+
+
+	for(i = 0; i < size; i++, x >>= 8)
+		buf[i] = x & 0xFF;
+}
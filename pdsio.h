@@ -0,0 +1,144 @@
+/********************************************************************
+ *                                                                  *
+ *  Copyright (C) 2026                                              *
+ *  Geoscience Australia, Canberra, Australia                       *
+ *                                                                  *
+ *  This program is free software; you can redistribute it and/or   *
+ *  modify it under the terms of the GNU General Public License as  *
+ *  published by the Free Software Foundation; either version 2 of  *
+ *  the License, or (at your option) any later version.             *
+ *                                                                  *
+ *  This program is distributed in the hope that it will be         *
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied      *
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR         *
+ *  PURPOSE.  See the GNU General Public License for more details.  *
+ *                                                                  *
+ *  You should have received a copy of the GNU General Public       *
+ *  License along with this program; if not, write to the Free      *
+ *  Software Foundation, Inc., 59 Temple Place, Suite 330, Boston,  *
+ *  MA  02111-1307  USA                                             *
+ *                                                                  *
+ ********************************************************************
+ *                                                                  *
+ *  PDS file input and output with transparent (de)compression      *
+ *                                                                  *
+ *  Plain, gzip, bzip2 and (if built with HAVE_ZSTD) zstd files     *
+ *  are detected by their magic bytes. bgzip style gzip files and   *
+ *  zstd files made of several frames are decompressed by a pool    *
+ *  of threads when more than one thread is requested.              *
+ *                                                                  *
+ *  Output is either plain or zstd compressed. Compressed output    *
+ *  is cut into independent frames at packet boundaries, which are  *
+ *  compressed by a pool of threads and followed by a time index    *
+ *  and a zstd seek table.                                          *
+ *                                                                  *
+ *  PDS archives hold blocks of packets, each compressed on its     *
+ *  own and preceded by a header with the statistics of its         *
+ *  packets, and an index of all blocks at the end. They are read   *
+ *  like any other PDS file, reading can be limited to the blocks   *
+ *  overlapping a time range (PDSSetWindow) and the statistics of   *
+ *  the whole file can be taken from the block headers alone        *
+ *  (PDSArchiveStats).                                              *
+ *                                                                  *
+ *  archive layout (all values little endian):                      *
+ *   file header:  "PDSA", version (2), reserved (2)                *
+ *   block header: "PDSB", codec (1), reserved (3),                 *
+ *                 header size (4), compressed size (4),            *
+ *                 uncompressed size (4), number of packets (4),    *
+ *                 statistics (see StatEncode())                    *
+ *   index:        "PDSI", number of blocks (4), per block: offset  *
+ *                 (8), first and last packet time as days (2),     *
+ *                 milliseconds (4) and microseconds (2)            *
+ *   trailer:      index offset (8), number of blocks (4), "PDSZ"   *
+ *                                                                  *
+ ********************************************************************/
+
+#ifndef PDSIO_H
+#define PDSIO_H
+
+#include "pdsstat.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/********************************************************************
+ *                                                                  *
+ *  defines                                                         *
+ *                                                                  *
+ ********************************************************************/
+/* file formats */
+#define PDS_FMT_PLAIN 0
+#define PDS_FMT_GZIP 1
+#define PDS_FMT_BGZF 2
+#define PDS_FMT_BZIP2 3
+#define PDS_FMT_ZSTD 4
+#define PDS_FMT_ARCHIVE 5
+/* default size of compressed output frames */
+#define PDS_FRAME_SIZE 4194304
+/* magic number of time index skippable frame */
+#define PDS_TIME_MAGIC 0x184D2A5DUL
+/* magic number of seek table skippable frame */
+#define PDS_SEEK_MAGIC 0x184D2A5EUL
+/* magic number at end of seek table */
+#define PDS_SEEKABLE_MAGIC 0x8F92EAB1UL
+/* archive magic numbers */
+#define PDS_ARC_MAGIC "PDSA"
+#define PDS_BLK_MAGIC "PDSB"
+#define PDS_IDX_MAGIC "PDSI"
+#define PDS_END_MAGIC "PDSZ"
+/* archive version */
+#define PDS_ARC_VERSION 1
+/* archive block codecs */
+#define PDS_CODEC_STORE 0
+#define PDS_CODEC_DEFLATE 1
+#define PDS_CODEC_ZSTD 2
+
+
+/********************************************************************
+ *                                                                  *
+ *  structure definitions                                           *
+ *                                                                  *
+ ********************************************************************/
+/* PDS file (private) */
+struct pds_file;
+
+/* PDS output file (private) */
+struct pds_out;
+
+
+/********************************************************************
+ *                                                                  *
+ *  function declarations                                           *
+ *                                                                  *
+ ********************************************************************/
+struct pds_file *PDSOpen(char *name, int threads);
+int PDSMagic(unsigned char *buf, long n);
+int PDSRead(struct pds_file *f, unsigned char *buf, int size);
+int PDSSkip(struct pds_file *f, long size);
+int PDSSeek(struct pds_file *f, long long offset);
+long long PDSTell(struct pds_file *f);
+long long PDSSize(struct pds_file *f);
+int PDSEof(struct pds_file *f);
+int PDSFormat(struct pds_file *f);
+void PDSSetWindow(struct pds_file *f, int startday,
+									unsigned long startmillisec, int endday,
+									unsigned long endmillisec, int apid);
+int PDSArchiveStats(struct pds_file *f, struct pds_stats *s);
+void PDSClose(struct pds_file *f);
+struct pds_out *PDSCreate(char *name, int format, int level, int threads,
+													long frame_size);
+struct pds_out *PDSAppend(char *name, long long size);
+void PDSMark(struct pds_out *o, struct pkt_info *info);
+int PDSWrite(struct pds_out *o, unsigned char *buf, int size);
+long long PDSFlush(struct pds_out *o);
+int PDSFinish(struct pds_out *o);
+unsigned long long GetLE(unsigned char *buf, int size);
+void PutLE(unsigned char *buf, unsigned long long x, int size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,390 @@
+/********************************************************************
+ *                                                                  *
+ *  Copyright (C) 2026                                              *
+ *  Geoscience Australia, Canberra, Australia                       *
+ *                                                                  *
+ *  This program is free software; you can redistribute it and/or   *
+ *  modify it under the terms of the GNU General Public License as  *
+ *  published by the Free Software Foundation; either version 2 of  *
+ *  the License, or (at your option) any later version.             *
+ *                                                                  *
+ *  This program is distributed in the hope that it will be         *
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied      *
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR         *
+ *  PURPOSE.  See the GNU General Public License for more details.  *
+ *                                                                  *
+ *  You should have received a copy of the GNU General Public       *
+ *  License along with this program; if not, write to the Free      *
+ *  Software Foundation, Inc., 59 Temple Place, Suite 330, Boston,  *
+ *  MA  02111-1307  USA                                             *
+ *                                                                  *
+ ********************************************************************
+ *                                                                  *
+ *  merge of packet streams in time order (see pdsjoin.h)           *
+ *                                                                  *
+ *  18/10/2026  GA           initial version, moved from pdsmerge.c *
+ *  18/10/2026  GA           JoinStep(), inputs closed until the    *
+ *                           merge reaches them (JOIN_CLOSED)       *
+ *                                                                  *
+ ********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pdsjoin.h"
+
+
+/********************************************************************
+ *                                                                  *
+ *  initialise merge                                                *
+ *                                                                  *
+ *  All inputs start in state JOIN_READ with checksum test          *
+ *  JOIN_CHECK, the last packet is the oldest possible.             *
+ *                                                                  *
+ *  j:              pointer to merge                                *
+ *  n:              number of inputs                                *
+ *  apid:           APID                                            *
+ *  startday:       start day (days since 01/01/1958)               *
+ *  startmillisec:  start millisecond of day                        *
+ *  endday:         end day (> 65535 = no end)                      *
+ *  endmillisec:    end millisecond of day (not included)           *
+ *  filter:         pointer to compiled filter (or NULL)            *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          -1 - out of memory                                      *
+ *                                                                  *
+ ********************************************************************/
+int JoinInit(struct pds_join *j, int n, int apid, int startday,
+						 unsigned long startmillisec, int endday,
+						 unsigned long endmillisec, struct pds_filter *filter) {
+	/* counter */
+	int i;
+
+
+	/* inputs */
+	memset(j, 0, sizeof(struct pds_join));
+	if(!(j->in = calloc(n > 0 ? n : 1, sizeof(struct join_input))))
+		return(-1);
+	j->n = n;
+	for(i = 0; i < n; i++) {
+		j->in[i].state = JOIN_READ;
+		j->in[i].check = JOIN_CHECK;
+	}
+
+	/* APID, time range and filter */
+	j->apid = apid;
+	j->start = JoinKey(startday, startmillisec, 0);
+	j->end = (endday > 65535) ? ~0ULL : JoinKey(endday, endmillisec, 0);
+	j->filter = filter;
+
+	/* alles klar */
+	return(0);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  offer packet read by input                                      *
+ *                                                                  *
+ *  Packets of other APIDs, rejected by the filter, with invalid    *
+ *  checksum (counted) or outside the time range are dropped, else  *
+ *  the packet becomes the pending packet of the input. The buffer  *
+ *  and packet are kept by reference until the input is in state    *
+ *  JOIN_READ again.                                                *
+ *                                                                  *
+ *  j:   pointer to merge                                           *
+ *  i:   input                                                      *
+ *  buf: pointer to packet buffer                                   *
+ *  pkt: pointer to decoded packet                                  *
+ *                                                                  *
+ *  result:  1 - packet pending                                     *
+ *           0 - packet dropped                                     *
+ *                                                                  *
+ ********************************************************************/
+int JoinOffer(struct pds_join *j, int i, unsigned char *buf,
+							struct pds_packet *pkt) {
+	/* pointer to input */
+	struct join_input *in = &(j->in[i]);
+	/* packet time */
+	unsigned long long t;
+
+
+	/* is it a packet we need? */
+	if(pkt->hdr.apid != j->apid)
+		return(0);
+
+	/* rejected by filter? */
+	if(j->filter && !FilterMatch(j->filter, pkt))
+		return(0);
+
+	/* invalid packet? */
+	if(((in->check == JOIN_CHECK) && !PDSCheckPacket(buf, pkt)) ||
+		 ((in->check == JOIN_CHECKED) && !pkt->info.valid)) {
+		in->checksum++;
+		return(0);
+	}
+
+	/* outside time range? */
+	t = JoinKey(pkt->info.days, pkt->info.millisec, pkt->info.microsec);
+	if((t < j->start) || (t >= j->end))
+		return(0);
+
+	/* packet pending */
+	in->buf = buf;
+	in->pkt = pkt;
+	in->state = JOIN_PENDING;
+
+	/* okeydokey */
+	return(1);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  find input with oldest pending packet                           *
+ *                                                                  *
+ *  Pending packets of later inputs identical to the oldest one     *
+ *  (same time and packet count) are dropped as duplicates.         *
+ *                                                                  *
+ *  j: pointer to merge                                             *
+ *                                                                  *
+ *  result: >=0 - input with oldest packet                          *
+ *           -1 - no packet pending                                 *
+ *                                                                  *
+ ********************************************************************/
+int JoinOldest(struct pds_join *j) {
+	/* input with oldest packet */
+	int oldest = -1;
+	/* result of comparison */
+	int cmp;
+	/* counter */
+	int i;
+
+
+	for(i = 0; i < j->n; i++) {
+		/* no packet pending? */
+		if(j->in[i].state != JOIN_PENDING)
+			continue;
+
+		/* first pending packet? */
+		if(oldest < 0) {
+			oldest = i;
+			continue;
+		}
+
+		/* older, or identical packets? */
+		cmp = JoinCompare(&(j->in[i].pkt->info), &(j->in[oldest].pkt->info));
+		if(cmp < 0)
+			oldest = i;
+		else if(cmp == 0) {
+			j->in[i].state = JOIN_READ;
+			j->in[i].duplicate++;
+		}
+	}
+
+	/* voila */
+	return(oldest);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  take pending packet of input                                    *
+ *                                                                  *
+ *  The packet becomes the last packet, the input is in state       *
+ *  JOIN_READ again. Packets not newer than the last packet are     *
+ *  duplicated (or old) and dropped.                                *
+ *                                                                  *
+ *  j: pointer to merge                                             *
+ *  i: input (see JoinOldest())                                     *
+ *                                                                  *
+ *  result:  1 - packet to write (in j->in[i].buf and .pkt)         *
+ *           0 - packet dropped                                     *
+ *                                                                  *
+ ********************************************************************/
+int JoinTake(struct pds_join *j, int i) {
+	/* pointer to input */
+	struct join_input *in = &(j->in[i]);
+	/* result of comparison */
+	int cmp;
+
+
+	/* avoid duplicated and old packets */
+	cmp = JoinCompare(&(in->pkt->info), &(j->last));
+	j->last = in->pkt->info;
+	in->state = JOIN_READ;
+	if(cmp <= 0) {
+		in->duplicate++;
+		return(0);
+	}
+
+	/* gut */
+	in->written++;
+	return(1);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  merge up to next packet to write                                *
+ *                                                                  *
+ *  Reads a packet of each input in state JOIN_READ (read function  *
+ *  of caller, see pdsjoin.h), picks and takes the oldest pending   *
+ *  packet until one is to be written. Inputs in state JOIN_CLOSED  *
+ *  are set to JOIN_READ when the oldest pending packet reaches     *
+ *  their open time, or the next ones if no packet is pending.      *
+ *  Inputs at their end are set to JOIN_EOF. An input without a     *
+ *  packet yet stops the merge after the other inputs are read.     *
+ *                                                                  *
+ *  j:    pointer to merge                                          *
+ *  read: read function                                             *
+ *  arg:  argument of read function                                 *
+ *                                                                  *
+ *  result: >=0 - input with packet to write (in j->in[i].buf and   *
+ *                .pkt)                                             *
+ *          JOIN_DONE  - all inputs at their end                    *
+ *          JOIN_WAIT  - an input has no packet available yet       *
+ *          JOIN_ERROR - read error                                 *
+ *                                                                  *
+ ********************************************************************/
+int JoinStep(struct pds_join *j, join_read read, void *arg) {
+	/* packet buffer and decoded packet read */
+	unsigned char *buf;
+	struct pds_packet *pkt;
+	/* input with oldest packet (-1 = none) */
+	int oldest;
+	/* time inputs are opened up to */
+	unsigned long long t;
+	/* result of read function */
+	int result;
+	/* flags for input waiting and input opened */
+	int blocked, opened;
+	/* counter */
+	int i;
+
+
+	for(;;) {
+		/* read until each input has a packet pending or is at its end */
+		for(i = 0, blocked = 0; i < j->n; i++) {
+			while(j->in[i].state == JOIN_READ) {
+				result = read(arg, i, &buf, &pkt);
+				if(result == JOIN_PACKET)
+					JoinOffer(j, i, buf, pkt);
+				else if(result == JOIN_END)
+					j->in[i].state = JOIN_EOF;
+				else if(result == JOIN_NOTYET) {
+					blocked = 1;
+					break;
+				}
+				else if(result != JOIN_SKIP)
+					return(JOIN_ERROR);
+			}
+		}
+		if(blocked)
+			return(JOIN_WAIT);
+
+		/* find the oldest packet, identical packets of later inputs
+			 are dropped */
+		oldest = JoinOldest(j);
+
+		/* open inputs whose time has been reached (or the next ones if
+			 no packet is pending) */
+		if(oldest >= 0)
+			t = JoinKey(j->in[oldest].pkt->info.days,
+									j->in[oldest].pkt->info.millisec,
+									j->in[oldest].pkt->info.microsec);
+		else
+			for(i = 0, t = ~0ULL; i < j->n; i++)
+				if((j->in[i].state == JOIN_CLOSED) && (j->in[i].open < t))
+					t = j->in[i].open;
+		for(i = 0, opened = 0; i < j->n; i++) {
+			if((j->in[i].state != JOIN_CLOSED) || (j->in[i].open > t))
+				continue;
+			j->in[i].state = JOIN_READ;
+			opened = 1;
+		}
+		if(opened)
+			continue;
+
+		/* no packet pending? */
+		if(oldest < 0)
+			return(JOIN_DONE);
+
+		/* avoid duplicated and old packets */
+		if(JoinTake(j, oldest))
+			return(oldest);
+	}
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  free merge                                                      *
+ *                                                                  *
+ *  j: pointer to merge                                             *
+ *                                                                  *
+ *  result: none                                                    *
+ *                                                                  *
+ ********************************************************************/
+void JoinFree(struct pds_join *j) {
+	free(j->in);
+	j->in = NULL;
+	j->n = 0;
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  compare packets by time and packet count                        *
+ *                                                                  *
+ *  Packet counts are 14bit and wrap, of two counts the one up to   *
+ *  8191 behind is the older one.                                   *
+ *                                                                  *
+ *  a: pointer to info of 1. packet                                 *
+ *  b: pointer to info of 2. packet                                 *
+ *                                                                  *
+ *  result: <0 - 1. packet older                                    *
+ *           0 - same time and packet count                         *
+ *          >0 - 1. packet newer                                    *
+ *                                                                  *
+ ********************************************************************/
+int JoinCompare(struct pkt_info *a, struct pkt_info *b) {
+	/* packet difference */
+	int pktdiff;
+
+
+	/* test time */
+	if(a->days != b->days)
+		return((a->days < b->days) ? -1 : 1);
+	if(a->millisec != b->millisec)
+		return((a->millisec < b->millisec) ? -1 : 1);
+	if(a->microsec != b->microsec)
+		return((a->microsec < b->microsec) ? -1 : 1);
+
+	/* test packet count */
+	pktdiff = a->pkt_count - b->pkt_count;
+	if(pktdiff < -8191) pktdiff += 16384;
+	if(pktdiff > 8191) pktdiff -= 16384;
+
+	/* passt */
+	return(pktdiff);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  get packet time as a single number for comparisons              *
+ *                                                                  *
+ *  days:     days since 01/01/1958                                 *
+ *  millisec: milliseconds of day                                   *
+ *  microsec: microseconds of millisecond                           *
+ *                                                                  *
+ *  result: ((days * 86400000 + millisec) << 16) + microsec         *
+ *                                                                  *
+ ********************************************************************/
+unsigned long long JoinKey(int days, unsigned long millisec,
+													 int microsec) {
+	return((((unsigned long long)days * 86400000ULL + millisec) << 16) +
+				 (unsigned long long)(microsec & 0xFFFF));
+}
@@ -0,0 +1,149 @@
+/********************************************************************
+ *                                                                  *
+ *  Copyright (C) 2026                                              *
+ *  Geoscience Australia, Canberra, Australia                       *
+ *                                                                  *
+ *  This program is free software; you can redistribute it and/or   *
+ *  modify it under the terms of the GNU General Public License as  *
+ *  published by the Free Software Foundation; either version 2 of  *
+ *  the License, or (at your option) any later version.             *
+ *                                                                  *
+ *  This program is distributed in the hope that it will be         *
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied      *
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR         *
+ *  PURPOSE.  See the GNU General Public License for more details.  *
+ *                                                                  *
+ *  You should have received a copy of the GNU General Public       *
+ *  License along with this program; if not, write to the Free      *
+ *  Software Foundation, Inc., 59 Temple Place, Suite 330, Boston,  *
+ *  MA  02111-1307  USA                                             *
+ *                                                                  *
+ ********************************************************************
+ *                                                                  *
+ *  merge of packet streams in time order                           *
+ *                                                                  *
+ *  The merge engine of pdsmerge: any number of inputs offer the    *
+ *  packets they read (JoinOffer()), which keeps packets of the     *
+ *  APID and time range passing filter and checksum test pending.   *
+ *  JoinOldest() picks the input with the oldest pending packet     *
+ *  (time, then packet count) and drops identical packets of later  *
+ *  inputs, JoinTake() takes it and drops packets not newer than    *
+ *  the last packet taken. JoinStep() runs these steps up to the    *
+ *  next packet to write, reading the inputs by a function of the   *
+ *  caller (files, chunks in memory, ...). Inputs in state          *
+ *  JOIN_CLOSED are only read once the merge reaches their open     *
+ *  time, inputs in other states below 0 (set by the caller, e.g.   *
+ *  skipped) are left alone.                                        *
+ *                                                                  *
+ *  typical use:                                                    *
+ *   JoinInit(&j, n, apid, startday, startms, endday, endms, NULL); *
+ *   while((i = JoinStep(&j, ReadInput, arg)) >= 0)                 *
+ *     write j.in[i].buf (j.in[i].pkt->size bytes)                  *
+ *   if(i != JOIN_DONE)                                             *
+ *     read error (or JOIN_WAIT: input has no packet yet)           *
+ *   JoinFree(&j);                                                  *
+ *                                                                  *
+ ********************************************************************/
+
+#ifndef PDSJOIN_H
+#define PDSJOIN_H
+
+#include "pds.h"
+#include "pdsfilter.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/********************************************************************
+ *                                                                  *
+ *  defines                                                         *
+ *                                                                  *
+ ********************************************************************/
+/* input states (other states below 0 are set by the caller) */
+#define JOIN_READ 0
+#define JOIN_PENDING 1
+#define JOIN_EOF -1
+#define JOIN_CLOSED -2
+/* test of offered packets: checksum tested by JoinOffer(), tested
+	 before (info.valid set), not tested (e.g. existing output) */
+#define JOIN_CHECK 0
+#define JOIN_CHECKED 1
+#define JOIN_TRUSTED 2
+/* results of read function of JoinStep() */
+#define JOIN_PACKET 0
+#define JOIN_END 1
+#define JOIN_SKIP 2
+#define JOIN_NOTYET 3
+/* results of JoinStep() besides the input of the packet to write */
+#define JOIN_DONE -1
+#define JOIN_WAIT -2
+#define JOIN_ERROR -3
+
+
+/********************************************************************
+ *                                                                  *
+ *  structure definitions                                           *
+ *                                                                  *
+ ********************************************************************/
+/* input of merge */
+struct join_input {
+	/* state, test of offered packets */
+	int state, check;
+	/* time the merge starts to read the input at in state
+		 JOIN_CLOSED (see JoinKey()) */
+	unsigned long long open;
+	/* pending packet and its buffer */
+	struct pds_packet *pkt;
+	unsigned char *buf;
+	/* packets taken, with invalid checksum and duplicated (or older) */
+	long written, checksum, duplicate;
+};
+
+/* merge */
+struct pds_join {
+	/* APID, time range (see JoinKey(), end not included) */
+	int apid;
+	unsigned long long start, end;
+	/* filter (NULL = all packets) */
+	struct pds_filter *filter;
+	/* inputs */
+	int n;
+	struct join_input *in;
+	/* last packet taken */
+	struct pkt_info last;
+};
+
+
+/* read function of JoinStep(): reads the next packet of input i,
+	 stores pointers to its buffer and decoded packet, result
+	 JOIN_PACKET, JOIN_END (end of input), JOIN_SKIP (no packet, read
+	 again), JOIN_NOTYET (no packet available yet) or -1 (error) */
+typedef int (*join_read)(void *arg, int i, unsigned char **buf,
+												 struct pds_packet **pkt);
+
+
+/********************************************************************
+ *                                                                  *
+ *  function declarations                                           *
+ *                                                                  *
+ ********************************************************************/
+int JoinInit(struct pds_join *j, int n, int apid, int startday,
+						 unsigned long startmillisec, int endday,
+						 unsigned long endmillisec, struct pds_filter *filter);
+int JoinOffer(struct pds_join *j, int i, unsigned char *buf,
+							struct pds_packet *pkt);
+int JoinOldest(struct pds_join *j);
+int JoinTake(struct pds_join *j, int i);
+int JoinStep(struct pds_join *j, join_read read, void *arg);
+void JoinFree(struct pds_join *j);
+int JoinCompare(struct pkt_info *a, struct pkt_info *b);
+unsigned long long JoinKey(int days, unsigned long millisec,
+													 int microsec);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -28,29 +28,97 @@
  *  10/06/2008  S. W. Maier    increased data buffer and test for   *
  *                             packet size before reading           *
  *  10/10/2008  S. W. Maier    increased data buffer                *
+ *  18/10/2026  GA             read gzip, bzip2 and zstd compressed *
+ *                             files, decompress in parallel (-t)   *
+ *  18/10/2026  GA             zstd compressed output (-z), frames  *
+ *                             compressed in parallel (-t)          *
+ *  18/10/2026  GA             PDS archive output (-A), only read   *
+ *                             archive blocks in time range         *
+ *  18/10/2026  GA             time coverage of inputs from catalog *
+ *                             (-c), archive or header scan (-s),   *
+ *                             open inputs when needed, skip inputs *
+ *                             covered by a clean input             *
+ *  18/10/2026  GA             statistics of output and packet      *
+ *                             counts of inputs (-r)                *
+ *  18/10/2026  GA             packet decoding moved to libpds      *
+ *                             (pds.c)                              *
+ *  18/10/2026  GA             merge packets of other instruments   *
+ *                             (see APIDs below)                    *
+ *  18/10/2026  GA             export of MODIS science samples of   *
+ *                             output packets (-u)                  *
+ *  18/10/2026  GA             filter expression over packet        *
+ *                             headers (-f), tested before checksum *
+ *  18/10/2026  GA             incremental merge of new inputs into *
+ *                             existing output (-i)                 *
+ *  18/10/2026  GA             checkpoints of merge state (-k),     *
+ *                             resume from checkpoint (-R)          *
+ *  18/10/2026  GA             batch of merge jobs from manifest    *
+ *                             (-m), inputs shared by jobs are read *
+ *                             once                                 *
+ *  18/10/2026  GA             catalog read by libpds               *
+ *                             (pdscatalog.c)                       *
+ *  18/10/2026  GA             other APIDs of the merged instrument *
+ *                             from PDSDecoder() instead of MODIS   *
+ *                             APID range                           *
+ *  18/10/2026  GA             merge of inputs moved to libpds      *
+ *                             (pdsjoin.c)                          *
+ *  18/10/2026  GA             jobs of manifest merged by libpds    *
+ *                             as well                              *
+ *  18/10/2026  GA             inputs tested before output is       *
+ *                             created, output written to           *
+ *                             <output>.part and renamed when done  *
+ *  18/10/2026  GA             inputs found in catalog by canonical *
+ *                             path, missing or changed ones        *
+ *                             reported                             *
+ *  18/10/2026  GA             merge loop of libpds (JoinStep()),   *
+ *                             inputs read by ReadInput() and       *
+ *                             ReadJobInput()                       *
+ *  18/10/2026  GA             output of manifest job only created  *
+ *                             when its inputs are open, written to *
+ *                             <output>.part, removed on failure    *
+ *  18/10/2026  GA             <output>.part of failed merge        *
+ *                             removed (kept with checkpoint)       *
  *                                                                  *
  ********************************************************************
  *                                                                  *
- *  usage: pdsmerge start_date end_date APID <input 1> [<input 2>   *
- *         [...]] output                                            *
+ *  usage: pdsmerge [-t threads] [-z level] [-A] [-B frame_kb]      *
+ *         [-c catalog] [-s] [-r] [-u samples] [-f filter] [-i]     *
+ *         [-k checkpoint [-R]] start_date end_date APID <input 1>  *
+ *         [<input 2> [...]] output                                 *
+ *         pdsmerge [-t threads] [-z level] [-A] [-B frame_kb] [-r] *
+ *         [-f filter] -m manifest                                  *
  *                                                                  *
  ********************************************************************
  *                                                                  *
- *  to do:                                                          *
- *   - support other sensors                                        *
+ *  APIDs: MODIS (64 to 127), Aqua CERES (141 to 171), AMSU-A       *
+ *   (257 to 290), HSB (342), AIRS (404 to 417), GBAD (957)         *
  *                                                                  *
  *  known issues:                                                   *
  *   - doesn't take into account leap seconds                       *
  *                                                                  *
  ********************************************************************
  *                                                                  *
- *  build: cc pdsmerge.c -lm -o pdsmerge                            *
+ *  build: cc -DHAVE_ZLIB -DHAVE_BZLIB pdsmerge.c pds.c pdsio.c     *
+ *         pdsstat.c pdsfilter.c pdscatalog.c pdsjoin.c -lz -lbz2   *
+ *         -lpthread -lm -o pdsmerge                                *
  *                                                                  *
  ********************************************************************/
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 #include <math.h>
+#include <time.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "pds.h"
+#include "pdscatalog.h"
+#include "pdsfilter.h"
+#include "pdsjoin.h"
 
 
 /********************************************************************
@@ -63,17 +131,24 @@
 /* version */
 #define VERSION 1
 /* revision */
-#define REVISION 3
+#define REVISION 24
 /* usage */
-#define USAGE "start_date end_date APID <input 1> [<input 2> [...]] output\nstart_date/end_date: YYYY/MM/DD,hh:mm:ss or -"
-/* primary header size */
-#define PRI_HDR_SIZE 6
-/* MODIS secondary header size */
-#define MODIS_HDR_SIZE 12
-/* data buffer size */
-#define DATA_SIZE 100000
-/* Julian Day of MODIS reference date (01/01/1958)*/
-#define MODIS_REF_DATE 2436205.0
+#define USAGE "[-t threads] [-z level] [-A] [-B frame_kb] [-c catalog] [-s] [-r] [-u samples] [-f filter] [-i] [-k checkpoint [-R]] start_date end_date APID <input 1> [<input 2> [...]] output\n       pdsmerge [-t threads] [-z level] [-A] [-B frame_kb] [-r] [-f filter] -m manifest\nstart_date/end_date: YYYY/MM/DD,hh:mm:ss or -\n-z: write zstd compressed output in frames of frame_kb kB (default 4096)\n-A: write PDS archive in blocks of frame_kb kB (default 4096)\n-c: take time coverage of inputs from pdscat catalog\n-s: scan packet headers of plain inputs for time coverage\n-r: report statistics of output file and packets taken from each input\n-u: write 12bit samples of output MODIS packets to file\n-f: only merge packets matching filter expression, e.g. \"pkt_type = 2 | pkt_type = 4\"\n-i: merge inputs into existing plain output, only rewrite output from first new packet on\n-k: write checkpoint of plain merge every minute\n-R: resume merge from checkpoint\n-m: run merge jobs of manifest, one per line: start_date end_date APID <input 1> [<input 2> [...]] output"
+/* input state skipped (besides the states of pdsjoin.h) */
+#define IN_SKIPPED -3
+/* size of copy buffer */
+#define COPY_SIZE 1048576
+/* checkpoint magic number, version and sizes */
+#define CKP_MAGIC "PDSK"
+#define CKP_VERSION 1
+#define CKP_HDR_SIZE 44
+#define CKP_INPUT_SIZE 24
+/* seconds between checkpoints, packets between tests of time */
+#define CKP_SECS 60
+#define CKP_PKTS 4096
+/* maximum number of packets and bytes of input chunk (manifest) */
+#define MAN_CHUNK_PKTS 8192
+#define MAN_CHUNK_SIZE 4194304
 
 
 /********************************************************************
@@ -81,33 +156,133 @@
  *  structure definitions                                           *
  *                                                                  *
  ********************************************************************/
-/* primary header */
-struct pri_hdr {
-	int flag;
-	int version;
-	int type;
-	int sec_hdr_flag;
+/* time coverage and quality of input */
+struct coverage {
+	/* time range known? */
+	int known;
+	/* no packet of APID in file */
+	int empty;
+	/* time of first and last packet as ((days * 86400000 + ms) << 16) +
+		 microseconds */
+	unsigned long long start, end;
+	/* packet count of first and last packet (-1 = unknown) */
+	long first_count, last_count;
+	/* no missing packets, i.e. packets in order */
+	int ordered;
+	/* all packets of APID there and valid, no other APID of the same
+		 instrument */
+	int clean;
+};
+
+/* inputs of single merge (read by ReadInput()) */
+struct merge_files {
+	/* names, files (NULL = not open), packet buffers and decoded
+		 packets */
+	char **names;
+	struct pds_file **fin;
+	unsigned char **buf;
+	struct pds_packet *pkt;
+	/* number of inputs, number of decompression threads */
+	int n, threads;
+	/* APID and time range (archive blocks read) */
+	int apid, startday, endday;
+	unsigned long startmillisec, endmillisec;
+	/* unpack samples */
+	int samples;
+	/* offset of first new packet in existing output, the last input
+		 (-1 = no incremental merge) */
+	long long spliceoff;
+	/* positions of inputs at checkpoint (NULL = no checkpoints) */
+	long long *offset;
+	/* exit code of error */
+	int error;
+};
+
+/* packet of existing output (incremental merge) */
+struct out_key {
+	/* packet time (see JoinKey()) */
+	unsigned long long t;
+	/* offset in file */
+	long long offset;
+	/* packet count */
+	int count;
+};
+
+/* packet of input chunk (manifest) */
+struct merge_pkt {
+	/* decoded and checked packet */
+	struct pds_packet pkt;
+	/* packet data and its offset in chunk */
+	unsigned char *data;
+	long offset;
+};
+
+/* chunk of packets read from input (manifest) */
+struct merge_chunk {
+	/* index of first packet in input, number of packets */
+	long long first;
+	int n;
+	struct merge_pkt *pkts;
+	/* packet data */
+	unsigned char *data;
+	struct merge_chunk *next;
+};
+
+/* input shared by jobs (manifest) */
+struct merge_input {
+	char *name;
+	struct pds_file *f;
+	/* time range and APID of all jobs (-1 = more than one APID) */
+	int startday, endday, apid;
+	unsigned long startmillisec, endmillisec;
+	/* APIDs of jobs */
+	char apids[2048];
+	/* chunks not freed yet, number of packets read so far */
+	struct merge_chunk *head, *tail;
+	long long count;
+	/* first packet of chunks still used by jobs */
+	long long keep;
+	/* next chunk wanted by job, end of file, error code */
+	int wanted, eof, error;
+};
+
+/* merge job (manifest) */
+struct merge_job {
+	/* output file name and name while written, APID and time range */
+	char *outname, *partname;
 	int apid;
-	int seq_flags;
-	int pkt_count;
-	int pkt_length;
+	int startday, endday;
+	unsigned long startmillisec, endmillisec;
+	/* inputs */
+	int n;
+	struct merge_input **in;
+	/* position in inputs: chunk and index of next packet */
+	struct merge_chunk **chunk;
+	int *idx;
+	/* merge of inputs (packets checked when read) */
+	struct pds_join join;
+	/* output file and statistics */
+	struct pds_out *fout;
+	struct pds_stats stats;
+	/* job done, exit code */
+	int done, error;
 };
 
-/* MODIS header */
-struct modis_hdr {
-	int days;
-	unsigned long int millisec;
-	int microsec;
-	int ql;
-	int pkt_type;
-	int scan_count;
-	int mirror_side;
-	int src1;
-	int src2;
-	int conf;
-	int sci_state;
-	int sci_abnorm;
-	int checksum;
+/* merge jobs of manifest */
+struct manifest {
+	/* jobs and inputs */
+	struct merge_job *jobs;
+	int njobs;
+	struct merge_input **inputs;
+	int ninputs;
+	/* number of threads */
+	int threads;
+	/* work of round (0 = read inputs, 1 = run jobs), items of round
+		 and next item */
+	int phase;
+	int *items;
+	int nitems, next;
+	pthread_mutex_t lock;
 };
 
 
@@ -116,16 +291,41 @@ struct modis_hdr {
  *  function declarations                                           *
  *                                                                  *
  ********************************************************************/
-int ReadPriHdr(FILE *f, unsigned char *buf);
-int WritePriHdr(FILE *f, unsigned char *buf);
-int DecodePriHdr(unsigned char *buf, struct pri_hdr *hdr);
-int DecodeMODISHdr(unsigned char *buf, int len,
-									 struct modis_hdr *hdr);
-void julday(int minute, int hour, int day, int month, int year,
-						double *jul);
-void caldat(int *minute, int *hour, int *day, int *month, int *year,
-						double jul);
-int CalcChecksum12(unsigned char *buf, int n);
+int GetCoverage(char *name, struct pds_catalog *cat, int prescan, int apid,
+								struct coverage *cov);
+int CatalogCoverage(char *name, struct pds_catalog *cat, int apid,
+										struct coverage *cov);
+int ArchiveCoverage(char *name, int apid, struct coverage *cov);
+int ScanCoverage(char *name, int apid, struct coverage *cov);
+int OtherAPID(int a, int apid);
+int Covers(struct coverage *a, struct coverage *b);
+int Before(unsigned long long t1, long c1, unsigned long long t2, long c2,
+					 int ordered);
+int FindSplice(char *name, char **inputs, int n, int apid,
+							 struct pds_filter *filter, unsigned long long startkey,
+							 unsigned long long endkey, unsigned long long *key,
+							 long long *offset);
+int SpliceFile(char *name, long long offset, char *partname);
+int WriteCheckpoint(char *name, struct pds_join *join, long long outsize,
+										long long *offset, struct pds_stats *stats);
+int ReadCheckpoint(char *name, struct pds_join *join, long long *outsize,
+									 long long *offset, struct pds_stats *stats);
+void PrintStats(struct pds_stats *s);
+int RunManifest(char *name, int threads, int format, int level,
+								long frame_size, char *filterexpr, int report);
+int ReadManifest(char *name, struct manifest *m);
+int GetDateArg(char *s, int end, int *day, unsigned long *millisec);
+int RunPhase(struct manifest *m);
+void *PhaseWorker(void *arg);
+void ReadChunk(struct merge_input *in);
+int ReadInput(void *arg, int i, unsigned char **buf,
+							struct pds_packet **pkt);
+void RunJob(struct merge_job *j);
+int ReadJobInput(void *arg, int i, unsigned char **buf,
+								 struct pds_packet **pkt);
+void JobDone(struct merge_job *j);
+void TrimInputs(struct manifest *m);
+void FreeManifest(struct manifest *m);
 
 
 /********************************************************************
@@ -135,27 +335,24 @@ int CalcChecksum12(unsigned char *buf, int n);
  ********************************************************************/
 int main(int argc, char *argv[]) {
 	/* pointer to input file pointer array */
-  FILE **fin;
+  struct pds_file **fin;
 	/* output file pointer */
-	FILE *fout;
-	/* pointer to primary header structure pointer array */
-	struct pri_hdr **hdr;
-	/* pointer to MODIS header structure pointer array */
-	struct modis_hdr **mhdr;
-	/* pointer to header buffer pointer array */
-	unsigned char **buf_hdr;
-	/* pointer to data buffer pointer array */
-	unsigned char **buf_data;
+	struct pds_out *fout;
+	/* output file format */
+	int format = PDS_FMT_PLAIN;
+	/* pointer to decoded packet array */
+	struct pds_packet *pkt;
+	/* merge of inputs and the inputs */
+	struct pds_join join;
+	struct merge_files mf;
+	/* pointer to packet buffer pointer array */
+	unsigned char **buf;
 	/* number of input files */
 	int n;
 	/* APID */
 	int apid;
-	/* checksum */
-	int chksum;
-	/* input stream with oldest packet */
+	/* input stream with oldest packet (-1 = none) */
 	int oldest;
-	/* flag for valid packet available */
-	int valpkt;
 	/* counter */
 	int i;
 	/* error code */
@@ -170,25 +367,175 @@ int main(int argc, char *argv[]) {
 	unsigned long endmillisec;
 	/* buffer */
 	double x;
-	/* last packet date/time/pktcount */
-	int lastdays = 0, lastmicrosec = 0, lastpktcount = 0;
-	unsigned long int lastmillisec = 0;
-	/* packet difference */
-	int pktdiff;
+	/* number of (de)compression threads */
+	int threads = 1;
+	/* compression level */
+	int level = 0;
+	/* size of compressed frames */
+	long frame_size = PDS_FRAME_SIZE;
+	/* catalog file name */
+	char *catname = NULL;
+	/* mapped catalog */
+	struct pds_catalog cat;
+	/* pre-scan plain inputs */
+	int prescan = 0;
+	/* time coverage of inputs */
+	struct coverage *cov;
+	/* print report */
+	int report = 0;
+	/* statistics of output file */
+	struct pds_stats stats;
+	/* counter */
+	int j;
+	/* sample file name */
+	char *samplename = NULL;
+	/* sample file */
+	FILE *fsample = NULL;
+	/* filter expression and compiled filter */
+	char *filterexpr = NULL;
+	struct pds_filter *filter = NULL;
+	/* position of syntax error in filter expression */
+	char *filtererr;
+	/* merge into existing output */
+	int incremental = 0;
+	/* output file name, name of output (rewritten part of output for
+		 incremental merge) while merging */
+	char *outname;
+	char *partname;
+	/* time of first new packet and its offset in existing output */
+	unsigned long long splicekey = 0;
+	long long spliceoff = 0;
+	/* checkpoint file name, resume from checkpoint */
+	char *ckpname = NULL;
+	int resume = 0;
+	/* size of output file at checkpoint */
+	long long outsize;
+	/* offsets of inputs at checkpoint (-1 = not open) */
+	long long *offset = NULL;
+	/* time of last checkpoint, packets since last test of time */
+	time_t ckptime;
+	long ckppkts = 0;
+	/* manifest file name */
+	char *manifest = NULL;
+	/* option character */
+	int c;
 
 
 	/* print version information */
 	fprintf(stderr, "%s V%d.%d ("__DATE__")\n",
 					NAME,	VERSION, REVISION);
 	
+	/* get options */
+	while((c = getopt(argc, argv, "t:z:AB:c:sru:f:ik:Rm:")) != -1) {
+		switch(c) {
+		case 't':
+			threads = atoi(optarg);
+			if(threads < 1) {
+				fprintf(stderr, "USAGE: %s %s\n", NAME, USAGE);
+				return(20);
+			}
+			break;
+		case 'z':
+			level = atoi(optarg);
+			if(level < 1) {
+				fprintf(stderr, "USAGE: %s %s\n", NAME, USAGE);
+				return(20);
+			}
+			if(format == PDS_FMT_PLAIN)
+				format = PDS_FMT_ZSTD;
+			break;
+		case 'A':
+			format = PDS_FMT_ARCHIVE;
+			break;
+		case 'c':
+			catname = optarg;
+			break;
+		case 's':
+			prescan = 1;
+			break;
+		case 'r':
+			report = 1;
+			break;
+		case 'u':
+			samplename = optarg;
+			break;
+		case 'f':
+			filterexpr = optarg;
+			break;
+		case 'i':
+			incremental = 1;
+			break;
+		case 'k':
+			ckpname = optarg;
+			break;
+		case 'R':
+			resume = 1;
+			break;
+		case 'm':
+			manifest = optarg;
+			break;
+		case 'B':
+			frame_size = atol(optarg) * 1024L;
+			if(frame_size < 1) {
+				fprintf(stderr, "USAGE: %s %s\n", NAME, USAGE);
+				return(20);
+			}
+			break;
+		default:
+			fprintf(stderr, "USAGE: %s %s\n", NAME, USAGE);
+			return(20);
+		}
+	}
+
+	/* incremental merge only into plain output without samples */
+	if(incremental && ((format != PDS_FMT_PLAIN) || samplename)) {
+		fprintf(stderr, "USAGE: %s %s\n", NAME, USAGE);
+		return(20);
+	}
+
+	/* checkpoints only of plain merge without samples */
+	if((resume && !ckpname) ||
+		 (ckpname &&
+			((format != PDS_FMT_PLAIN) || samplename || incremental))) {
+		fprintf(stderr, "USAGE: %s %s\n", NAME, USAGE);
+		return(20);
+	}
+
+	/* compile filter */
+	if(filterexpr && !(filter = FilterCompile(filterexpr, &filtererr))) {
+		if(filtererr)
+			fprintf(stderr, "syntax error in filter at \"%s\"\n", filtererr);
+		else
+			fprintf(stderr, "not enough memory for filter\n");
+		return(20);
+	}
+
+	/* run jobs of manifest, no arguments */
+	if(manifest) {
+		if((optind != argc) || catname || prescan || samplename ||
+			 incremental || ckpname) {
+			fprintf(stderr, "USAGE: %s %s\n", NAME, USAGE);
+			return(20);
+		}
+		FilterFree(filter);
+		return(RunManifest(manifest, threads, format, level, frame_size,
+											 filterexpr, report));
+	}
+
+	/* skip options, argv[1] is start date from here on */
+	argc -= optind - 1;
+	argv += optind - 1;
+
 	/* check number of arguments */
 	if(argc < 6) {
 		fprintf(stderr, "USAGE: %s %s\n", NAME, USAGE);
 		return(20);
 	}
 	
-	/* determine number of input files */
-	n = argc - 5;
+	/* determine number of input files, existing output is last input
+		 of incremental merge */
+	n = argc - 5 + incremental;
+	outname = argv[argc - 1];
 
 	/* get start date */
 	if(strcmp(argv[1], "-") == 0) {
@@ -253,331 +600,309 @@ int main(int argc, char *argv[]) {
 	
 	/* get APID */
 	apid = atoi(argv[3]);
-	if((apid < 64) || (apid > 127)) {
-		fprintf(stderr, "only APID 64 to 127 supported\n");
+	if(!PDSDecoder(apid)) {
+		fprintf(stderr, "APID %d not supported\n", apid);
 		return(10);
 	}
 
 	/* allocate pointer memory */
-	if(!(fin = malloc(sizeof(FILE *) * n))) {
+	if(!(fin = malloc(sizeof(struct pds_file *) * n))) {
 		fprintf(stderr, "not enough memory\n");
 		return(10);
 	}
-	if(!(hdr = malloc(sizeof(struct pri_hdr *) * n))) {
+	if(!(pkt = malloc(sizeof(struct pds_packet) * n))) {
 		fprintf(stderr, "not enough memory\n");
 		return(10);
 	}
-	if(!(mhdr = malloc(sizeof(struct modis_hdr *) * n))) {
+	if(JoinInit(&join, n, apid, startday, startmillisec, endday,
+							 endmillisec, filter)) {
 		fprintf(stderr, "not enough memory\n");
 		return(10);
 	}
-	if(!(buf_hdr = malloc(sizeof(unsigned char *) * n))) {
+	if(!(buf = malloc(sizeof(unsigned char *) * n))) {
 		fprintf(stderr, "not enough memory\n");
 		return(10);
 	}
-	if(!(buf_data = malloc(sizeof(unsigned char *) * n))) {
+
+	/* inputs are opened (and get their packet buffer) when the merge
+		 reaches them */
+	for(i = 0; i < n; i++) {
+		join.in[i].state = JOIN_CLOSED;
+		fin[i] = NULL;
+		buf[i] = NULL;
+		pkt[i].samples = NULL;
+	}
+
+	/* map catalog */
+	if(catname && CatOpen(catname, &cat)) {
+		fprintf(stderr, "can't read catalog (%s)\n", catname);
+		return(10);
+	}
+
+	/* get time coverage and quality of inputs */
+	if(!(cov = calloc(n, sizeof(struct coverage))) ||
+		 !(offset = malloc(sizeof(long long) * n))) {
 		fprintf(stderr, "not enough memory\n");
 		return(10);
 	}
+	for(i = 0; i < n; i++) {
+		GetCoverage(argv[i + 4], catname ? &cat : NULL, prescan, apid,
+							&(cov[i]));
+		join.in[i].open = cov[i].start;
+
+		/* no packets in time range? */
+		if(cov[i].known &&
+			 (cov[i].empty ||
+				(cov[i].end < join.start) || (cov[i].start >= join.end))) {
+			fprintf(stderr,
+							"no packets in time range in input file (%s), skipped\n",
+							argv[i + 4]);
+			join.in[i].state = IN_SKIPPED;
+		}
+	}
+	if(catname)
+		CatClose(&cat);
 
-	/* allocate data memory */
+	/* all inputs readable? (they are opened when needed, existing
+		 output is left alone if one is missing) */
 	for(i = 0; i < n; i++) {
-		if(!(hdr[i] = malloc(sizeof(struct pri_hdr)))) {
-			fprintf(stderr, "not enough memory\n");
+		if((join.in[i].state != IN_SKIPPED) && access(argv[i + 4], R_OK)) {
+			fprintf(stderr,	"can't open input file (%s)\n", argv[i + 4]);
 			return(10);
 		}
-		hdr[i]->flag = 0;
-		if(!(mhdr[i] = malloc(sizeof(struct modis_hdr)))) {
-			fprintf(stderr, "not enough memory\n");
-			return(10);
+	}
+
+	/* output is written to <output>.part and renamed when done */
+	if(!(partname = malloc(strlen(outname) + 6))) {
+		fprintf(stderr, "not enough memory\n");
+		return(10);
+	}
+	sprintf(partname, "%s.part", outname);
+
+	/* skip inputs whose packets are all in a clean input */
+	for(i = 0; i < n; i++) {
+		for(j = 0; (join.in[i].state != IN_SKIPPED) && (j < n); j++) {
+			if((j == i) || (join.in[j].state == IN_SKIPPED) ||
+				 !Covers(&(cov[j]), &(cov[i])))
+				continue;
+			fprintf(stderr,
+							"input file (%s) covered by input file (%s), skipped\n",
+							argv[i + 4], argv[j + 4]);
+			join.in[i].state = IN_SKIPPED;
 		}
-		if(!(buf_hdr[i] = malloc(sizeof(unsigned char) * PRI_HDR_SIZE))) {
-			fprintf(stderr, "not enough memory\n");
+	}
+
+	/* find first new packet of incremental merge, output is rewritten
+		 from there */
+	if(incremental) {
+		error = FindSplice(outname, argv + 4, n - 1, apid, filter,
+											 join.start, join.end, &splicekey, &spliceoff);
+		if(error == 1) {
+			fprintf(stderr, "no new packets in input files\n");
+			return(0);
+		}
+		if(error == -1) {
+			fprintf(stderr, "can't read plain output file (%s)\n", outname);
 			return(10);
 		}
-		if(!(buf_data[i] = malloc(sizeof(unsigned char) * DATA_SIZE))) {
+		if(error == -2) {
+			fprintf(stderr, "error reading input file\n");
+			return(5);
+		}
+		if(error == -3) {
 			fprintf(stderr, "not enough memory\n");
 			return(10);
 		}
+
+		/* only merge new packets, packets of existing output are
+			 checked */
+		if(splicekey > join.start)
+			join.start = splicekey;
+		join.in[n - 1].check = JOIN_TRUSTED;
+		fprintf(stderr, "rewriting output file (%s) from offset %lld\n",
+						outname, spliceoff);
 	}
 
-	/* open input files */
-	for(i = 0; i < n; i++) {
-		if(!(fin[i] = fopen(argv[i + 4], "rb"))) {
-			fprintf(stderr,	"can't open input file (%s)\n", argv[i + 4]);
+	/* resume from checkpoint, inputs open at checkpoint are opened
+		 first and positioned (pending packets are read again) */
+	for(i = 0; i < n; i++)
+		offset[i] = -1;
+	if(resume) {
+		if(ReadCheckpoint(ckpname, &join, &outsize, offset, &stats)) {
+			fprintf(stderr, "can't read checkpoint (%s)\n", ckpname);
 			return(10);
 		}
+		for(i = 0; i < n; i++) {
+			if(join.in[i].state < 0)
+				continue;
+			join.in[i].state = JOIN_CLOSED;
+			join.in[i].open = 0;
+		}
+		fprintf(stderr, "resuming output file (%s) at offset %lld\n",
+						partname, outsize);
 	}
 
 	/* open output file */
-	if(!(fout = fopen(argv[n + 4], "wb"))) {
-		fprintf(stderr, "can't create output file (%s)\n", argv[n + 4]);
+	if(resume)
+		fout = PDSAppend(partname, outsize);
+	else
+		fout = PDSCreate(partname, format, level, threads, frame_size);
+	if(!fout) {
+		fprintf(stderr, "can't create output file (%s)\n", partname);
 		return(10);
 	}
 
-	/* main loop */
-	for(;;) {
-		/* for each input file */
-		for(i = 0; i < n; i++) {
-			/* do until we have a valid packet or we have reached EOF */
-			for(;hdr[i]->flag == 0;) {
-				/* read primary header */
-				if(ReadPriHdr(fin[i], buf_hdr[i])) {
-					/* end of file? */
-					if(feof(fin[i])) {
-						hdr[i]->flag = -1;
-						break;
-					} else {
-						fprintf(stderr,
-										"error reading input file (%s)\n",
-										argv[i + 4]);
-						return(5);
-					}
-				}
-					
-				/* decode primary header */
-				switch(error = DecodePriHdr(buf_hdr[i], hdr[i])) {
-				case 0:
-					break;
-				case -1:
-					fprintf(stderr,
-									"unsupported packet version (%d) in input file "
-									"(%s): "
-									"file might be corrupted, trying to resyncronise\n",
-									hdr[i]->version,
-									argv[i + 4]);
-
-					/* read data block */
-					if(hdr[i]->pkt_length + 1 > DATA_SIZE) {
-						fprintf(stderr,
-										"buffer overflow (%d), "
-										"please contact developer\n",
-										hdr[i]->pkt_length);
-						return(20);
-					}
-					if(fread(buf_data[i], hdr[i]->pkt_length + 1, 1, fin[i]) !=
-						 1) {
-						fprintf(stderr,
-										"error reading input file (%s)\n",
-										argv[i + 4]);
-						return(5);
-					}
-					continue;
-				default:
-					fprintf(stderr,
-									"unknown error (%d) while decoding primary "
-									"header\n",
-									error);
-					return(5);
-				}
-					
-				/* read data block */
-				if(hdr[i]->pkt_length + 1 > DATA_SIZE) {
-					fprintf(stderr,
-									"buffer overflow (%d), "
-									"please contact developer\n",
-									hdr[i]->pkt_length);
-					return(20);
-				}
-				if(fread(buf_data[i], hdr[i]->pkt_length + 1, 1, fin[i]) !=
-					 1) {
-					fprintf(stderr,
-									"error reading input file (%s)\n",
-									argv[i + 4]);
-					return(5);
-				}
+	/* create sample file */
+	if(samplename && !(fsample = fopen(samplename, "wb"))) {
+		fprintf(stderr, "can't create sample file (%s)\n", samplename);
+		return(10);
+	}
 
-				/* is it a packet we need? */
-				if(hdr[i]->apid != apid)
-					continue;
-
-				/* decode MODIS header */
-				DecodeMODISHdr(buf_data[i],
-											 hdr[i]->pkt_length + 1,
-											 mhdr[i]);
-
-				/* calculate checksum */
-				chksum =
-					CalcChecksum12(&(buf_data[i][MODIS_HDR_SIZE]),
-												 (hdr[i]->pkt_length + 1 - MODIS_HDR_SIZE) /
-												 1.5 - 1);
-
-				/* invalid packet? */
-				if(chksum != mhdr[i]->checksum)
-					continue;
-
-				/* before startdate? */
-				if((mhdr[i]->days < startday) ||
-					 ((mhdr[i]->days == startday) &&
-						(mhdr[i]->millisec < startmillisec)))
-					continue;
-
-				/* after enddate? */
-				if((mhdr[i]->days > endday) ||
-					 ((mhdr[i]->days == endday) &&
-						(mhdr[i]->millisec >= endmillisec)))
-					continue;
-
-				/* set valid packet flag */
-				hdr[i]->flag = 1;
-			}
+	/* initialise statistics of output file */
+	if(!resume)
+		StatInit(&stats);
+	ckptime = time(NULL);
+
+	/* inputs read by ReadInput() */
+	mf.names = argv + 4;
+	mf.fin = fin;
+	mf.buf = buf;
+	mf.pkt = pkt;
+	mf.n = n;
+	mf.threads = threads;
+	mf.apid = apid;
+	mf.startday = startday;
+	mf.startmillisec = startmillisec;
+	mf.endday = endday;
+	mf.endmillisec = endmillisec;
+	mf.samples = (fsample != NULL);
+	mf.spliceoff = incremental ? spliceoff : -1;
+	mf.offset = ckpname ? offset : NULL;
+	mf.error = 0;
+
+	/* main loop, oldest packet of inputs to write */
+	error = 0;
+	while(!error && ((oldest = JoinStep(&join, ReadInput, &mf)) >= 0)) {
+		/* write packet to output file */
+		PDSMark(fout, &(pkt[oldest].info));
+		if(PDSWrite(fout, buf[oldest], pkt[oldest].size)) {
+			fprintf(stderr,
+							"error writing to output file (%s)\n",
+							outname);
+			error = 5;
 		}
 
-		/* find the oldest packet */
-		for(i = 0, valpkt = 0; i < n; i++) {
-			/* invalid packet? */
-			if(hdr[i]->flag != 1)
-				continue;
-
-			/* first valid packet? */
-			if(valpkt == 0) {
-				/* set oldest to this this packet */
-				oldest = i;
-
-				/* set flag for valid packet available */
-				valpkt = 1;
-
-				/* next stream */
-				continue;
-			}
-
-			/* test days */
-			if(mhdr[i]->days < mhdr[oldest]->days) {
-				oldest = i;
-				continue;
-			}
-			if(mhdr[i]->days > mhdr[oldest]->days) {
-				continue;
-			}
+		/* write samples (unpacked when checksum was tested) */
+		else if(fsample && pkt[oldest].info.modis &&
+						PDSWriteSamples(fsample, &(pkt[oldest]))) {
+			fprintf(stderr, "error writing sample file (%s)\n", samplename);
+			error = 5;
+		}
 
-			/* test milliseconds */
-			if(mhdr[i]->millisec < mhdr[oldest]->millisec) {
-				oldest = i;
-				continue;
-			}
-			if(mhdr[i]->millisec > mhdr[oldest]->millisec) {
-				continue;
-			}
+		/* add packet to report */
+		else if(report && StatAdd(&stats, &(pkt[oldest].info))) {
+			fprintf(stderr, "not enough memory\n");
+			error = 10;
+		}
 
-			/* test microseconds */
-			if(mhdr[i]->microsec < mhdr[oldest]->microsec) {
-				oldest = i;
-				continue;
-			}
-			if(mhdr[i]->microsec > mhdr[oldest]->microsec) {
-				continue;
-			}
+		/* time for checkpoint? */
+		if(error || !ckpname || (++ckppkts < CKP_PKTS))
+			continue;
+		ckppkts = 0;
+		if(time(NULL) < ckptime + CKP_SECS)
+			continue;
+		ckptime = time(NULL);
 
-			/* test packet count */
-			pktdiff = hdr[i]->pkt_count - hdr[oldest]->pkt_count;
-			if(pktdiff < -8191) pktdiff += 16384;
-			if(pktdiff > 8191) pktdiff -= 16384;
-			if(pktdiff < 0) {
-				oldest = i;
-				continue;
-			}
-			if(pktdiff > 0) {
-				continue;
-			}
+		/* positions of inputs, pending packets are read again */
+		for(i = 0; i < n; i++) {
+			offset[i] = -1;
+			if(fin[i] && (join.in[i].state >= 0))
+				offset[i] = PDSTell(fin[i]) -
+					((join.in[i].state == JOIN_PENDING) ? pkt[i].size : 0);
+		}
 
-			/* identical packets, flag packet from stream i invalid */
-			hdr[i]->flag = 0;
+		/* write checkpoint */
+		if(((outsize = PDSFlush(fout)) < 0) ||
+			 WriteCheckpoint(ckpname, &join, outsize, offset, &stats)) {
+			fprintf(stderr, "error writing checkpoint (%s)\n", ckpname);
+			error = 5;
 		}
+	}
 
-		/* no valid packet available? */
-		if(valpkt == 0)
-			break;
+	/* error reading input? */
+	if(!error && (oldest != JOIN_DONE))
+		error = mf.error;
 
-		/* avoid duplicated and old packets */
-		if(mhdr[oldest]->days < lastdays) {
-			hdr[oldest]->flag = 0;
-			lastdays = mhdr[oldest]->days;
-			lastmillisec = mhdr[oldest]->millisec;
-			lastmicrosec = mhdr[oldest]->microsec;
-			lastpktcount = hdr[oldest]->pkt_count;
-			continue;
-		}
-		if(mhdr[oldest]->days == lastdays) {
-			if(mhdr[oldest]->millisec < lastmillisec) {
-				hdr[oldest]->flag = 0;
-				lastdays = mhdr[oldest]->days;
-				lastmillisec = mhdr[oldest]->millisec;
-				lastmicrosec = mhdr[oldest]->microsec;
-				lastpktcount = hdr[oldest]->pkt_count;
-				continue;
-			}
-			if(mhdr[oldest]->millisec == lastmillisec) {
-				if(mhdr[oldest]->microsec < lastmicrosec) {
-					hdr[oldest]->flag = 0;
-					lastdays = mhdr[oldest]->days;
-					lastmillisec = mhdr[oldest]->millisec;
-					lastmicrosec = mhdr[oldest]->microsec;
-					lastpktcount = hdr[oldest]->pkt_count;
-					continue;
-				}
-				if(mhdr[oldest]->microsec == lastmicrosec) {
-					pktdiff = hdr[oldest]->pkt_count - lastpktcount;
-					if(pktdiff < -8191) pktdiff += 16384;
-					if(pktdiff > 8191) pktdiff -= 16384;
-					if(pktdiff <= 0) {
-						hdr[oldest]->flag = 0;
-						lastdays = mhdr[oldest]->days;
-						lastmillisec = mhdr[oldest]->millisec;
-						lastmicrosec = mhdr[oldest]->microsec;
-						lastpktcount = hdr[oldest]->pkt_count;
-						continue;
-						/*	}*/
-					}
-				}
-			}
-		}
+	/* close output file */
+	if(!error && PDSFinish(fout)) {
+		fprintf(stderr,
+						"error writing to output file (%s)\n",
+						outname);
+		error = 5;
+	}
 
-		/* store packet date/time/sample/pktcount */
-		lastdays = mhdr[oldest]->days;
-		lastmillisec = mhdr[oldest]->millisec;
-		lastmicrosec = mhdr[oldest]->microsec;
-		lastpktcount = hdr[oldest]->pkt_count;
-		
-		/* write packet to output file */
-		if(WritePriHdr(fout, buf_hdr[oldest])) {
-			fprintf(stderr,
-							"error writing to output file (%s)\n",
-							argv[n + 4]);
-			return(5);
-		}
-		if(fwrite(buf_data[oldest],
-							hdr[oldest]->pkt_length + 1,
-							1, fout) != 1) {
-			fprintf(stderr,
-							"error writing to output file (%s)\n",
-							argv[n + 4]);
-			return(5);
-		}
+	/* failed? then the part written is removed, unless it's needed to
+		 resume from the checkpoint */
+	if(error) {
+		if(!ckpname)
+			remove(partname);
+		return(error);
+	}
 
-		/* flag packet from stream oldest invalid */
-		hdr[oldest]->flag = 0;
+	/* close sample file */
+	if(fsample && fclose(fsample)) {
+		fprintf(stderr, "error writing sample file (%s)\n", samplename);
+		return(5);
 	}
-	
-	/* close output file */
-	fclose(fout);
 
 	/* close input files */
 	for(i = 0; i < n; i++){
-		fclose(fin[i]);
+		if(fin[i])
+			PDSClose(fin[i]);
+	}
+
+	/* replace rewritten part of existing output or move output into
+		 place */
+	if(incremental ? SpliceFile(outname, spliceoff, partname) :
+		 rename(partname, outname)) {
+		fprintf(stderr,
+						"error writing to output file (%s)\n",
+						outname);
+		return(5);
 	}
 
+	/* merge done, checkpoint not needed anymore */
+	if(ckpname)
+		remove(ckpname);
+
+	/* print report */
+	if(report) {
+		PrintStats(&stats);
+		for(i = 0; i < n; i++) {
+			printf("input %s: ", argv[i + 4]);
+			if(join.in[i].state == IN_SKIPPED)
+				printf("skipped\n");
+			else
+				printf("written %ld checksum errors %ld duplicates %ld\n",
+							 join.in[i].written, join.in[i].checksum,
+							 join.in[i].duplicate);
+		}
+	}
+	StatFree(&stats);
+
 	/* free memory */
 	for(i = 0; i < n; i++) {
-		free(buf_data[i]);
-		free(buf_hdr[i]);
-		free(mhdr[i]);
-		free(hdr[i]);
-	}
-	free(buf_data);
-	free(buf_hdr);
-	free(mhdr);
-	free(hdr);
+		free(buf[i]);
+		free(pkt[i].samples);
+	}
+	free(buf);
+	JoinFree(&join);
+	free(pkt);
 	free(fin);
+	free(cov);
+	free(partname);
+	free(offset);
+	FilterFree(filter);
 
 	/* Ja das war's. Der Pop-Shop ist zu Ende */
   return(0);
@@ -586,303 +911,1723 @@ int main(int argc, char *argv[]) {
 
 /********************************************************************
  *                                                                  *
- *  read primary header from file                                   *
+ *  read next packet of input (read function of JoinStep())         *
  *                                                                  *
- *  f:   file pointer                                               *
- *  buf: pointer to buffer                                          *
+ *  The input is opened on the first read, i.e. when the merge      *
+ *  reaches it, and closed at its end.                              *
  *                                                                  *
- *  result:  0 - ok                                                 *
- *          -1 - read error                                         *
+ *  arg: pointer to inputs (struct merge_files, error is set)       *
+ *  i:   input                                                      *
+ *  buf: pointer to store pointer to packet buffer                  *
+ *  pkt: pointer to store pointer to decoded packet                 *
+ *                                                                  *
+ *  result: JOIN_PACKET, JOIN_END, JOIN_SKIP (see pdsjoin.h)        *
+ *          -1 - error                                              *
  *                                                                  *
  ********************************************************************/
-int ReadPriHdr(FILE *f, unsigned char *buf) {
-	/* read header */
-	if(fread(buf, PRI_HDR_SIZE, 1, f) != 1)
-		return(-1);
+int ReadInput(void *arg, int i, unsigned char **buf,
+							struct pds_packet **pkt) {
+	/* inputs */
+	struct merge_files *m = arg;
+	/* error code */
+	int error;
 
-	/* ois rodger */
-	return(0);
-}
 
+	/* open input */
+	if(!m->fin[i]) {
+		m->error = 10;
+		if(!(m->buf[i] = malloc(sizeof(unsigned char) * PDS_PKT_SIZE)) ||
+			 (m->samples &&
+				!(m->pkt[i].samples =
+					malloc(sizeof(unsigned short) * PDS_MAX_SAMPLES)))) {
+			fprintf(stderr, "not enough memory\n");
+			return(-1);
+		}
+		if(!(m->fin[i] = PDSOpen(m->names[i], m->threads))) {
+			fprintf(stderr,	"can't open input file (%s)\n", m->names[i]);
+			return(-1);
+		}
+
+		/* existing output from first new packet on */
+		if((m->spliceoff >= 0) && (i == m->n - 1) &&
+			 PDSSeek(m->fin[i], m->spliceoff)) {
+			fprintf(stderr,	"can't open input file (%s)\n", m->names[i]);
+			return(-1);
+		}
 
-/********************************************************************
- *                                                                  *
- *  write primary header to file                                    *
- *                                                                  *
- *  f:   file pointer                                               *
- *  buf: pointer to buffer                                          *
- *                                                                  *
- *  result:  0 - ok                                                 *
- *          -1 - write error                                        *
- *                                                                  *
- ********************************************************************/
-int WritePriHdr(FILE *f, unsigned char *buf) {
-	/* read header */
-	if(fwrite(buf, PRI_HDR_SIZE, 1, f) != 1)
+		/* checkpoints need positions in input */
+		if(m->offset && ((PDSFormat(m->fin[i]) != PDS_FMT_PLAIN) ||
+										 ((m->offset[i] >= 0) &&
+											PDSSeek(m->fin[i], m->offset[i])))) {
+			fprintf(stderr,	"can't resume plain input file (%s)\n",
+							m->names[i]);
+			return(-1);
+		}
+
+		/* only read archive blocks we need */
+		PDSSetWindow(m->fin[i], m->startday, m->startmillisec, m->endday,
+								 m->endmillisec, m->apid);
+		m->error = 0;
+	}
+
+	/* read next packet, checked after filter */
+	error = PDSReadPacket(m->fin[i], m->buf[i], &(m->pkt[i]),
+												PDS_LEVEL_DATA);
+
+	/* end of file? then close input file */
+	if(error == 1) {
+		PDSClose(m->fin[i]);
+		m->fin[i] = NULL;
+		free(m->buf[i]);
+		m->buf[i] = NULL;
+		free(m->pkt[i].samples);
+		m->pkt[i].samples = NULL;
+		return(JOIN_END);
+	}
+	if((error == -1) || (error == -3)) {
+		fprintf(stderr, "error reading input file (%s)\n", m->names[i]);
+		m->error = 5;
+		return(-1);
+	}
+	if(error == -4) {
+		fprintf(stderr,
+						"buffer overflow (%d), please contact developer\n",
+						(((int)m->buf[i][4]) << 8) + m->buf[i][5]);
+		m->error = 20;
 		return(-1);
+	}
 
-	/* ois rodger */
-	return(0);
+	/* unsupported packet version? */
+	if(error == -2) {
+		fprintf(stderr,
+						"unsupported packet version (%d) in input file (%s): "
+						"file might be corrupted, trying to resyncronise\n",
+						m->pkt[i].hdr.version, m->names[i]);
+		return(JOIN_SKIP);
+	}
+
+	/* here you are */
+	*buf = m->buf[i];
+	*pkt = &(m->pkt[i]);
+	return(JOIN_PACKET);
 }
 
 
 /********************************************************************
  *                                                                  *
- *  decode primary header                                           *
+ *  run merge jobs of manifest                                      *
  *                                                                  *
- *  buf: pointer to buffer                                          *
- *  hdr: pointer to header structure                                *
+ *  Every input named in the manifest is opened once and read in    *
+ *  chunks of packets, which all jobs merging the input take their  *
+ *  packets from. The jobs run in rounds on a pool of threads: each *
+ *  job merges until it needs a packet of an input which hasn't     *
+ *  been read yet, then the inputs jobs are waiting for are read    *
+ *  (one thread per input) and the chunks all jobs are done with    *
+ *  are freed. Each job gives the same output as pdsmerge run with  *
+ *  the job alone. The output of a job is only created when all its *
+ *  inputs are open, it's written to <output>.part, which is        *
+ *  renamed when the job is done or removed when it fails.          *
  *                                                                  *
- *  result:  0 - ok                                                 *
- *          -1 - decode error (version not supported)               *
+ *  name:       manifest file name                                  *
+ *  threads:    number of threads                                   *
+ *  format:     output file format                                  *
+ *  level:      compression level                                   *
+ *  frame_size: size of compressed frames                           *
+ *  filterexpr: filter expression (or NULL)                         *
+ *  report:     print statistics of each job                        *
+ *                                                                  *
+ *  result:  0 - all jobs ok                                        *
+ *          >0 - exit code of failed job (highest)                  *
  *                                                                  *
  ********************************************************************/
-int DecodePriHdr(unsigned char *buf, struct pri_hdr *hdr) {
-	/* version */
-	hdr->version = (buf[0] & 0xE0) >> 5;
-
-	/* version supported? */
-	if(hdr->version != 0)
-		return(-1);
+int RunManifest(char *name, int threads, int format, int level,
+								long frame_size, char *filterexpr, int report) {
+	/* manifest */
+	struct manifest m;
+	/* pointer to job */
+	struct merge_job *j;
+	/* pointer to input */
+	struct merge_input *in;
+	/* counters */
+	int i, k;
+	/* exit code */
+	int retvalue = 0;
+
+
+	/* read manifest */
+	memset(&m, 0, sizeof(struct manifest));
+	m.threads = threads;
+	pthread_mutex_init(&(m.lock), NULL);
+	switch(ReadManifest(name, &m)) {
+	case 0:
+		break;
+	case -1:
+		fprintf(stderr, "can't read manifest (%s)\n", name);
+		FreeManifest(&m);
+		return(10);
+	case -2:
+		fprintf(stderr, "not enough memory\n");
+		FreeManifest(&m);
+		return(10);
+	default:
+		FreeManifest(&m);
+		return(20);
+	}
+	fprintf(stderr, "%d jobs, %d input files\n", m.njobs, m.ninputs);
+
+	/* open inputs, archives are only read in the time range of all
+		 their jobs, all inputs are read first */
+	for(i = 0; i < m.ninputs; i++) {
+		in = m.inputs[i];
+		in->wanted = 1;
+		if(!(in->f = PDSOpen(in->name, 1))) {
+			fprintf(stderr,	"can't open input file (%s)\n", in->name);
+			in->error = 10;
+			continue;
+		}
+		PDSSetWindow(in->f, in->startday, in->startmillisec, in->endday,
+								 in->endmillisec, in->apid);
+	}
 
-	/* type */
-	hdr->type = (buf[0] & 0x10) >> 4;
+	/* create outputs of jobs with all inputs open */
+	for(k = 0; k < m.njobs; k++) {
+		j = &(m.jobs[k]);
+		StatInit(&(j->stats));
+		if((filterexpr &&
+				!(j->join.filter = FilterCompile(filterexpr, NULL))) ||
+			 !(j->partname = malloc(strlen(j->outname) + 6))) {
+			fprintf(stderr, "not enough memory\n");
+			FreeManifest(&m);
+			return(10);
+		}
+		sprintf(j->partname, "%s.part", j->outname);
+		for(i = 0; (i < j->n) && !j->in[i]->error; i++)
+			;
+		if(i < j->n) {
+			j->error = j->in[i]->error;
+			j->done = 1;
+		}
+		else if(!(j->fout = PDSCreate(j->partname, format, level, 1,
+																	frame_size))) {
+			fprintf(stderr, "can't create output file (%s)\n", j->partname);
+			j->error = 10;
+			j->done = 1;
+		}
+	}
 
-	/* secondary header flag */
-	hdr->sec_hdr_flag = (buf[0] & 0x08) >> 3;
+	/* rounds of reading and merging */
+	for(;;) {
+		/* read inputs jobs are waiting for */
+		m.phase = 0;
+		for(i = 0, m.nitems = 0; i < m.ninputs; i++) {
+			in = m.inputs[i];
+			if(in->wanted && !in->eof && !in->error)
+				m.items[m.nitems++] = i;
+			in->wanted = 0;
+		}
+		if(RunPhase(&m)) {
+			fprintf(stderr, "can't start threads\n");
+			FreeManifest(&m);
+			return(10);
+		}
 
-	/* APID */
-	hdr->apid = (((int)(buf[0] & 0x07)) << 8) + buf[1];
+		/* run jobs until they wait for input or are done */
+		m.phase = 1;
+		for(k = 0, m.nitems = 0; k < m.njobs; k++)
+			if(!m.jobs[k].done)
+				m.items[m.nitems++] = k;
+		if(!m.nitems)
+			break;
+		if(RunPhase(&m)) {
+			fprintf(stderr, "can't start threads\n");
+			FreeManifest(&m);
+			return(10);
+		}
 
-	/* sequence flags */
-	hdr->seq_flags = (buf[2] & 0xC0) >> 6;
+		/* note inputs jobs wait for, free chunks all jobs are done with */
+		for(k = 0; k < m.njobs; k++) {
+			j = &(m.jobs[k]);
+			for(i = 0; !j->done && (i < j->n); i++)
+				if((j->join.in[i].state == JOIN_READ) &&
+					 (j->chunk[i] ? (j->chunk[i] == j->in[i]->tail) &&
+						(j->idx[i] == j->chunk[i]->n) : !j->in[i]->head))
+					j->in[i]->wanted = 1;
+		}
+		TrimInputs(&m);
+	}
 
-	/* packet count per APID */
-	hdr->pkt_count = (((int)(buf[2] & 0x3F)) << 8) + buf[3];
+	/* report jobs */
+	for(k = 0; k < m.njobs; k++) {
+		j = &(m.jobs[k]);
+		switch(j->error) {
+		case 0:
+			break;
+		case 5:
+			fprintf(stderr, "error reading input or writing output file, "
+							"job failed (%s)\n", j->outname);
+			break;
+		case 10:
+			fprintf(stderr, "job failed (%s)\n", j->outname);
+			break;
+		default:
+			fprintf(stderr, "buffer overflow, please contact developer, "
+							"job failed (%s)\n", j->outname);
+			break;
+		}
+		if(j->error > retvalue)
+			retvalue = j->error;
+		if(!report || j->error)
+			continue;
+		printf("output %s:\n", j->outname);
+		PrintStats(&(j->stats));
+		for(i = 0; i < j->n; i++)
+			printf("input %s: written %ld checksum errors %ld duplicates %ld\n",
+						 j->in[i]->name, j->join.in[i].written,
+						 j->join.in[i].checksum, j->join.in[i].duplicate);
+	}
 
-	/* packet length (length - 1) */
-	hdr->pkt_length = (((int)buf[4]) << 8) + buf[5];
+	/* clean up */
+	FreeManifest(&m);
 
-	/* okeydokey */
-	return(0);
+	/* passt */
+	return(retvalue);
 }
 
 
 /********************************************************************
  *                                                                  *
- *  decode MODIS header                                             *
+ *  read manifest                                                   *
+ *                                                                  *
+ *  One job per line: start_date end_date APID <input 1> [<input 2> *
+ *  [...]] output, like the arguments of pdsmerge. Empty lines and  *
+ *  lines starting with # are skipped. Inputs named by more than    *
+ *  one job are read once, in the time range of all these jobs.     *
  *                                                                  *
- *  buf: pointer to buffer                                          *
- *  len: data lengh                                                 *
- *  hdr: pointer to header structure                                *
+ *  name: manifest file name                                        *
+ *  m:    pointer to manifest to fill                               *
  *                                                                  *
  *  result:  0 - ok                                                 *
- *          -1 - decode error                                       *
- *          -2 - decode error                                       *
+ *          -1 - can't read manifest                                *
+ *          -2 - out of memory                                      *
+ *          -3 - syntax error or no jobs (reported)                 *
  *                                                                  *
  ********************************************************************/
-int DecodeMODISHdr(unsigned char *buf, int len,
-									 struct modis_hdr *hdr) {
-	/* days since 01/01/1958 */
-	hdr->days =
-		(((int)buf[0]) << 8) +
-		(((int)buf[1]));
-	
-	/* milliseconds of day */
-	hdr->millisec =
-		(((unsigned long int)buf[2]) << 24) +
-		(((unsigned long int)buf[3]) << 16) +
-		(((unsigned long int)buf[4]) << 8) +
-		(((unsigned long int)buf[5]));
-	
-	/* microseconds of milliseconds */
-	hdr->microsec =
-		(((int)buf[6]) << 8) +
-		(((int)buf[7]));
-	
-	/* quicklook flag */
-	hdr->ql = (buf[8] & 0x80) >> 7;
-	
-	/* packet type */
-	hdr->pkt_type = (buf[8] & 0x70) >> 4;
-	
-	/* scan count */
-	hdr->scan_count = (buf[8] & 0x0E) >> 1;
-	
-	/* mirror side */
-	hdr->mirror_side = (buf[8] & 1);
-	
-	/* source identification (0 = earth, 1 = calibration) */
-	hdr->src1 = (buf[9] & 0x80) >> 7;
-
-	/* source identification (0 = eng., 1 to 1354 = sample count) */
-	hdr->src2 =
-		(((int)buf[9] & 0x7F) << 4) +
-		(((int)buf[10] & 0xF0) >> 4);
-
-	/* FPA/AEM config */
-	hdr->conf =
-		(((int)buf[10] & 0x0F) << 6) +
-		(((int)buf[11] & 0xFC) >> 2);
+int ReadManifest(char *name, struct manifest *m) {
+	/* manifest file */
+	FILE *f;
+	/* line and its size */
+	char *line = NULL;
+	size_t size = 0;
+	/* words of line */
+	char **words = NULL;
+	int nwords, maxwords = 0;
+	/* pointer to word */
+	char *w;
+	/* new array */
+	void *p;
+	/* pointer to job */
+	struct merge_job *j;
+	/* pointer to input */
+	struct merge_input *in;
+	/* line number */
+	int lineno = 0;
+	/* counters */
+	int i, k;
+	/* error code */
+	int error = 0;
 
-	/* sci state */
-	hdr->sci_state = (((int)buf[11] & 0x02) >> 1);
 
-	/* sci abnorm */
-	hdr->sci_abnorm = (((int)buf[11] & 0x01));
+	/* open manifest */
+	if(!(f = fopen(name, "r")))
+		return(-1);
 
-	/* check sum */
-	hdr->checksum =
-		(((int)buf[len - 2] & 0x0F) << 8) +
-		(((int)buf[len - 1]));
-}
+	while(!error && (getline(&line, &size, f) >= 0)) {
+		lineno++;
 
+		/* split line into words */
+		for(nwords = 0, w = strtok(line, " \t\r\n"); w;
+				w = strtok(NULL, " \t\r\n")) {
+			if(nwords == maxwords) {
+				if(!(p = realloc(words, (maxwords + 16) * sizeof(char *)))) {
+					error = -2;
+					break;
+				}
+				words = p;
+				maxwords += 16;
+			}
+			words[nwords++] = w;
+		}
+		if(error || !nwords || (words[0][0] == '#'))
+			continue;
 
-/********************************************************************
+		/* add job */
+		if(nwords < 5) {
+			fprintf(stderr, "manifest line %d: missing arguments\n", lineno);
+			error = -3;
+			break;
+		}
+		if(!(p = realloc(m->jobs, (m->njobs + 1) *
+										 sizeof(struct merge_job)))) {
+			error = -2;
+			break;
+		}
+		m->jobs = p;
+		j = &(m->jobs[m->njobs++]);
+		memset(j, 0, sizeof(struct merge_job));
+
+		/* time range and APID */
+		if(GetDateArg(words[0], 0, &(j->startday), &(j->startmillisec)) ||
+			 GetDateArg(words[1], 1, &(j->endday), &(j->endmillisec)) ||
+			 (j->endday < j->startday) ||
+			 ((j->endday == j->startday) &&
+				(j->endmillisec <= j->startmillisec))) {
+			fprintf(stderr, "manifest line %d: invalid date\n", lineno);
+			error = -3;
+			break;
+		}
+		j->apid = atoi(words[2]);
+		if(!PDSDecoder(j->apid)) {
+			fprintf(stderr, "manifest line %d: APID %d not supported\n",
+							lineno, j->apid);
+			error = -3;
+			break;
+		}
+
+		/* output and inputs */
+		j->n = nwords - 4;
+		if(!(j->outname = strdup(words[nwords - 1])) ||
+			 !(j->in = calloc(j->n, sizeof(struct merge_input *))) ||
+			 !(j->chunk = calloc(j->n, sizeof(struct merge_chunk *))) ||
+			 !(j->idx = calloc(j->n, sizeof(int))) ||
+			 JoinInit(&(j->join), j->n, j->apid, j->startday, j->startmillisec,
+								j->endday, j->endmillisec, NULL)) {
+			error = -2;
+			break;
+		}
+		for(i = 0; i < j->n; i++)
+			j->join.in[i].check = JOIN_CHECKED;
+		for(i = 0; !error && (i < j->n); i++) {
+			/* new input? */
+			for(k = 0; (k < m->ninputs) &&
+						strcmp(m->inputs[k]->name, words[i + 3]); k++)
+				;
+			if(k == m->ninputs) {
+				if(!(p = realloc(m->inputs, (m->ninputs + 1) *
+												 sizeof(struct merge_input *))) ||
+					 !(in = calloc(1, sizeof(struct merge_input)))) {
+					error = -2;
+					break;
+				}
+				m->inputs = p;
+				m->inputs[m->ninputs++] = in;
+				if(!(in->name = strdup(words[i + 3]))) {
+					error = -2;
+					break;
+				}
+				in->startday = j->startday;
+				in->startmillisec = j->startmillisec;
+				in->endday = j->endday;
+				in->endmillisec = j->endmillisec;
+				in->apid = j->apid;
+			}
+			in = m->inputs[k];
+			j->in[i] = in;
+
+			/* time range and APIDs of all jobs */
+			if((j->startday < in->startday) ||
+				 ((j->startday == in->startday) &&
+					(j->startmillisec < in->startmillisec))) {
+				in->startday = j->startday;
+				in->startmillisec = j->startmillisec;
+			}
+			if((j->endday > in->endday) ||
+				 ((j->endday == in->endday) &&
+					(j->endmillisec > in->endmillisec))) {
+				in->endday = j->endday;
+				in->endmillisec = j->endmillisec;
+			}
+			if(in->apid != j->apid)
+				in->apid = -1;
+			in->apids[j->apid] = 1;
+		}
+	}
+	fclose(f);
+	free(line);
+	free(words);
+	if(error)
+		return(error);
+	if(!m->njobs) {
+		fprintf(stderr, "no jobs in manifest\n");
+		return(-3);
+	}
+
+	/* work items of rounds */
+	if(!(m->items = malloc(((m->njobs > m->ninputs) ? m->njobs :
+													m->ninputs) * sizeof(int))))
+		return(-2);
+
+	/* okeydokey */
+	return(0);
+}
+
+
+/********************************************************************
  *                                                                  *
- *  convert calendar date to julian day                             *
+ *  convert date argument                                           *
  *                                                                  *
- *  minute: minute of time to convert                               *
- *  hour:   hour of time to convert                                 *
- *  day:    day of date to convert                                  *
- *  month:  month of date to convert                                *
- *  year:   year of date to convert                                 *
- *  jul:    pointer to store julian day                             *
+ *  s:        date string (YYYY/MM/DD,hh:mm:ss or -)                *
+ *  end:      end date (- is after all packets, else before)        *
+ *  day:      pointer to store days since 01/01/1958                *
+ *  millisec: pointer to store milliseconds of day                  *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          -1 - invalid date                                       *
+ *                                                                  *
+ ********************************************************************/
+int GetDateArg(char *s, int end, int *day, unsigned long *millisec) {
+	/* date/time */
+	int year, month, mday, hour, min, sec;
+	/* julian day */
+	double x;
+
+
+	/* open range */
+	if(strcmp(s, "-") == 0) {
+		*day = end ? 4000000 : 0;
+		*millisec = end ? 90000000L : 0;
+		return(0);
+	}
+
+	/* decode and check date */
+	if(sscanf(s, " %d/%d/%d,%d:%d:%d",
+						&year, &month, &mday, &hour, &min, &sec) != 6)
+		return(-1);
+	if((year < 1958) ||
+		 (month < 1) || (month > 12) ||
+		 (mday < 1) || (mday > 31) ||
+		 (hour < 0) || (hour > 23) ||
+		 (min < 0) || (min > 59) ||
+		 (sec < 0) || (sec >59))
+		return(-1);
+
+	/* convert */
+	julday(0, 0, mday, month, year, &x);
+	*day = (int)(x - MODIS_REF_DATE);
+	*millisec =
+		(unsigned long)hour * 60L * 60L * 1000L +
+		(unsigned long)min * 60L * 1000L +
+		(unsigned long)sec * 1000L;
+
+	/* ok */
+	return(0);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  run work items of a round on the threads                        *
+ *                                                                  *
+ *  m: pointer to manifest (phase and items set)                    *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          -1 - can't start threads                                *
+ *                                                                  *
+ ********************************************************************/
+int RunPhase(struct manifest *m) {
+	/* threads */
+	pthread_t *tid;
+	/* number of threads */
+	int n;
+	/* counter */
+	int i;
+	/* error code */
+	int error = 0;
+
+
+	/* single thread */
+	m->next = 0;
+	n = (m->threads < m->nitems) ? m->threads : m->nitems;
+	if(n <= 1) {
+		PhaseWorker(m);
+		return(0);
+	}
+
+	/* pool of threads */
+	if(!(tid = malloc(n * sizeof(pthread_t))))
+		return(-1);
+	for(i = 0; i < n; i++) {
+		if(pthread_create(&(tid[i]), NULL, PhaseWorker, m)) {
+			error = -1;
+			break;
+		}
+	}
+	while(i--)
+		pthread_join(tid[i], NULL);
+	free(tid);
+
+	/* ois rodger */
+	return(error);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  worker of round: reads inputs or runs jobs until none is left   *
+ *                                                                  *
+ *  arg: pointer to manifest                                        *
+ *                                                                  *
+ *  result: NULL                                                    *
+ *                                                                  *
+ ********************************************************************/
+void *PhaseWorker(void *arg) {
+	/* manifest */
+	struct manifest *m = arg;
+	/* item */
+	int item;
+
+
+	for(;;) {
+		/* take next item */
+		pthread_mutex_lock(&(m->lock));
+		item = (m->next < m->nitems) ? m->items[m->next++] : -1;
+		pthread_mutex_unlock(&(m->lock));
+		if(item < 0)
+			return(NULL);
+
+		/* do it */
+		if(m->phase == 0)
+			ReadChunk(m->inputs[item]);
+		else
+			RunJob(&(m->jobs[item]));
+	}
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  read next chunk of input                                        *
+ *                                                                  *
+ *  Reads up to MAN_CHUNK_PKTS packets or MAN_CHUNK_SIZE bytes and  *
+ *  keeps the packets of APIDs of jobs, checked once for all jobs.  *
+ *                                                                  *
+ *  in: pointer to input (chunk appended, eof or error set)         *
  *                                                                  *
  *  result: none                                                    *
  *                                                                  *
  ********************************************************************/
-void julday(int minute, int hour, int day, int month, int year,
-						double *jul) {
-	/* julian day as long */
-	long ljul;
-	/* helping variables */
-	int ja, jy, jm;
+void ReadChunk(struct merge_input *in) {
+	/* new chunk */
+	struct merge_chunk *c;
+	/* pointer to packet */
+	struct merge_pkt *p;
+	/* bytes of packets */
+	long used = 0;
+	/* counter */
+	int i;
+	/* error code */
+	int error;
 
 
-	jy = year;
+	/* new chunk */
+	if(!(c = calloc(1, sizeof(struct merge_chunk))) ||
+		 !(c->pkts = malloc(MAN_CHUNK_PKTS * sizeof(struct merge_pkt))) ||
+		 !(c->data = malloc(MAN_CHUNK_SIZE + PDS_PKT_SIZE))) {
+		if(c)
+			free(c->pkts);
+		free(c);
+		in->error = 10;
+		return;
+	}
 
-	if(jy < 0)
-		++jy;
-	if(month > 2) {
-		jm = month + 1;
-	} else {
-		--jy;
-		jm = month + 13;
+	/* read packets */
+	while((c->n < MAN_CHUNK_PKTS) && (used < MAN_CHUNK_SIZE)) {
+		p = &(c->pkts[c->n]);
+		p->pkt.samples = NULL;
+		error = PDSReadPacket(in->f, c->data + used, &(p->pkt),
+													PDS_LEVEL_DATA);
+
+		/* end of file? */
+		if(error == 1) {
+			in->eof = 1;
+			break;
+		}
+		if((error == -1) || (error == -3)) {
+			fprintf(stderr, "error reading input file (%s)\n", in->name);
+			in->error = 5;
+			break;
+		}
+		if(error == -4) {
+			in->error = 20;
+			break;
+		}
+
+		/* unsupported packet version? */
+		if(error == -2) {
+			fprintf(stderr,
+							"unsupported packet version (%d) in input file (%s): "
+							"file might be corrupted, trying to resyncronise\n",
+							p->pkt.hdr.version, in->name);
+			continue;
+		}
+
+		/* keep packets of APIDs of jobs */
+		if(!in->apids[p->pkt.hdr.apid])
+			continue;
+		PDSCheckPacket(c->data + used, &(p->pkt));
+		p->offset = used;
+		used += p->pkt.size;
+		c->n++;
+	}
+
+	/* append chunk, nothing to keep? */
+	for(i = 0; i < c->n; i++)
+		c->pkts[i].data = c->data + c->pkts[i].offset;
+	c->first = in->count;
+	in->count += c->n;
+	if(!c->n) {
+		free(c->pkts);
+		free(c->data);
+		free(c);
+		return;
+	}
+	if(in->tail)
+		in->tail->next = c;
+	else
+		in->head = c;
+	in->tail = c;
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  run job until it waits for an input or is done                  *
+ *                                                                  *
+ *  Merges like the main loop, the inputs being the chunks read so  *
+ *  far. The job waits when it needs a packet of an input beyond    *
+ *  these chunks, after taking the packets of all other inputs it   *
+ *  needs. When all inputs are at their end the output is closed.   *
+ *                                                                  *
+ *  j: pointer to job (done and error set)                          *
+ *                                                                  *
+ *  result: none                                                    *
+ *                                                                  *
+ ********************************************************************/
+void RunJob(struct merge_job *j) {
+	/* pointer to packet taken */
+	struct join_input *out;
+	/* input with oldest packet */
+	int oldest;
+
+
+	while((oldest = JoinStep(&(j->join), ReadJobInput, j)) >= 0) {
+		out = &(j->join.in[oldest]);
+
+		/* write packet to output file */
+		PDSMark(j->fout, &(out->pkt->info));
+		if(PDSWrite(j->fout, out->buf, out->pkt->size)) {
+			j->error = 5;
+			JobDone(j);
+			return;
+		}
+
+		/* add packet to report */
+		if(StatAdd(&(j->stats), &(out->pkt->info))) {
+			j->error = 10;
+			JobDone(j);
+			return;
+		}
 	}
-	ljul = (long)(floor(365.25 * jy) + floor(30.6001 * jm) + day +
-								1720995);
-	if(day + 31L * (month + 12L * year) >= (15+31L*(10+12L*1582))) {
-		ja = (int)(0.01 * jy);
-		ljul += 2 - ja + (int)(0.25 * ja);
+
+	/* wait for inputs to be read, or done (error of input set) */
+	if(oldest != JOIN_WAIT)
+		JobDone(j);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  next packet of job from chunks of input (read function of       *
+ *  JoinStep())                                                     *
+ *                                                                  *
+ *  arg: pointer to job (error set)                                 *
+ *  i:   input of job                                               *
+ *  buf: pointer to store pointer to packet data                    *
+ *  pkt: pointer to store pointer to decoded packet                 *
+ *                                                                  *
+ *  result: JOIN_PACKET, JOIN_END, JOIN_NOTYET (see pdsjoin.h)      *
+ *          -1 - error reading input                                *
+ *                                                                  *
+ ********************************************************************/
+int ReadJobInput(void *arg, int i, unsigned char **buf,
+								 struct pds_packet **pkt) {
+	/* job */
+	struct merge_job *j = arg;
+	/* pointer to input */
+	struct merge_input *in = j->in[i];
+	/* pointer to packet of chunk */
+	struct merge_pkt *p;
+
+
+	/* next chunk */
+	if(!j->chunk[i] && in->head) {
+		j->chunk[i] = in->head;
+		j->idx[i] = 0;
+	}
+	while(j->chunk[i] && (j->idx[i] == j->chunk[i]->n) &&
+				j->chunk[i]->next) {
+		j->chunk[i] = j->chunk[i]->next;
+		j->idx[i] = 0;
+	}
+
+	/* all packets read so far taken? */
+	if(!j->chunk[i] || (j->idx[i] == j->chunk[i]->n)) {
+		if(in->error) {
+			j->error = in->error;
+			return(-1);
+		}
+		return(in->eof ? JOIN_END : JOIN_NOTYET);
 	}
 
-	*jul =
-		(double)ljul +
-		(double)hour / 24.0 +
-		(double)minute / 1440.0 +
-		0.000001; /* add about 0.1s to avoid precision problems */
+	/* packet of job (checked when read) */
+	p = &(j->chunk[i]->pkts[j->idx[i]]);
+	j->idx[i]++;
+	*buf = p->data;
+	*pkt = &(p->pkt);
+	return(JOIN_PACKET);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  close output of finished or failed job                          *
+ *                                                                  *
+ *  The output replaces <output> when the job is done, it's removed *
+ *  when the job failed, so an existing output is left alone.       *
+ *                                                                  *
+ *  j: pointer to job                                               *
+ *                                                                  *
+ *  result: none                                                    *
+ *                                                                  *
+ ********************************************************************/
+void JobDone(struct merge_job *j) {
+	/* close output, move it into place */
+	if(j->fout) {
+		if(PDSFinish(j->fout) && !j->error)
+			j->error = 5;
+		if(!j->error && rename(j->partname, j->outname)) {
+			fprintf(stderr, "can't rename output file (%s)\n", j->partname);
+			j->error = 5;
+		}
+		if(j->error)
+			remove(j->partname);
+	}
+	j->fout = NULL;
+	j->done = 1;
 }
 
 
 /********************************************************************
  *                                                                  *
- *  convert julian day to calendar date                             *
+ *  free chunks of inputs all running jobs are done with            *
+ *                                                                  *
+ *  The last chunk of an input is kept, as jobs continue from it.   *
  *                                                                  *
- *  minute: pointer to store minute                                 *
- *  hour:   pointer to store hour                                   *
- *  day:    pointer to store day                                    *
- *  month:  pointer to store month                                  *
- *  year:   pointer to store year                                   *
- *  jul:    julian day                                              *
+ *  m: pointer to manifest                                          *
  *                                                                  *
  *  result: none                                                    *
  *                                                                  *
  ********************************************************************/
-void caldat(int *minute, int *hour, int *day, int *month, int *year,
-						double jul) {
-	/* julian day as long */
-	long ljul;
-	/* helping variables */
-	long ja, jalpha, jb, jc, jd, je;
-
-
-	ljul = (long)floor(jul);
-	jul -= (double)ljul;
-	*hour = (int)(floor(jul * 24.0));
-	jul -= (double)*hour / 24.0;
-	*minute = (int)(floor(jul * 1440.0));
-
-	if(ljul >= 2299161) {
-		jalpha = (long)(((float)(ljul - 1867216) - 0.25) / 36524.25);
-		ja = ljul + 1 + jalpha -(long)(0.25 * jalpha);
-	} else
-		ja = ljul;
-	jb = ja + 1524;
-	jc = (long)(6680.0 + ((float)(jb - 2439870) - 122.1) / 365.25);
-	jd = (long)(365 * jc + (0.25 * jc));
-	je = (long)((jb - jd) / 30.6001);
-	*day = jb - jd -(long)(30.6001*je);
-	*month = je - 1;
-	if(*month > 12)
-		*month -= 12;
-	*year = jc - 4715;
-	if(*month > 2)
-		--(*year);
-	if(*year <= 0)
-		--(*year);
+void TrimInputs(struct manifest *m) {
+	/* pointer to job */
+	struct merge_job *j;
+	/* pointer to input */
+	struct merge_input *in;
+	/* first chunk */
+	struct merge_chunk *c;
+	/* counters */
+	int i, k;
+
+
+	/* first chunk used by a job (holding its position and packet
+		 available) */
+	for(i = 0; i < m->ninputs; i++)
+		m->inputs[i]->keep = LLONG_MAX;
+	for(k = 0; k < m->njobs; k++) {
+		j = &(m->jobs[k]);
+		if(j->done)
+			continue;
+		for(i = 0; i < j->n; i++) {
+			in = j->in[i];
+			if(j->join.in[i].state == JOIN_EOF)
+				continue;
+			if(!j->chunk[i])
+				in->keep = 0;
+			else if(j->chunk[i]->first < in->keep)
+				in->keep = j->chunk[i]->first;
+		}
+	}
+
+	/* free chunks */
+	for(i = 0; i < m->ninputs; i++) {
+		in = m->inputs[i];
+		while((c = in->head) && (c != in->tail) && (c->first < in->keep)) {
+			in->head = c->next;
+			free(c->pkts);
+			free(c->data);
+			free(c);
+		}
+	}
 }
 
 
 /********************************************************************
  *                                                                  *
- *  calculate 12bit checksum                                        *
+ *  free manifest, close inputs                                     *
  *                                                                  *
- *  buf: pointer to data buffer                                     *
- *  n:   number of bytes in buffer                                  *
+ *  m: pointer to manifest                                          *
  *                                                                  *
- *  result: checksum                                                *
+ *  result: none                                                    *
  *                                                                  *
  ********************************************************************/
-int CalcChecksum12(unsigned char *buf, int n) {
+void FreeManifest(struct manifest *m) {
+	/* pointer to job */
+	struct merge_job *j;
+	/* pointer to input */
+	struct merge_input *in;
+	/* pointer to chunk */
+	struct merge_chunk *c;
 	/* counter */
 	int i;
-	/* data value */
-	unsigned long x;
-	/* checksum */
-	unsigned long s = 0;
 
-	
-	/* main loop */
-	for(i = 0; i < n; i++) {
-		/* get 1. value */
-		x =
-			(((unsigned long)buf[(int)(1.5 * i)]) << 4) +
-			(((unsigned long)buf[(int)(1.5 * i) + 1] & 0xF0) >> 4);
 
-		/* add to checksum */
-		s = s + x;
+	/* jobs */
+	for(i = 0; i < m->njobs; i++) {
+		j = &(m->jobs[i]);
+		if(j->fout) {
+			PDSFinish(j->fout);
+			remove(j->partname);
+		}
+		FilterFree(j->join.filter);
+		StatFree(&(j->stats));
+		free(j->outname);
+		free(j->partname);
+		free(j->in);
+		free(j->chunk);
+		free(j->idx);
+		JoinFree(&(j->join));
+	}
+	free(m->jobs);
+
+	/* inputs */
+	for(i = 0; i < m->ninputs; i++) {
+		in = m->inputs[i];
+		if(in->f)
+			PDSClose(in->f);
+		while((c = in->head)) {
+			in->head = c->next;
+			free(c->pkts);
+			free(c->data);
+			free(c);
+		}
+		free(in->name);
+		free(in);
+	}
+	free(m->inputs);
+	free(m->items);
+	pthread_mutex_destroy(&(m->lock));
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  get time coverage and quality of input file                     *
+ *                                                                  *
+ *  Taken from the catalog, from the block headers of a PDS archive *
+ *  or, if requested, from a scan of the packet headers of a plain  *
+ *  file. Otherwise the coverage stays unknown.                     *
+ *                                                                  *
+ *  name:    file name                                              *
+ *  cat:     pointer to catalog (NULL = no catalog)                 *
+ *  prescan: scan packet headers of plain files                     *
+ *  apid:    APID                                                   *
+ *  cov:     pointer to store coverage                              *
+ *                                                                  *
+ *  result:  0 - coverage known                                     *
+ *          -1 - coverage unknown                                   *
+ *                                                                  *
+ ********************************************************************/
+int GetCoverage(char *name, struct pds_catalog *cat, int prescan, int apid,
+								struct coverage *cov) {
+	/* start with unknown coverage */
+	memset(cov, 0, sizeof(struct coverage));
+	cov->first_count = -1;
+	cov->last_count = -1;
+
+	/* try catalog, archive and scan */
+	if(cat && !CatalogCoverage(name, cat, apid, cov))
+		return(0);
+	if(!ArchiveCoverage(name, apid, cov))
+		return(0);
+	if(prescan && !ScanCoverage(name, apid, cov))
+		return(0);
+
+	/* no idea */
+	memset(cov, 0, sizeof(struct coverage));
+	return(-1);
+}
+
 
-		/* increase counter */
-		i++;
+/********************************************************************
+ *                                                                  *
+ *  get coverage of input file from catalog                         *
+ *                                                                  *
+ *  The file is looked up by its canonical path, the entry is only  *
+ *  used if modification time and size of the file haven't          *
+ *  changed since it was catalogued.                                *
+ *                                                                  *
+ *  name: file name                                                 *
+ *  cat:  pointer to catalog                                        *
+ *  apid: APID                                                      *
+ *  cov:  pointer to store coverage                                 *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          -1 - file not in catalog or changed                     *
+ *                                                                  *
+ ********************************************************************/
+int CatalogCoverage(char *name, struct pds_catalog *cat, int apid,
+										struct coverage *cov) {
+	/* file status */
+	struct stat st;
+	/* catalog entry */
+	struct cat_file e;
+	/* canonical path */
+	char *canon;
+	/* number of other APIDs of the instrument */
+	long other;
+	/* counter */
+	long i;
+
+
+	/* find file */
+	if(stat(name, &st) || !(canon = realpath(name, NULL)))
+		return(-1);
+	i = CatFind(cat, canon);
+	free(canon);
+	if(i < 0) {
+		fprintf(stderr, "input file (%s) not in catalog\n", name);
+		return(-1);
+	}
+	if(CatRead(cat, i, &e)) {
+		CatFreeFile(&e);
+		return(-1);
+	}
 
-		/* do we have a second value */
-		if(i >= n)
+	/* file changed? */
+	if((e.mtime != (long long)st.st_mtime) ||
+		 (e.size != (long long)st.st_size)) {
+		fprintf(stderr, "input file (%s) changed since catalogued\n", name);
+		CatFreeFile(&e);
+		return(-1);
+	}
+
+	/* time range (microseconds in catalog) */
+	cov->known = 1;
+	cov->start = ((e.start / 1000ULL) << 16) + e.start % 1000ULL;
+	cov->end = ((e.end / 1000ULL) << 16) + e.end % 1000ULL;
+
+	/* find APID */
+	cov->empty = 1;
+	for(i = 0, other = 0; i < e.napids; i++) {
+		if(OtherAPID(e.apids[i].apid, apid))
+			other++;
+		if(e.apids[i].apid != apid)
+			continue;
+		cov->empty = 0;
+		cov->first_count = e.apids[i].first_count;
+		cov->last_count = e.apids[i].last_count;
+		cov->ordered = (e.apids[i].missing == 0);
+		cov->clean = cov->ordered && (e.apids[i].invalid == 0);
+	}
+	if(other) {
+		cov->ordered = 0;
+		cov->clean = 0;
+	}
+	CatFreeFile(&e);
+
+	/* got it */
+	return(0);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  get coverage of PDS archive from its block headers              *
+ *                                                                  *
+ *  name: file name                                                 *
+ *  apid: APID                                                      *
+ *  cov:  pointer to store coverage                                 *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          -1 - not an archive or error                            *
+ *                                                                  *
+ ********************************************************************/
+int ArchiveCoverage(char *name, int apid, struct coverage *cov) {
+	/* PDS file pointer */
+	struct pds_file *f;
+	/* statistics */
+	struct pds_stats stats;
+	/* pointer to APID Info object */
+	struct apid_info *ai;
+	/* number of other APIDs of the instrument */
+	int other = 0;
+
+
+	/* get statistics of archive */
+	if(!(f = PDSOpen(name, 1)))
+		return(-1);
+	if((PDSFormat(f) != PDS_FMT_ARCHIVE) || PDSArchiveStats(f, &stats)) {
+		PDSClose(f);
+		return(-1);
+	}
+	PDSClose(f);
+
+	/* time range */
+	cov->known = 1;
+	cov->empty = (stats.headday == 0);
+	cov->start = JoinKey(stats.firstday, stats.firstms, stats.firstmics);
+	cov->end = JoinKey(stats.lastday, stats.lastms, stats.lastmics);
+
+	/* find APID */
+	for(ai = stats.apidlist; ai; ai = ai->next)
+		if(OtherAPID(ai->apid, apid))
+			other++;
+	if(!(ai = FindAPIDInfo(stats.apidlist, apid)))
+		cov->empty = 1;
+	else {
+		cov->first_count = ai->first_pkt_count;
+		cov->last_count = ai->last_pkt_count;
+		cov->ordered = (ai->missing == 0) && !other;
+		cov->clean = cov->ordered && (ai->invalid == 0);
+	}
+	StatFree(&stats);
+
+	/* got it */
+	return(0);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  get coverage of plain PDS file from its packet headers          *
+ *                                                                  *
+ *  Only the headers are read, so the quality of the packets stays  *
+ *  unknown.                                                        *
+ *                                                                  *
+ *  name: file name                                                 *
+ *  apid: APID                                                      *
+ *  cov:  pointer to store coverage                                 *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          -1 - not a plain file or read error                     *
+ *                                                                  *
+ ********************************************************************/
+int ScanCoverage(char *name, int apid, struct coverage *cov) {
+	/* PDS file pointer */
+	struct pds_file *f;
+	/* primary header structure */
+	struct pri_hdr hdr;
+	/* header buffer */
+	unsigned char buf[PRI_HDR_SIZE + 8];
+	/* packet time */
+	unsigned long long t;
+	/* number of missing packets */
+	long missing = 0;
+	/* flag for other APIDs of the instrument */
+	int other = 0;
+	/* error code */
+	int error = 0;
+
+
+	/* open file */
+	if(!(f = PDSOpen(name, 1)))
+		return(-1);
+	if(PDSFormat(f) != PDS_FMT_PLAIN) {
+		PDSClose(f);
+		return(-1);
+	}
+
+	/* read headers only */
+	cov->empty = 1;
+	for(;;) {
+		/* read primary header */
+		if(ReadPriHdr(f, buf)) {
+			error = !PDSEof(f);
 			break;
+		}
 
-		/* get 2. value */
-		x =
-			(((unsigned long)buf[(int)(1.5 * (i - 1)) + 1] & 0x0F) << 8) +
-			(((unsigned long)buf[(int)(1.5 * (i - 1)) + 2]));
+		/* other packet? then skip */
+		if(DecodePriHdr(buf, &hdr) || (hdr.apid != apid)) {
+			if(!hdr.version && OtherAPID(hdr.apid, apid))
+				other = 1;
+			if(PDSSkip(f, (((int)buf[4]) << 8) + buf[5] + 1)) {
+				error = !PDSEof(f);
+				break;
+			}
+			continue;
+		}
 
-		/* add to checksum */
-		s = s + x;
+		/* read packet time, skip rest */
+		if((hdr.pkt_length + 1 < 8) || PDSRead(f, buf + PRI_HDR_SIZE, 8) ||
+			 PDSSkip(f, hdr.pkt_length + 1 - 8)) {
+			error = !PDSEof(f);
+			break;
+		}
+		t = JoinKey((((int)buf[6]) << 8) + buf[7],
+								(((unsigned long)buf[8]) << 24) +
+								(((unsigned long)buf[9]) << 16) +
+								(((unsigned long)buf[10]) << 8) +
+								((unsigned long)buf[11]),
+								(((int)buf[12]) << 8) + buf[13]);
+
+		/* time range and packet counts */
+		if(cov->empty || (t < cov->start))
+			cov->start = t;
+		if(cov->empty || (t > cov->end))
+			cov->end = t;
+		if(cov->empty)
+			cov->first_count = hdr.pkt_count;
+		else if(hdr.pkt_count != (cov->last_count + 1) % 16384)
+			missing++;
+		cov->last_count = hdr.pkt_count;
+		cov->empty = 0;
 	}
+	PDSClose(f);
 
-	
-	s = s >> 4;
-	s = s & 0xFFF;
+	/* quality unknown */
+	cov->known = !error;
+	cov->ordered = (missing == 0) && !other;
+	cov->clean = 0;
+
+	/* voila */
+	return(error ? -1 : 0);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  test for other APID of the instrument of the merged APID        *
+ *                                                                  *
+ *  The instrument of an APID is given by its decoder, inputs with  *
+ *  other APIDs of the merged instrument are neither ordered nor    *
+ *  clean.                                                          *
+ *                                                                  *
+ *  a:    APID found in file                                        *
+ *  apid: merged APID                                               *
+ *                                                                  *
+ *  result:  1 - other APID of the same instrument                  *
+ *           0 - same APID or other instrument                      *
+ *                                                                  *
+ ********************************************************************/
+int OtherAPID(int a, int apid) {
+	return((a != apid) && (PDSDecoder(a) == PDSDecoder(apid)));
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  test if all packets of an input are in another, clean input     *
+ *                                                                  *
+ *  a: pointer to coverage of clean input                           *
+ *  b: pointer to coverage of other input                           *
+ *                                                                  *
+ *  result:  1 - b covered by a                                     *
+ *           0 - not covered                                        *
+ *                                                                  *
+ ********************************************************************/
+int Covers(struct coverage *a, struct coverage *b) {
+	return(a->known && a->clean && !a->empty && b->known && !b->empty &&
+				 Before(a->start, a->first_count, b->start, b->first_count,
+								b->ordered) &&
+				 Before(b->end, b->last_count, a->end, a->last_count,
+								b->ordered));
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  test order of two packets                                       *
+ *                                                                  *
+ *  Packets with the same time (packets of the same scan) are       *
+ *  ordered by packet count, if the packet counts can be trusted.   *
+ *                                                                  *
+ *  t1:      time of 1. packet                                      *
+ *  c1:      packet count of 1. packet                              *
+ *  t2:      time of 2. packet                                      *
+ *  c2:      packet count of 2. packet                              *
+ *  ordered: packet counts can be trusted                           *
+ *                                                                  *
+ *  result:  1 - 1. packet not after 2. packet                      *
+ *           0 - 1. packet after 2. packet or unknown               *
+ *                                                                  *
+ ********************************************************************/
+int Before(unsigned long long t1, long c1, unsigned long long t2, long c2,
+					 int ordered) {
+	/* different times */
+	if(t1 != t2)
+		return(t1 < t2);
+
+	/* same time */
+	return(ordered && (c1 >= 0) && (c2 >= 0) &&
+				 ((c2 - c1 + 16384) % 16384 < 8192));
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  find first new packet of incremental merge                      *
+ *                                                                  *
+ *  The packet times and counts of the existing output are read     *
+ *  from the headers (it holds checked packets in time order), the  *
+ *  inputs are searched for the oldest packet of the APID in the    *
+ *  time range which isn't in the output. Only packets not in the   *
+ *  output are checked.                                             *
+ *                                                                  *
+ *  name:     name of existing (plain) output file                  *
+ *  inputs:   array of names of input files                         *
+ *  n:        number of input files                                 *
+ *  apid:     APID                                                  *
+ *  filter:   pointer to compiled filter (or NULL)                  *
+ *  startkey: start of time range (see JoinKey())                   *
+ *  endkey:   end of time range                                     *
+ *  key:      pointer to store time of first new packet             *
+ *  offset:   pointer to store offset of first packet in output     *
+ *            not before first new packet                           *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *           1 - no new packets                                     *
+ *          -1 - error reading output file                          *
+ *          -2 - error reading input file                           *
+ *          -3 - out of memory                                      *
+ *                                                                  *
+ ********************************************************************/
+int FindSplice(char *name, char **inputs, int n, int apid,
+							 struct pds_filter *filter, unsigned long long startkey,
+							 unsigned long long endkey, unsigned long long *key,
+							 long long *offset) {
+	/* PDS file pointer */
+	struct pds_file *f;
+	/* packet buffer */
+	unsigned char *buf;
+	/* decoded packet */
+	struct pds_packet pkt;
+	/* packets of output, number of packets and size of array */
+	struct out_key *keys = NULL, *tmp;
+	long nkeys = 0, size = 0;
+	/* offset in output */
+	long long off = 0;
+	/* packet time, time of first new packet */
+	unsigned long long t, first = ~0ULL;
+	/* bounds of binary search */
+	long lo, hi, mid;
+	/* counter */
+	int i;
+	/* error code */
+	int error = 0;
+
+
+	/* allocate packet buffer */
+	pkt.samples = NULL;
+	if(!(buf = malloc(sizeof(unsigned char) * PDS_PKT_SIZE)))
+		return(-3);
+
+	/* read headers of output */
+	if(!(f = PDSOpen(name, 1)) || (PDSFormat(f) != PDS_FMT_PLAIN)) {
+		if(f)
+			PDSClose(f);
+		free(buf);
+		return(-1);
+	}
+	while(!(error = PDSReadPacket(f, buf, &pkt, PDS_LEVEL_SECONDARY))) {
+		if(nkeys == size) {
+			size = size ? size * 2 : 65536;
+			if(!(tmp = realloc(keys, sizeof(struct out_key) * size))) {
+				error = -3;
+				break;
+			}
+			keys = tmp;
+		}
+		keys[nkeys].t = JoinKey(pkt.info.days, pkt.info.millisec,
+														pkt.info.microsec);
+		keys[nkeys].offset = off;
+		keys[nkeys++].count = pkt.hdr.pkt_count;
+		off += pkt.size;
+	}
+	PDSClose(f);
+	if(error != 1) {
+		free(keys);
+		free(buf);
+		return((error == -3) ? -3 : -1);
+	}
+
+	/* search inputs for packets not in output */
+	for(i = 0, error = 0; (i < n) && !error; i++) {
+		if(!(f = PDSOpen(inputs[i], 1))) {
+			error = -2;
+			break;
+		}
+		while(!(error = PDSReadPacket(f, buf, &pkt, PDS_LEVEL_DATA)) ||
+					(error == -2)) {
+			/* packet we need and older than first new packet? */
+			if(error || (pkt.hdr.apid != apid) ||
+				 (filter && !FilterMatch(filter, &pkt)))
+				continue;
+			t = JoinKey(pkt.info.days, pkt.info.millisec, pkt.info.microsec);
+			if((t < startkey) || (t >= endkey) || (t >= first))
+				continue;
+
+			/* in output? */
+			for(lo = 0, hi = nkeys; lo < hi;) {
+				mid = (lo + hi) / 2;
+				if(keys[mid].t < t)
+					lo = mid + 1;
+				else
+					hi = mid;
+			}
+			for(; (lo < nkeys) && (keys[lo].t == t) &&
+						(keys[lo].count != pkt.hdr.pkt_count); lo++);
+			if((lo < nkeys) && (keys[lo].t == t))
+				continue;
+
+			/* new packet if valid */
+			if(PDSCheckPacket(buf, &pkt))
+				first = t;
+		}
+		PDSClose(f);
+		error = (error == 1) ? 0 : -2;
+	}
+
+	/* offset of first packet in output not before first new packet */
+	if(!error && (first != ~0ULL)) {
+		for(lo = 0, hi = nkeys; lo < hi;) {
+			mid = (lo + hi) / 2;
+			if(keys[mid].t < first)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		*key = first;
+		*offset = (lo < nkeys) ? keys[lo].offset : off;
+	}
+	free(keys);
+	free(buf);
+
+	/* okeydokey */
+	return(error ? error : ((first == ~0ULL) ? 1 : 0));
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  replace end of file by other file                               *
+ *                                                                  *
+ *  name:     name of file                                          *
+ *  offset:   offset of part to replace                             *
+ *  partname: name of file with new part (removed when done)        *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          -1 - error                                              *
+ *                                                                  *
+ ********************************************************************/
+int SpliceFile(char *name, long long offset, char *partname) {
+	/* file pointers */
+	FILE *f, *part;
+	/* copy buffer */
+	unsigned char *buf;
+	/* number of bytes read */
+	size_t n;
+	/* error code */
+	int error = 0;
+
+
+	/* cut file, append new part */
+	if(!(buf = malloc(COPY_SIZE)))
+		return(-1);
+	if(truncate(name, (off_t)offset) || !(f = fopen(name, "ab"))) {
+		free(buf);
+		return(-1);
+	}
+	if(!(part = fopen(partname, "rb"))) {
+		fclose(f);
+		free(buf);
+		return(-1);
+	}
+	while((n = fread(buf, 1, COPY_SIZE, part)) > 0)
+		if(fwrite(buf, 1, n, f) != n) {
+			error = -1;
+			break;
+		}
+	if(ferror(part))
+		error = -1;
+	fclose(part);
+	if(fclose(f))
+		error = -1;
+	free(buf);
+
+	/* remove new part */
+	if(!error && remove(partname))
+		error = -1;
+
+	/* gut */
+	return(error);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  write checkpoint                                                *
+ *                                                                  *
+ *  The checkpoint is written to <name>.tmp and renamed, so an      *
+ *  interruption leaves the previous checkpoint.                    *
+ *                                                                  *
+ *  layout (all values little endian):                              *
+ *   header: "PDSK", version (2), reserved (2), number of inputs    *
+ *           (4), APID (4), size of output (8), days (4),           *
+ *           milliseconds (4), microseconds (4) and packet count    *
+ *           (4) of last packet, size of statistics (4)             *
+ *   input:  state (4), offset (8, -1 = not open), packets written  *
+ *           (4), with bad checksum (4) and duplicated (4)          *
+ *   statistics of output (see StatEncode())                        *
+ *                                                                  *
+ *  name:    name of checkpoint file                                *
+ *  join:    pointer to merge (inputs and last packet)              *
+ *  outsize: size of output file                                    *
+ *  offset:  array of input offsets                                 *
+ *  stats:   pointer to statistics of output                        *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          -1 - error                                              *
+ *                                                                  *
+ ********************************************************************/
+int WriteCheckpoint(char *name, struct pds_join *join, long long outsize,
+										long long *offset, struct pds_stats *stats) {
+	/* pointer to input */
+	struct join_input *in;
+	/* checkpoint buffer and its size */
+	unsigned char *buf, *p;
+	size_t size;
+	/* size of statistics */
+	int ssize;
+	/* name of temporary file */
+	char *tmpname;
+	/* file pointer */
+	FILE *f;
+	/* counter */
+	int i;
+	/* error code */
+	int error = 0;
+
+
+	/* allocate memory */
+	ssize = StatEncode(stats, NULL);
+	size = CKP_HDR_SIZE + (size_t)join->n * CKP_INPUT_SIZE + ssize;
+	if(!(buf = malloc(size)))
+		return(-1);
+	if(!(tmpname = malloc(strlen(name) + 5))) {
+		free(buf);
+		return(-1);
+	}
+	sprintf(tmpname, "%s.tmp", name);
+
+	/* header */
+	memcpy(buf, CKP_MAGIC, 4);
+	PutLE(buf + 4, CKP_VERSION, 2);
+	buf[6] = 0;
+	buf[7] = 0;
+	PutLE(buf + 8, join->n, 4);
+	PutLE(buf + 12, join->apid, 4);
+	PutLE(buf + 16, outsize, 8);
+	PutLE(buf + 24, join->last.days, 4);
+	PutLE(buf + 28, join->last.millisec, 4);
+	PutLE(buf + 32, join->last.microsec, 4);
+	PutLE(buf + 36, join->last.pkt_count, 4);
+	PutLE(buf + 40, ssize, 4);
+
+	/* inputs */
+	for(i = 0, p = buf + CKP_HDR_SIZE; i < join->n;
+			i++, p += CKP_INPUT_SIZE) {
+		in = &(join->in[i]);
+		PutLE(p, (unsigned long)in->state, 4);
+		PutLE(p + 4, (unsigned long long)offset[i], 8);
+		PutLE(p + 12, in->written, 4);
+		PutLE(p + 16, in->checksum, 4);
+		PutLE(p + 20, in->duplicate, 4);
+	}
+
+	/* statistics */
+	StatEncode(stats, p);
+
+	/* write and rename */
+	if(!(f = fopen(tmpname, "wb")))
+		error = -1;
+	else {
+		if(fwrite(buf, size, 1, f) != 1)
+			error = -1;
+		if(fclose(f))
+			error = -1;
+	}
+	if(!error && rename(tmpname, name))
+		error = -1;
+	free(tmpname);
+	free(buf);
+
+	/* passt */
+	return(error);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  read checkpoint                                                 *
+ *                                                                  *
+ *  name:    name of checkpoint file                                *
+ *  join:    pointer to merge to store inputs and last packet       *
+ *  outsize: pointer to store size of output file                   *
+ *  offset:  array to store input offsets                           *
+ *  stats:   pointer to store statistics of output                  *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          -1 - error or checkpoint of other merge                 *
+ *                                                                  *
+ ********************************************************************/
+int ReadCheckpoint(char *name, struct pds_join *join, long long *outsize,
+									 long long *offset, struct pds_stats *stats) {
+	/* pointer to input */
+	struct join_input *in;
+	/* checkpoint buffer and its size */
+	unsigned char *buf = NULL, *p;
+	size_t size;
+	/* size of statistics */
+	long ssize;
+	/* header */
+	unsigned char hdr[CKP_HDR_SIZE];
+	/* file pointer */
+	FILE *f;
+	/* counter */
+	int i;
+	/* error code */
+	int error = 0;
+
+
+	/* read header */
+	if(!(f = fopen(name, "rb")))
+		return(-1);
+	if((fread(hdr, CKP_HDR_SIZE, 1, f) != 1) ||
+		 memcmp(hdr, CKP_MAGIC, 4) ||
+		 (GetLE(hdr + 4, 2) != CKP_VERSION) ||
+		 (GetLE(hdr + 8, 4) != join->n) ||
+		 (GetLE(hdr + 12, 4) != join->apid)) {
+		fclose(f);
+		return(-1);
+	}
+
+	/* read inputs and statistics */
+	ssize = GetLE(hdr + 40, 4);
+	size = (size_t)join->n * CKP_INPUT_SIZE + ssize;
+	if(!(buf = malloc(size)) || (fread(buf, size, 1, f) != 1)) {
+		fclose(f);
+		free(buf);
+		return(-1);
+	}
+	fclose(f);
+
+	/* merge state */
+	*outsize = GetLE(hdr + 16, 8);
+	join->last.days = GetLE(hdr + 24, 4);
+	join->last.millisec = GetLE(hdr + 28, 4);
+	join->last.microsec = GetLE(hdr + 32, 4);
+	join->last.pkt_count = GetLE(hdr + 36, 4);
+
+	/* inputs */
+	for(i = 0, p = buf; i < join->n; i++, p += CKP_INPUT_SIZE) {
+		in = &(join->in[i]);
+		in->state = (int)GetLE(p, 4);
+		offset[i] = (long long)GetLE(p + 4, 8);
+		in->written = GetLE(p + 12, 4);
+		in->checksum = GetLE(p + 16, 4);
+		in->duplicate = GetLE(p + 20, 4);
+	}
+
+	/* statistics */
+	if(StatDecode(p, ssize, stats))
+		error = -1;
+	free(buf);
+
+	/* nix */
+	return(error);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  print statistics of output file like pdsinfo                    *
+ *                                                                  *
+ *  s: pointer to statistics                                        *
+ *                                                                  *
+ *  result: none                                                    *
+ *                                                                  *
+ ********************************************************************/
+void PrintStats(struct pds_stats *s) {
+	/* pointer to APID Info object */
+	struct apid_info *apidinfo;
+	/* date buffer */
+	int second, minute, hour, day, month, year;
+	long int ms;
+
+
+	/* no packets written? */
+	if(s->apidlist == NULL) {
+		printf("no packets written\n");
+		return;
+	}
+
+	/* print APID statistics */
+	for(apidinfo = s->apidlist;
+			apidinfo != NULL;
+			apidinfo = apidinfo->next) {
+		printf("APID %d: count %ld invalid %ld missing %ld\n",
+					 apidinfo->apid,
+					 apidinfo->count,
+					 apidinfo->invalid,
+					 apidinfo->missing);
+	}
 
-	/* return checksum */
-	return(s);
+	/* print first and last packet date/time */
+	caldat(&minute, &hour, &day, &month, &year,
+				 s->firstday + MODIS_REF_DATE);
+	hour = s->firstms / (1000L * 60L * 60L);
+	ms = s->firstms - hour * 1000L * 60L * 60L;
+	minute = ms / (1000L * 60L);
+	ms = ms - minute * 1000L * 60L;
+	second = ms / 1000L;
+	ms = ms - second * 1000L;
+	printf("first packet: %04d/%02d/%02d %02d:%02d:%d.%03ld%03ld\n",
+				 year, month, day, hour, minute, second, ms, s->firstmics);
+	caldat(&minute, &hour, &day, &month, &year,
+				 s->lastday + MODIS_REF_DATE);
+	hour = s->lastms / (1000L * 60L * 60L);
+	ms = s->lastms - hour * 1000L * 60L * 60L;
+	minute = ms / (1000L * 60L);
+	ms = ms - minute * 1000L * 60L;
+	second = ms / 1000L;
+	ms = ms - second * 1000L;
+	printf("last packet: %04d/%02d/%02d %02d:%02d:%d.%03ld%03ld\n",
+				 year, month, day, hour, minute, second, ms, s->lastmics);
+
+	/* print number of missing secs */
+	printf("missing seconds: %ld\n", s->missingsecs);
+
+	/* print packet type counts */
+	printf("day packets: %ld/%ld\n", s->daypkts1, s->daypkts2);
+	printf("night packets: %ld/%ld\n", s->nightpkts1, s->nightpkts2);
+	printf("engineering packets: %ld/%ld\n", s->engpkts1, s->engpkts2);
 }
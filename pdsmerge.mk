@@ -8,16 +8,16 @@ MAKEFILE = pdsmerge.mk
 EXE	= pdsmerge 
 
 # Object modules for EXE
-OBJ    	= pdsmerge.o 
+OBJ    	= pdsmerge.o pds.o pdscatalog.o pdsio.o pdsstat.o pdsfilter.o pdsjoin.o 
 
 # Library locations
 LIBS 	= 
 
 # LIBS needed to compile EXE
-LLIBS 	= -lm
+LLIBS 	= -lz -lbz2 -lpthread -lm
 
 
 # Include file locations
-INCLUDE = 
+INCLUDE = -DHAVE_ZLIB -DHAVE_BZLIB
 
 include $(MAKEFILE_APP_TEMPLATE)
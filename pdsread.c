@@ -0,0 +1,645 @@
+/********************************************************************
+ *                                                                  *
+ *  Copyright (C) 2026                                              *
+ *  Geoscience Australia, Canberra, Australia                       *
+ *                                                                  *
+ *  This program is free software; you can redistribute it and/or   *
+ *  modify it under the terms of the GNU General Public License as  *
+ *  published by the Free Software Foundation; either version 2 of  *
+ *  the License, or (at your option) any later version.             *
+ *                                                                  *
+ *  This program is distributed in the hope that it will be         *
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied      *
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR         *
+ *  PURPOSE.  See the GNU General Public License for more details.  *
+ *                                                                  *
+ *  You should have received a copy of the GNU General Public       *
+ *  License along with this program; if not, write to the Free      *
+ *  Software Foundation, Inc., 59 Temple Place, Suite 330, Boston,  *
+ *  MA  02111-1307  USA                                             *
+ *                                                                  *
+ ********************************************************************
+ *                                                                  *
+ *  reading many plain PDS files in large chunks                    *
+ *                                                                  *
+ *  18/10/2026  GA           initial version                        *
+ *                                                                  *
+ ********************************************************************
+ *                                                                  *
+ *  notes:                                                          *
+ *   - io_uring is used through its system calls and rings mapped   *
+ *     into memory (no liburing needed), reads are submitted and    *
+ *     completions taken under the lock of the reader, only one     *
+ *     thread at a time waits for completions in the kernel         *
+ *   - without io_uring a slot waiting for its read is read by the  *
+ *     next thread asking for a chunk, outside the lock             *
+ *                                                                  *
+ ********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#ifdef HAVE_IO_URING
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#endif
+
+#include "pds.h"
+#include "pdsread.h"
+
+
+/********************************************************************
+ *                                                                  *
+ *  defines                                                         *
+ *                                                                  *
+ ********************************************************************/
+/* slot states */
+#define SLOT_FREE 0
+#define SLOT_WAITING 1
+#define SLOT_READING 2
+#define SLOT_READY 3
+#define SLOT_BUSY 4
+
+
+/********************************************************************
+ *                                                                  *
+ *  structure definitions                                           *
+ *                                                                  *
+ ********************************************************************/
+/* open file */
+struct read_slot {
+	/* state, index of file, file descriptor and size */
+	int state;
+	int file;
+	int fd;
+	long long size;
+	/* buffer, bytes kept from previous chunk, offset of buffer in
+		 file */
+	unsigned char *buf;
+	long carry;
+	long long offset;
+	/* vector of read, bytes read (negative errno on error) */
+	struct iovec iov;
+	long result;
+};
+
+/* reader */
+struct pds_reader {
+	/* file names, number of files, next file to open */
+	char **names;
+	int nfiles;
+	int next;
+	/* slots, number of slots, bytes read per chunk */
+	struct read_slot *slots;
+	int nslots;
+	long chunk;
+	/* lock and condition of changed slots */
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	/* io_uring file descriptor (-1 = pread), flag for thread waiting
+		 for completions, number of reads in flight */
+	int ring;
+	int waiter;
+	int inflight;
+#ifdef HAVE_IO_URING
+	/* mapped rings and their sizes */
+	unsigned char *sq, *cq;
+	size_t sqsize, cqsize;
+	struct io_uring_sqe *sqes;
+	size_t sqessize;
+	/* submission queue */
+	unsigned *sqhead, *sqtail, *sqmask, *sqarray;
+	/* completion queue */
+	unsigned *cqhead, *cqtail, *cqmask;
+	struct io_uring_cqe *cqes;
+#endif
+};
+
+
+/********************************************************************
+ *                                                                  *
+ *  function declarations                                           *
+ *                                                                  *
+ ********************************************************************/
+static void StartFile(struct pds_reader *r, struct read_slot *s);
+static void SubmitRead(struct pds_reader *r, struct read_slot *s);
+#ifdef HAVE_IO_URING
+static int SetupRing(struct pds_reader *r);
+static void ReapRing(struct pds_reader *r);
+#endif
+
+
+/********************************************************************
+ *                                                                  *
+ *  create reader                                                   *
+ *                                                                  *
+ *  The files are opened in list order as slots become free, the    *
+ *  first reads are submitted right away.                           *
+ *                                                                  *
+ *  names:      file names                                          *
+ *  n:          number of files                                     *
+ *  files:      number of files open at the same time               *
+ *  chunk_size: bytes read per chunk (at least PDS_PKT_SIZE)        *
+ *                                                                  *
+ *  result: pointer to reader                                       *
+ *          NULL - not enough memory                                *
+ *                                                                  *
+ ********************************************************************/
+struct pds_reader *ReaderCreate(char **names, int n, int files,
+																long chunk_size) {
+	/* reader */
+	struct pds_reader *r;
+	/* counter */
+	int i;
+
+
+	/* allocate memory */
+	if(!(r = calloc(1, sizeof(struct pds_reader))))
+		return(NULL);
+	if(chunk_size < PDS_PKT_SIZE)
+		chunk_size = PDS_PKT_SIZE;
+	if(files < 1)
+		files = 1;
+	r->names = names;
+	r->nfiles = n;
+	r->nslots = files;
+	r->chunk = chunk_size;
+	r->ring = -1;
+	if(!(r->slots = calloc(files, sizeof(struct read_slot)))) {
+		free(r);
+		return(NULL);
+	}
+	for(i = 0; i < files; i++) {
+		r->slots[i].fd = -1;
+		if(!(r->slots[i].buf = malloc(chunk_size + PDS_PKT_SIZE))) {
+			ReaderFree(r);
+			return(NULL);
+		}
+	}
+	pthread_mutex_init(&(r->lock), NULL);
+	pthread_cond_init(&(r->cond), NULL);
+
+#ifdef HAVE_IO_URING
+	/* io_uring, pread if not allowed */
+	SetupRing(r);
+#endif
+
+	/* open first files */
+	pthread_mutex_lock(&(r->lock));
+	for(i = 0; i < files; i++)
+		StartFile(r, &(r->slots[i]));
+	pthread_mutex_unlock(&(r->lock));
+
+	/* voila */
+	return(r);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  get next chunk                                                  *
+ *                                                                  *
+ *  Waits for the next completed read of any file. The chunk starts *
+ *  with the bytes kept from the previous chunk of the file and has *
+ *  to be given back with ReaderDone().                             *
+ *                                                                  *
+ *  r: pointer to reader                                            *
+ *  c: pointer to store chunk                                       *
+ *                                                                  *
+ *  result: 0 - ok                                                  *
+ *          1 - all files done                                      *
+ *                                                                  *
+ ********************************************************************/
+int ReaderNext(struct pds_reader *r, struct pds_chunk *c) {
+	/* slot */
+	struct read_slot *s;
+	/* counter */
+	int i;
+	/* flag for slots in use */
+	int busy;
+	/* bytes read */
+	ssize_t n;
+#ifdef HAVE_IO_URING
+	/* reads not submitted yet */
+	unsigned pending;
+#endif
+
+
+	pthread_mutex_lock(&(r->lock));
+	for(;;) {
+#ifdef HAVE_IO_URING
+		/* take completions, unless a thread waits for them */
+		if((r->ring >= 0) && !r->waiter)
+			ReapRing(r);
+#endif
+
+		/* read completed? then hand it out */
+		for(i = 0; i < r->nslots; i++)
+			if(r->slots[i].state == SLOT_READY)
+				break;
+		if(i < r->nslots) {
+			s = &(r->slots[i]);
+			s->state = SLOT_BUSY;
+			c->file = s->file;
+			c->slot = i;
+			c->offset = s->offset;
+			c->data = s->buf;
+			c->error = (s->result < 0) ? -s->result : 0;
+			c->size = s->carry + ((s->result > 0) ? s->result : 0);
+			c->eof = c->error || (s->result == 0) ||
+				(s->offset + c->size >= s->size);
+			pthread_mutex_unlock(&(r->lock));
+			return(0);
+		}
+
+		/* read waiting? then read it ourselves */
+		for(i = 0; i < r->nslots; i++)
+			if(r->slots[i].state == SLOT_WAITING)
+				break;
+		if(i < r->nslots) {
+			s = &(r->slots[i]);
+			s->state = SLOT_READING;
+			pthread_mutex_unlock(&(r->lock));
+			n = pread(s->fd, s->iov.iov_base, s->iov.iov_len,
+								s->offset + s->carry);
+			pthread_mutex_lock(&(r->lock));
+			s->result = (n < 0) ? -errno : n;
+			s->state = SLOT_READY;
+			continue;
+		}
+
+#ifdef HAVE_IO_URING
+		/* reads in flight? then wait for one, submitting any left
+			 over */
+		if((r->ring >= 0) && r->inflight && !r->waiter) {
+			r->waiter = 1;
+			pending = *(r->sqtail) - __atomic_load_n(r->sqhead, __ATOMIC_ACQUIRE);
+			pthread_mutex_unlock(&(r->lock));
+			syscall(__NR_io_uring_enter, r->ring, pending, 1,
+							IORING_ENTER_GETEVENTS, NULL, 0);
+			pthread_mutex_lock(&(r->lock));
+			r->waiter = 0;
+			ReapRing(r);
+			pthread_cond_broadcast(&(r->cond));
+			continue;
+		}
+#endif
+
+		/* files still in use? then wait for them */
+		for(i = 0, busy = 0; i < r->nslots; i++)
+			if(r->slots[i].state != SLOT_FREE)
+				busy = 1;
+		if(!busy)
+			break;
+		pthread_cond_wait(&(r->cond), &(r->lock));
+	}
+	pthread_mutex_unlock(&(r->lock));
+
+	/* all done */
+	return(1);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  give back chunk                                                 *
+ *                                                                  *
+ *  The bytes after the used ones are kept for the next chunk of    *
+ *  the file, which is read right away. After the last chunk of a   *
+ *  file, or if the caller doesn't want more of it, the file is     *
+ *  closed and the next file of the list opened.                    *
+ *                                                                  *
+ *  r:    pointer to reader                                         *
+ *  c:    pointer to chunk                                          *
+ *  used: bytes used (-1 = stop reading file, reading stops as      *
+ *        well if PDS_PKT_SIZE or more bytes are left)              *
+ *                                                                  *
+ *  result: none                                                    *
+ *                                                                  *
+ ********************************************************************/
+void ReaderDone(struct pds_reader *r, struct pds_chunk *c, long used) {
+	/* slot */
+	struct read_slot *s = &(r->slots[c->slot]);
+	/* bytes kept */
+	long keep;
+
+
+	pthread_mutex_lock(&(r->lock));
+
+	/* file done? then take next file */
+	keep = c->size - used;
+	if((used < 0) || c->eof || (keep >= PDS_PKT_SIZE)) {
+		if(s->fd >= 0)
+			close(s->fd);
+		s->fd = -1;
+		s->state = SLOT_FREE;
+		StartFile(r, s);
+	}
+
+	/* or keep rest and read next chunk */
+	else {
+		memmove(s->buf, s->buf + used, keep);
+		s->offset = c->offset + used;
+		s->carry = keep;
+		SubmitRead(r, s);
+	}
+
+	/* wake up threads waiting for slots */
+	pthread_cond_broadcast(&(r->cond));
+	pthread_mutex_unlock(&(r->lock));
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  is io_uring used?                                               *
+ *                                                                  *
+ *  r: pointer to reader                                            *
+ *                                                                  *
+ *  result: 1 - io_uring                                            *
+ *          0 - pread                                               *
+ *                                                                  *
+ ********************************************************************/
+int ReaderRing(struct pds_reader *r) {
+	/* gut */
+	return(r->ring >= 0);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  free reader                                                     *
+ *                                                                  *
+ *  Files still open are closed, reads still in flight are waited   *
+ *  for.                                                            *
+ *                                                                  *
+ *  r: pointer to reader                                            *
+ *                                                                  *
+ *  result: none                                                    *
+ *                                                                  *
+ ********************************************************************/
+void ReaderFree(struct pds_reader *r) {
+	/* counter */
+	int i;
+
+
+	/* nothing to do? */
+	if(!r)
+		return;
+
+#ifdef HAVE_IO_URING
+	/* wait for reads in flight, unmap rings */
+	if(r->ring >= 0) {
+		while(r->inflight > 0) {
+			syscall(__NR_io_uring_enter, r->ring, 0, 1, IORING_ENTER_GETEVENTS,
+							NULL, 0);
+			ReapRing(r);
+		}
+		munmap(r->sqes, r->sqessize);
+		if(r->cq != r->sq)
+			munmap(r->cq, r->cqsize);
+		munmap(r->sq, r->sqsize);
+		close(r->ring);
+	}
+#endif
+
+	/* close files, free buffers */
+	if(r->slots) {
+		for(i = 0; i < r->nslots; i++) {
+			if(r->slots[i].fd >= 0)
+				close(r->slots[i].fd);
+			free(r->slots[i].buf);
+		}
+		pthread_mutex_destroy(&(r->lock));
+		pthread_cond_destroy(&(r->cond));
+	}
+	free(r->slots);
+	free(r);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  open next file in slot                                          *
+ *                                                                  *
+ *  A file which can't be opened is handed out as chunk with error. *
+ *  Called with lock held.                                          *
+ *                                                                  *
+ *  r: pointer to reader                                            *
+ *  s: pointer to free slot                                         *
+ *                                                                  *
+ *  result: none                                                    *
+ *                                                                  *
+ ********************************************************************/
+static void StartFile(struct pds_reader *r, struct read_slot *s) {
+	/* file status */
+	struct stat st;
+
+
+	/* files left? */
+	if(r->next >= r->nfiles)
+		return;
+	s->file = r->next++;
+	s->offset = 0;
+	s->carry = 0;
+
+	/* open file */
+	if(((s->fd = open(r->names[s->file], O_RDONLY)) < 0) ||
+		 fstat(s->fd, &st)) {
+		s->result = -errno;
+		s->state = SLOT_READY;
+		return;
+	}
+	s->size = st.st_size;
+#ifdef POSIX_FADV_SEQUENTIAL
+	posix_fadvise(s->fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+	/* read first chunk */
+	SubmitRead(r, s);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  read next chunk of file in slot                                 *
+ *                                                                  *
+ *  The chunk is read after the bytes kept, by io_uring or else by  *
+ *  the next thread asking for a chunk. Nothing is read at the end  *
+ *  of the file. Called with lock held.                             *
+ *                                                                  *
+ *  r: pointer to reader                                            *
+ *  s: pointer to slot                                              *
+ *                                                                  *
+ *  result: none                                                    *
+ *                                                                  *
+ ********************************************************************/
+static void SubmitRead(struct pds_reader *r, struct read_slot *s) {
+	/* position and length of read */
+	long long pos = s->offset + s->carry;
+	long long len = (s->size - pos < r->chunk) ? s->size - pos : r->chunk;
+#ifdef HAVE_IO_URING
+	/* submission queue entry and its index */
+	struct io_uring_sqe *sqe;
+	unsigned tail, index;
+#endif
+
+
+	/* end of file? */
+	if(len <= 0) {
+		s->result = 0;
+		s->state = SLOT_READY;
+		return;
+	}
+	s->iov.iov_base = s->buf + s->carry;
+	s->iov.iov_len = len;
+
+	/* read by thread asking for chunk? */
+	s->state = SLOT_WAITING;
+#ifdef HAVE_IO_URING
+	if(r->ring < 0)
+		return;
+
+	/* queue read, it's submitted now or by the next thread waiting
+		 for completions */
+	tail = *(r->sqtail);
+	index = tail & *(r->sqmask);
+	sqe = &(r->sqes[index]);
+	memset(sqe, 0, sizeof(struct io_uring_sqe));
+	sqe->opcode = IORING_OP_READV;
+	sqe->fd = s->fd;
+	sqe->addr = (unsigned long)&(s->iov);
+	sqe->len = 1;
+	sqe->off = pos;
+	sqe->user_data = s - r->slots;
+	r->sqarray[index] = index;
+	__atomic_store_n(r->sqtail, tail + 1, __ATOMIC_RELEASE);
+	s->state = SLOT_READING;
+	r->inflight++;
+	syscall(__NR_io_uring_enter, r->ring, 1, 0, 0, NULL, 0);
+#endif
+}
+
+
+#ifdef HAVE_IO_URING
+/********************************************************************
+ *                                                                  *
+ *  set up io_uring                                                 *
+ *                                                                  *
+ *  One submission queue entry per slot, the rings are mapped into  *
+ *  memory.                                                         *
+ *                                                                  *
+ *  r: pointer to reader                                            *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          -1 - io_uring not available                             *
+ *                                                                  *
+ ********************************************************************/
+static int SetupRing(struct pds_reader *r) {
+	/* parameters */
+	struct io_uring_params p;
+	/* file descriptor */
+	int fd;
+	/* mapped memory */
+	void *m;
+
+
+	/* create ring */
+	memset(&p, 0, sizeof(p));
+	if((fd = syscall(__NR_io_uring_setup, r->nslots, &p)) < 0)
+		return(-1);
+
+	/* map submission and completion ring, one mapping if possible */
+	r->sqsize = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+	r->cqsize = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+	if((p.features & IORING_FEAT_SINGLE_MMAP) && (r->cqsize > r->sqsize))
+		r->sqsize = r->cqsize;
+	m = mmap(NULL, r->sqsize, PROT_READ | PROT_WRITE,
+					 MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+	if(m == MAP_FAILED) {
+		close(fd);
+		return(-1);
+	}
+	r->sq = m;
+	r->cq = r->sq;
+	if(!(p.features & IORING_FEAT_SINGLE_MMAP)) {
+		m = mmap(NULL, r->cqsize, PROT_READ | PROT_WRITE,
+						 MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+		if(m == MAP_FAILED) {
+			munmap(r->sq, r->sqsize);
+			close(fd);
+			return(-1);
+		}
+		r->cq = m;
+	}
+
+	/* map submission queue entries */
+	r->sqessize = p.sq_entries * sizeof(struct io_uring_sqe);
+	m = mmap(NULL, r->sqessize, PROT_READ | PROT_WRITE,
+					 MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+	if(m == MAP_FAILED) {
+		if(r->cq != r->sq)
+			munmap(r->cq, r->cqsize);
+		munmap(r->sq, r->sqsize);
+		close(fd);
+		return(-1);
+	}
+	r->sqes = m;
+
+	/* pointers into rings */
+	r->sqhead = (unsigned *)(r->sq + p.sq_off.head);
+	r->sqtail = (unsigned *)(r->sq + p.sq_off.tail);
+	r->sqmask = (unsigned *)(r->sq + p.sq_off.ring_mask);
+	r->sqarray = (unsigned *)(r->sq + p.sq_off.array);
+	r->cqhead = (unsigned *)(r->cq + p.cq_off.head);
+	r->cqtail = (unsigned *)(r->cq + p.cq_off.tail);
+	r->cqmask = (unsigned *)(r->cq + p.cq_off.ring_mask);
+	r->cqes = (struct io_uring_cqe *)(r->cq + p.cq_off.cqes);
+	r->ring = fd;
+
+	/* passt */
+	return(0);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  take completions of io_uring                                    *
+ *                                                                  *
+ *  Called with lock held.                                          *
+ *                                                                  *
+ *  r: pointer to reader                                            *
+ *                                                                  *
+ *  result: none                                                    *
+ *                                                                  *
+ ********************************************************************/
+static void ReapRing(struct pds_reader *r) {
+	/* head and tail of completion queue */
+	unsigned head, tail;
+	/* completion queue entry */
+	struct io_uring_cqe *cqe;
+	/* slot */
+	struct read_slot *s;
+
+
+	/* all completions */
+	head = *(r->cqhead);
+	tail = __atomic_load_n(r->cqtail, __ATOMIC_ACQUIRE);
+	for(; head != tail; head++) {
+		cqe = &(r->cqes[head & *(r->cqmask)]);
+		s = &(r->slots[cqe->user_data]);
+		s->result = cqe->res;
+		s->state = SLOT_READY;
+		r->inflight--;
+	}
+	__atomic_store_n(r->cqhead, head, __ATOMIC_RELEASE);
+}
+#endif
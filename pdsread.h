@@ -0,0 +1,92 @@
+/********************************************************************
+ *                                                                  *
+ *  Copyright (C) 2026                                              *
+ *  Geoscience Australia, Canberra, Australia                       *
+ *                                                                  *
+ *  This program is free software; you can redistribute it and/or   *
+ *  modify it under the terms of the GNU General Public License as  *
+ *  published by the Free Software Foundation; either version 2 of  *
+ *  the License, or (at your option) any later version.             *
+ *                                                                  *
+ *  This program is distributed in the hope that it will be         *
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied      *
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR         *
+ *  PURPOSE.  See the GNU General Public License for more details.  *
+ *                                                                  *
+ *  You should have received a copy of the GNU General Public       *
+ *  License along with this program; if not, write to the Free      *
+ *  Software Foundation, Inc., 59 Temple Place, Suite 330, Boston,  *
+ *  MA  02111-1307  USA                                             *
+ *                                                                  *
+ ********************************************************************
+ *                                                                  *
+ *  reading many plain PDS files in large chunks                    *
+ *                                                                  *
+ *  A reader keeps a number of files open at the same time and a    *
+ *  read of the next chunk of each in flight, with io_uring if      *
+ *  built with HAVE_IO_URING and the kernel allows it, or else with *
+ *  pread() by the threads asking for chunks. Chunks are handed out *
+ *  as they complete, so several threads can decode different       *
+ *  files while the reads of the others go on. Each file has only   *
+ *  one chunk at a time: the caller tells with ReaderDone() how     *
+ *  much of it was used, the rest (a packet cut by the end of the   *
+ *  chunk) is kept at the start of the next chunk of the file.      *
+ *                                                                  *
+ *  typical use (by any number of threads):                         *
+ *   while(!ReaderNext(r, &c)) {                                    *
+ *     used = <bytes of complete packets in c.data>;                *
+ *     ReaderDone(r, &c, used);                                     *
+ *   }                                                              *
+ *                                                                  *
+ ********************************************************************/
+
+#ifndef PDSREAD_H
+#define PDSREAD_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/********************************************************************
+ *                                                                  *
+ *  structure definitions                                           *
+ *                                                                  *
+ ********************************************************************/
+/* reader (private) */
+struct pds_reader;
+
+/* chunk of file */
+struct pds_chunk {
+	/* index of file in list of names */
+	int file;
+	/* offset of data in file, data and number of bytes */
+	long long offset;
+	unsigned char *data;
+	long size;
+	/* last chunk of file */
+	int eof;
+	/* error opening or reading file (errno, 0 = ok) */
+	int error;
+	/* slot of file in reader (private) */
+	int slot;
+};
+
+
+/********************************************************************
+ *                                                                  *
+ *  function declarations                                           *
+ *                                                                  *
+ ********************************************************************/
+struct pds_reader *ReaderCreate(char **names, int n, int files,
+																long chunk_size);
+int ReaderNext(struct pds_reader *r, struct pds_chunk *c);
+void ReaderDone(struct pds_reader *r, struct pds_chunk *c, long used);
+int ReaderRing(struct pds_reader *r);
+void ReaderFree(struct pds_reader *r);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,446 @@
+/********************************************************************
+ *                                                                  *
+ *  Copyright (C) 2026                                              *
+ *  Geoscience Australia, Canberra, Australia                       *
+ *                                                                  *
+ *  This program is free software; you can redistribute it and/or   *
+ *  modify it under the terms of the GNU General Public License as  *
+ *  published by the Free Software Foundation; either version 2 of  *
+ *  the License, or (at your option) any later version.             *
+ *                                                                  *
+ *  This program is distributed in the hope that it will be         *
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied      *
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR         *
+ *  PURPOSE.  See the GNU General Public License for more details.  *
+ *                                                                  *
+ *  You should have received a copy of the GNU General Public       *
+ *  License along with this program; if not, write to the Free      *
+ *  Software Foundation, Inc., 59 Temple Place, Suite 330, Boston,  *
+ *  MA  02111-1307  USA                                             *
+ *                                                                  *
+ ********************************************************************
+ *                                                                  *
+ *  scan index of MODIS packets (layout see pdsscan.h)              *
+ *                                                                  *
+ *  18/10/2026  GA           initial version                        *
+ *  18/10/2026  GA           bitmap of frames of scan, index file   *
+ *                           optional (completeness check only)     *
+ *                                                                  *
+ ********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pdsscan.h"
+
+
+/********************************************************************
+ *                                                                  *
+ *  defines                                                         *
+ *                                                                  *
+ ********************************************************************/
+/* number of packet slots of scan: half of day frame (1), source
+	 (1), frame count (11) */
+#define SCAN_SLOTS 8192
+/* earth view frames */
+#define SCAN_EARTH_FRAMES 1354
+/* frame count bits of calibration sector */
+#define SCAN_SECTOR_BITS 9
+
+
+/********************************************************************
+ *                                                                  *
+ *  structure definitions                                           *
+ *                                                                  *
+ ********************************************************************/
+/* scan index */
+struct pds_scan {
+	/* output file */
+	FILE *f;
+	/* current scan */
+	struct scan_info cur;
+	/* flag for scan in progress */
+	int open;
+	/* packet count of previous packet of scan */
+	int last_count;
+	/* flags for day and night packets in scan */
+	int day, night;
+	/* bitmap of packet slots of scan (see Slot()) */
+	unsigned char map[SCAN_SLOTS / 8];
+	/* number of packets */
+	long long pkts;
+	/* number of scans */
+	long long scans;
+	/* number of complete and partial scans */
+	long complete, partial;
+	/* error code */
+	int error;
+};
+
+
+/********************************************************************
+ *                                                                  *
+ *  function declarations                                           *
+ *                                                                  *
+ ********************************************************************/
+static void CloseScan(struct pds_scan *s);
+static int Slot(struct pds_packet *pkt);
+static int Expected(int type, int slot);
+
+
+/********************************************************************
+ *                                                                  *
+ *  create scan index                                               *
+ *                                                                  *
+ *  name: file name (NULL = count complete and partial scans only)  *
+ *                                                                  *
+ *  result:  pointer to scan index                                  *
+ *           NULL - error                                           *
+ *                                                                  *
+ ********************************************************************/
+struct pds_scan *ScanCreate(char *name) {
+	/* scan index */
+	struct pds_scan *s;
+	/* header */
+	unsigned char hdr[PDS_SCAN_HDR_SIZE];
+
+
+	/* allocate memory */
+	if(!(s = calloc(1, sizeof(struct pds_scan))))
+		return(NULL);
+
+	/* create file, number of scans is written at the end */
+	memset(hdr, 0, sizeof(hdr));
+	memcpy(hdr, PDS_SCAN_MAGIC, 4);
+	PutLE(hdr + 4, PDS_SCAN_VERSION, 2);
+	if(name &&
+		 (!(s->f = fopen(name, "wb")) ||
+			(fwrite(hdr, sizeof(hdr), 1, s->f) != 1))) {
+		if(s->f)
+			fclose(s->f);
+		free(s);
+		return(NULL);
+	}
+
+	/* tschuess */
+	return(s);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  add packet                                                      *
+ *                                                                  *
+ *  All packets of the file have to be added in file order, only    *
+ *  MODIS packets are indexed.                                      *
+ *                                                                  *
+ *  s:      pointer to scan index                                   *
+ *  offset: offset of packet in (uncompressed) PDS file             *
+ *  pkt:    pointer to decoded packet (see PDSNextPacket())         *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          -1 - write error                                        *
+ *                                                                  *
+ ********************************************************************/
+int ScanAdd(struct pds_scan *s, long long offset, struct pds_packet *pkt) {
+	/* difference of packet counts */
+	int diff;
+	/* slot of packet in bitmap */
+	int slot;
+
+
+	/* count packet, index MODIS packets only */
+	s->pkts++;
+	if(pkt->hdr.version || !pkt->info.modis)
+		return(s->error);
+
+	/* new scan? packets with bad checksum belong to current scan */
+	if(!s->open || (pkt->hdr.apid != s->cur.apid) ||
+		 (pkt->info.valid &&
+			((pkt->info.days != s->cur.days) ||
+			 (pkt->info.millisec != s->cur.millisec) ||
+			 (pkt->info.microsec != s->cur.microsec)))) {
+		CloseScan(s);
+		memset(&(s->cur), 0, sizeof(struct scan_info));
+		s->cur.first_offset = offset;
+		s->cur.first_pkt = s->pkts - 1;
+		s->cur.days = pkt->info.days;
+		s->cur.millisec = pkt->info.millisec;
+		s->cur.microsec = pkt->info.microsec;
+		s->cur.apid = pkt->hdr.apid;
+		s->cur.scan_count = pkt->mhdr.scan_count;
+		s->cur.mirror_side = pkt->mhdr.mirror_side;
+		s->last_count = pkt->hdr.pkt_count;
+		s->day = 0;
+		s->night = 0;
+		memset(s->map, 0, sizeof(s->map));
+		s->open = 1;
+	} else {
+		/* duplicate or missing packets? packets going back in the
+			 packet count are out of order and don't move it */
+		diff = (pkt->hdr.pkt_count - s->last_count) & 0x3FFF;
+		if(diff == 0) {
+			s->cur.end_offset = offset + pkt->size;
+			return(s->error);
+		}
+		if(diff < 8192) {
+			s->cur.missing += diff - 1;
+			s->last_count = pkt->hdr.pkt_count;
+		}
+	}
+	s->cur.end_offset = offset + pkt->size;
+
+	/* count packet, mark slot of valid packet */
+	if(!pkt->info.valid) {
+		s->cur.invalid++;
+	} else {
+		slot = Slot(pkt);
+		s->map[slot >> 3] |= 1 << (slot & 7);
+		if(pkt->mhdr.pkt_type == 0)
+			s->day = 1;
+		if(pkt->mhdr.pkt_type == 1)
+			s->night = 1;
+	}
+
+	/* ois rodger */
+	return(s->error);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  write last scan and number of scans, close file                 *
+ *                                                                  *
+ *  s:        pointer to scan index                                 *
+ *  complete: pointer to store number of complete scans (or NULL)   *
+ *  partial:  pointer to store number of partial scans (or NULL)    *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          -1 - write error                                        *
+ *                                                                  *
+ ********************************************************************/
+int ScanFinish(struct pds_scan *s, long *complete, long *partial) {
+	/* number of scans */
+	unsigned char buf[8];
+	/* error code */
+	int error;
+
+
+	/* last scan */
+	CloseScan(s);
+
+	/* number of scans */
+	PutLE(buf, s->scans, 8);
+	if(s->f &&
+		 (fseek(s->f, 8, SEEK_SET) || (fwrite(buf, 8, 1, s->f) != 1)))
+		s->error = -1;
+	if(s->f && fclose(s->f))
+		s->error = -1;
+
+	/* return scan counts */
+	if(complete)
+		*complete = s->complete;
+	if(partial)
+		*partial = s->partial;
+	error = s->error;
+	free(s);
+
+	/* voila */
+	return(error);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  get number of partial scans                                     *
+ *                                                                  *
+ *  The current scan is counted as soon as it has a packet with bad *
+ *  checksum, so a check for clean files can stop there.            *
+ *                                                                  *
+ *  s: pointer to scan index                                        *
+ *                                                                  *
+ *  result: number of partial scans                                 *
+ *                                                                  *
+ ********************************************************************/
+long ScanPartial(struct pds_scan *s) {
+	/* alles klar */
+	return(s->partial + (s->open && s->cur.invalid));
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  encode scan record                                              *
+ *                                                                  *
+ *  si:  pointer to scan                                            *
+ *  buf: pointer to buffer of PDS_SCAN_REC_SIZE bytes               *
+ *                                                                  *
+ *  result: none                                                    *
+ *                                                                  *
+ ********************************************************************/
+void ScanEncode(struct scan_info *si, unsigned char *buf) {
+	memset(buf, 0, PDS_SCAN_REC_SIZE);
+	PutLE(buf, si->first_offset, 8);
+	PutLE(buf + 8, si->end_offset, 8);
+	PutLE(buf + 16, si->first_pkt, 8);
+	PutLE(buf + 24, si->days, 2);
+	PutLE(buf + 26, si->millisec, 4);
+	PutLE(buf + 30, si->microsec, 2);
+	PutLE(buf + 32, si->present, 2);
+	PutLE(buf + 34, si->expected, 2);
+	PutLE(buf + 36, si->invalid, 2);
+	PutLE(buf + 38, (si->missing > 0xFFFF) ? 0xFFFF : si->missing, 2);
+	PutLE(buf + 40, si->apid, 2);
+	buf[42] = si->scan_count;
+	buf[43] = si->mirror_side;
+	buf[44] = si->type;
+	buf[45] = si->complete;
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  decode scan record                                              *
+ *                                                                  *
+ *  buf: pointer to record of PDS_SCAN_REC_SIZE bytes               *
+ *  si:  pointer to store scan                                      *
+ *                                                                  *
+ *  result: none                                                    *
+ *                                                                  *
+ ********************************************************************/
+void ScanDecode(unsigned char *buf, struct scan_info *si) {
+	si->first_offset = GetLE(buf, 8);
+	si->end_offset = GetLE(buf + 8, 8);
+	si->first_pkt = GetLE(buf + 16, 8);
+	si->days = GetLE(buf + 24, 2);
+	si->millisec = GetLE(buf + 26, 4);
+	si->microsec = GetLE(buf + 30, 2);
+	si->present = GetLE(buf + 32, 2);
+	si->expected = GetLE(buf + 34, 2);
+	si->invalid = GetLE(buf + 36, 2);
+	si->missing = GetLE(buf + 38, 2);
+	si->apid = GetLE(buf + 40, 2);
+	si->scan_count = buf[42];
+	si->mirror_side = buf[43];
+	si->type = buf[44];
+	si->complete = buf[45];
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  write record of current scan                                    *
+ *                                                                  *
+ *  s: pointer to scan index                                        *
+ *                                                                  *
+ *  result: none (write errors are kept in s->error)                *
+ *                                                                  *
+ ********************************************************************/
+static void CloseScan(struct pds_scan *s) {
+	/* record */
+	unsigned char buf[PDS_SCAN_REC_SIZE];
+	/* slot */
+	int i;
+
+
+	/* scan in progress? */
+	if(!s->open)
+		return;
+	s->open = 0;
+
+	/* type and expected packets */
+	if(s->day) {
+		s->cur.type = PDS_SCAN_DAY;
+		s->cur.expected = 2 * PDS_SCAN_FRAMES + PDS_SCAN_ENG;
+	} else if(s->night) {
+		s->cur.type = PDS_SCAN_NIGHT;
+		s->cur.expected = PDS_SCAN_FRAMES + PDS_SCAN_ENG;
+	} else {
+		s->cur.type = PDS_SCAN_ENG_ONLY;
+		s->cur.expected = PDS_SCAN_ENG;
+	}
+
+	/* expected packets present, complete? */
+	for(i = 0; i < SCAN_SLOTS; i++) {
+		if((s->map[i >> 3] & (1 << (i & 7))) && Expected(s->cur.type, i))
+			s->cur.present++;
+	}
+	s->cur.complete =
+		(s->cur.present == s->cur.expected) && !s->cur.invalid;
+	if(s->cur.complete)
+		s->complete++;
+	else
+		s->partial++;
+
+	/* write record */
+	ScanEncode(&(s->cur), buf);
+	if(s->f && (fwrite(buf, sizeof(buf), 1, s->f) != 1))
+		s->error = -1;
+	s->scans++;
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  get slot of packet in scan bitmap                               *
+ *                                                                  *
+ *  Science packets are identified by source (src1, 0 = earth view, *
+ *  1 = calibration), frame count (src2) and, in day mode, first or *
+ *  second half of the frame (sequence flags), engineering packets  *
+ *  by their type (slots of frame count 0).                         *
+ *                                                                  *
+ *  pkt: pointer to decoded MODIS packet                            *
+ *                                                                  *
+ *  result: slot                                                    *
+ *                                                                  *
+ ********************************************************************/
+static int Slot(struct pds_packet *pkt) {
+	/* engineering packet? */
+	if((pkt->mhdr.pkt_type == 2) || (pkt->mhdr.pkt_type == 4))
+		return((pkt->mhdr.pkt_type == 4) << 12);
+
+	/* science packet */
+	return((((pkt->mhdr.pkt_type == 0) && (pkt->hdr.seq_flags == 2)) << 12) +
+				 (pkt->mhdr.src1 << 11) + pkt->mhdr.src2);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  test if packet slot is expected in scan                         *
+ *                                                                  *
+ *  Expected are the 2 engineering packets and, depending on the    *
+ *  type, both (day) or the first (night) half of the frames 1 to   *
+ *  1354 of the earth view and of the calibration sectors, whose    *
+ *  frame counts are sector * 512 + frame: solar diffuser (1 to     *
+ *  50), SRCA (1 to 10), blackbody (1 to 50) and space view (1 to   *
+ *  50).                                                            *
+ *                                                                  *
+ *  type: type of scan                                              *
+ *  slot: slot (see Slot())                                         *
+ *                                                                  *
+ *  result: 1 - expected                                            *
+ *          0 - not expected                                        *
+ *                                                                  *
+ ********************************************************************/
+static int Expected(int type, int slot) {
+	/* frame count, frame of calibration sector */
+	int count, frame;
+
+
+	/* engineering packets */
+	count = slot & 2047;
+	if(!count && !(slot & 2048))
+		return(1);
+
+	/* science packets */
+	if((type == PDS_SCAN_ENG_ONLY) ||
+		 ((type == PDS_SCAN_NIGHT) && (slot & 4096)))
+		return(0);
+	if(!(slot & 2048))
+		return((count >= 1) && (count <= SCAN_EARTH_FRAMES));
+	frame = count & ((1 << SCAN_SECTOR_BITS) - 1);
+	return((frame >= 1) &&
+				 (frame <= (((count >> SCAN_SECTOR_BITS) == 1) ? 10 : 50)));
+}
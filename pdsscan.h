@@ -0,0 +1,132 @@
+/********************************************************************
+ *                                                                  *
+ *  Copyright (C) 2026                                              *
+ *  Geoscience Australia, Canberra, Australia                       *
+ *                                                                  *
+ *  This program is free software; you can redistribute it and/or   *
+ *  modify it under the terms of the GNU General Public License as  *
+ *  published by the Free Software Foundation; either version 2 of  *
+ *  the License, or (at your option) any later version.             *
+ *                                                                  *
+ *  This program is distributed in the hope that it will be         *
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied      *
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR         *
+ *  PURPOSE.  See the GNU General Public License for more details.  *
+ *                                                                  *
+ *  You should have received a copy of the GNU General Public       *
+ *  License along with this program; if not, write to the Free      *
+ *  Software Foundation, Inc., 59 Temple Place, Suite 330, Boston,  *
+ *  MA  02111-1307  USA                                             *
+ *                                                                  *
+ ********************************************************************
+ *                                                                  *
+ *  scan index of MODIS packets                                     *
+ *                                                                  *
+ *  MODIS packets carry the start time of their scan, so the        *
+ *  packets of a scan are the consecutive MODIS packets with the    *
+ *  same APID and time. The index has one record per scan with the  *
+ *  range of the scan in the (uncompressed) PDS file and the number *
+ *  of packets expected and present, so L1A processing can go to    *
+ *  complete scans directly.                                        *
+ *                                                                  *
+ *  A scan has 1514 frames (1354 earth view, 160 calibration),      *
+ *  each giving 2 packets in day mode and 1 packet in night mode,   *
+ *  and 2 engineering packets. The valid packets of a scan are      *
+ *  marked in a bitmap of frames (source, frame count, half of day  *
+ *  frame) and engineering packets, so duplicates and unexpected    *
+ *  packets aren't counted as present. Packets with bad checksum    *
+ *  belong to the scan they are found in, gaps in the packet count  *
+ *  within a scan are counted as missing. A scan is complete if all *
+ *  expected packets are present and no packet has a bad checksum.  *
+ *                                                                  *
+ *  layout (all values unsigned little endian):                     *
+ *   header: "PDSN", version (2), reserved (2), number of scans (8) *
+ *   record: offset of first packet (8), offset after last packet   *
+ *           (8), number of first packet in file (8), days (2),     *
+ *           milliseconds (4), microseconds (2), packets present    *
+ *           (2), expected (2), invalid (2), missing (2), APID (2), *
+ *           scan count (1), mirror side (1), type (1, 0 = day, 1 = *
+ *           night, 2 = engineering only), complete (1), reserved   *
+ *           (2)                                                    *
+ *                                                                  *
+ ********************************************************************/
+
+#ifndef PDSSCAN_H
+#define PDSSCAN_H
+
+#include "pds.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/********************************************************************
+ *                                                                  *
+ *  defines                                                         *
+ *                                                                  *
+ ********************************************************************/
+/* magic number */
+#define PDS_SCAN_MAGIC "PDSN"
+/* version */
+#define PDS_SCAN_VERSION 1
+/* header and record size */
+#define PDS_SCAN_HDR_SIZE 16
+#define PDS_SCAN_REC_SIZE 48
+/* frames of scan (earth view and calibration) */
+#define PDS_SCAN_FRAMES 1514
+/* engineering packets of scan */
+#define PDS_SCAN_ENG 2
+/* scan types */
+#define PDS_SCAN_DAY 0
+#define PDS_SCAN_NIGHT 1
+#define PDS_SCAN_ENG_ONLY 2
+
+
+/********************************************************************
+ *                                                                  *
+ *  structure definitions                                           *
+ *                                                                  *
+ ********************************************************************/
+/* scan */
+struct scan_info {
+	/* range in file */
+	long long first_offset, end_offset;
+	/* number of first packet in file */
+	long long first_pkt;
+	/* scan start time */
+	int days;
+	unsigned long int millisec;
+	int microsec;
+	/* packets present (valid, without duplicates), expected, with bad
+		 checksum and missing in packet count */
+	int present, expected, invalid, missing;
+	/* APID, scan count, mirror side */
+	int apid, scan_count, mirror_side;
+	/* type */
+	int type;
+	/* all packets present and valid */
+	int complete;
+};
+
+/* scan index (private) */
+struct pds_scan;
+
+
+/********************************************************************
+ *                                                                  *
+ *  function declarations                                           *
+ *                                                                  *
+ ********************************************************************/
+struct pds_scan *ScanCreate(char *name);
+int ScanAdd(struct pds_scan *s, long long offset, struct pds_packet *pkt);
+int ScanFinish(struct pds_scan *s, long *complete, long *partial);
+long ScanPartial(struct pds_scan *s);
+void ScanEncode(struct scan_info *si, unsigned char *buf);
+void ScanDecode(unsigned char *buf, struct scan_info *si);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,432 @@
+/********************************************************************
+ *                                                                  *
+ *  Copyright (C) 2026                                              *
+ *  Geoscience Australia, Canberra, Australia                       *
+ *                                                                  *
+ *  This program is free software; you can redistribute it and/or   *
+ *  modify it under the terms of the GNU General Public License as  *
+ *  published by the Free Software Foundation; either version 2 of  *
+ *  the License, or (at your option) any later version.             *
+ *                                                                  *
+ *  This program is distributed in the hope that it will be         *
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied      *
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR         *
+ *  PURPOSE.  See the GNU General Public License for more details.  *
+ *                                                                  *
+ *  You should have received a copy of the GNU General Public       *
+ *  License along with this program; if not, write to the Free      *
+ *  Software Foundation, Inc., 59 Temple Place, Suite 330, Boston,  *
+ *  MA  02111-1307  USA                                             *
+ *                                                                  *
+ ********************************************************************
+ *                                                                  *
+ *  reassembly of segmented packets (see pdsseg.h)                  *
+ *                                                                  *
+ *  18/10/2026  GA           initial version                        *
+ *                                                                  *
+ ********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pdsseg.h"
+
+
+/********************************************************************
+ *                                                                  *
+ *  defines                                                         *
+ *                                                                  *
+ ********************************************************************/
+/* number of APIDs */
+#define SEG_APIDS 2048
+/* initial number of segments of group */
+#define SEG_GROUP_SIZE 4
+
+
+/********************************************************************
+ *                                                                  *
+ *  structure definitions                                           *
+ *                                                                  *
+ ********************************************************************/
+/* segments of packet of APID (n = 0: no packet open) */
+struct seg_group {
+	/* info of first segment */
+	struct pkt_info info;
+	/* packet count of last segment */
+	int last_count;
+	/* number of segments and allocated segments */
+	int n, cap;
+	/* segments */
+	struct pds_segment *seg;
+	/* size of data of segments */
+	long size;
+};
+
+/* reassembly */
+struct pds_seg {
+	/* groups and counts of APIDs */
+	struct seg_group *group[SEG_APIDS];
+	struct seg_count count[SEG_APIDS];
+	/* free buffers, their number, number of all buffers */
+	unsigned char **pool;
+	int npool, nbufs;
+	/* buffer handed out and not kept yet */
+	unsigned char *cur;
+	/* APID of packet handed to caller, released at next call (-1 =
+		 none) */
+	int done;
+	/* segment of standalone packet */
+	struct pds_segment single;
+};
+
+
+/********************************************************************
+ *                                                                  *
+ *  function declarations                                           *
+ *                                                                  *
+ ********************************************************************/
+static void Release(struct pds_seg *s, struct seg_group *g);
+static void Orphan(struct pds_seg *s, int apid);
+
+
+/********************************************************************
+ *                                                                  *
+ *  create reassembly                                               *
+ *                                                                  *
+ *  result:  pointer to reassembly                                  *
+ *           NULL - out of memory                                   *
+ *                                                                  *
+ ********************************************************************/
+struct pds_seg *SegCreate(void) {
+	/* reassembly */
+	struct pds_seg *s;
+
+
+	/* allocate memory */
+	if(!(s = calloc(1, sizeof(struct pds_seg))))
+		return(NULL);
+	s->done = -1;
+
+	/* tschuess */
+	return(s);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  get buffer for next packet                                      *
+ *                                                                  *
+ *  Returns the same buffer until it is kept by SegAdd(). Buffers   *
+ *  of orphaned segments and of packets handed to the caller are    *
+ *  reused, new ones are only allocated while more segments are     *
+ *  waiting for their packet than ever before.                      *
+ *                                                                  *
+ *  s: pointer to reassembly                                        *
+ *                                                                  *
+ *  result:  pointer to buffer of PDS_PKT_SIZE bytes                *
+ *           NULL - out of memory                                   *
+ *                                                                  *
+ ********************************************************************/
+unsigned char *SegBuffer(struct pds_seg *s) {
+	/* new pool */
+	unsigned char **p;
+
+
+	/* release packet handed to caller */
+	if(s->done >= 0) {
+		Release(s, s->group[s->done]);
+		s->done = -1;
+	}
+
+	/* buffer from pool or new one, the pool can take all buffers */
+	if(!s->cur) {
+		if(s->npool) {
+			s->cur = s->pool[--s->npool];
+		} else {
+			if(!(p = realloc(s->pool,
+											 (s->nbufs + 1) * sizeof(unsigned char *))))
+				return(NULL);
+			s->pool = p;
+			if(!(s->cur = malloc(PDS_PKT_SIZE)))
+				return(NULL);
+			s->nbufs++;
+		}
+	}
+
+	/* gut */
+	return(s->cur);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  add packet                                                      *
+ *                                                                  *
+ *  The buffer has to be the one of the last SegBuffer() call.      *
+ *  Segments of a packet are kept until its last segment arrives,   *
+ *  standalone packets and packets of unsupported version are       *
+ *  handed back right away. Works at all verification levels, but   *
+ *  below PDS_LEVEL_DATA the buffers only hold the headers.         *
+ *                                                                  *
+ *  s:      pointer to reassembly                                   *
+ *  buf:    pointer to buffer of packet (from SegBuffer())          *
+ *  pkt:    pointer to decoded packet (see PDSReadPacket())         *
+ *  offset: offset of packet in (uncompressed) PDS file             *
+ *  lp:     pointer to store complete logical packet                *
+ *                                                                  *
+ *  result:  1 - logical packet complete (lp set, valid until the   *
+ *               next call)                                         *
+ *           0 - segment kept or orphaned                           *
+ *          -1 - out of memory                                      *
+ *                                                                  *
+ ********************************************************************/
+int SegAdd(struct pds_seg *s, unsigned char *buf, struct pds_packet *pkt,
+					 long long offset, struct pds_logical *lp) {
+	/* APID, sequence flags */
+	int apid, flags;
+	/* group of APID */
+	struct seg_group *g;
+	/* new segments */
+	struct pds_segment *p;
+
+
+	/* release packet handed to caller */
+	if(s->done >= 0) {
+		Release(s, s->group[s->done]);
+		s->done = -1;
+	}
+	apid = pkt->hdr.apid;
+	flags = pkt->hdr.seq_flags;
+
+	/* standalone packet? then it ends an open packet of its APID */
+	if(pkt->hdr.version || (flags == PDS_SEG_STANDALONE)) {
+		if(!pkt->hdr.version && s->group[apid] && s->group[apid]->n)
+			Orphan(s, apid);
+		s->single.buf = buf;
+		s->single.size = pkt->size;
+		s->single.offset = offset;
+		lp->apid = pkt->info.apid;
+		lp->info = pkt->info;
+		lp->n = 1;
+		lp->seg = &(s->single);
+		lp->size = pkt->size - PRI_HDR_SIZE;
+		return(1);
+	}
+
+	/* group of APID */
+	if(!(g = s->group[apid]) &&
+		 !(g = s->group[apid] = calloc(1, sizeof(struct seg_group))))
+		return(-1);
+
+	/* first segment? then open packet is orphaned */
+	if(flags == PDS_SEG_FIRST) {
+		if(g->n)
+			Orphan(s, apid);
+		g->info = pkt->info;
+	}
+
+	/* continuation or last without open packet, after gap in packet
+		 count or too many segments? then orphaned */
+	else if(!g->n || (pkt->hdr.pkt_count != ((g->last_count + 1) & 0x3FFF)) ||
+					(g->n == PDS_SEG_MAX)) {
+		if(g->n)
+			Orphan(s, apid);
+		s->count[apid].orphans++;
+		return(0);
+	}
+
+	/* keep segment and its buffer */
+	if(g->n == g->cap) {
+		if(!(p = realloc(g->seg, (g->cap ? 2 * g->cap : SEG_GROUP_SIZE) *
+										 sizeof(struct pds_segment))))
+			return(-1);
+		g->seg = p;
+		g->cap = g->cap ? 2 * g->cap : SEG_GROUP_SIZE;
+	}
+	g->seg[g->n].buf = buf;
+	g->seg[g->n].size = pkt->size;
+	g->seg[g->n].offset = offset;
+	g->n++;
+	g->size += pkt->size - PRI_HDR_SIZE;
+	g->last_count = pkt->hdr.pkt_count;
+	s->cur = NULL;
+	if(flags != PDS_SEG_LAST)
+		return(0);
+
+	/* packet complete, hand it to caller */
+	s->count[apid].packets++;
+	s->count[apid].segments += g->n;
+	lp->apid = apid;
+	lp->info = g->info;
+	lp->n = g->n;
+	lp->seg = g->seg;
+	lp->size = g->size;
+	s->done = apid;
+
+	/* ois rodger */
+	return(1);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  end of input                                                    *
+ *                                                                  *
+ *  Segments of packets still open are orphaned.                    *
+ *                                                                  *
+ *  s: pointer to reassembly                                        *
+ *                                                                  *
+ *  result: none                                                    *
+ *                                                                  *
+ ********************************************************************/
+void SegEnd(struct pds_seg *s) {
+	/* APID */
+	int apid;
+
+
+	/* release packet handed to caller */
+	if(s->done >= 0) {
+		Release(s, s->group[s->done]);
+		s->done = -1;
+	}
+
+	/* orphan open packets */
+	for(apid = 0; apid < SEG_APIDS; apid++)
+		if(s->group[apid] && s->group[apid]->n)
+			Orphan(s, apid);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  get counts of APID                                              *
+ *                                                                  *
+ *  s:    pointer to reassembly                                     *
+ *  apid: APID                                                      *
+ *                                                                  *
+ *  result:  pointer to counts                                      *
+ *           NULL - APID out of range                               *
+ *                                                                  *
+ ********************************************************************/
+const struct seg_count *SegCount(struct pds_seg *s, int apid) {
+	/* out of range? */
+	if((apid < 0) || (apid >= SEG_APIDS))
+		return(NULL);
+
+	/* voila */
+	return(&(s->count[apid]));
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  copy logical packet into contiguous buffer                      *
+ *                                                                  *
+ *  The data of all segments (without their primary headers) is     *
+ *  copied one after the other.                                     *
+ *                                                                  *
+ *  lp:   pointer to logical packet                                 *
+ *  out:  pointer to buffer                                         *
+ *  size: size of buffer                                            *
+ *                                                                  *
+ *  result: number of bytes copied                                  *
+ *          -1 - buffer too small                                   *
+ *                                                                  *
+ ********************************************************************/
+long SegJoin(struct pds_logical *lp, unsigned char *out, long size) {
+	/* counter */
+	int i;
+
+
+	/* enough space? */
+	if(lp->size > size)
+		return(-1);
+
+	/* copy data of segments */
+	for(i = 0; i < lp->n; i++) {
+		memcpy(out, lp->seg[i].buf + PRI_HDR_SIZE,
+					 lp->seg[i].size - PRI_HDR_SIZE);
+		out += lp->seg[i].size - PRI_HDR_SIZE;
+	}
+
+	/* passt */
+	return(lp->size);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  free reassembly                                                 *
+ *                                                                  *
+ *  s: pointer to reassembly (NULL = nothing to do)                 *
+ *                                                                  *
+ *  result: none                                                    *
+ *                                                                  *
+ ********************************************************************/
+void SegFree(struct pds_seg *s) {
+	/* counters */
+	int apid, i;
+
+
+	if(!s)
+		return;
+
+	/* buffers of open packets and groups */
+	for(apid = 0; apid < SEG_APIDS; apid++) {
+		if(!s->group[apid])
+			continue;
+		for(i = 0; i < s->group[apid]->n; i++)
+			free(s->group[apid]->seg[i].buf);
+		free(s->group[apid]->seg);
+		free(s->group[apid]);
+	}
+
+	/* free buffers */
+	for(i = 0; i < s->npool; i++)
+		free(s->pool[i]);
+	free(s->pool);
+	free(s->cur);
+	free(s);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  release segments of group                                       *
+ *                                                                  *
+ *  Their buffers go back to the pool.                              *
+ *                                                                  *
+ *  s: pointer to reassembly                                        *
+ *  g: pointer to group                                             *
+ *                                                                  *
+ *  result: none                                                    *
+ *                                                                  *
+ ********************************************************************/
+static void Release(struct pds_seg *s, struct seg_group *g) {
+	/* counter */
+	int i;
+
+
+	for(i = 0; i < g->n; i++)
+		s->pool[s->npool++] = g->seg[i].buf;
+	g->n = 0;
+	g->size = 0;
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  orphan open packet of APID                                      *
+ *                                                                  *
+ *  s:    pointer to reassembly                                     *
+ *  apid: APID                                                      *
+ *                                                                  *
+ *  result: none                                                    *
+ *                                                                  *
+ ********************************************************************/
+static void Orphan(struct pds_seg *s, int apid) {
+	/* count segments, reuse buffers */
+	s->count[apid].orphans += s->group[apid]->n;
+	Release(s, s->group[apid]);
+}
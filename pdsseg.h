@@ -0,0 +1,132 @@
+/********************************************************************
+ *                                                                  *
+ *  Copyright (C) 2026                                              *
+ *  Geoscience Australia, Canberra, Australia                       *
+ *                                                                  *
+ *  This program is free software; you can redistribute it and/or   *
+ *  modify it under the terms of the GNU General Public License as  *
+ *  published by the Free Software Foundation; either version 2 of  *
+ *  the License, or (at your option) any later version.             *
+ *                                                                  *
+ *  This program is distributed in the hope that it will be         *
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied      *
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR         *
+ *  PURPOSE.  See the GNU General Public License for more details.  *
+ *                                                                  *
+ *  You should have received a copy of the GNU General Public       *
+ *  License along with this program; if not, write to the Free      *
+ *  Software Foundation, Inc., 59 Temple Place, Suite 330, Boston,  *
+ *  MA  02111-1307  USA                                             *
+ *                                                                  *
+ ********************************************************************
+ *                                                                  *
+ *  reassembly of segmented packets                                 *
+ *                                                                  *
+ *  CCSDS packets can be cut into segments, marked by the sequence  *
+ *  flags of the primary header: first (1), continuation (0), last  *
+ *  (2) or standalone (3). The segments of a packet follow each     *
+ *  other within their APID with consecutive packet counts, other   *
+ *  APIDs can come in between (MODIS day packets are the first and  *
+ *  last segment of a frame, each with its own MODIS header).       *
+ *                                                                  *
+ *  The reassembly hands out the buffers packets are read into      *
+ *  (SegBuffer()) and keeps the buffers of segments until their     *
+ *  packet is complete, so a logical packet is a scatter list over  *
+ *  these buffers and nothing is copied unless a contiguous copy is *
+ *  asked for (SegJoin()). Standalone packets are passed through in *
+ *  the buffer they were read into. Segments which can't become     *
+ *  part of a complete packet (no first segment, first segment      *
+ *  without last one, gap in the packet count or more than          *
+ *  PDS_SEG_MAX segments) are orphaned: they are counted per APID   *
+ *  and their buffers are reused.                                   *
+ *                                                                  *
+ *  typical use:                                                    *
+ *   s = SegCreate();                                               *
+ *   while(!PDSNextPacket(f, buf = SegBuffer(s), &pkt)) {           *
+ *     if(SegAdd(s, buf, &pkt, offset, &lp) == 1)                   *
+ *       use lp.seg[0] to lp.seg[lp.n - 1]                          *
+ *     offset += pkt.size;                                          *
+ *   }                                                              *
+ *   SegEnd(s);                                                     *
+ *                                                                  *
+ ********************************************************************/
+
+#ifndef PDSSEG_H
+#define PDSSEG_H
+
+#include "pds.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/********************************************************************
+ *                                                                  *
+ *  defines                                                         *
+ *                                                                  *
+ ********************************************************************/
+/* sequence flags */
+#define PDS_SEG_CONTINUATION 0
+#define PDS_SEG_FIRST 1
+#define PDS_SEG_LAST 2
+#define PDS_SEG_STANDALONE 3
+/* maximum number of segments of packet */
+#define PDS_SEG_MAX 256
+
+
+/********************************************************************
+ *                                                                  *
+ *  structure definitions                                           *
+ *                                                                  *
+ ********************************************************************/
+/* segment: packet buffer (primary header and data), size of packet
+	 and offset in (uncompressed) file */
+struct pds_segment {
+	unsigned char *buf;
+	int size;
+	long long offset;
+};
+
+/* logical packet: APID, info of first segment, number of segments,
+	 scatter list (valid until the next call of the reassembly) and
+	 size of the data of all segments (without primary headers) */
+struct pds_logical {
+	int apid;
+	struct pkt_info info;
+	int n;
+	struct pds_segment *seg;
+	long size;
+};
+
+/* counts of APID: packets reassembled from segments, their segments,
+	 orphaned segments */
+struct seg_count {
+	long packets;
+	long segments;
+	long orphans;
+};
+
+/* reassembly (private) */
+struct pds_seg;
+
+
+/********************************************************************
+ *                                                                  *
+ *  function declarations                                           *
+ *                                                                  *
+ ********************************************************************/
+struct pds_seg *SegCreate(void);
+unsigned char *SegBuffer(struct pds_seg *s);
+int SegAdd(struct pds_seg *s, unsigned char *buf, struct pds_packet *pkt,
+					 long long offset, struct pds_logical *lp);
+void SegEnd(struct pds_seg *s);
+const struct seg_count *SegCount(struct pds_seg *s, int apid);
+long SegJoin(struct pds_logical *lp, unsigned char *out, long size);
+void SegFree(struct pds_seg *s);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
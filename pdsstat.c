@@ -0,0 +1,905 @@
+/********************************************************************
+ *                                                                  *
+ *  Copyright (C) 2026                                              *
+ *  Geoscience Australia, Canberra, Australia                       *
+ *                                                                  *
+ *  This program is free software; you can redistribute it and/or   *
+ *  modify it under the terms of the GNU General Public License as  *
+ *  published by the Free Software Foundation; either version 2 of  *
+ *  the License, or (at your option) any later version.             *
+ *                                                                  *
+ *  This program is distributed in the hope that it will be         *
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied      *
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR         *
+ *  PURPOSE.  See the GNU General Public License for more details.  *
+ *                                                                  *
+ *  You should have received a copy of the GNU General Public       *
+ *  License along with this program; if not, write to the Free      *
+ *  Software Foundation, Inc., 59 Temple Place, Suite 330, Boston,  *
+ *  MA  02111-1307  USA                                             *
+ *                                                                  *
+ ********************************************************************
+ *                                                                  *
+ *  PDS file statistics as printed by pdsinfo                       *
+ *                                                                  *
+ *  18/10/2026  GA           initial version, taken from pdsinfo    *
+ *  18/10/2026  GA           set of recent packets for duplicates   *
+ *  18/10/2026  GA           duplicate set with 32bit tags and no   *
+ *                           age array (4 MB instead of 8.25 MB) in *
+ *                           huge pages                             *
+ *                                                                  *
+ ********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "pdsstat.h"
+#include "pdsio.h"
+
+
+/********************************************************************
+ *                                                                  *
+ *  defines                                                         *
+ *                                                                  *
+ ********************************************************************/
+/* number of encoded values (without APIDs) */
+#define STAT_VALUES 18
+/* number of encoded values per APID */
+#define APID_VALUES 6
+/* number of entries per bucket of duplicate set */
+#define DUP_WAYS 4
+/* alignment of duplicate set (size of huge page) */
+#define DUP_ALIGN 2097152
+
+
+/********************************************************************
+ *                                                                  *
+ *  structure definitions                                           *
+ *                                                                  *
+ ********************************************************************/
+/* set of recent packets: buckets of DUP_WAYS packet tags (0 =
+	 empty), newest first, the oldest entry of a full bucket drops
+	 out */
+struct pds_dupset {
+	unsigned int *tag;
+	int bits;
+};
+
+
+/********************************************************************
+ *                                                                  *
+ *  function declarations                                           *
+ *                                                                  *
+ ********************************************************************/
+static long MissingPackets(long last_pkt_count, long pkt_count);
+static unsigned long long Mix64(unsigned long long x);
+static unsigned int DupHash(struct pds_dupset *d, int apid, int days,
+														unsigned long millisec, int microsec,
+														int pkt_count, unsigned int **b);
+static long GetValue(unsigned char *buf);
+
+
+/********************************************************************
+ *                                                                  *
+ *  initialise statistics                                           *
+ *                                                                  *
+ *  s: pointer to statistics                                        *
+ *                                                                  *
+ *  result:  none                                                   *
+ *                                                                  *
+ ********************************************************************/
+void StatInit(struct pds_stats *s) {
+	s->apidlist = NULL;
+	s->apidinfo = NULL;
+	s->firstday = 1.E6;
+	s->firstms = 1.E6;
+	s->firstmics = 1.E6;
+	s->lastday = 0;
+	s->lastms = 0;
+	s->lastmics = 0;
+	s->headday = 0;
+	s->headms = 0;
+	s->prevday = 0;
+	s->prevms = 0;
+	s->missingsecs = 0;
+	s->daypkts1 = 0;
+	s->daypkts2 = 0;
+	s->nightpkts1 = 0;
+	s->nightpkts2 = 0;
+	s->engpkts1 = 0;
+	s->engpkts2 = 0;
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  add primary header of a packet to statistics                    *
+ *                                                                  *
+ *  s:         pointer to statistics                                *
+ *  apid:      APID                                                 *
+ *  pkt_count: packet count                                         *
+ *                                                                  *
+ *  result:  number of missing packets before this packet           *
+ *           (16383 - duplicated packet)                            *
+ *          -1 - out of memory                                      *
+ *                                                                  *
+ ********************************************************************/
+long StatAddPacket(struct pds_stats *s, int apid, int pkt_count) {
+	/* number of missing packets */
+	long missing = 0;
+
+
+	/* do we have a current APID Info object? */
+	if(s->apidinfo != NULL) {
+		/* APID different as of current APID Info object? */
+		if(s->apidinfo->apid != apid) {
+			/* find APID Info object */
+			if(!(s->apidinfo = FindAPIDInfo(s->apidlist, apid))) {
+				/* allocate an APID Info object */
+				if(!(s->apidinfo = AllocAPIDInfo(apid)))
+					return(-1);
+
+				/* add APID Info object to list */
+				AddAPIDInfo(&(s->apidlist), s->apidinfo);
+			}
+		}
+	} else {
+		/* allocate an APID Info object */
+		if(!(s->apidinfo = AllocAPIDInfo(apid)))
+			return(-1);
+
+		/* add APID Info object to list */
+		AddAPIDInfo(&(s->apidlist), s->apidinfo);
+	}
+
+	/* increase packet counter */
+	s->apidinfo->count = s->apidinfo->count + 1;
+
+	/* check if there are missing packets */
+	/* first packet with this APID? */
+	if(s->apidinfo->last_pkt_count != -1) {
+		/* calculate number of missing packets */
+		missing = MissingPackets(s->apidinfo->last_pkt_count, pkt_count);
+
+		/* add to counter for missing packets */
+		s->apidinfo->missing += missing;
+	} else
+		s->apidinfo->first_pkt_count = pkt_count;
+
+	/* store packet count */
+	s->apidinfo->last_pkt_count = pkt_count;
+
+	/* that's it */
+	return(missing);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  add MODIS header of a packet to statistics                      *
+ *  (after StatAddPacket() for the same packet)                     *
+ *                                                                  *
+ *  s:    pointer to statistics                                     *
+ *  info: pointer to packet info                                    *
+ *                                                                  *
+ *  result:  none                                                   *
+ *                                                                  *
+ ********************************************************************/
+void StatAddMODIS(struct pds_stats *s, struct pkt_info *info) {
+	/* millisecs difference between packets */
+	long int diffms;
+
+
+	/* valid packet? */
+	if(!info->valid) {
+		/* increase invalid packet counter */
+		s->apidinfo->invalid = s->apidinfo->invalid + 1;
+	}
+
+	/* determine first and last packet date/time */
+	if((info->days < s->firstday) ||
+		 ((info->days == s->firstday) &&
+			((info->millisec < s->firstms) ||
+			 ((info->millisec == s->firstms) &&
+				(info->microsec < s->firstmics))))) {
+		s->firstday = info->days;
+		s->firstms = info->millisec;
+		s->firstmics = info->microsec;
+	}
+	if((info->days > s->lastday) ||
+		 ((info->days == s->lastday) &&
+			((info->millisec > s->lastms) ||
+			 ((info->millisec == s->lastms) &&
+				(info->microsec > s->lastmics))))) {
+		s->lastday = info->days;
+		s->lastms = info->millisec;
+		s->lastmics = info->microsec;
+	}
+
+	/* check if there are missing seconds */
+	if(s->prevday != 0) {
+		diffms =
+			info->millisec - s->prevms +
+			(info->days - s->prevday) * 86400000;
+		s->missingsecs += diffms / 1000;
+	} else {
+		s->headday = info->days;
+		s->headms = info->millisec;
+	}
+	s->prevday = info->days;
+	s->prevms = info->millisec;
+
+	/* earth view packet? */
+	if(info->src1 == 0) {
+		/* increase packet type counters? */
+		switch(info->pkt_type) {
+		case 0:
+			s->daypkts1++;
+			break;
+		case 1:
+			s->nightpkts1++;
+			break;
+		case 2:
+		case 4:
+			s->engpkts1++;
+			break;
+		}
+	} else {
+		/* increase packet type counters? */
+		switch(info->pkt_type) {
+		case 0:
+			s->daypkts2++;
+			break;
+		case 1:
+			s->nightpkts2++;
+			break;
+		case 2:
+		case 4:
+			s->engpkts2++;
+			break;
+		}
+	}
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  add a complete packet to statistics                             *
+ *                                                                  *
+ *  s:    pointer to statistics                                     *
+ *  info: pointer to packet info (apid < 0 - not a packet)          *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          -1 - out of memory                                      *
+ *                                                                  *
+ ********************************************************************/
+int StatAdd(struct pds_stats *s, struct pkt_info *info) {
+	/* not a packet? */
+	if(info->apid < 0)
+		return(0);
+
+	/* primary header */
+	if(StatAddPacket(s, info->apid, info->pkt_count) < 0)
+		return(-1);
+
+	/* MODIS header */
+	if(info->modis)
+		StatAddMODIS(s, info);
+
+	/* good */
+	return(0);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  merge statistics of the following part of a file                *
+ *                                                                  *
+ *  dst: pointer to statistics to merge into                        *
+ *  src: pointer to statistics of the part following dst            *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          -1 - out of memory                                      *
+ *                                                                  *
+ ********************************************************************/
+int StatMerge(struct pds_stats *dst, struct pds_stats *src) {
+	/* pointers to APID Info objects */
+	struct apid_info *p, *q;
+
+
+	/* APIDs */
+	for(p = src->apidlist; p != NULL; p = p->next) {
+		if(!(q = FindAPIDInfo(dst->apidlist, p->apid))) {
+			if(!(q = AllocAPIDInfo(p->apid)))
+				return(-1);
+			q->first_pkt_count = p->first_pkt_count;
+			AddAPIDInfo(&(dst->apidlist), q);
+		} else
+			q->missing += MissingPackets(q->last_pkt_count,
+																	 p->first_pkt_count);
+		q->count += p->count;
+		q->invalid += p->invalid;
+		q->missing += p->missing;
+		q->last_pkt_count = p->last_pkt_count;
+	}
+
+	/* no MODIS packets in following part? */
+	if(src->headday == 0)
+		return(0);
+
+	/* first and last packet date/time */
+	if((src->firstday < dst->firstday) ||
+		 ((src->firstday == dst->firstday) &&
+			((src->firstms < dst->firstms) ||
+			 ((src->firstms == dst->firstms) &&
+				(src->firstmics < dst->firstmics))))) {
+		dst->firstday = src->firstday;
+		dst->firstms = src->firstms;
+		dst->firstmics = src->firstmics;
+	}
+	if((src->lastday > dst->lastday) ||
+		 ((src->lastday == dst->lastday) &&
+			((src->lastms > dst->lastms) ||
+			 ((src->lastms == dst->lastms) &&
+				(src->lastmics > dst->lastmics))))) {
+		dst->lastday = src->lastday;
+		dst->lastms = src->lastms;
+		dst->lastmics = src->lastmics;
+	}
+
+	/* missing seconds, including the gap between both parts */
+	if(dst->prevday != 0)
+		dst->missingsecs +=
+			(src->headms - dst->prevms +
+			 (src->headday - dst->prevday) * 86400000) / 1000;
+	else {
+		dst->headday = src->headday;
+		dst->headms = src->headms;
+	}
+	dst->missingsecs += src->missingsecs;
+	dst->prevday = src->prevday;
+	dst->prevms = src->prevms;
+
+	/* packet type counters */
+	dst->daypkts1 += src->daypkts1;
+	dst->daypkts2 += src->daypkts2;
+	dst->nightpkts1 += src->nightpkts1;
+	dst->nightpkts2 += src->nightpkts2;
+	dst->engpkts1 += src->engpkts1;
+	dst->engpkts2 += src->engpkts2;
+
+	/* fine */
+	return(0);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  encode statistics                                               *
+ *                                                                  *
+ *  The statistics are stored as signed 32 bit little endian        *
+ *  values, followed by six values for each APID.                   *
+ *                                                                  *
+ *  s:   pointer to statistics                                      *
+ *  buf: pointer to buffer (NULL - only determine size)             *
+ *                                                                  *
+ *  result:  size of encoded statistics                             *
+ *                                                                  *
+ ********************************************************************/
+int StatEncode(struct pds_stats *s, unsigned char *buf) {
+	/* pointer to APID Info object */
+	struct apid_info *p;
+	/* number of APIDs */
+	int napid;
+	/* values */
+	long v[STAT_VALUES];
+	/* counter */
+	int i;
+
+
+	/* count APIDs */
+	for(p = s->apidlist, napid = 0; p != NULL; p = p->next)
+		napid++;
+
+	/* size only? */
+	if(buf == NULL)
+		return(4 * (STAT_VALUES + APID_VALUES * napid));
+
+	/* statistics */
+	v[0] = s->firstday;
+	v[1] = s->firstms;
+	v[2] = s->firstmics;
+	v[3] = s->lastday;
+	v[4] = s->lastms;
+	v[5] = s->lastmics;
+	v[6] = s->headday;
+	v[7] = s->headms;
+	v[8] = s->prevday;
+	v[9] = s->prevms;
+	v[10] = s->missingsecs;
+	v[11] = s->daypkts1;
+	v[12] = s->daypkts2;
+	v[13] = s->nightpkts1;
+	v[14] = s->nightpkts2;
+	v[15] = s->engpkts1;
+	v[16] = s->engpkts2;
+	v[17] = napid;
+	for(i = 0; i < STAT_VALUES; i++, buf += 4)
+		PutLE(buf, v[i], 4);
+
+	/* APIDs */
+	for(p = s->apidlist; p != NULL; p = p->next, buf += 4 * APID_VALUES) {
+		PutLE(buf, p->apid, 4);
+		PutLE(buf + 4, p->count, 4);
+		PutLE(buf + 8, p->invalid, 4);
+		PutLE(buf + 12, p->missing, 4);
+		PutLE(buf + 16, p->first_pkt_count, 4);
+		PutLE(buf + 20, p->last_pkt_count, 4);
+	}
+
+	/* return size */
+	return(4 * (STAT_VALUES + APID_VALUES * napid));
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  decode statistics                                               *
+ *                                                                  *
+ *  buf:  pointer to encoded statistics                             *
+ *  size: size of buffer                                            *
+ *  s:    pointer to statistics                                     *
+ *                                                                  *
+ *  result:  0 - ok                                                 *
+ *          -1 - corrupted statistics or out of memory              *
+ *                                                                  *
+ ********************************************************************/
+int StatDecode(unsigned char *buf, int size, struct pds_stats *s) {
+	/* pointer to APID Info object */
+	struct apid_info *p;
+	/* number of APIDs */
+	long napid;
+	/* values */
+	long v[STAT_VALUES];
+	/* counter */
+	int i;
+
+
+	/* initialise statistics */
+	StatInit(s);
+
+	/* statistics */
+	if(size < 4 * STAT_VALUES)
+		return(-1);
+	for(i = 0; i < STAT_VALUES; i++, buf += 4)
+		v[i] = GetValue(buf);
+	s->firstday = v[0];
+	s->firstms = v[1];
+	s->firstmics = v[2];
+	s->lastday = v[3];
+	s->lastms = v[4];
+	s->lastmics = v[5];
+	s->headday = v[6];
+	s->headms = v[7];
+	s->prevday = v[8];
+	s->prevms = v[9];
+	s->missingsecs = v[10];
+	s->daypkts1 = v[11];
+	s->daypkts2 = v[12];
+	s->nightpkts1 = v[13];
+	s->nightpkts2 = v[14];
+	s->engpkts1 = v[15];
+	s->engpkts2 = v[16];
+	napid = v[17];
+
+	/* APIDs */
+	if((napid < 0) || (size < 4 * (STAT_VALUES + APID_VALUES * napid)))
+		return(-1);
+	for(; napid > 0; napid--, buf += 4 * APID_VALUES) {
+		if(!(p = AllocAPIDInfo(GetValue(buf)))) {
+			StatFree(s);
+			return(-1);
+		}
+		p->count = GetValue(buf + 4);
+		p->invalid = GetValue(buf + 8);
+		p->missing = GetValue(buf + 12);
+		p->first_pkt_count = GetValue(buf + 16);
+		p->last_pkt_count = GetValue(buf + 20);
+		AddAPIDInfo(&(s->apidlist), p);
+	}
+
+	/* continue with first APID (StatAdd() would add it again) */
+	s->apidinfo = s->apidlist;
+
+	/* ok */
+	return(0);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  free statistics                                                 *
+ *                                                                  *
+ *  s: pointer to statistics                                        *
+ *                                                                  *
+ *  result:  none                                                   *
+ *                                                                  *
+ ********************************************************************/
+void StatFree(struct pds_stats *s) {
+	FreeAPIDInfoList(s->apidlist);
+	s->apidlist = NULL;
+	s->apidinfo = NULL;
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  allocate and initialise APID Info object                        *
+ *                                                                  *
+ *  apid: APID                                                      *
+ *                                                                  *
+ *  result:  pointer to APID Info object                            *
+ *           0 - error                                              *
+ *                                                                  *
+ ********************************************************************/
+struct apid_info *AllocAPIDInfo(int apid) {
+	/* pointer to APID Info object */
+	struct apid_info *ai;
+
+
+	/* allocate memory for object */
+	if(!(ai = malloc(sizeof(struct apid_info))))
+		return(0);
+
+	/* store APID */
+	ai->apid = apid;
+
+	/* initialise packet counter */
+	ai->count = 0;
+
+	/* initialise invalid packet counter */
+	ai->invalid = 0;
+
+	/* initialise missing packet counter */
+	ai->missing = 0;
+
+	/* initialise first and last packet count value */
+	ai->first_pkt_count = -1;
+	ai->last_pkt_count = -1;
+
+	/* initialise pointer to next object */
+	ai->next = NULL;
+
+	/* all done */
+	return(ai);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  add APID Info object to list                                    *
+ *                                                                  *
+ *  list: pointer to pointer to first object in list                *
+ *  ai:   pointer to APID Info object to be added                   *
+ *                                                                  *
+ *  result:  none                                                   *
+ *                                                                  *
+ ********************************************************************/
+void AddAPIDInfo(struct apid_info **list, struct apid_info *ai) {
+	/* pointer to APID Info object */
+	struct apid_info *p;
+
+
+	/* empty list? */
+	if(*list == NULL) {
+		/* add object as first in list */
+		*list = ai;
+
+		/* ciao */
+		return;
+	}
+
+	/* first object? */
+	if((*list)->apid > ai->apid) {
+		/* add object as first in list */
+		ai->next = *list;
+		*list = ai;
+
+		/* Tschuess */
+		return;
+	}
+
+	/* find right place in list */
+	for(p = *list; p->next != NULL; p = p->next) {
+		/* reached right position */
+		if(p->next->apid > ai->apid) {
+			/* add object to list */
+			ai->next = p->next;
+			p->next = ai;
+
+			/* all good */
+			return;
+		}
+	}
+
+	/* add object as last in list */
+	p->next = ai;
+	
+	/* hasta la vista*/
+	return;
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  free memory in APID list                                        *
+ *                                                                  *
+ *  list: pointer to first object in list                           *
+ *                                                                  *
+ *  result:  none                                                   *
+ *                                                                  *
+ ********************************************************************/
+void FreeAPIDInfoList(struct apid_info *list) {
+	/* pointers to APID Info objects */
+	struct apid_info *p1, *p2;
+
+
+	/* go through list */
+	for(p1 = list; p1 != NULL; p1 = p2) {
+		/* get pointer to next object */
+		p2 = p1->next;
+
+		/* free memory of current object */
+		free(p1);
+	}
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  find APID Info object                                           *
+ *                                                                  *
+ *  list: pointer to first object in list                           *
+ *  apid: APID                                                      *
+ *                                                                  *
+ *  result:  pointer to APID Info object                            *
+ *           0 - APID Info object not found                         *
+ *                                                                  *
+ ********************************************************************/
+struct apid_info *FindAPIDInfo(struct apid_info *list, int apid) {
+	/* pointer to APID Info object */
+	struct apid_info *p;
+
+
+	/* go through list */
+	for(p = list; p != NULL; p = p->next) {
+		/* right APID? */
+		if(p->apid == apid)
+			/* return object address */
+			return(p);
+	}
+
+	/* couldn't find object */
+	return(NULL);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  create set of recent packets for duplicate detection            *
+ *                                                                  *
+ *  The set holds DUP_WAYS << bits packets (4 bytes each), older    *
+ *  packets drop out when their bucket is full. Duplicates further  *
+ *  apart than about this number of packets aren't found. Lookups   *
+ *  go anywhere in the set, so it's aligned for huge pages to keep  *
+ *  them from missing the TLB as well as the cache.                 *
+ *                                                                  *
+ *  bits: log2 of number of buckets                                 *
+ *                                                                  *
+ *  result:  pointer to set                                         *
+ *           NULL - out of memory                                   *
+ *                                                                  *
+ ********************************************************************/
+struct pds_dupset *DupCreate(int bits) {
+	/* set */
+	struct pds_dupset *d;
+	/* size of buckets */
+	size_t size;
+
+
+	/* allocate memory */
+	if(!(d = calloc(1, sizeof(struct pds_dupset))))
+		return(NULL);
+	d->bits = bits;
+	size = ((size_t)DUP_WAYS << bits) * sizeof(unsigned int);
+	if(posix_memalign((void **)&(d->tag), DUP_ALIGN, size)) {
+		d->tag = NULL;
+		DupFree(d);
+		return(NULL);
+	}
+#ifdef MADV_HUGEPAGE
+	madvise(d->tag, size, MADV_HUGEPAGE);
+#endif
+	memset(d->tag, 0, size);
+
+	/* fine */
+	return(d);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  test if packet is in set of recent packets                      *
+ *                                                                  *
+ *  d:         pointer to set                                       *
+ *  apid:      APID                                                 *
+ *  days:      days since 01/01/1958                                *
+ *  millisec:  milliseconds of day                                  *
+ *  microsec:  microseconds of millisecond                          *
+ *  pkt_count: packet count                                         *
+ *                                                                  *
+ *  result: 1 - duplicate of a packet in set                        *
+ *          0 - new packet                                          *
+ *                                                                  *
+ ********************************************************************/
+int DupTest(struct pds_dupset *d, int apid, int days,
+						unsigned long millisec, int microsec, int pkt_count) {
+	/* tag of packet */
+	unsigned int t;
+	/* pointer to bucket */
+	unsigned int *b;
+
+
+	/* in bucket? */
+	t = DupHash(d, apid, days, millisec, microsec, pkt_count, &b);
+
+	/* gut */
+	return((b[0] == t) || (b[1] == t) || (b[2] == t) || (b[3] == t));
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  add packet to set of recent packets                             *
+ *                                                                  *
+ *  The packet goes first in its bucket, the oldest entry drops     *
+ *  out, so only packets not in the set should be added (see        *
+ *  DupTest()).                                                     *
+ *                                                                  *
+ *  d:         pointer to set                                       *
+ *  apid:      APID                                                 *
+ *  days:      days since 01/01/1958                                *
+ *  millisec:  milliseconds of day                                  *
+ *  microsec:  microseconds of millisecond                          *
+ *  pkt_count: packet count                                         *
+ *                                                                  *
+ *  result: none                                                    *
+ *                                                                  *
+ ********************************************************************/
+void DupAdd(struct pds_dupset *d, int apid, int days,
+						unsigned long millisec, int microsec, int pkt_count) {
+	/* tag of packet */
+	unsigned int t;
+	/* pointer to bucket */
+	unsigned int *b;
+
+
+	/* shift bucket, oldest entry drops out */
+	t = DupHash(d, apid, days, millisec, microsec, pkt_count, &b);
+	b[3] = b[2];
+	b[2] = b[1];
+	b[1] = b[0];
+	b[0] = t;
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  free set of recent packets                                      *
+ *                                                                  *
+ *  d: pointer to set (or NULL)                                     *
+ *                                                                  *
+ *  result: none                                                    *
+ *                                                                  *
+ ********************************************************************/
+void DupFree(struct pds_dupset *d) {
+	if(!d)
+		return;
+	free(d->tag);
+	free(d);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  calculate number of missing packets between two packet counts   *
+ *                                                                  *
+ *  last_pkt_count: packet count of previous packet                 *
+ *  pkt_count:      packet count of current packet                  *
+ *                                                                  *
+ *  result: number of missing packets (16383 - same packet count)   *
+ *                                                                  *
+ ********************************************************************/
+static long MissingPackets(long last_pkt_count, long pkt_count) {
+	return((pkt_count > last_pkt_count)?
+				 (pkt_count - last_pkt_count - 1):
+				 (pkt_count - last_pkt_count + 16383));
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  get signed 32 bit little endian value                           *
+ *                                                                  *
+ *  buf: pointer to buffer                                          *
+ *                                                                  *
+ *  result: value                                                   *
+ *                                                                  *
+ ********************************************************************/
+static long GetValue(unsigned char *buf) {
+	/* value */
+	unsigned long x;
+
+
+	x = GetLE(buf, 4);
+
+	/* sign extension */
+	return((x & 0x80000000UL) ? (long)x - 0x100000000L : (long)x);
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  mix bits of 64 bit value (finaliser of splitmix64)              *
+ *                                                                  *
+ *  x: value                                                        *
+ *                                                                  *
+ *  result: mixed value                                             *
+ *                                                                  *
+ ********************************************************************/
+static unsigned long long Mix64(unsigned long long x) {
+	x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+	return(x ^ (x >> 31));
+}
+
+
+/********************************************************************
+ *                                                                  *
+ *  hash of packet for set of recent packets                        *
+ *                                                                  *
+ *  Packets are identified by a 64 bit hash of APID, time and       *
+ *  packet count, its top bits select the bucket and its low 32     *
+ *  bits are the tag stored in the bucket.                          *
+ *                                                                  *
+ *  d:         pointer to set                                       *
+ *  apid:      APID                                                 *
+ *  days:      days since 01/01/1958                                *
+ *  millisec:  milliseconds of day                                  *
+ *  microsec:  microseconds of millisecond                          *
+ *  pkt_count: packet count                                         *
+ *  b:         pointer to store pointer to bucket                   *
+ *                                                                  *
+ *  result: tag (never 0)                                           *
+ *                                                                  *
+ ********************************************************************/
+static unsigned int DupHash(struct pds_dupset *d, int apid, int days,
+														unsigned long millisec, int microsec,
+														int pkt_count, unsigned int **b) {
+	/* hash of packet */
+	unsigned long long h;
+
+
+	/* hash */
+	h = Mix64(((unsigned long long)days * 86400000ULL + millisec) * 1000ULL +
+						(unsigned long long)(microsec & 0xFFFF));
+	h = Mix64(h ^ (((unsigned long long)apid << 14) | (pkt_count & 0x3FFF)));
+
+	/* bucket */
+	*b = d->tag + (size_t)(h >> (64 - d->bits)) * DUP_WAYS;
+
+	/* tag, never 0 */
+	return((unsigned int)(h & 0xFFFFFFFFUL) | 1);
+}
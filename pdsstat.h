@@ -0,0 +1,127 @@
+/********************************************************************
+ *                                                                  *
+ *  Copyright (C) 2026                                              *
+ *  Geoscience Australia, Canberra, Australia                       *
+ *                                                                  *
+ *  This program is free software; you can redistribute it and/or   *
+ *  modify it under the terms of the GNU General Public License as  *
+ *  published by the Free Software Foundation; either version 2 of  *
+ *  the License, or (at your option) any later version.             *
+ *                                                                  *
+ *  This program is distributed in the hope that it will be         *
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied      *
+ *  warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR         *
+ *  PURPOSE.  See the GNU General Public License for more details.  *
+ *                                                                  *
+ *  You should have received a copy of the GNU General Public       *
+ *  License along with this program; if not, write to the Free      *
+ *  Software Foundation, Inc., 59 Temple Place, Suite 330, Boston,  *
+ *  MA  02111-1307  USA                                             *
+ *                                                                  *
+ ********************************************************************
+ *                                                                  *
+ *  PDS file statistics as printed by pdsinfo                       *
+ *                                                                  *
+ *  Statistics of consecutive parts of a file (e.g. the blocks of   *
+ *  a PDS archive) can be merged into the statistics of the whole   *
+ *  file, giving the same result as a single pass over the file.    *
+ *                                                                  *
+ *  The duplicate set (DupCreate()) finds packets repeated anywhere *
+ *  within a bounded window of recent packets in constant memory.   *
+ *                                                                  *
+ ********************************************************************/
+
+#ifndef PDSSTAT_H
+#define PDSSTAT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/********************************************************************
+ *                                                                  *
+ *  structure definitions                                           *
+ *                                                                  *
+ ********************************************************************/
+/* packet info */
+struct pkt_info {
+	int apid;
+	int pkt_count;
+	int modis;
+	int valid;
+	int days;
+	unsigned long int millisec;
+	int microsec;
+	int pkt_type;
+	int src1;
+};
+
+/* APID info */
+struct apid_info {
+	int apid;
+	long int count;
+	long int invalid;
+	long int missing;
+	long int first_pkt_count;
+	long int last_pkt_count;
+	struct apid_info *next;
+};
+
+/* set of recent packets for duplicate detection (private) */
+struct pds_dupset;
+
+/* statistics */
+struct pds_stats {
+	/* APID Info list */
+	struct apid_info *apidlist;
+	/* current APID Info object */
+	struct apid_info *apidinfo;
+	/* first packet date/time */
+	long int firstday, firstms, firstmics;
+	/* last packet date/time */
+	long int lastday, lastms, lastmics;
+	/* date/time of first MODIS packet in file order */
+	long int headday, headms;
+	/* date/time of previous MODIS packet in file order */
+	long int prevday, prevms;
+	/* number of missing seconds */
+	long int missingsecs;
+	/* number of day packets (earth view/calibration) */
+	long int daypkts1, daypkts2;
+	/* number of night packets */
+	long int nightpkts1, nightpkts2;
+	/* number of engineering packets */
+	long int engpkts1, engpkts2;
+};
+
+
+/********************************************************************
+ *                                                                  *
+ *  function declarations                                           *
+ *                                                                  *
+ ********************************************************************/
+void StatInit(struct pds_stats *s);
+long StatAddPacket(struct pds_stats *s, int apid, int pkt_count);
+void StatAddMODIS(struct pds_stats *s, struct pkt_info *info);
+int StatAdd(struct pds_stats *s, struct pkt_info *info);
+int StatMerge(struct pds_stats *dst, struct pds_stats *src);
+int StatEncode(struct pds_stats *s, unsigned char *buf);
+int StatDecode(unsigned char *buf, int size, struct pds_stats *s);
+void StatFree(struct pds_stats *s);
+struct apid_info *AllocAPIDInfo(int apid);
+void AddAPIDInfo(struct apid_info **list, struct apid_info *ai);
+void FreeAPIDInfoList(struct apid_info *list);
+struct apid_info *FindAPIDInfo(struct apid_info *list, int apid);
+struct pds_dupset *DupCreate(int bits);
+int DupTest(struct pds_dupset *d, int apid, int days,
+						unsigned long millisec, int microsec, int pkt_count);
+void DupAdd(struct pds_dupset *d, int apid, int days,
+						unsigned long millisec, int microsec, int pkt_count);
+void DupFree(struct pds_dupset *d);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif